@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "effect-impl/BiquadCascade.h"
+
+namespace aidl::android::hardware::audio::effect {
+
+namespace {
+
+struct CookbookParameters {
+    double a;  // amplitude
+    double cosW0;
+    double alpha;
+};
+
+CookbookParameters getCookbookParameters(float sampleRate, float frequency, float q,
+                                         float gainDb) {
+    const double w0 = 2 * M_PI * frequency / sampleRate;
+    return {.a = std::pow(10., gainDb / 40.),
+            .cosW0 = std::cos(w0),
+            .alpha = std::sin(w0) / (2 * q)};
+}
+
+BiquadCoefficients normalize(double b0, double b1, double b2, double a0, double a1, double a2) {
+    return {.b0 = static_cast<float>(b0 / a0),
+            .b1 = static_cast<float>(b1 / a0),
+            .b2 = static_cast<float>(b2 / a0),
+            .a1 = static_cast<float>(a1 / a0),
+            .a2 = static_cast<float>(a2 / a0)};
+}
+
+}  // namespace
+
+BiquadCoefficients BiquadCoefficients::peaking(float sampleRate, float frequency, float q,
+                                               float gainDb) {
+    const auto [a, cosW0, alpha] = getCookbookParameters(sampleRate, frequency, q, gainDb);
+    return normalize(1 + alpha * a, -2 * cosW0, 1 - alpha * a, 1 + alpha / a, -2 * cosW0,
+                     1 - alpha / a);
+}
+
+BiquadCoefficients BiquadCoefficients::lowShelf(float sampleRate, float frequency, float q,
+                                                float gainDb) {
+    const auto [a, cosW0, alpha] = getCookbookParameters(sampleRate, frequency, q, gainDb);
+    const double sqrtAAlpha2 = 2 * std::sqrt(a) * alpha;
+    return normalize(a * ((a + 1) - (a - 1) * cosW0 + sqrtAAlpha2),
+                     2 * a * ((a - 1) - (a + 1) * cosW0),
+                     a * ((a + 1) - (a - 1) * cosW0 - sqrtAAlpha2),
+                     (a + 1) + (a - 1) * cosW0 + sqrtAAlpha2, -2 * ((a - 1) + (a + 1) * cosW0),
+                     (a + 1) + (a - 1) * cosW0 - sqrtAAlpha2);
+}
+
+BiquadCoefficients BiquadCoefficients::highShelf(float sampleRate, float frequency, float q,
+                                                 float gainDb) {
+    const auto [a, cosW0, alpha] = getCookbookParameters(sampleRate, frequency, q, gainDb);
+    const double sqrtAAlpha2 = 2 * std::sqrt(a) * alpha;
+    return normalize(a * ((a + 1) + (a - 1) * cosW0 + sqrtAAlpha2),
+                     -2 * a * ((a - 1) + (a + 1) * cosW0),
+                     a * ((a + 1) + (a - 1) * cosW0 - sqrtAAlpha2),
+                     (a + 1) - (a - 1) * cosW0 + sqrtAAlpha2, 2 * ((a - 1) - (a + 1) * cosW0),
+                     (a + 1) - (a - 1) * cosW0 - sqrtAAlpha2);
+}
+
+BiquadCoefficients BiquadCoefficients::lowPass(float sampleRate, float frequency, float q) {
+    const auto [a, cosW0, alpha] = getCookbookParameters(sampleRate, frequency, q, 0.f);
+    return normalize((1 - cosW0) / 2, 1 - cosW0, (1 - cosW0) / 2, 1 + alpha, -2 * cosW0,
+                     1 - alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::highPass(float sampleRate, float frequency, float q) {
+    const auto [a, cosW0, alpha] = getCookbookParameters(sampleRate, frequency, q, 0.f);
+    return normalize((1 + cosW0) / 2, -(1 + cosW0), (1 + cosW0) / 2, 1 + alpha, -2 * cosW0,
+                     1 - alpha);
+}
+
+BiquadCascade::BiquadCascade(size_t channelCount, size_t sectionCount)
+    : mChannelCount(channelCount),
+      mSectionCount(sectionCount),
+      mSectionLanes(channelCount <= 2 ? channelCount
+                                      : (channelCount + kLanes - 1) / kLanes * kLanes),
+      mVectorCount((sectionCount * mSectionLanes + kLanes - 1) / kLanes),
+      mTargets(mVectorCount),
+      mCoefficients(mVectorCount),
+      mRampSteps(mVectorCount),
+      mZ1(mVectorCount),
+      mZ2(mVectorCount),
+      mOutputs(mVectorCount),
+      mSections(mVectorCount) {
+    for (size_t lane = 0; lane < mVectorCount * kLanes; lane++) {
+        mSections[lane / kLanes][lane % kLanes] =
+                mSectionLanes > 0 ? std::min(lane / mSectionLanes, mSectionCount) : 0;
+    }
+    // Pass-through filters, including the lanes of the padding
+    for (auto& target : mTargets) {
+        target.b0 = Vector{} + 1.f;
+    }
+    reset();
+}
+
+void BiquadCascade::setCoefficients(size_t section, const BiquadCoefficients& coefficients,
+                                    size_t rampFrames) {
+    for (size_t channel = 0; channel < mChannelCount; channel++) {
+        setTarget(section, channel, coefficients, rampFrames == 0);
+    }
+    if (rampFrames > 0) {
+        startRamp(rampFrames);
+    }
+}
+
+void BiquadCascade::setCoefficients(size_t section, size_t channel,
+                                    const BiquadCoefficients& coefficients, size_t rampFrames) {
+    setTarget(section, channel, coefficients, rampFrames == 0);
+    if (rampFrames > 0) {
+        startRamp(rampFrames);
+    }
+}
+
+void BiquadCascade::setTarget(size_t section, size_t channel,
+                              const BiquadCoefficients& coefficients, bool apply) {
+    const size_t v = (section * mSectionLanes + channel) / kLanes;
+    const size_t lane = (section * mSectionLanes + channel) % kLanes;
+    for (auto* c : {&mTargets[v], apply ? &mCoefficients[v] : nullptr}) {
+        if (c != nullptr) {
+            c->b0[lane] = coefficients.b0;
+            c->b1[lane] = coefficients.b1;
+            c->b2[lane] = coefficients.b2;
+            c->a1[lane] = coefficients.a1;
+            c->a2[lane] = coefficients.a2;
+        }
+    }
+    if (apply) {
+        // the pending ramp, if any, goes on for the other filters
+        VectorCoefficients& d = mRampSteps[v];
+        d.b0[lane] = d.b1[lane] = d.b2[lane] = d.a1[lane] = d.a2[lane] = 0.f;
+    }
+}
+
+void BiquadCascade::startRamp(size_t rampFrames) {
+    const float scale = 1.f / rampFrames;
+    for (size_t v = 0; v < mVectorCount; v++) {
+        const VectorCoefficients& t = mTargets[v];
+        const VectorCoefficients& c = mCoefficients[v];
+        mRampSteps[v] = {(t.b0 - c.b0) * scale, (t.b1 - c.b1) * scale, (t.b2 - c.b2) * scale,
+                         (t.a1 - c.a1) * scale, (t.a2 - c.a2) * scale};
+    }
+    mRampFrames = rampFrames;
+}
+
+void BiquadCascade::reset() {
+    std::fill(mZ1.begin(), mZ1.end(), Vector{});
+    std::fill(mZ2.begin(), mZ2.end(), Vector{});
+    std::fill(mOutputs.begin(), mOutputs.end(), Vector{});
+    mCoefficients = mTargets;
+    std::fill(mRampSteps.begin(), mRampSteps.end(), VectorCoefficients{});
+    mRampFrames = 0;
+}
+
+void BiquadCascade::process(const float* in, float* out, size_t frameCount) {
+    if (mChannelCount == 0 || frameCount == 0) {
+        return;
+    }
+    if (mSectionCount == 0) {
+        std::memmove(out, in, frameCount * mChannelCount * sizeof(float));
+        return;
+    }
+
+    switch (mSectionLanes) {
+        case 1:
+            processFrames<1>(in, out, frameCount);
+            break;
+        case 2:
+            processFrames<2>(in, out, frameCount);
+            break;
+        default:
+            processFrames<0>(in, out, frameCount);
+            break;
+    }
+    mRampFrames -= std::min(mRampFrames, frameCount);
+}
+
+template <size_t kSectionLanes>
+void BiquadCascade::processFrames(const float* in, float* out, size_t frameCount) {
+    // Steps filling the skew, where the last sections have no frame yet
+    const size_t fillEnd = std::min(mSectionCount - 1, frameCount);
+    // Steps draining the skew, where the first sections have no frame left
+    const size_t drainBegin = std::max(fillEnd, frameCount);
+    const size_t stepCount = frameCount + mSectionCount - 1;
+
+    for (size_t step = 0; step < stepCount; step++) {
+        const bool masked = step < fillEnd || step >= drainBegin;
+        // The filters of section s reach the end of the ramp at step mRampFrames - 1 + s
+        Ramp ramp = Ramp::MASKED;
+        if (mRampFrames == 0 || step >= mRampFrames + mSectionCount - 1) {
+            ramp = Ramp::NONE;
+        } else if (step + 1 < mRampFrames) {
+            ramp = Ramp::ALL;
+        }
+        switch (ramp) {
+            case Ramp::NONE:
+                masked ? processStep<kSectionLanes, true, Ramp::NONE>(in, out, step, frameCount)
+                       : processStep<kSectionLanes, false, Ramp::NONE>(in, out, step, frameCount);
+                break;
+            case Ramp::ALL:
+                masked ? processStep<kSectionLanes, true, Ramp::ALL>(in, out, step, frameCount)
+                       : processStep<kSectionLanes, false, Ramp::ALL>(in, out, step, frameCount);
+                break;
+            case Ramp::MASKED:
+                masked ? processStep<kSectionLanes, true, Ramp::MASKED>(in, out, step, frameCount)
+                       : processStep<kSectionLanes, false, Ramp::MASKED>(in, out, step,
+                                                                        frameCount);
+                break;
+        }
+    }
+}
+
+// The input of the filters of vector v: the frame for the first section, the previous output of
+// section s - 1 for section s.
+template <size_t kSectionLanes>
+inline BiquadCascade::Vector BiquadCascade::getInput(const float* in, size_t v) const {
+    const Vector* outputs = mOutputs.data();
+    if constexpr (kSectionLanes == 1) {
+        if (v == 0) {
+            return __builtin_shufflevector(Vector{in[0]}, outputs[0], 0, 4, 5, 6);
+        }
+        return __builtin_shufflevector(outputs[v - 1], outputs[v], 3, 4, 5, 6);
+    } else if constexpr (kSectionLanes == 2) {
+        if (v == 0) {
+            return __builtin_shufflevector(Vector{in[0], in[1]}, outputs[0], 0, 1, 4, 5);
+        }
+        return __builtin_shufflevector(outputs[v - 1], outputs[v], 2, 3, 4, 5);
+    } else {
+        const size_t frameVectors = mSectionLanes / kLanes;
+        if (v >= frameVectors) {
+            return outputs[v - frameVectors];
+        }
+        const size_t channel = v * kLanes;
+        switch (std::min(mChannelCount - channel, kLanes)) {
+            case 1:
+                return Vector{in[channel]};
+            case 2:
+                return Vector{in[channel], in[channel + 1]};
+            case 3:
+                return Vector{in[channel], in[channel + 1], in[channel + 2]};
+            default: {
+                Vector x;
+                std::memcpy(&x, in + channel, sizeof(x));
+                return x;
+            }
+        }
+    }
+}
+
+template <size_t kSectionLanes, bool kMasked, BiquadCascade::Ramp kRamp>
+inline void BiquadCascade::processStep(const float* in, float* out, size_t step,
+                                       size_t frameCount) {
+    // Sections [first, last] have a frame to filter at this step
+    const float first = static_cast<float>(step) - frameCount + 1;
+    const float last = step;
+    // Sections reaching the end of the ramp at this step, the following ones are still ramping
+    const float rampEnd = static_cast<float>(step) - mRampFrames + 1;
+    // The frame of the first section. While draining the first section is masked, and any
+    // frame will do.
+    const float* frame = in + std::min(step, frameCount - 1) * mChannelCount;
+
+    Vector* const outputs = mOutputs.data();
+    Vector* const z1 = mZ1.data();
+    Vector* const z2 = mZ2.data();
+    // From the last vector down, so that the previous outputs are read before they are updated
+    for (size_t v = mVectorCount; v-- > 0;) {
+        const Vector x = getInput<kSectionLanes>(frame, v);
+        const Mask active = kMasked ? (mSections[v] >= first) & (mSections[v] <= last)
+                                    : Mask{} - 1;
+        if constexpr (kRamp != Ramp::NONE) {
+            const VectorCoefficients& d = mRampSteps[v];
+            const VectorCoefficients& t = mTargets[v];
+            VectorCoefficients& c = mCoefficients[v];
+            if (kRamp == Ramp::ALL && !kMasked) {
+                c = {c.b0 + d.b0, c.b1 + d.b1, c.b2 + d.b2, c.a1 + d.a1, c.a2 + d.a2};
+            } else {
+                const Mask ramping = kRamp == Ramp::ALL ? active
+                                                        : active & (mSections[v] > rampEnd);
+                const Mask ended = kRamp == Ramp::ALL ? Mask{}
+                                                      : active & (mSections[v] == rampEnd);
+                c = {select(ended, t.b0, c.b0 + select(ramping, d.b0, Vector{})),
+                     select(ended, t.b1, c.b1 + select(ramping, d.b1, Vector{})),
+                     select(ended, t.b2, c.b2 + select(ramping, d.b2, Vector{})),
+                     select(ended, t.a1, c.a1 + select(ramping, d.a1, Vector{})),
+                     select(ended, t.a2, c.a2 + select(ramping, d.a2, Vector{}))};
+            }
+        }
+        const VectorCoefficients c = mCoefficients[v];
+        const Vector y = c.b0 * x + z1[v];
+        if constexpr (kMasked) {
+            z1[v] = select(active, c.b1 * x - c.a1 * y + z2[v], z1[v]);
+            z2[v] = select(active, c.b2 * x - c.a2 * y, z2[v]);
+        } else {
+            z1[v] = c.b1 * x - c.a1 * y + z2[v];
+            z2[v] = c.b2 * x - c.a2 * y;
+        }
+        outputs[v] = y;
+    }
+
+    if (step + 1 < mSectionCount) {
+        return;
+    }
+    // Output of the last section
+    float* const outFrame = out + (step + 1 - mSectionCount) * mChannelCount;
+    const size_t lane = (mSectionCount - 1) * mSectionLanes;
+    if constexpr (kSectionLanes > 0) {
+        for (size_t channel = 0; channel < kSectionLanes; channel++) {
+            outFrame[channel] = outputs[lane / kLanes][lane % kLanes + channel];
+        }
+    } else {
+        for (size_t channel = 0; channel < mChannelCount; channel += kLanes) {
+            const Vector& y = outputs[(lane + channel) / kLanes];
+            if (mChannelCount - channel >= kLanes) {
+                std::memcpy(outFrame + channel, &y, sizeof(y));
+            } else {
+                for (size_t i = 0; i < mChannelCount - channel; i++) {
+                    outFrame[channel + i] = y[i];
+                }
+            }
+        }
+    }
+}
+
+}  // namespace aidl::android::hardware::audio::effect
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <memory>
 #define ATRACE_TAG ATRACE_TAG_AUDIO
 #define LOG_TAG "AHAL_EffectImpl"
@@ -394,6 +395,9 @@ void EffectImpl::process() {
         if (!inputMQ || !outputMQ) {
             return;
         }
+        if (isDirectProcessingSupported() && processDirect_l(*inputMQ, *outputMQ, *statusMQ)) {
+            return;
+        }
 
         assert(mImplContext->getWorkBufferSize() >=
                std::max(inputMQ->availableToRead(), outputMQ->availableToWrite()));
@@ -407,6 +411,101 @@ void EffectImpl::process() {
     }
 }
 
+bool EffectImpl::processDirect_l(EffectContext::DataMQ& inputMQ, EffectContext::DataMQ& outputMQ,
+                                 EffectContext::StatusMQ& statusMQ) {
+    // effectProcessImpl() produces as many samples as it consumes, so an output frame smaller
+    // than the input frame would not fit in the output MQ region.
+    const size_t frameSamples = mImplContext->getInputFrameSize() / sizeof(float);
+    if (frameSamples == 0 || mImplContext->getOutputFrameSize() / sizeof(float) != frameSamples) {
+        return false;
+    }
+    const size_t frames = std::min(inputMQ.availableToRead(), outputMQ.availableToWrite()) /
+                          frameSamples;
+    if (frames == 0) {
+        return false;
+    }
+
+    EffectContext::DataMQ::MemTransaction input;
+    EffectContext::DataMQ::MemTransaction output;
+    if (!inputMQ.beginRead(frames * frameSamples, &input) ||
+        !outputMQ.beginWrite(frames * frameSamples, &output)) {
+        return false;
+    }
+    // The regions of each MQ wrap around its ring at most once. If a frame straddles the wrap
+    // around, returns false and process() falls back to copying through the work buffer.
+    const auto& inputFirst = input.getFirstRegion();
+    const auto& outputFirst = output.getFirstRegion();
+    if (inputFirst.getLength() % frameSamples != 0 ||
+        outputFirst.getLength() % frameSamples != 0) {
+        return false;
+    }
+    const size_t inputWrapFrame = inputFirst.getLength() / frameSamples;
+    const size_t outputWrapFrame = outputFirst.getLength() / frameSamples;
+
+    // One call per span of frames contiguous in both MQs, stopping at the first status other
+    // than STATUS_OK, or at the first span producing less than its frames, so that the produced
+    // output stays contiguous. The frames not processed stay in the input MQ.
+    IEffect::Status status{STATUS_OK, 0, 0};
+    size_t frame = 0;
+    bool complete = true;
+    while (frame < frames && status.status == STATUS_OK && complete) {
+        size_t end = frames;
+        if (frame < inputWrapFrame) {
+            end = std::min(end, inputWrapFrame);
+        }
+        if (frame < outputWrapFrame) {
+            end = std::min(end, outputWrapFrame);
+        }
+        float* in = frame < inputWrapFrame
+                            ? inputFirst.getAddress() + frame * frameSamples
+                            : input.getSecondRegion().getAddress() +
+                                      (frame - inputWrapFrame) * frameSamples;
+        float* out = frame < outputWrapFrame
+                             ? outputFirst.getAddress() + frame * frameSamples
+                             : output.getSecondRegion().getAddress() +
+                                       (frame - outputWrapFrame) * frameSamples;
+        const size_t spanSamples = (end - frame) * frameSamples;
+        const IEffect::Status spanStatus = effectProcessImpl(in, out, spanSamples);
+        status.status = spanStatus.status;
+        status.fmqConsumed += spanStatus.fmqConsumed;
+        status.fmqProduced += spanStatus.fmqProduced;
+        complete = static_cast<size_t>(spanStatus.fmqProduced) >= spanSamples;
+        frame = end;
+    }
+    // Never commit more than the regions reserved above
+    const int processedSamples = frame * frameSamples;
+    status.fmqConsumed = std::clamp(status.fmqConsumed, 0, processedSamples);
+    status.fmqProduced = std::clamp(status.fmqProduced, 0, processedSamples);
+    inputMQ.commitRead(processedSamples);
+    outputMQ.commitWrite(status.fmqProduced);
+    statusMQ.writeBlocking(&status, 1);
+    return true;
+}
+
+bool EffectImpl::processInline(float* buffer, size_t frameCount, size_t channelCount,
+                               int sampleRate) {
+    // Waits for mImplMutex rather than bypassing the effect for the whole period. The other
+    // holders only copy parameters or process one block of the data MQs, and never wait on
+    // another thread while holding it, so the wait is short.
+    std::lock_guard lg(mImplMutex);
+    if ((mState != State::PROCESSING && mState != State::DRAINING) || !mImplContext) {
+        return false;
+    }
+    const size_t frameSize = channelCount * sizeof(float);
+    if (mImplContext->getInputFrameSize() != frameSize ||
+        mImplContext->getOutputFrameSize() != frameSize) {
+        return false;
+    }
+    const Parameter::Common common = mImplContext->getCommon();
+    if (common.input.base.sampleRate != sampleRate ||
+        common.output.base.sampleRate != sampleRate) {
+        return false;
+    }
+    const int samples = frameCount * channelCount;
+    const IEffect::Status status = effectProcessImpl(buffer, buffer, samples);
+    return status.status == STATUS_OK && status.fmqProduced == samples;
+}
+
 // A placeholder processing implementation to copy samples from input to output
 IEffect::Status EffectImpl::effectProcessImpl(float* in, float* out, int samples) {
     for (int i = 0; i < samples; i++) {
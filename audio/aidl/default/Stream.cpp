@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <numeric>
+
 #include <pthread.h>
 
 #define ATRACE_TAG ATRACE_TAG_AUDIO
@@ -165,6 +167,20 @@ std::string StreamWorkerCommonLogic::init() {
 void StreamWorkerCommonLogic::onBufferStateChange(size_t /*bufferFramesLeft*/) {}
 void StreamWorkerCommonLogic::onClipStateChange(size_t /*clipFramesLeft*/, bool /*hasNextClip*/) {}
 
+StreamWorkerCommonLogic::DataBufferElement* StreamWorkerCommonLogic::getDirectTransferBuffer(
+        const StreamContext::DataMQ::MemTransaction& transaction, size_t byteCount) const {
+    const auto& region = transaction.getFirstRegion();
+    DataBufferElement* const address = region.getAddress();
+    // Keep the samples aligned, as the driver and the effects may access them as such.
+    const size_t alignment = std::gcd(mContext->getFrameSize(), sizeof(float));
+    if (address == nullptr || region.getLength() < byteCount ||
+        reinterpret_cast<uintptr_t>(address) % alignment != 0 ||
+        !mDriver->isDirectTransferSupported()) {
+        return nullptr;
+    }
+    return address;
+}
+
 void StreamWorkerCommonLogic::populateReply(StreamDescriptor::Reply* reply,
                                             bool isConnected) const {
     static const StreamDescriptor::Position kUnknownPosition = {
@@ -366,21 +382,39 @@ bool StreamInWorkerLogic::read(size_t clientSize, StreamDescriptor::Reply* reply
     size_t actualFrameCount = 0;
     bool fatal = false;
     int32_t latency = mContext->getNominalLatencyMs();
+    // Unless the free space wraps around the ring of the data MQ, the data is transferred
+    // directly into the MQ memory, and only committed after the transfer.
+    StreamContext::DataMQ::MemTransaction transaction;
+    DataBufferElement* buffer = nullptr;
+    if (byteCount > 0 && dataMQ->beginWrite(byteCount, &transaction)) {
+        buffer = getDirectTransferBuffer(transaction, byteCount);
+    }
+    const bool isDirectTransfer = buffer != nullptr;
+    if (!isDirectTransfer) {
+        buffer = mDataBuffer.get();
+    }
     if (isConnected) {
-        if (::android::status_t status = mDriver->transfer(mDataBuffer.get(), byteCount / frameSize,
-                                                           &actualFrameCount, &latency);
+        if (::android::status_t status =
+                    mDriver->transfer(buffer, byteCount / frameSize, &actualFrameCount, &latency);
             status != ::android::OK) {
             fatal = true;
             LOG(ERROR) << __func__ << ": read failed: " << status;
         }
+        if (StreamEffectChain* effectChain = mContext->getEffectChain(); effectChain != nullptr) {
+            effectChain->process(buffer, actualFrameCount);
+        }
     } else {
         usleep(3000);  // Simulate blocking transfer delay.
-        for (size_t i = 0; i < byteCount; ++i) mDataBuffer[i] = 0;
+        for (size_t i = 0; i < byteCount; ++i) buffer[i] = 0;
         actualFrameCount = byteCount / frameSize;
     }
     const size_t actualByteCount = actualFrameCount * frameSize;
-    if (bool success = actualByteCount > 0 ? dataMQ->write(&mDataBuffer[0], actualByteCount) : true;
-        success) {
+    bool success = true;
+    if (actualByteCount > 0) {
+        success = isDirectTransfer ? dataMQ->commitWrite(actualByteCount)
+                                   : dataMQ->write(buffer, actualByteCount);
+    }
+    if (success) {
         LOG(VERBOSE) << __func__ << ": writing of " << actualByteCount << " bytes into data MQ"
                      << " succeeded; connected? " << isConnected;
         // Frames are provided and counted regardless of connection status.
@@ -698,7 +732,8 @@ bool StreamOutWorkerLogic::write(size_t clientSize, StreamDescriptor::Reply* rep
     const size_t frameSize = mContext->getFrameSize();
     bool fatal = false;
     int32_t latency = mContext->getNominalLatencyMs();
-    if (readByteCount > 0 ? dataMQ->read(&mDataBuffer[0], readByteCount) : true) {
+    StreamContext::DataMQ::MemTransaction transaction;
+    if (readByteCount > 0 ? dataMQ->beginRead(readByteCount, &transaction) : true) {
         const bool isConnected = mIsConnected;
         LOG(VERBOSE) << __func__ << ": reading of " << readByteCount << " bytes from data MQ"
                      << " succeeded; connected? " << isConnected;
@@ -711,15 +746,27 @@ bool StreamOutWorkerLogic::write(size_t clientSize, StreamDescriptor::Reply* rep
         }
         size_t actualFrameCount = 0;
         if (isConnected) {
-            if (::android::status_t status = mDriver->transfer(
-                        mDataBuffer.get(), byteCount / frameSize, &actualFrameCount, &latency);
+            // Unless the data wraps around the ring of the data MQ, it is transferred directly
+            // from the MQ memory.
+            DataBufferElement* buffer = getDirectTransferBuffer(transaction, byteCount);
+            if (buffer == nullptr) {
+                buffer = mDataBuffer.get();
+                transaction.copyTo(buffer, 0, byteCount);
+            }
+            // The attached effects process the data before it reaches the driver.
+            if (StreamEffectChain* effectChain = mContext->getEffectChain();
+                effectChain != nullptr) {
+                effectChain->process(buffer, byteCount / frameSize);
+            }
+            if (::android::status_t status = mDriver->transfer(buffer, byteCount / frameSize,
+                                                               &actualFrameCount, &latency);
                 status != ::android::OK) {
                 fatal = true;
                 LOG(ERROR) << __func__ << ": write failed: " << status;
             }
             auto streamDataProcessor = mContext->getStreamDataProcessor().lock();
             if (streamDataProcessor != nullptr) {
-                streamDataProcessor->process(mDataBuffer.get(), actualFrameCount * frameSize);
+                streamDataProcessor->process(buffer, actualFrameCount * frameSize);
             }
         } else {
             if (mContext->getAsyncCallback() == nullptr) {
@@ -727,6 +774,11 @@ bool StreamOutWorkerLogic::write(size_t clientSize, StreamDescriptor::Reply* rep
             }
             actualFrameCount = byteCount / frameSize;
         }
+        // All the data available in the MQ is consumed, even if the driver has used less.
+        if (readByteCount > 0 && !dataMQ->commitRead(readByteCount)) {
+            LOG(WARNING) << __func__ << ": committing the reading of " << readByteCount
+                         << " bytes failed";
+        }
         const size_t actualByteCount = actualFrameCount * frameSize;
         // Frames are consumed and counted regardless of the connection status.
         reply->fmqByteCount += actualByteCount;
@@ -826,6 +878,13 @@ ndk::ScopedAStatus StreamCommonImpl::addEffect(
     } else {
         LOG(DEBUG) << __func__ << ": effect Binder" << in_effect->asBinder().get();
     }
+    // Only effects hosted in this process can be attached, the effects of the example effect
+    // service (android.hardware.audio.effect.service-aidl.example) live in another process and
+    // are rejected with EX_UNSUPPORTED_OPERATION. A vendor which wants its effects to run inline
+    // has to register its EffectImpl based effects in the process of the audio HAL.
+    if (StreamEffectChain* effectChain = mContext.getEffectChain(); effectChain != nullptr) {
+        return effectChain->addEffect(in_effect);
+    }
     return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
 }
 
@@ -836,6 +895,9 @@ ndk::ScopedAStatus StreamCommonImpl::removeEffect(
     } else {
         LOG(DEBUG) << __func__ << ": effect Binder" << in_effect->asBinder().get();
     }
+    if (StreamEffectChain* effectChain = mContext.getEffectChain(); effectChain != nullptr) {
+        return effectChain->removeEffect(in_effect);
+    }
     return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
 }
 
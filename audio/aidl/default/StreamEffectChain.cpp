@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AHAL_StreamEffectChain"
+
+#include "core-impl/StreamEffectChain.h"
+
+#include <algorithm>
+
+#include <Utils.h>
+#include <android-base/logging.h>
+#include <audio_utils/format.h>
+#include <media/AidlConversionCppNdk.h>
+
+using aidl::android::hardware::audio::common::getChannelCount;
+using aidl::android::hardware::audio::effect::IEffect;
+using aidl::android::media::audio::common::AudioChannelLayout;
+using aidl::android::media::audio::common::AudioFormatDescription;
+
+namespace aidl::android::hardware::audio::core {
+
+namespace {
+
+audio_format_t getConvertibleFormat(const AudioFormatDescription& format) {
+    const audio_format_t legacy =
+            ::aidl::android::aidl2legacy_AudioFormatDescription_audio_format_t(format).value_or(
+                    AUDIO_FORMAT_INVALID);
+    switch (legacy) {
+        case AUDIO_FORMAT_PCM_16_BIT:
+        case AUDIO_FORMAT_PCM_8_24_BIT:
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        case AUDIO_FORMAT_PCM_32_BIT:
+        case AUDIO_FORMAT_PCM_FLOAT:
+            return legacy;
+        default:
+            return AUDIO_FORMAT_INVALID;
+    }
+}
+
+}  // namespace
+
+StreamEffectChain::StreamEffectChain(const AudioFormatDescription& format,
+                                     const AudioChannelLayout& layout, int sampleRate)
+    : mFormat(getConvertibleFormat(format)),
+      mChannelCount(getChannelCount(layout)),
+      mFrameSize(mFormat != AUDIO_FORMAT_INVALID
+                         ? audio_bytes_per_sample(mFormat) * mChannelCount
+                         : 0),
+      mSampleRate(sampleRate) {}
+
+ndk::ScopedAStatus StreamEffectChain::addEffect(const std::shared_ptr<IEffect>& effect) {
+    if (effect == nullptr) {
+        LOG(ERROR) << __func__ << ": null effect";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
+    }
+    if (mFrameSize == 0) {
+        LOG(DEBUG) << __func__ << ": the stream format can not be processed";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
+    }
+    // Proxies of effects in other processes do not implement the interface.
+    auto* inlineProcessing = dynamic_cast<InlineProcessingInterface*>(effect.get());
+    if (inlineProcessing == nullptr) {
+        LOG(DEBUG) << __func__ << ": the effect can not process inline";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
+    }
+    ::android::audio_utils::lock_guard l(mMutex);
+    if (std::any_of(mEffects.begin(), mEffects.end(),
+                    [&](const auto& attached) { return attached.first == effect; })) {
+        LOG(ERROR) << __func__ << ": the effect is already attached";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
+    }
+    if (mFormat != AUDIO_FORMAT_PCM_FLOAT && mWorkBuffer.empty()) {
+        mWorkBuffer.resize(kWorkBufferFrames * mChannelCount);
+    }
+    mEffects.emplace_back(effect, inlineProcessing);
+    LOG(DEBUG) << __func__ << ": " << mEffects.size() << " effects attached";
+    return ndk::ScopedAStatus::ok();
+}
+
+ndk::ScopedAStatus StreamEffectChain::removeEffect(const std::shared_ptr<IEffect>& effect) {
+    if (effect == nullptr) {
+        LOG(ERROR) << __func__ << ": null effect";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
+    }
+    ::android::audio_utils::lock_guard l(mMutex);
+    auto it = std::find_if(mEffects.begin(), mEffects.end(),
+                           [&](const auto& attached) { return attached.first == effect; });
+    if (it == mEffects.end()) {
+        LOG(ERROR) << __func__ << ": the effect is not attached";
+        return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
+    }
+    mEffects.erase(it);
+    LOG(DEBUG) << __func__ << ": " << mEffects.size() << " effects attached";
+    return ndk::ScopedAStatus::ok();
+}
+
+void StreamEffectChain::process(void* buffer, size_t frameCount) {
+    ::android::audio_utils::lock_guard l(mMutex);
+    if (mEffects.empty() || frameCount == 0) {
+        return;
+    }
+    if (mFormat == AUDIO_FORMAT_PCM_FLOAT) {
+        processFloat_l(static_cast<float*>(buffer), frameCount);
+        return;
+    }
+    auto* data = static_cast<uint8_t*>(buffer);
+    for (size_t frame = 0; frame < frameCount; frame += kWorkBufferFrames) {
+        const size_t frames = std::min(kWorkBufferFrames, frameCount - frame);
+        void* block = data + frame * mFrameSize;
+        memcpy_by_audio_format(mWorkBuffer.data(), AUDIO_FORMAT_PCM_FLOAT, block, mFormat,
+                               frames * mChannelCount);
+        processFloat_l(mWorkBuffer.data(), frames);
+        memcpy_by_audio_format(block, mFormat, mWorkBuffer.data(), AUDIO_FORMAT_PCM_FLOAT,
+                               frames * mChannelCount);
+    }
+}
+
+void StreamEffectChain::processFloat_l(float* buffer, size_t frameCount) {
+    for (const auto& attached : mEffects) {
+        // Effects which are not started, busy, or configured for another channel count or sample
+        // rate, are bypassed.
+        if (!attached.second->processInline(buffer, frameCount, mChannelCount, mSampleRate)) {
+            LOG(VERBOSE) << __func__ << ": effect bypassed";
+        }
+    }
+}
+
+}  // namespace aidl::android::hardware::audio::core
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <fmq/EventFlag.h>
+
+#include "effect-impl/EffectImpl.h"
+
+using aidl::android::hardware::audio::effect::CommandId;
+using aidl::android::hardware::audio::effect::Descriptor;
+using aidl::android::hardware::audio::effect::EffectContext;
+using aidl::android::hardware::audio::effect::EffectImpl;
+using aidl::android::hardware::audio::effect::IEffect;
+using aidl::android::hardware::audio::effect::kEventFlagDataMqNotEmpty;
+using aidl::android::hardware::audio::effect::kEventFlagNotEmpty;
+using aidl::android::hardware::audio::effect::kReopenSupportedVersion;
+using aidl::android::hardware::audio::effect::Parameter;
+using aidl::android::hardware::audio::effect::RetCode;
+using aidl::android::media::audio::common::AudioChannelLayout;
+using aidl::android::media::audio::common::AudioFormatDescription;
+using aidl::android::media::audio::common::AudioFormatType;
+using aidl::android::media::audio::common::PcmType;
+using ::android::hardware::EventFlag;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr int kChannelCount = 2;
+
+// Applies a gain, with or without the direct processing in the data MQs.
+class GainEffect final : public EffectImpl {
+  public:
+    explicit GainEffect(bool directProcessing) : mDirectProcessing(directProcessing) {}
+    ~GainEffect() { cleanUp(); }
+
+    ndk::ScopedAStatus getDescriptor(Descriptor* desc) override {
+        *desc = {};
+        return ndk::ScopedAStatus::ok();
+    }
+    ndk::ScopedAStatus setParameterSpecific(const Parameter::Specific&)
+            REQUIRES(mImplMutex) override {
+        return ndk::ScopedAStatus::ok();
+    }
+    ndk::ScopedAStatus getParameterSpecific(const Parameter::Id&, Parameter::Specific*)
+            REQUIRES(mImplMutex) override {
+        return ndk::ScopedAStatus::ok();
+    }
+    std::string getEffectName() override { return "GainEffect"; }
+    RetCode releaseContext() REQUIRES(mImplMutex) override { return RetCode::SUCCESS; }
+    bool isDirectProcessingSupported() override { return mDirectProcessing; }
+
+    IEffect::Status effectProcessImpl(float* in, float* out, int samples)
+            REQUIRES(mImplMutex) override {
+        for (int i = 0; i < samples; i++) {
+            out[i] = in[i] * 0.5f;
+        }
+        return {STATUS_OK, samples, samples};
+    }
+
+  private:
+    const bool mDirectProcessing;
+};
+
+Parameter::Common createCommon(int frameCount) {
+    Parameter::Common common;
+    common.input.base.sampleRate = kSampleRate;
+    common.input.base.channelMask = AudioChannelLayout::make<AudioChannelLayout::layoutMask>(
+            AudioChannelLayout::LAYOUT_STEREO);
+    common.input.base.format = AudioFormatDescription{.type = AudioFormatType::PCM,
+                                                      .pcm = PcmType::FLOAT_32_BIT};
+    common.input.frameCount = frameCount;
+    common.output = common.input;
+    return common;
+}
+
+// args: frames per block, whether the effect processes directly in the data MQs
+void BM_EffectProcess(benchmark::State& state) {
+    const int frameCount = state.range(0);
+    const bool directProcessing = state.range(1);
+    auto effect = ndk::SharedRefBase::make<GainEffect>(directProcessing);
+    IEffect::OpenEffectReturn ret;
+    // MQs of 2.5 blocks, so that every other block wraps around the rings
+    if (!effect->open(createCommon(frameCount * 5 / 2), std::nullopt, &ret).isOk()) {
+        state.SkipWithError("open failed");
+        return;
+    }
+    int version = 0;
+    effect->getInterfaceVersion(&version);
+    auto statusMQ = std::make_unique<EffectContext::StatusMQ>(ret.statusMQ);
+    auto inputMQ = std::make_unique<EffectContext::DataMQ>(ret.inputDataMQ);
+    auto outputMQ = std::make_unique<EffectContext::DataMQ>(ret.outputDataMQ);
+    EventFlag* eventFlag = nullptr;
+    if (!statusMQ->isValid() || !inputMQ->isValid() || !outputMQ->isValid() ||
+        EventFlag::createEventFlag(statusMQ->getEventFlagWord(), &eventFlag) != ::android::OK) {
+        state.SkipWithError("invalid MQs");
+        return;
+    }
+    const uint32_t dataMqNotEmpty =
+            version >= kReopenSupportedVersion ? kEventFlagDataMqNotEmpty : kEventFlagNotEmpty;
+    effect->command(CommandId::START);
+
+    std::vector<float> input(frameCount * kChannelCount, 0.25f);
+    std::vector<float> output(input.size());
+    IEffect::Status status;
+    for (auto _ : state) {
+        inputMQ->write(input.data(), input.size());
+        eventFlag->wake(dataMqNotEmpty);
+        statusMQ->readBlocking(&status, 1);
+        outputMQ->read(output.data(), status.fmqProduced);
+    }
+
+    effect->command(CommandId::STOP);
+    effect->close();
+    EventFlag::deleteEventFlag(&eventFlag);
+    state.SetItemsProcessed(state.iterations() * frameCount);
+}
+
+void EffectProcessArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"frames", "direct"});
+    // 2 ms, 5 ms and 20 ms blocks
+    for (int frames : {kSampleRate / 500, kSampleRate / 200, kSampleRate / 50}) {
+        for (int direct : {0, 1}) {
+            b->Args({frames, direct});
+        }
+    }
+}
+
+// The CPU time includes the effect worker thread.
+BENCHMARK(BM_EffectProcess)->Apply(EffectProcessArgs)->MeasureProcessCPUTime()->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <time.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <Utils.h>
+#include <benchmark/benchmark.h>
+
+#include "core-impl/StreamAlsa.h"
+#include "core-impl/StreamStub.h"
+#include "primary/PrimaryMixer.h"
+
+using aidl::android::hardware::audio::common::getFrameSizeInBytes;
+using aidl::android::hardware::audio::common::SourceMetadata;
+using aidl::android::hardware::audio::core::StreamAlsa;
+using aidl::android::hardware::audio::core::StreamContext;
+using aidl::android::hardware::audio::core::StreamDescriptor;
+using aidl::android::hardware::audio::core::StreamOut;
+using aidl::android::hardware::audio::core::StreamStub;
+using aidl::android::hardware::audio::core::alsa::DeviceProfile;
+using aidl::android::hardware::audio::core::primary::PrimaryMixer;
+using aidl::android::media::audio::common::AudioChannelLayout;
+using aidl::android::media::audio::common::AudioDevice;
+using aidl::android::media::audio::common::AudioFormatDescription;
+using aidl::android::media::audio::common::AudioFormatType;
+using aidl::android::media::audio::common::AudioIoFlags;
+using aidl::android::media::audio::common::PcmType;
+using aidl::android::media::audio::common::Void;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+// The data MQ holds this many bursts, thus the bursts never wrap around its ring.
+constexpr size_t kBurstsPerBuffer = 4;
+
+// StreamOutStub, with the direct transfer from the data MQ optional.
+class StreamOutStubBenchmark final : public StreamOut, public StreamStub {
+  public:
+    friend class ndk::SharedRefBase;
+    StreamOutStubBenchmark(StreamContext&& context, bool directTransfer)
+        : StreamOut(std::move(context), std::nullopt),
+          StreamStub(&mContextInstance, SourceMetadata{}),
+          mDirectTransfer(directTransfer) {}
+
+    bool isDirectTransferSupported() override { return mDirectTransfer; }
+
+  private:
+    void onClose(StreamDescriptor::State) override { defaultOnClose(); }
+
+    const bool mDirectTransfer;
+};
+
+// An output stream on the primary ALSA card, with the direct transfer from the data MQ optional.
+class StreamOutAlsaBenchmark final : public StreamOut, public StreamAlsa {
+  public:
+    friend class ndk::SharedRefBase;
+    StreamOutAlsaBenchmark(StreamContext&& context, bool directTransfer)
+        : StreamOut(std::move(context), std::nullopt),
+          StreamAlsa(&mContextInstance, SourceMetadata{}, 3 /*readWriteRetries*/),
+          mDirectTransfer(directTransfer) {}
+
+    bool isDirectTransferSupported() override { return mDirectTransfer; }
+
+  private:
+    std::vector<DeviceProfile> getDeviceProfiles() override {
+        return {DeviceProfile{.card = PrimaryMixer::kAlsaCard,
+                              .device = PrimaryMixer::kAlsaDevice,
+                              .direction = PCM_OUT,
+                              .isExternal = false}};
+    }
+    void onClose(StreamDescriptor::State) override { defaultOnClose(); }
+
+    const bool mDirectTransfer;
+};
+
+StreamContext createOutContext(size_t burstFrames) {
+    const AudioFormatDescription format{.type = AudioFormatType::PCM,
+                                        .pcm = PcmType::INT_16_BIT};
+    const auto layout = AudioChannelLayout::make<AudioChannelLayout::layoutMask>(
+            AudioChannelLayout::LAYOUT_STEREO);
+    const size_t frameSize = getFrameSizeInBytes(format, layout);
+    return StreamContext(
+            std::make_unique<StreamContext::CommandMQ>(1, true /*configureEventFlagWord*/),
+            std::make_unique<StreamContext::ReplyMQ>(1, true /*configureEventFlagWord*/), format,
+            layout, kSampleRate, AudioIoFlags::make<AudioIoFlags::output>(0),
+            0 /*nominalLatencyMs*/, 0 /*mixPortHandle*/,
+            std::make_unique<StreamContext::DataMQ>(frameSize * burstFrames * kBurstsPerBuffer),
+            nullptr /*asyncCallback*/, nullptr /*outEventCallback*/,
+            {} /*streamDataProcessor*/, {} /*debugParameters*/);
+}
+
+bool sendCommand(const StreamContext& context, const StreamDescriptor::Command& command,
+                 StreamDescriptor::Reply* reply) {
+    return context.getCommandMQ()->writeBlocking(&command, 1) &&
+           context.getReplyMQ()->readBlocking(reply, 1) && reply->status == STATUS_OK;
+}
+
+double getProcessCpuSeconds() {
+    struct timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// args: frames per burst, whether the driver transfers directly from the data MQ
+template <class Stream>
+void BM_StreamOutTransfer(benchmark::State& state) {
+    const size_t burstFrames = state.range(0);
+    const bool directTransfer = state.range(1);
+    auto stream = ndk::SharedRefBase::make<Stream>(createOutContext(burstFrames), directTransfer);
+    const StreamContext& context = stream->getContext();
+    if (!context.isValid() || !stream->initInstance(stream).isOk()) {
+        state.SkipWithError("stream initialization failed");
+        return;
+    }
+    stream->setConnectedDevices({AudioDevice{}});
+
+    using Command = StreamDescriptor::Command;
+    StreamDescriptor::Reply reply;
+    const std::vector<int8_t> data(burstFrames * context.getFrameSize(), 1);
+    const Command burst = Command::make<Command::Tag::burst>(data.size());
+    if (!sendCommand(context, Command::make<Command::Tag::start>(Void{}), &reply)) {
+        state.SkipWithError("start failed");
+    } else {
+        const double startCpuSeconds = getProcessCpuSeconds();
+        for (auto _ : state) {
+            if (!context.getDataMQ()->write(data.data(), data.size()) ||
+                !sendCommand(context, burst, &reply)) {
+                state.SkipWithError("burst failed");
+                break;
+            }
+        }
+        const double cpuSeconds = getProcessCpuSeconds() - startCpuSeconds;
+        const double frames = static_cast<double>(state.iterations()) * burstFrames;
+        state.counters["frames_per_cpu_second"] = cpuSeconds > 0 ? frames / cpuSeconds : 0;
+        state.SetItemsProcessed(state.iterations() * burstFrames);
+    }
+    stream->close();
+}
+
+void StreamOutTransferArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"frames", "direct"});
+    // 2 ms, 5 ms and 20 ms bursts
+    for (int frames : {kSampleRate / 500, kSampleRate / 200, kSampleRate / 50}) {
+        for (int direct : {0, 1}) {
+            b->Args({frames, direct});
+        }
+    }
+}
+
+// The drivers pace the bursts in real time, thus the CPU time of the process, which includes
+// the stream worker thread, is reported per frame in the "frames_per_cpu_second" counter.
+BENCHMARK(BM_StreamOutTransfer<StreamOutStubBenchmark>)
+        ->Apply(StreamOutTransferArgs)
+        ->MeasureProcessCPUTime()
+        ->UseRealTime();
+// Skipped when the primary ALSA card can not be opened.
+BENCHMARK(BM_StreamOutTransfer<StreamOutAlsaBenchmark>)
+        ->Apply(StreamOutTransferArgs)
+        ->MeasureProcessCPUTime()
+        ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
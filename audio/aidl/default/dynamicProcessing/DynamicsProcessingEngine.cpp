@@ -0,0 +1,578 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "DynamicsProcessingEngine.h"
+
+namespace aidl::android::hardware::audio::effect {
+
+namespace {
+
+typedef float Vector __attribute__((vector_size(16)));
+typedef int32_t Mask __attribute__((vector_size(16)));
+constexpr size_t kLanes = sizeof(Vector) / sizeof(float);
+
+constexpr int32_t kInvalidChannelId = -1;
+constexpr float kMinFrequencyHz = 10.f;
+constexpr float kMaxFrequencyRatio = 0.45f;
+// Q of the two sections of a Linkwitz-Riley crossover
+constexpr float kCrossoverQ = M_SQRT1_2;
+constexpr float kShelfQ = M_SQRT1_2;
+constexpr float kMinPeakQ = 0.1f;
+constexpr float kMaxPeakQ = 10.f;
+// Ramp of the filter coefficient changes
+constexpr size_t kRampMs = 10;
+// Level of silence, and threshold of the limiter noise gate which never closes
+constexpr float kMinLevelDb = -200.f;
+constexpr float kNoGateDb = -1000.f;
+constexpr float kMinKneeWidthDb = 1e-3f;
+
+Vector broadcast(float value) {
+    return Vector{} + value;
+}
+
+Vector select(Mask mask, Vector a, Vector b) {
+    return (Vector)(((Mask)a & mask) | ((Mask)b & ~mask));
+}
+
+Vector max(Vector a, Vector b) {
+    return select(a > b, a, b);
+}
+
+Vector min(Vector a, Vector b) {
+    return select(a < b, a, b);
+}
+
+Vector load(const float* in) {
+    Vector v;
+    memcpy(&v, in, sizeof(v));
+    return v;
+}
+
+void store(Vector v, float* out) {
+    memcpy(out, &v, sizeof(v));
+}
+
+Vector abs(Vector v) {
+    return (Vector)((Mask)v & 0x7fffffff);
+}
+
+// log2 with an absolute error below 1e-5: the exponent comes from the float bits, and the
+// logarithm of the mantissa, reduced to [sqrt(1/2), sqrt(2)), from the series of atanh.
+Vector log2Fast(Vector x) {
+    const Mask bits = (Mask)max(x, broadcast(1e-30f));
+    Mask exponent = ((bits >> 23) & 0xff) - 127;
+    Vector mantissa = (Vector)((bits & 0x007fffff) | 0x3f800000);
+    const Mask high = mantissa > static_cast<float>(M_SQRT2);
+    mantissa = select(high, mantissa * 0.5f, mantissa);
+    exponent -= high;
+    const Vector t = (mantissa - 1.f) / (mantissa + 1.f);
+    const Vector t2 = t * t;
+    const Vector series =
+            ((0.4121985831f * t2 + 0.5770780164f) * t2 + 0.9617966939f) * t2 + 2.885390082f;
+    return __builtin_convertvector(exponent, Vector) + t * series;
+}
+
+// exp2 with a relative error below 1e-5: the integer part goes to the float exponent, and the
+// fractional part through a polynomial.
+Vector exp2Fast(Vector x) {
+    x = min(max(x, broadcast(-126.f)), broadcast(126.f));
+    Mask integer = __builtin_convertvector(x, Mask);
+    // the conversion truncates toward zero, so round down the negative values
+    integer += (Mask)(__builtin_convertvector(integer, Vector) > x);
+    const Vector f = x - __builtin_convertvector(integer, Vector);
+    Vector polynomial = 0.0001540353f * f + 0.0013333558f;
+    polynomial = polynomial * f + 0.0096181291f;
+    polynomial = polynomial * f + 0.0555041087f;
+    polynomial = polynomial * f + 0.2402265070f;
+    polynomial = polynomial * f + 0.6931471806f;
+    polynomial = polynomial * f + 1.f;
+    return (Vector)((Mask)polynomial + (integer << 23));
+}
+
+Vector linearToDb(Vector linear) {
+    return max(log2Fast(linear) * 6.020599913f, broadcast(kMinLevelDb));
+}
+
+Vector dbToLinear(Vector db) {
+    return exp2Fast(db * 0.1660964047f);
+}
+
+float dbToLinear(float db) {
+    return std::pow(10.f, db / 20.f);
+}
+
+// One pole coefficient reaching 1 - 1 / e of a step after timeMs
+float getSmoothingCoefficient(float sampleRate, float timeMs) {
+    return timeMs > 0 ? std::exp(-1000.f / (timeMs * sampleRate)) : 0.f;
+}
+
+float clampFrequency(float frequency, float sampleRate) {
+    return std::clamp(frequency, kMinFrequencyHz,
+                      std::max(kMinFrequencyHz, sampleRate * kMaxFrequencyRatio));
+}
+
+size_t roundUpToLanes(size_t count) {
+    return (count + kLanes - 1) / kLanes * kLanes;
+}
+
+// Band b covers the frequencies from the cutoff of band b - 1 up to its own cutoff. The first band
+// is a low shelf and the last one a high shelf, the ones in between are peaks.
+BiquadCoefficients designEqBand(const DynamicsProcessing::EqBandConfig* bands, size_t bandCount,
+                                size_t band, float sampleRate) {
+    const float high = clampFrequency(bands[band].cutoffFrequencyHz, sampleRate);
+    if (band == 0) {
+        return BiquadCoefficients::lowShelf(sampleRate, high, kShelfQ, bands[band].gainDb);
+    }
+    const float low = clampFrequency(bands[band - 1].cutoffFrequencyHz, sampleRate);
+    if (band == bandCount - 1) {
+        return BiquadCoefficients::highShelf(sampleRate, low, kShelfQ, bands[band].gainDb);
+    }
+    const float center = std::sqrt(low * high);
+    const float q = high > low ? std::clamp(center / (high - low), kMinPeakQ, kMaxPeakQ)
+                               : kMaxPeakQ;
+    return BiquadCoefficients::peaking(sampleRate, center, q, bands[band].gainDb);
+}
+
+bool isChannelEnabled(const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+                      size_t channel) {
+    return channel < channels.size() && channels[channel].channel != kInvalidChannelId &&
+           channels[channel].enable;
+}
+
+}  // namespace
+
+DynamicsProcessingEngine::Vector DynamicsProcessingEngine::DynamicsParameters::computeGainDb(
+        Vector levelDb) const {
+    // Soft knee: the slope fades in quadratically over the knee width around the threshold.
+    const Vector over = levelDb - threshold;
+    const Vector inKnee = over + kneeWidth * 0.5f;
+    const Vector width = max(kneeWidth, broadcast(kMinKneeWidthDb));
+    const Vector knee = slope * inKnee * inKnee / (2.f * width);
+    Vector gainDb = select(over * 2.f >= kneeWidth, slope * over, knee);
+    gainDb = select(over * 2.f <= -kneeWidth, Vector{}, gainDb);
+    const Vector under = levelDb - gateThreshold;
+    return gainDb + select(under < 0.f, gateSlope * under, Vector{});
+}
+
+void DynamicsProcessingEngine::Dynamics::resize(size_t laneCount) {
+    const size_t vectorCount = roundUpToLanes(laneCount) / kLanes;
+    parameters.assign(vectorCount, DynamicsParameters{});
+    gainDb.assign(vectorCount, Vector{});
+    for (size_t lane = 0; lane < vectorCount * kLanes; lane++) {
+        disableLane(lane);
+    }
+}
+
+void DynamicsProcessingEngine::Dynamics::setLane(size_t lane, float sampleRate, float preGainDb,
+                                                 float postGainDb, float thresholdDb, float ratio,
+                                                 float kneeWidthDb, float gateThresholdDb,
+                                                 float expanderRatio, float attackMs,
+                                                 float releaseMs) {
+    auto& p = parameters[lane / kLanes];
+    const size_t i = lane % kLanes;
+    p.preGain[i] = dbToLinear(preGainDb);
+    p.postGain[i] = dbToLinear(postGainDb);
+    p.threshold[i] = thresholdDb;
+    p.slope[i] = 1.f / std::max(ratio, 1.f) - 1.f;
+    p.kneeWidth[i] = std::abs(kneeWidthDb);
+    p.gateThreshold[i] = gateThresholdDb;
+    p.gateSlope[i] = std::max(expanderRatio, 1.f) - 1.f;
+    p.attack[i] = getSmoothingCoefficient(sampleRate, attackMs);
+    p.release[i] = getSmoothingCoefficient(sampleRate, releaseMs);
+    p.enabled[i] = -1;
+}
+
+void DynamicsProcessingEngine::Dynamics::disableLane(size_t lane) {
+    auto& p = parameters[lane / kLanes];
+    const size_t i = lane % kLanes;
+    p.preGain[i] = 1.f;
+    p.postGain[i] = 1.f;
+    p.threshold[i] = 0.f;
+    p.slope[i] = 0.f;
+    p.kneeWidth[i] = 0.f;
+    p.gateThreshold[i] = kNoGateDb;
+    p.gateSlope[i] = 0.f;
+    p.attack[i] = 0.f;
+    p.release[i] = 0.f;
+    p.enabled[i] = 0;
+    gainDb[lane / kLanes][i] = 0.f;
+}
+
+DynamicsProcessingEngine::DynamicsProcessingEngine(size_t channelCount, float sampleRate)
+    : mChannelCount(channelCount),
+      mSampleRate(sampleRate),
+      mLookAheadFrames(std::lround(sampleRate * kLimiterLookAheadMs / 1000)),
+      mInputGains(channelCount, 1.f),
+      mLimiterPostGains(channelCount, 1.f),
+      mPeakDb(roundUpToLanes(channelCount) / kLanes, broadcast(kMinLevelDb)),
+      mPeakHoldFrames(roundUpToLanes(channelCount) / kLanes),
+      mLimiterGainBuffer(kBlockFrames * roundUpToLanes(channelCount)),
+      mDelayLine(mLookAheadFrames * channelCount),
+      mGainBuffer(kBlockFrames) {
+    mLimiter.resize(channelCount);
+}
+
+void DynamicsProcessingEngine::setInputGains(
+        const std::vector<DynamicsProcessing::InputGain>& gains) {
+    std::fill(mInputGains.begin(), mInputGains.end(), 1.f);
+    for (const auto& gain : gains) {
+        if (gain.channel >= 0 && (size_t)gain.channel < mChannelCount) {
+            mInputGains[gain.channel] = dbToLinear(gain.gainDb);
+        }
+    }
+    mInputGainsInUse = std::any_of(mInputGains.begin(), mInputGains.end(),
+                                   [](float gain) { return gain != 1.f; });
+}
+
+void DynamicsProcessingEngine::setPreEq(
+        const DynamicsProcessing::StageEnablement& stage,
+        const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+        const std::vector<DynamicsProcessing::EqBandConfig>& bands) {
+    setEq(stage, channels, bands, mPreEq);
+}
+
+void DynamicsProcessingEngine::setPostEq(
+        const DynamicsProcessing::StageEnablement& stage,
+        const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+        const std::vector<DynamicsProcessing::EqBandConfig>& bands) {
+    setEq(stage, channels, bands, mPostEq);
+}
+
+void DynamicsProcessingEngine::setEq(const DynamicsProcessing::StageEnablement& stage,
+                                     const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+                                     const std::vector<DynamicsProcessing::EqBandConfig>& bands,
+                                     std::unique_ptr<BiquadCascade>& eq) {
+    if (!stage.inUse || stage.bandCount <= 0) {
+        eq.reset();
+        return;
+    }
+    const size_t bandCount = stage.bandCount;
+    size_t rampFrames = mSampleRate * kRampMs / 1000;
+    if (!eq || eq->getSectionCount() != bandCount) {
+        eq = std::make_unique<BiquadCascade>(mChannelCount, bandCount);
+        rampFrames = 0;
+    }
+    for (size_t channel = 0; channel < mChannelCount; channel++) {
+        const bool enabled =
+                isChannelEnabled(channels, channel) && bands.size() >= (channel + 1) * bandCount;
+        const auto* channelBands = enabled ? &bands[channel * bandCount] : nullptr;
+        for (size_t band = 0; band < bandCount; band++) {
+            BiquadCoefficients coefficients;
+            if (enabled && channelBands[band].channel != kInvalidChannelId &&
+                channelBands[band].enable) {
+                coefficients = designEqBand(channelBands, bandCount, band, mSampleRate);
+            }
+            eq->setCoefficients(band, channel, coefficients, rampFrames);
+        }
+    }
+}
+
+void DynamicsProcessingEngine::setMbc(
+        const DynamicsProcessing::StageEnablement& stage,
+        const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+        const std::vector<DynamicsProcessing::MbcBandConfig>& bands) {
+    if (!stage.inUse || stage.bandCount <= 0) {
+        mMbcBandCount = 0;
+        mCrossover.reset();
+        return;
+    }
+    const size_t bandCount = stage.bandCount;
+    const size_t crossoverCount = bandCount - 1;
+    size_t rampFrames = mSampleRate * kRampMs / 1000;
+    if (bandCount != mMbcBandCount) {
+        mMbcBandCount = bandCount;
+        mCrossover = crossoverCount > 0
+                             ? std::make_unique<BiquadCascade>(crossoverCount * mChannelCount, 2)
+                             : nullptr;
+        mMbc.resize(bandCount * mChannelCount);
+        mCrossoverBuffer.resize(kBlockFrames * crossoverCount * mChannelCount);
+        mBandBuffer.resize(kBlockFrames * roundUpToLanes(bandCount * mChannelCount));
+        rampFrames = 0;
+    }
+    for (size_t channel = 0; channel < mChannelCount; channel++) {
+        const bool enabled = isChannelEnabled(channels, channel);
+        float cutoff = 0.f;
+        for (size_t band = 0; band < bandCount; band++) {
+            const size_t index = channel * bandCount + band;
+            const auto* config = index < bands.size() && bands[index].channel != kInvalidChannelId
+                                         ? &bands[index]
+                                         : nullptr;
+            if (band < crossoverCount) {
+                // Cutoffs never set are spread logarithmically from 20 Hz to 20 kHz, and the
+                // crossovers are kept in increasing order.
+                const float frequency = config ? config->cutoffFrequencyHz
+                                               : 20.f * std::pow(1000.f, (band + 1.f) / bandCount);
+                cutoff = std::max(cutoff, clampFrequency(frequency, mSampleRate));
+                const auto lowPass = BiquadCoefficients::lowPass(mSampleRate, cutoff, kCrossoverQ);
+                mCrossover->setCoefficients(0, band * mChannelCount + channel, lowPass,
+                                            rampFrames);
+                mCrossover->setCoefficients(1, band * mChannelCount + channel, lowPass,
+                                            rampFrames);
+            }
+            const size_t lane = band * mChannelCount + channel;
+            if (enabled && config && config->enable) {
+                mMbc.setLane(lane, mSampleRate, config->preGainDb, config->postGainDb,
+                             config->thresholdDb, config->ratio, config->kneeWidthDb,
+                             config->noiseGateThresholdDb, config->expanderRatio,
+                             config->attackTimeMs, config->releaseTimeMs);
+            } else {
+                mMbc.disableLane(lane);
+            }
+        }
+    }
+}
+
+void DynamicsProcessingEngine::setLimiter(
+        bool inUse, const std::vector<DynamicsProcessing::LimiterConfig>& limiters) {
+    if (inUse && !mLimiterInUse) {
+        std::fill(mDelayLine.begin(), mDelayLine.end(), 0.f);
+        std::fill(mPeakDb.begin(), mPeakDb.end(), broadcast(kMinLevelDb));
+        std::fill(mPeakHoldFrames.begin(), mPeakHoldFrames.end(), Mask{});
+    }
+    mLimiterInUse = inUse;
+    std::map<int32_t, std::vector<size_t>> groups;
+    for (size_t channel = 0; channel < mChannelCount; channel++) {
+        const auto* config = channel < limiters.size() &&
+                                             limiters[channel].channel != kInvalidChannelId &&
+                                             limiters[channel].enable
+                                     ? &limiters[channel]
+                                     : nullptr;
+        if (config) {
+            mLimiter.setLane(channel, mSampleRate, 0.f /* preGainDb */, 0.f /* postGainDb */,
+                             config->thresholdDb, config->ratio, 0.f /* kneeWidthDb */,
+                             kNoGateDb, 1.f /* expanderRatio */, config->attackTimeMs,
+                             config->releaseTimeMs);
+            mLimiterPostGains[channel] = dbToLinear(config->postGainDb);
+            groups[config->linkGroup].push_back(channel);
+        } else {
+            mLimiter.disableLane(channel);
+            mLimiterPostGains[channel] = 1.f;
+        }
+    }
+    mLinkGroups.clear();
+    for (auto& [linkGroup, groupChannels] : groups) {
+        if (groupChannels.size() > 1) {
+            mLinkGroups.push_back(std::move(groupChannels));
+        }
+    }
+}
+
+void DynamicsProcessingEngine::process(const float* in, float* out, size_t frameCount) {
+    for (size_t frame = 0; frame < frameCount; frame += kBlockFrames) {
+        const size_t blockFrames = std::min(kBlockFrames, frameCount - frame);
+        const size_t sampleCount = blockFrames * mChannelCount;
+        const float* blockIn = in + frame * mChannelCount;
+        float* block = out + frame * mChannelCount;
+        if (mInputGainsInUse) {
+            for (size_t i = 0; i < sampleCount; i++) {
+                block[i] = blockIn[i] * mInputGains[i % mChannelCount];
+            }
+        } else if (block != blockIn) {
+            memmove(block, blockIn, sampleCount * sizeof(float));
+        }
+        if (mPreEq) {
+            mPreEq->process(block, block, blockFrames);
+        }
+        if (mMbcBandCount > 0) {
+            processMbc(block, blockFrames);
+        }
+        if (mPostEq) {
+            mPostEq->process(block, block, blockFrames);
+        }
+        if (mLimiterInUse) {
+            processLimiter(block, blockFrames);
+        }
+    }
+}
+
+void DynamicsProcessingEngine::processMbc(float* buffer, size_t frameCount) {
+    const size_t channelCount = mChannelCount;
+    const size_t crossoverCount = mMbcBandCount - 1;
+    const size_t crossoverSamples = crossoverCount * channelCount;
+    const size_t frameLanes = roundUpToLanes(mMbcBandCount * channelCount);
+
+    // Low passes of every crossover, filtered side by side as a single cascade
+    float* lowPasses = mCrossoverBuffer.data();
+    if (crossoverCount > 0) {
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            for (size_t crossover = 0; crossover < crossoverCount; crossover++) {
+                memcpy(lowPasses + (frame * crossoverCount + crossover) * channelCount,
+                       buffer + frame * channelCount, channelCount * sizeof(float));
+            }
+        }
+        mCrossover->process(lowPasses, lowPasses, frameCount);
+    }
+
+    // Bands as the differences of consecutive low passes
+    for (size_t frame = 0; frame < frameCount; frame++) {
+        const float* x = buffer + frame * channelCount;
+        const float* lowPass = lowPasses + frame * crossoverSamples;
+        float* bands = mBandBuffer.data() + frame * frameLanes;
+        for (size_t i = 0; i < std::min(channelCount, crossoverSamples); i++) {
+            bands[i] = lowPass[i];
+        }
+        for (size_t i = channelCount; i < crossoverSamples; i++) {
+            bands[i] = lowPass[i] - lowPass[i - channelCount];
+        }
+        for (size_t channel = 0; channel < channelCount; channel++) {
+            bands[crossoverSamples + channel] =
+                    crossoverCount > 0 ? x[channel] - lowPass[crossoverSamples - channelCount +
+                                                              channel]
+                                       : x[channel];
+        }
+    }
+
+    // Dynamics of 4 lanes at a time over the whole block. Only the gain smoothing depends on the
+    // previous frame, so the level detection, the gain computer and the gain conversion run in
+    // separate loops without a dependency chain.
+    Vector* gainsDb = mGainBuffer.data();
+    for (size_t v = 0; v < frameLanes / kLanes; v++) {
+        const DynamicsParameters p = mMbc.parameters[v];
+        if ((p.enabled[0] | p.enabled[1] | p.enabled[2] | p.enabled[3]) == 0) {
+            continue;
+        }
+        float* bands = mBandBuffer.data() + v * kLanes;
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const Vector x = load(bands + frame * frameLanes) * p.preGain;
+            gainsDb[frame] = p.computeGainDb(linearToDb(abs(x)));
+        }
+        Vector gainDb = mMbc.gainDb[v];
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const Vector targetDb = gainsDb[frame];
+            const Vector coefficient = select(targetDb < gainDb, p.attack, p.release);
+            gainDb = targetDb + coefficient * (gainDb - targetDb);
+            gainsDb[frame] = gainDb;
+        }
+        mMbc.gainDb[v] = gainDb;
+        const Vector gain = p.preGain * p.postGain;
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const Vector x = load(bands + frame * frameLanes);
+            store(select(p.enabled, x * gain * dbToLinear(gainsDb[frame]), x),
+                  bands + frame * frameLanes);
+        }
+    }
+
+    // Sum of the bands of every channel
+    for (size_t frame = 0; frame < frameCount; frame++) {
+        float* y = buffer + frame * channelCount;
+        const float* bands = mBandBuffer.data() + frame * frameLanes;
+        for (size_t channel = 0; channel < channelCount; channel++) {
+            float sum = 0.f;
+            for (size_t band = 0; band <= crossoverCount; band++) {
+                sum += bands[band * channelCount + channel];
+            }
+            y[channel] = sum;
+        }
+    }
+}
+
+void DynamicsProcessingEngine::processLimiter(float* buffer, size_t frameCount) {
+    const size_t channelCount = mChannelCount;
+    const size_t frameLanes = roundUpToLanes(channelCount);
+    float* gains = mLimiterGainBuffer.data();
+
+    // Input of every frame padded to whole vectors
+    for (size_t frame = 0; frame < frameCount; frame++) {
+        memcpy(gains + frame * frameLanes, buffer + frame * channelCount,
+               channelCount * sizeof(float));
+    }
+
+    // Linear gains of 4 channels at a time, in separate loops as for the MBC. The peak is held for
+    // the look ahead, so that the gain is down when the peak comes out of the delay line.
+    Vector* gainsDb = mGainBuffer.data();
+    const Mask lookAheadFrames = Mask{} + static_cast<int32_t>(mLookAheadFrames);
+    for (size_t v = 0; v < frameLanes / kLanes; v++) {
+        const DynamicsParameters p = mLimiter.parameters[v];
+        if ((p.enabled[0] | p.enabled[1] | p.enabled[2] | p.enabled[3]) == 0) {
+            for (size_t frame = 0; frame < frameCount; frame++) {
+                store(broadcast(1.f), gains + frame * frameLanes + v * kLanes);
+            }
+            continue;
+        }
+        float* g = gains + v * kLanes;
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            gainsDb[frame] = linearToDb(abs(load(g + frame * frameLanes)));
+        }
+        Vector peakDb = mPeakDb[v];
+        Mask holdFrames = mPeakHoldFrames[v];
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const Vector levelDb = gainsDb[frame];
+            const Mask higher = levelDb >= peakDb;
+            const Mask holding = holdFrames > 0;
+            peakDb = select(higher | ~holding, levelDb, peakDb);
+            holdFrames = (lookAheadFrames & higher) | ((holdFrames + holding) & ~higher);
+            gainsDb[frame] = peakDb;
+        }
+        mPeakDb[v] = peakDb;
+        mPeakHoldFrames[v] = holdFrames;
+        Vector gainDb = mLimiter.gainDb[v];
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const Vector targetDb = p.computeGainDb(gainsDb[frame]);
+            const Vector coefficient = select(targetDb < gainDb, p.attack, p.release);
+            gainDb = targetDb + coefficient * (gainDb - targetDb);
+            gainsDb[frame] = gainDb;
+        }
+        mLimiter.gainDb[v] = gainDb;
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            store(select(p.enabled, dbToLinear(gainsDb[frame]), broadcast(1.f)),
+                  g + frame * frameLanes);
+        }
+    }
+
+    // Linked channels take the lowest gain of their group
+    for (const auto& group : mLinkGroups) {
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            float* g = gains + frame * frameLanes;
+            float gain = 1.f;
+            for (size_t channel : group) {
+                gain = std::min(gain, g[channel]);
+            }
+            for (size_t channel : group) {
+                g[channel] = gain;
+            }
+        }
+    }
+
+    // Gains applied to the delayed input
+    if (mLookAheadFrames == 0) {
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            float* x = buffer + frame * channelCount;
+            const float* g = gains + frame * frameLanes;
+            for (size_t channel = 0; channel < channelCount; channel++) {
+                x[channel] *= g[channel] * mLimiterPostGains[channel];
+            }
+        }
+        return;
+    }
+    for (size_t frame = 0; frame < frameCount; frame++) {
+        float* x = buffer + frame * channelCount;
+        const float* g = gains + frame * frameLanes;
+        float* delayed = mDelayLine.data() + mDelayPosition * channelCount;
+        for (size_t channel = 0; channel < channelCount; channel++) {
+            const float input = x[channel];
+            x[channel] = delayed[channel] * g[channel] * mLimiterPostGains[channel];
+            delayed[channel] = input;
+        }
+        mDelayPosition = (mDelayPosition + 1) % mLookAheadFrames;
+    }
+}
+
+}  // namespace aidl::android::hardware::audio::effect
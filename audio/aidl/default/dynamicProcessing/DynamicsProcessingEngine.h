@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <aidl/android/hardware/audio/effect/DynamicsProcessing.h>
+
+#include "effect-impl/BiquadCascade.h"
+
+namespace aidl::android::hardware::audio::effect {
+
+// The signal processing of DynamicsProcessingSw. Every channel flows through the input gain, the
+// pre-EQ, the multi band compressor (MBC), the post-EQ and the limiter.
+//
+// - The EQs are biquad cascades, one section per band.
+// - The MBC splits every channel with Linkwitz-Riley low passes at the band cutoff frequencies.
+//   Band b is the difference of the low passes of bands b and b - 1, so the bands always add up
+//   to the input. Every band has its own envelope follower and gain computer.
+// - The limiter looks ahead by kLimiterLookAheadMs, so that the gain is already reduced when a
+//   peak comes out. Channels of the same link group share the lowest gain.
+//
+// The filters and dynamics of all the channels and bands are laid out as structs of arrays of 4
+// lane vectors.
+//
+// Stages not in use, disabled channels and disabled bands let the signal through. Configs with an
+// invalid channel are the ones never set by the client, and let the signal through too.
+//
+// This class is not thread-safe.
+class DynamicsProcessingEngine {
+  public:
+    static constexpr float kLimiterLookAheadMs = 1.f;
+
+    DynamicsProcessingEngine(size_t channelCount, float sampleRate);
+
+    // Configs of the channels in channel order, configs of the bands in [channel][band] order,
+    // as kept by DynamicsProcessingSwContext.
+    void setInputGains(const std::vector<DynamicsProcessing::InputGain>& gains);
+    void setPreEq(const DynamicsProcessing::StageEnablement& stage,
+                  const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+                  const std::vector<DynamicsProcessing::EqBandConfig>& bands);
+    void setPostEq(const DynamicsProcessing::StageEnablement& stage,
+                   const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+                   const std::vector<DynamicsProcessing::EqBandConfig>& bands);
+    void setMbc(const DynamicsProcessing::StageEnablement& stage,
+                const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+                const std::vector<DynamicsProcessing::MbcBandConfig>& bands);
+    void setLimiter(bool inUse, const std::vector<DynamicsProcessing::LimiterConfig>& limiters);
+
+    // Processes frameCount interleaved frames. in and out may be the same buffer.
+    void process(const float* in, float* out, size_t frameCount);
+
+  private:
+    typedef float Vector __attribute__((vector_size(16)));
+    typedef int32_t Mask __attribute__((vector_size(16)));
+    static constexpr size_t kLanes = sizeof(Vector) / sizeof(float);
+    // Frames processed by every stage in turn, to keep the intermediate buffers in cache
+    static constexpr size_t kBlockFrames = 128;
+
+    // Gain computer and envelope follower parameters of 4 lanes
+    struct DynamicsParameters {
+        // Linear gains applied before and after the gain computer
+        Vector preGain;
+        Vector postGain;
+        // Compression above the threshold, with a soft knee. Slope is 1 / ratio - 1.
+        Vector threshold;
+        Vector slope;
+        Vector kneeWidth;
+        // Expansion below the noise gate. Slope is expander ratio - 1.
+        Vector gateThreshold;
+        Vector gateSlope;
+        // One pole coefficients smoothing the gain
+        Vector attack;
+        Vector release;
+        Mask enabled;
+
+        // Returns the gain in dB for input levels in dB
+        Vector computeGainDb(Vector levelDb) const;
+    };
+
+    // Dynamics of a set of lanes, 4 lanes per vector
+    struct Dynamics {
+        std::vector<DynamicsParameters> parameters;
+        // State, smoothed gain in dB
+        std::vector<Vector> gainDb;
+
+        void resize(size_t laneCount);
+        void setLane(size_t lane, float sampleRate, float preGainDb, float postGainDb,
+                     float thresholdDb, float ratio, float kneeWidthDb, float gateThresholdDb,
+                     float expanderRatio, float attackMs, float releaseMs);
+        void disableLane(size_t lane);
+    };
+
+    void setEq(const DynamicsProcessing::StageEnablement& stage,
+               const std::vector<DynamicsProcessing::ChannelConfig>& channels,
+               const std::vector<DynamicsProcessing::EqBandConfig>& bands,
+               std::unique_ptr<BiquadCascade>& eq);
+    void processMbc(float* buffer, size_t frameCount);
+    void processLimiter(float* buffer, size_t frameCount);
+
+    const size_t mChannelCount;
+    const float mSampleRate;
+    // Frames of limiter look ahead
+    const size_t mLookAheadFrames;
+
+    std::vector<float> mInputGains;
+    bool mInputGainsInUse = false;
+
+    std::unique_ptr<BiquadCascade> mPreEq;
+    std::unique_ptr<BiquadCascade> mPostEq;
+
+    // 0 if the MBC is not in use
+    size_t mMbcBandCount = 0;
+    // Low passes of the crossovers, as the channels [crossover][channel]
+    std::unique_ptr<BiquadCascade> mCrossover;
+    // Lanes [band][channel]
+    Dynamics mMbc;
+    // [frame][crossover][channel] low passes of a block
+    std::vector<float> mCrossoverBuffer;
+    // [frame][band][channel] bands of a block, each frame padded to whole vectors
+    std::vector<float> mBandBuffer;
+
+    bool mLimiterInUse = false;
+    // Lanes [channel]
+    Dynamics mLimiter;
+    std::vector<float> mLimiterPostGains;
+    // Groups of linked channels, with more than one channel
+    std::vector<std::vector<size_t>> mLinkGroups;
+    // State: peak level held for the look ahead, and the remaining frames to hold it
+    std::vector<Vector> mPeakDb;
+    std::vector<Mask> mPeakHoldFrames;
+    // [frame][channel] limiter gains of a block, each frame padded to whole vectors
+    std::vector<float> mLimiterGainBuffer;
+    // [frame][channel] ring of the delayed input
+    std::vector<float> mDelayLine;
+    size_t mDelayPosition = 0;
+
+    // Gains in dB of 4 lanes over a block
+    std::vector<Vector> mGainBuffer;
+};
+
+}  // namespace aidl::android::hardware::audio::effect
@@ -269,10 +269,16 @@ RetCode DynamicsProcessingSw::releaseContext() {
 
 // Processing method running in EffectWorker thread.
 IEffect::Status DynamicsProcessingSw::effectProcessImpl(float* in, float* out, int samples) {
-    // TODO: get data buffer and process.
-    LOG(DEBUG) << __func__ << " in " << in << " out " << out << " samples " << samples;
-    for (int i = 0; i < samples; i++) {
-        *out++ = *in++;
+    RETURN_VALUE_IF(!mContext, (IEffect::Status{EX_NULL_POINTER, 0, 0}), "nullContext");
+    return mContext->process(in, out, samples);
+}
+
+IEffect::Status DynamicsProcessingSwContext::process(float* in, float* out, int samples) {
+    LOG(VERBOSE) << __func__ << " in " << in << " out " << out << " samples " << samples;
+    if (!mEngine) {
+        std::copy(in, in + samples, out);
+    } else {
+        mEngine->process(in, out, samples / mChannelCount);
     }
     return {STATUS_OK, samples, samples};
 }
@@ -286,6 +292,7 @@ RetCode DynamicsProcessingSwContext::setCommon(const Parameter::Common& common)
             common.input.base.channelMask);
     resizeChannels();
     resizeBands();
+    createEngine();
     LOG(INFO) << __func__ << mCommon.toString();
     return RetCode::SUCCESS;
 }
@@ -301,6 +308,7 @@ RetCode DynamicsProcessingSwContext::setEngineArchitecture(
     }
     mEngineSettings = cfg;
     resizeBands();
+    updateEngine();
     return RetCode::SUCCESS;
 }
 
@@ -326,6 +334,7 @@ RetCode DynamicsProcessingSwContext::setChannelCfgs(
         }
         targetCfgs[cfg.channel] = cfg;
     }
+    updateEngine();
     return ret;
 }
 
@@ -368,6 +377,7 @@ RetCode DynamicsProcessingSwContext::setEqBandCfgs(
         }
         targetCfgs[cfg.channel * stage.bandCount + cfg.band] = cfg;
     }
+    updateEngine();
     return ret;
 }
 
@@ -406,6 +416,7 @@ RetCode DynamicsProcessingSwContext::setMbcBandCfgs(
         }
         mMbcChBands[it.channel * bandCount + it.band] = it;
     }
+    updateEngine();
     return ret;
 }
 
@@ -431,6 +442,7 @@ RetCode DynamicsProcessingSwContext::setLimiterCfgs(
         }
         mLimiterCfgs[it.channel] = it;
     }
+    updateEngine();
     return ret;
 }
 
@@ -474,6 +486,7 @@ RetCode DynamicsProcessingSwContext::setInputGainCfgs(
                         RetCode::ERROR_ILLEGAL_PARAMETER, "invalidChannel");
         mInputGainCfgs[cfg.channel] = cfg;
     }
+    updateEngine();
     return RetCode::SUCCESS;
 }
 
@@ -484,6 +497,31 @@ std::vector<DynamicsProcessing::InputGain> DynamicsProcessingSwContext::getInput
     return ret;
 }
 
+void DynamicsProcessingSwContext::createEngine() {
+    const size_t outputChannelCount = ::aidl::android::hardware::audio::common::getChannelCount(
+            mCommon.output.base.channelMask);
+    if (mChannelCount == 0 || mChannelCount != outputChannelCount) {
+        LOG(WARNING) << __func__ << " channel count mismatch, input " << mChannelCount
+                     << ", output " << outputChannelCount << ", bypass";
+        mEngine.reset();
+        return;
+    }
+    mEngine = std::make_unique<DynamicsProcessingEngine>(mChannelCount,
+                                                         mCommon.input.base.sampleRate);
+    updateEngine();
+}
+
+void DynamicsProcessingSwContext::updateEngine() {
+    if (!mEngine) {
+        return;
+    }
+    mEngine->setInputGains(mInputGainCfgs);
+    mEngine->setPreEq(mEngineSettings.preEqStage, mPreEqChCfgs, mPreEqChBands);
+    mEngine->setMbc(mEngineSettings.mbcStage, mMbcChCfgs, mMbcChBands);
+    mEngine->setPostEq(mEngineSettings.postEqStage, mPostEqChCfgs, mPostEqChBands);
+    mEngine->setLimiter(mEngineSettings.limiterInUse, mLimiterCfgs);
+}
+
 bool DynamicsProcessingSwContext::validateStageEnablement(
         const DynamicsProcessing::StageEnablement& enablement) {
     return !enablement.inUse || (enablement.inUse && enablement.bandCount > 0);
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "DynamicsProcessingEngine.h"
+
+using aidl::android::hardware::audio::effect::DynamicsProcessing;
+using aidl::android::hardware::audio::effect::DynamicsProcessingEngine;
+
+namespace {
+
+constexpr float kSampleRate = 48000;
+constexpr size_t kFrameCount = 480;
+
+std::vector<float> createNoise(size_t sampleCount) {
+    std::minstd_rand generator(42);
+    std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+    std::vector<float> noise(sampleCount);
+    for (auto& sample : noise) {
+        sample = distribution(generator);
+    }
+    return noise;
+}
+
+void configure(DynamicsProcessingEngine& engine, size_t channelCount, size_t mbcBandCount,
+               bool limiter) {
+    std::vector<DynamicsProcessing::ChannelConfig> channels;
+    std::vector<DynamicsProcessing::MbcBandConfig> bands;
+    std::vector<DynamicsProcessing::LimiterConfig> limiters;
+    for (size_t channel = 0; channel < channelCount; channel++) {
+        channels.push_back({.channel = static_cast<int32_t>(channel), .enable = true});
+        for (size_t band = 0; band < mbcBandCount; band++) {
+            bands.push_back({.channel = static_cast<int32_t>(channel),
+                             .band = static_cast<int32_t>(band),
+                             .enable = true,
+                             .cutoffFrequencyHz = 20000.f * (band + 1) / mbcBandCount,
+                             .attackTimeMs = 3,
+                             .releaseTimeMs = 80,
+                             .ratio = 4,
+                             .thresholdDb = -20,
+                             .kneeWidthDb = -6,
+                             .noiseGateThresholdDb = -90,
+                             .expanderRatio = 2});
+        }
+        limiters.push_back({.channel = static_cast<int32_t>(channel),
+                            .enable = true,
+                            .linkGroup = 0,
+                            .attackTimeMs = 1,
+                            .releaseTimeMs = 60,
+                            .ratio = 10,
+                            .thresholdDb = -3});
+    }
+    engine.setMbc({.inUse = mbcBandCount > 0, .bandCount = static_cast<int32_t>(mbcBandCount)},
+                  channels, bands);
+    engine.setLimiter(limiter, limiters);
+}
+
+// args: channel count, MBC band count (0 when not in use), whether the limiter is in use
+void BM_DynamicsProcessingEngine(benchmark::State& state) {
+    const size_t channelCount = state.range(0);
+    const size_t mbcBandCount = state.range(1);
+    const bool limiter = state.range(2);
+    DynamicsProcessingEngine engine(channelCount, kSampleRate);
+    configure(engine, channelCount, mbcBandCount, limiter);
+
+    std::vector<float> input = createNoise(kFrameCount * channelCount);
+    std::vector<float> output(input.size());
+    for (auto _ : state) {
+        engine.process(input.data(), output.data(), kFrameCount);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kFrameCount);
+    // CPU time per frame of every channel and band
+    state.counters["channel_band_frame"] =
+            benchmark::Counter(kFrameCount * channelCount * std::max<size_t>(mbcBandCount, 1),
+                               benchmark::Counter::kIsIterationInvariantRate |
+                                       benchmark::Counter::kInvert);
+}
+
+void DynamicsProcessingEngineArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"channels", "bands", "limiter"});
+    for (int channels : {1, 2, 6, 8}) {
+        for (int bands : {0, 1, 3, 5, 8}) {
+            b->Args({channels, bands, 0});
+        }
+        b->Args({channels, 5, 1});
+    }
+}
+
+BENCHMARK(BM_DynamicsProcessingEngine)->Apply(DynamicsProcessingEngineArgs);
+
+}  // namespace
+
+BENCHMARK_MAIN();
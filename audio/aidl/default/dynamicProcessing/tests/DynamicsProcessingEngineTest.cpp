@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DynamicsProcessingEngine.h"
+
+using aidl::android::hardware::audio::effect::DynamicsProcessing;
+using aidl::android::hardware::audio::effect::DynamicsProcessingEngine;
+
+namespace {
+
+constexpr float kSampleRate = 48000;
+
+std::vector<float> makeNoise(size_t sampleCount, float amplitude) {
+    std::minstd_rand generator(42);
+    std::uniform_real_distribution<float> distribution(-amplitude, amplitude);
+    std::vector<float> noise(sampleCount);
+    for (auto& sample : noise) {
+        sample = distribution(generator);
+    }
+    return noise;
+}
+
+std::vector<float> makeSine(size_t channelCount, size_t frameCount, float frequency,
+                            float amplitude) {
+    std::vector<float> sine(channelCount * frameCount);
+    for (size_t i = 0; i < sine.size(); i++) {
+        sine[i] = amplitude * std::sin(2 * M_PI * frequency * (i / channelCount) / kSampleRate);
+    }
+    return sine;
+}
+
+float getPeak(const float* samples, size_t sampleCount) {
+    float peak = 0.f;
+    for (size_t i = 0; i < sampleCount; i++) {
+        peak = std::max(peak, std::abs(samples[i]));
+    }
+    return peak;
+}
+
+std::vector<DynamicsProcessing::ChannelConfig> enableChannels(size_t channelCount) {
+    std::vector<DynamicsProcessing::ChannelConfig> channels;
+    for (size_t channel = 0; channel < channelCount; channel++) {
+        channels.push_back({.channel = static_cast<int32_t>(channel), .enable = true});
+    }
+    return channels;
+}
+
+std::vector<DynamicsProcessing::MbcBandConfig> makeMbcBands(size_t channelCount, size_t bandCount,
+                                                            float thresholdDb, float ratio) {
+    std::vector<DynamicsProcessing::MbcBandConfig> bands;
+    for (size_t channel = 0; channel < channelCount; channel++) {
+        for (size_t band = 0; band < bandCount; band++) {
+            bands.push_back({.channel = static_cast<int32_t>(channel),
+                             .band = static_cast<int32_t>(band),
+                             .enable = true,
+                             .cutoffFrequencyHz = 100.f * std::pow(8.f, float(band)),
+                             .attackTimeMs = 1,
+                             .releaseTimeMs = 50,
+                             .ratio = ratio,
+                             .thresholdDb = thresholdDb});
+        }
+    }
+    return bands;
+}
+
+DynamicsProcessing::LimiterConfig makeLimiter(int32_t channel, int32_t linkGroup) {
+    return {.channel = channel,
+            .enable = true,
+            .linkGroup = linkGroup,
+            .attackTimeMs = 0,
+            .releaseTimeMs = 50,
+            .ratio = 50,
+            .thresholdDb = -6};
+}
+
+}  // namespace
+
+TEST(DynamicsProcessingEngineTest, PassThroughWithoutStages) {
+    DynamicsProcessingEngine engine(2, kSampleRate);
+    const std::vector<float> input = makeNoise(2 * 1000, 1.f);
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 1000);
+    EXPECT_EQ(input, output);
+}
+
+TEST(DynamicsProcessingEngineTest, InputGain) {
+    DynamicsProcessingEngine engine(2, kSampleRate);
+    engine.setInputGains({{.channel = 1, .gainDb = -6}});
+    const std::vector<float> input = makeNoise(2 * 100, 1.f);
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 100);
+    for (size_t i = 0; i < input.size(); i += 2) {
+        EXPECT_EQ(input[i], output[i]);
+        EXPECT_NEAR(input[i + 1] * std::pow(10.f, -6.f / 20), output[i + 1], 1e-6);
+    }
+}
+
+TEST(DynamicsProcessingEngineTest, MbcBandsAddUpToInput) {
+    for (size_t channelCount : {1, 2, 3, 6}) {
+        for (size_t bandCount : {1, 2, 4, 5}) {
+            DynamicsProcessingEngine engine(channelCount, kSampleRate);
+            engine.setMbc({.inUse = true, .bandCount = static_cast<int32_t>(bandCount)},
+                          enableChannels(channelCount),
+                          makeMbcBands(channelCount, bandCount, 0 /* thresholdDb */,
+                                       1 /* ratio */));
+            const std::vector<float> input = makeNoise(channelCount * 1000, 1.f);
+            std::vector<float> output(input.size());
+            engine.process(input.data(), output.data(), 1000);
+            for (size_t i = 0; i < input.size(); i++) {
+                ASSERT_NEAR(input[i], output[i], 1e-4) << channelCount << " channels "
+                                                        << bandCount << " bands, sample " << i;
+            }
+        }
+    }
+}
+
+TEST(DynamicsProcessingEngineTest, MbcCompressesAboveThreshold) {
+    DynamicsProcessingEngine engine(2, kSampleRate);
+    engine.setMbc({.inUse = true, .bandCount = 1}, enableChannels(2),
+                  makeMbcBands(2, 1, -20 /* thresholdDb */, 4 /* ratio */));
+    // 14 dB over the threshold, so 10.5 dB of gain reduction
+    const std::vector<float> input = makeSine(2, 48000, 1000, 0.5f);
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 48000);
+    const float peak = getPeak(output.data() + output.size() / 2, output.size() / 2);
+    EXPECT_NEAR(-6.02 - 10.5, 20 * std::log10(peak), 1.);
+}
+
+TEST(DynamicsProcessingEngineTest, MbcDisabledChannelPassesThrough) {
+    DynamicsProcessingEngine engine(2, kSampleRate);
+    auto channels = enableChannels(2);
+    channels[1].enable = false;
+    engine.setMbc({.inUse = true, .bandCount = 3}, channels, makeMbcBands(2, 3, -40, 10));
+    const std::vector<float> input = makeNoise(2 * 1000, 1.f);
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 1000);
+    float inputPeak = 0.f;
+    float outputPeak = 0.f;
+    for (size_t i = 0; i < input.size(); i += 2) {
+        // after the attack
+        if (i >= input.size() / 2) {
+            inputPeak = std::max(inputPeak, std::abs(input[i]));
+            outputPeak = std::max(outputPeak, std::abs(output[i]));
+        }
+        ASSERT_NEAR(input[i + 1], output[i + 1], 1e-4) << "sample " << i + 1;
+    }
+    EXPECT_LT(outputPeak, inputPeak * 0.5f);
+}
+
+TEST(DynamicsProcessingEngineTest, LimiterCeiling) {
+    DynamicsProcessingEngine engine(3, kSampleRate);
+    engine.setLimiter(true, {makeLimiter(0, 0), makeLimiter(1, 1), makeLimiter(2, 2)});
+    const std::vector<float> input = makeNoise(3 * 10000, 1.f);
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 10000);
+    // -6 dB, plus 6 dB over the threshold at a ratio of 50
+    const float ceiling = std::pow(10.f, (-6.f + 6.f / 50) / 20);
+    EXPECT_LT(getPeak(output.data(), output.size()), ceiling * 1.01f);
+
+    // The output is delayed by the look ahead.
+    const size_t delay = std::lround(kSampleRate * DynamicsProcessingEngine::kLimiterLookAheadMs /
+                                     1000);
+    for (size_t i = 0; i < delay * 3; i++) {
+        EXPECT_EQ(0.f, output[i]);
+    }
+}
+
+TEST(DynamicsProcessingEngineTest, LimiterLinkGroup) {
+    DynamicsProcessingEngine engine(2, kSampleRate);
+    engine.setLimiter(true, {makeLimiter(0, 1), makeLimiter(1, 1)});
+    // A loud left channel and a quiet right channel
+    std::vector<float> input = makeSine(2, 4800, 1000, 1.f);
+    for (size_t i = 1; i < input.size(); i += 2) {
+        input[i] *= 0.1f;
+    }
+    std::vector<float> output(input.size());
+    engine.process(input.data(), output.data(), 4800);
+    for (size_t i = input.size() / 2; i < input.size(); i += 2) {
+        ASSERT_NEAR(output[i] * 0.1f, output[i + 1], 1e-5) << "sample " << i;
+    }
+}
+
+TEST(DynamicsProcessingEngineTest, IndependentOfBlockSize) {
+    const size_t channelCount = 3;
+    DynamicsProcessingEngine whole(channelCount, kSampleRate);
+    DynamicsProcessingEngine blocks(channelCount, kSampleRate);
+    const std::vector<DynamicsProcessing::EqBandConfig> eqBands = {
+            {.channel = 0, .band = 0, .enable = true, .cutoffFrequencyHz = 200, .gainDb = 6},
+            {.channel = 0, .band = 1, .enable = true, .cutoffFrequencyHz = 20000, .gainDb = -3},
+    };
+    for (auto* engine : {&whole, &blocks}) {
+        engine->setInputGains({{.channel = 2, .gainDb = 3}});
+        engine->setPreEq({.inUse = true, .bandCount = 2}, enableChannels(channelCount), eqBands);
+        engine->setMbc({.inUse = true, .bandCount = 3}, enableChannels(channelCount),
+                       makeMbcBands(channelCount, 3, -30, 3));
+        engine->setLimiter(true, {makeLimiter(0, 0), makeLimiter(1, 0), makeLimiter(2, 1)});
+    }
+
+    const std::vector<float> input = makeNoise(channelCount * 1000, 1.f);
+    std::vector<float> expected(input.size());
+    std::vector<float> output(input.size());
+    whole.process(input.data(), expected.data(), 1000);
+    for (size_t frame = 0; frame < 1000; frame += 77) {
+        const size_t offset = frame * channelCount;
+        blocks.process(input.data() + offset, output.data() + offset,
+                       std::min<size_t>(77, 1000 - frame));
+    }
+    for (size_t i = 0; i < output.size(); i++) {
+        ASSERT_NEAR(expected[i], output[i], 1e-5) << "sample " << i;
+    }
+}
@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 
 #define LOG_TAG "AHAL_EqualizerSw"
@@ -77,9 +78,9 @@ const std::vector<Range::EqualizerRange> EqualizerSw::kRanges = {
         MAKE_RANGE(Equalizer, preset, 0, EqualizerSw::kPresets.size() - 1),
         MAKE_RANGE(Equalizer, bandLevels,
                    std::vector<Equalizer::BandLevel>{
-                           Equalizer::BandLevel({.index = 0, .levelMb = -15})},
+                           Equalizer::BandLevel({.index = 0, .levelMb = -1500})},
                    std::vector<Equalizer::BandLevel>{Equalizer::BandLevel(
-                           {.index = EqualizerSwContext::kMaxBandNumber - 1, .levelMb = 15})}),
+                           {.index = EqualizerSwContext::kMaxBandNumber - 1, .levelMb = 1500})}),
         /* capability definition */
         MAKE_RANGE(Equalizer, bandFrequencies, EqualizerSw::kBandFrequency,
                    EqualizerSw::kBandFrequency),
@@ -207,12 +208,98 @@ RetCode EqualizerSw::releaseContext() {
 
 // Processing method running in EffectWorker thread.
 IEffect::Status EqualizerSw::effectProcessImpl(float* in, float* out, int samples) {
-    // TODO: get data buffer and process.
-    LOG(DEBUG) << __func__ << " in " << in << " out " << out << " samples " << samples;
-    for (int i = 0; i < samples; i++) {
-        *out++ = *in++;
+    RETURN_VALUE_IF(!mContext, (IEffect::Status{EX_NULL_POINTER, 0, 0}), "nullContext");
+    return mContext->process(in, out, samples);
+}
+
+RetCode EqualizerSwContext::setCommon(const Parameter::Common& common) {
+    if (auto ret = EffectContext::setCommon(common); ret != RetCode::SUCCESS) {
+        return ret;
+    }
+    createEqualizer();
+    return RetCode::SUCCESS;
+}
+
+RetCode EqualizerSwContext::setEqPreset(const int& presetIdx) {
+    if (presetIdx < 0 || presetIdx >= kMaxPresetNumber) {
+        return RetCode::ERROR_ILLEGAL_PARAMETER;
+    }
+    mPreset = presetIdx;
+    const size_t rampFrames = mCommon.input.base.sampleRate * kRampMs / 1000;
+    for (int i = 0; i < kMaxBandNumber; i++) {
+        if (mBandLevels[i] != kPresetBandLevels[presetIdx][i]) {
+            mBandLevels[i] = kPresetBandLevels[presetIdx][i];
+            updateBand(i, rampFrames);
+        }
+    }
+    return RetCode::SUCCESS;
+}
+
+RetCode EqualizerSwContext::setEqBandLevels(const std::vector<Equalizer::BandLevel>& bandLevels) {
+    if (bandLevels.size() > kMaxBandNumber) {
+        LOG(ERROR) << __func__ << " return because size exceed " << kMaxBandNumber;
+        return RetCode::ERROR_ILLEGAL_PARAMETER;
+    }
+    RetCode ret = RetCode::SUCCESS;
+    const size_t rampFrames = mCommon.input.base.sampleRate * kRampMs / 1000;
+    for (auto& it : bandLevels) {
+        if (it.index >= kMaxBandNumber || it.index < 0) {
+            LOG(ERROR) << __func__ << " index illegal, skip: " << it.index << " - "
+                       << it.levelMb;
+            ret = RetCode::ERROR_ILLEGAL_PARAMETER;
+        } else if (mBandLevels[it.index] != it.levelMb) {
+            mBandLevels[it.index] = it.levelMb;
+            updateBand(it.index, rampFrames);
+        }
+    }
+    return ret;
+}
+
+IEffect::Status EqualizerSwContext::process(float* in, float* out, int samples) {
+    LOG(VERBOSE) << __func__ << " in " << in << " out " << out << " samples " << samples;
+    if (!mEqualizer) {
+        std::copy(in, in + samples, out);
+    } else {
+        mEqualizer->process(in, out, samples / mInputChannelCount);
     }
     return {STATUS_OK, samples, samples};
 }
 
+void EqualizerSwContext::createEqualizer() {
+    if (mInputChannelCount != mOutputChannelCount) {
+        LOG(WARNING) << __func__ << " channel count mismatch, input " << mInputChannelCount
+                     << ", output " << mOutputChannelCount << ", bypass";
+        mEqualizer.reset();
+        return;
+    }
+    mEqualizer = std::make_unique<BiquadCascade>(mInputChannelCount, kMaxBandNumber);
+    for (int i = 0; i < kMaxBandNumber; i++) {
+        updateBand(i, 0 /* rampFrames */);
+    }
+}
+
+// The first and last bands are shelves, the others peaks about two octaves wide.
+void EqualizerSwContext::updateBand(int band, size_t rampFrames) {
+    if (!mEqualizer) {
+        return;
+    }
+    constexpr float kShelfQ = M_SQRT1_2;
+    constexpr float kPeakQ = 0.7f;
+    const float sampleRate = mCommon.input.base.sampleRate;
+    // keep the filters below Nyquist for low sample rates
+    const float frequency = std::min<float>(kPresetsFrequencies[band], sampleRate * 0.45f);
+    // band levels are in millibels
+    const float gainDb = mBandLevels[band] / 100.f;
+
+    BiquadCoefficients coefficients;
+    if (band == 0) {
+        coefficients = BiquadCoefficients::lowShelf(sampleRate, frequency, kShelfQ, gainDb);
+    } else if (band == kMaxBandNumber - 1) {
+        coefficients = BiquadCoefficients::highShelf(sampleRate, frequency, kShelfQ, gainDb);
+    } else {
+        coefficients = BiquadCoefficients::peaking(sampleRate, frequency, kPeakQ, gainDb);
+    }
+    mEqualizer->setCoefficients(band, coefficients, rampFrames);
+}
+
 }  // namespace aidl::android::hardware::audio::effect
@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <memory>
 
+#include "effect-impl/BiquadCascade.h"
 #include "effect-impl/EffectImpl.h"
 
 namespace aidl::android::hardware::audio::effect {
@@ -30,35 +31,15 @@ class EqualizerSwContext final : public EffectContext {
     EqualizerSwContext(int statusDepth, const Parameter::Common& common)
         : EffectContext(statusDepth, common) {
         LOG(DEBUG) << __func__;
+        createEqualizer();
     }
 
-    RetCode setEqPreset(const int& presetIdx) {
-        if (presetIdx < 0 || presetIdx >= kMaxPresetNumber) {
-            return RetCode::ERROR_ILLEGAL_PARAMETER;
-        }
-        mPreset = presetIdx;
-        return RetCode::SUCCESS;
-    }
-    int getEqPreset() { return mPreset; }
+    RetCode setCommon(const Parameter::Common& common) override;
 
-    RetCode setEqBandLevels(const std::vector<Equalizer::BandLevel>& bandLevels) {
-        if (bandLevels.size() > kMaxBandNumber) {
-            LOG(ERROR) << __func__ << " return because size exceed " << kMaxBandNumber;
-            return RetCode::ERROR_ILLEGAL_PARAMETER;
-        }
-        RetCode ret = RetCode::SUCCESS;
-        for (auto& it : bandLevels) {
-            if (it.index >= kMaxBandNumber || it.index < 0) {
-                LOG(ERROR) << __func__ << " index illegal, skip: " << it.index << " - "
-                           << it.levelMb;
-                ret = RetCode::ERROR_ILLEGAL_PARAMETER;
-            } else {
-                mBandLevels[it.index] = it.levelMb;
-            }
-        }
-        return ret;
-    }
+    RetCode setEqPreset(const int& presetIdx);
+    int getEqPreset() { return mPreset; }
 
+    RetCode setEqBandLevels(const std::vector<Equalizer::BandLevel>& bandLevels);
     std::vector<Equalizer::BandLevel> getEqBandLevels() {
         std::vector<Equalizer::BandLevel> bandLevels;
         for (int i = 0; i < kMaxBandNumber; i++) {
@@ -70,6 +51,9 @@ class EqualizerSwContext final : public EffectContext {
     std::vector<int> getCenterFreqs() {
         return {std::begin(kPresetsFrequencies), std::end(kPresetsFrequencies)};
     }
+
+    IEffect::Status process(float* in, float* out, int samples);
+
     static const int kMaxBandNumber = 5;
     static const int kMaxPresetNumber = 10;
     static const int kCustomPreset = -1;
@@ -77,11 +61,30 @@ class EqualizerSwContext final : public EffectContext {
   private:
     static constexpr std::array<uint16_t, kMaxBandNumber> kPresetsFrequencies = {60, 230, 910, 3600,
                                                                                  14000};
-    // preset band level
+    // band levels of the presets, in millibels
+    static constexpr std::array<std::array<int32_t, kMaxBandNumber>, kMaxPresetNumber>
+            kPresetBandLevels = {{{300, 0, 0, 0, 300},
+                                  {500, 300, -200, 400, 400},
+                                  {600, 0, 200, 400, 100},
+                                  {0, 0, 0, 0, 0},
+                                  {300, 0, 0, 200, -100},
+                                  {400, 100, 900, 300, 0},
+                                  {500, 300, 0, 100, 300},
+                                  {400, 200, -200, 200, 500},
+                                  {-100, 200, 500, 100, -200},
+                                  {500, 300, -100, 300, 500}}};
+    // Parameter changes are ramped over 10ms to avoid zipper noise.
+    static constexpr int kRampMs = 10;
+
+    // preset band level, in millibels
     int mPreset = kCustomPreset;
-    int32_t mBandLevels[kMaxBandNumber] = {3, 0, 0, 0, 3};
+    int32_t mBandLevels[kMaxBandNumber] = {300, 0, 0, 0, 300};
+
+    // One section per band, nullptr if the input and output channel masks differ
+    std::unique_ptr<BiquadCascade> mEqualizer;
 
-    // Add equalizer specific context for processing here
+    void createEqualizer();
+    void updateBand(int band, size_t rampFrames);
 };
 
 class EqualizerSw final : public EffectImpl {
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "EqualizerSw.h"
+
+using aidl::android::hardware::audio::effect::Equalizer;
+using aidl::android::hardware::audio::effect::EqualizerSwContext;
+using aidl::android::hardware::audio::effect::Parameter;
+using aidl::android::media::audio::common::AudioChannelLayout;
+using aidl::android::media::audio::common::AudioFormatDescription;
+using aidl::android::media::audio::common::AudioFormatType;
+using aidl::android::media::audio::common::PcmType;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+
+Parameter::Common createCommon(int32_t layout, int frameCount) {
+    Parameter::Common common;
+    common.input.base.sampleRate = kSampleRate;
+    common.input.base.channelMask =
+            AudioChannelLayout::make<AudioChannelLayout::layoutMask>(layout);
+    common.input.base.format = AudioFormatDescription{.type = AudioFormatType::PCM,
+                                                      .pcm = PcmType::FLOAT_32_BIT};
+    common.input.frameCount = frameCount;
+    common.output = common.input;
+    return common;
+}
+
+std::vector<float> createNoise(size_t sampleCount) {
+    std::minstd_rand generator(42);
+    std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+    std::vector<float> noise(sampleCount);
+    for (auto& sample : noise) {
+        sample = distribution(generator);
+    }
+    return noise;
+}
+
+// args: channel layout, frames per block, whether a band level changes at every block
+void BM_EqualizerSwProcess(benchmark::State& state) {
+    const int32_t layout = state.range(0);
+    const int frameCount = state.range(1);
+    const bool updateBands = state.range(2);
+    auto context = std::make_unique<EqualizerSwContext>(1 /* statusDepth */,
+                                                        createCommon(layout, frameCount));
+    context->setEqPreset(9 /* Rock */);
+
+    const int channelCount = __builtin_popcount(layout);
+    std::vector<float> input = createNoise(frameCount * channelCount);
+    std::vector<float> output(input.size());
+    int32_t level = 0;
+    for (auto _ : state) {
+        if (updateBands) {
+            level = (level + 100) % 1600;
+            context->setEqBandLevels({Equalizer::BandLevel({.index = 2, .levelMb = level})});
+        }
+        context->process(input.data(), output.data(), input.size());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frameCount);
+    // seconds of audio processed per second of CPU time
+    state.counters["realtime"] = benchmark::Counter(static_cast<double>(frameCount) / kSampleRate,
+                                                    benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void EqualizerSwArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"layout", "frames", "updates"});
+    for (int32_t layout : {AudioChannelLayout::LAYOUT_STEREO, AudioChannelLayout::LAYOUT_5POINT1,
+                           AudioChannelLayout::LAYOUT_7POINT1}) {
+        for (int updates : {0, 1}) {
+            b->Args({layout, 256, updates});
+        }
+    }
+}
+
+BENCHMARK(BM_EqualizerSwProcess)->Apply(EqualizerSwArgs);
+
+}  // namespace
+
+BENCHMARK_MAIN();
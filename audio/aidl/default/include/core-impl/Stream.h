@@ -46,6 +46,7 @@
 
 #include "core-impl/ChildInterface.h"
 #include "core-impl/SoundDose.h"
+#include "core-impl/StreamEffectChain.h"
 #include "core-impl/utils.h"
 
 namespace aidl::android::hardware::audio::core {
@@ -100,6 +101,7 @@ class StreamContext {
           mNominalLatencyMs(nominalLatencyMs),
           mMixPortHandle(mixPortHandle),
           mDataMQ(std::move(dataMQ)),
+          mEffectChain(std::make_shared<StreamEffectChain>(format, channelLayout, sampleRate)),
           mAsyncCallback(asyncCallback),
           mOutEventCallback(outEventCallback),
           mStreamDataProcessor(streamDataProcessor),
@@ -134,6 +136,8 @@ class StreamContext {
     }
     CommandMQ* getCommandMQ() const { return mCommandMQ.get(); }
     DataMQ* getDataMQ() const { return mDataMQ.get(); }
+    // Only non-mmap streams have an effect chain.
+    StreamEffectChain* getEffectChain() const { return mEffectChain.get(); }
     ::aidl::android::media::audio::common::AudioFormatDescription getFormat() const {
         return mFormat;
     }
@@ -179,6 +183,8 @@ class StreamContext {
     int32_t mMixPortHandle;
     // Only one of `mDataMQ` or `mMapBufferDesc` can be active, depending on `isMmap`
     std::unique_ptr<DataMQ> mDataMQ;
+    // Shared because it is not movable. Used both by the Binder and the worker threads.
+    std::shared_ptr<StreamEffectChain> mEffectChain;
     MmapBufferDescriptor mMmapBufferDesc;
     std::shared_ptr<IStreamCallback> mAsyncCallback;
     std::shared_ptr<IStreamOutEventCallback> mOutEventCallback;  // Only used by output streams
@@ -215,6 +221,10 @@ struct DriverInterface {
     virtual ::android::status_t start() = 0;
     virtual ::android::status_t transfer(void* buffer, size_t frameCount, size_t* actualFrameCount,
                                          int32_t* latencyMs) = 0;
+    // The buffer passed to 'transfer' can be the memory of the data MQ, which is only valid
+    // during the call. Drivers which keep using the buffer after 'transfer' returns must
+    // return false, then the data is copied through an intermediate buffer.
+    virtual bool isDirectTransferSupported() { return true; }
     // No need to implement 'refinePosition' unless the driver can provide more precise
     // data than just total frame count. For example, the driver may correctly account
     // for any intermediate buffers.
@@ -257,6 +267,11 @@ class StreamWorkerCommonLogic : public ::android::hardware::audio::common::Strea
     void onBufferStateChange(size_t bufferFramesLeft) override;
     void onClipStateChange(size_t clipFramesLeft, bool hasNextClip) override;
 
+    // Returns the data MQ memory of the transaction when the driver can transfer 'byteCount'
+    // bytes directly from or into it, or nullptr when the data must go through 'mDataBuffer',
+    // for example because it wraps around the ring of the MQ.
+    DataBufferElement* getDirectTransferBuffer(
+            const StreamContext::DataMQ::MemTransaction& transaction, size_t byteCount) const;
     void populateReply(StreamDescriptor::Reply* reply, bool isConnected) const;
     void populateReplyWrongState(StreamDescriptor::Reply* reply,
                                  const StreamDescriptor::Command& command) const;
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <aidl/android/hardware/audio/effect/IEffect.h>
+#include <aidl/android/media/audio/common/AudioChannelLayout.h>
+#include <aidl/android/media/audio/common/AudioFormatDescription.h>
+#include <android-base/thread_annotations.h>
+#include <audio_utils/mutex.h>
+#include <system/audio.h>
+
+#include "effect-impl/InlineProcessingInterface.h"
+
+namespace aidl::android::hardware::audio::core {
+
+// The effects attached to a stream with 'IStreamCommon.addEffect'. They process the data of the
+// stream on its worker thread, in the order they were added, on the same buffer which is
+// exchanged with the driver. This saves the wakeup of the effect thread and the copies through
+// the effect data MQs.
+//
+// Only effects living in the process of the stream and implementing InlineProcessingInterface
+// can be attached. PCM data which is not float is converted in blocks of kWorkBufferFrames.
+class StreamEffectChain {
+  public:
+    static constexpr size_t kWorkBufferFrames = 256;
+
+    StreamEffectChain(const ::aidl::android::media::audio::common::AudioFormatDescription& format,
+                      const ::aidl::android::media::audio::common::AudioChannelLayout& layout,
+                      int sampleRate);
+
+    // Called on a Binder thread.
+    ndk::ScopedAStatus addEffect(
+            const std::shared_ptr<::aidl::android::hardware::audio::effect::IEffect>& effect);
+    ndk::ScopedAStatus removeEffect(
+            const std::shared_ptr<::aidl::android::hardware::audio::effect::IEffect>& effect);
+
+    // Called on the worker thread. Processes 'frameCount' frames of the stream in place.
+    void process(void* buffer, size_t frameCount);
+
+  private:
+    using InlineProcessingInterface =
+            ::aidl::android::hardware::audio::effect::InlineProcessingInterface;
+
+    void processFloat_l(float* buffer, size_t frameCount) REQUIRES(mMutex);
+
+    const audio_format_t mFormat;
+    const size_t mChannelCount;
+    const size_t mFrameSize;
+    const int mSampleRate;
+    ::android::audio_utils::mutex mMutex;
+    // The effect keeps the processing interface alive.
+    std::vector<std::pair<std::shared_ptr<::aidl::android::hardware::audio::effect::IEffect>,
+                          InlineProcessingInterface*>>
+            mEffects GUARDED_BY(mMutex);
+    // Float frames converted from the stream format.
+    std::vector<float> mWorkBuffer GUARDED_BY(mMutex);
+};
+
+}  // namespace aidl::android::hardware::audio::core
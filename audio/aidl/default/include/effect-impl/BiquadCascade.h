@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aidl::android::hardware::audio::effect {
+
+// Coefficients of a biquad section, normalized so that a0 is 1:
+// y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+struct BiquadCoefficients {
+    float b0 = 1.f;
+    float b1 = 0.f;
+    float b2 = 0.f;
+    float a1 = 0.f;
+    float a2 = 0.f;
+
+    // Filters of the RBJ Audio EQ Cookbook. Frequencies are in Hz and gains in dB.
+    static BiquadCoefficients peaking(float sampleRate, float frequency, float q, float gainDb);
+    static BiquadCoefficients lowShelf(float sampleRate, float frequency, float q, float gainDb);
+    static BiquadCoefficients highShelf(float sampleRate, float frequency, float q, float gainDb);
+    static BiquadCoefficients lowPass(float sampleRate, float frequency, float q);
+    static BiquadCoefficients highPass(float sampleRate, float frequency, float q);
+};
+
+// Applies a cascade of biquad sections to interleaved float audio. Every channel has its own
+// coefficients and state.
+//
+// The filters of all the sections and channels are laid out side by side in vectors of 4 lanes,
+// so a stereo 5 band cascade runs 10 filters on 3 vectors. The sections are skewed in time:
+// while section s filters frame n, section s + 1 filters frame n - 1. All the filters of one
+// step then only depend on the outputs of the previous step, shifted by one section. The skew is
+// filled and drained within every process() call, so the cascade adds no latency.
+//
+// Coefficient changes can be ramped linearly over a number of frames to avoid zipper noise.
+// The region of stable (a1, a2) is convex, so a ramp between two stable sections stays stable.
+//
+// This class is not thread-safe.
+class BiquadCascade {
+  public:
+    BiquadCascade(size_t channelCount, size_t sectionCount);
+
+    size_t getChannelCount() const { return mChannelCount; }
+    size_t getSectionCount() const { return mSectionCount; }
+
+    // Sets the coefficients of a section for all channels, or for a single channel. A ramp
+    // started by rampFrames > 0 restarts the pending ramps of the other sections, so that they
+    // all reach their targets after rampFrames frames.
+    void setCoefficients(size_t section, const BiquadCoefficients& coefficients,
+                         size_t rampFrames = 0);
+    void setCoefficients(size_t section, size_t channel, const BiquadCoefficients& coefficients,
+                         size_t rampFrames = 0);
+
+    // Clears the filter state and completes the pending ramps.
+    void reset();
+
+    // Filters frameCount frames of mChannelCount samples. in and out may be the same buffer.
+    void process(const float* in, float* out, size_t frameCount);
+
+  private:
+    typedef float Vector __attribute__((vector_size(16)));
+    typedef int32_t Mask __attribute__((vector_size(16)));
+    static constexpr size_t kLanes = sizeof(Vector) / sizeof(float);
+
+    // The coefficients of the filters of 4 lanes
+    struct VectorCoefficients {
+        Vector b0, b1, b2, a1, a2;
+    };
+
+    // Sets the target of a filter, and applies it right away if apply is true.
+    void setTarget(size_t section, size_t channel, const BiquadCoefficients& coefficients,
+                   bool apply);
+    void startRamp(size_t rampFrames);
+
+    static Vector select(Mask mask, Vector a, Vector b) {
+        return (Vector)(((Mask)a & mask) | ((Mask)b & ~mask));
+    }
+
+    // How the coefficients move along a pending ramp at a step
+    enum class Ramp {
+        NONE,    // all the filters reached the targets
+        ALL,     // all the filters are ramping
+        MASKED,  // some filters reach their targets at this step
+    };
+
+    // kSectionLanes is the number of lanes of a section, 1, 2, or 0 for multiples of 4.
+    template <size_t kSectionLanes>
+    void processFrames(const float* in, float* out, size_t frameCount);
+    // kMasked only updates the filters of the sections with a frame to filter at this step, for
+    // the steps filling and draining the skew.
+    template <size_t kSectionLanes, bool kMasked, Ramp kRamp>
+    void processStep(const float* in, float* out, size_t step, size_t frameCount);
+    template <size_t kSectionLanes>
+    Vector getInput(const float* in, size_t v) const;
+
+    const size_t mChannelCount;
+    const size_t mSectionCount;
+    // Number of lanes used by a section: 1, 2, or the channel count rounded up to a multiple of 4
+    const size_t mSectionLanes;
+    const size_t mVectorCount;
+    // Lane layout [section][channel] for all the following, padded to [mVectorCount]
+    std::vector<VectorCoefficients> mTargets;
+    std::vector<VectorCoefficients> mCoefficients;
+    std::vector<VectorCoefficients> mRampSteps;
+    // Filter state (transposed direct form II) and output of the last step
+    std::vector<Vector> mZ1;
+    std::vector<Vector> mZ2;
+    std::vector<Vector> mOutputs;
+    // Section of every lane, mSectionCount for the padding
+    std::vector<Vector> mSections;
+    // Remaining frames of the pending ramp, common to all sections
+    size_t mRampFrames = 0;
+};
+
+}  // namespace aidl::android::hardware::audio::effect
@@ -27,13 +27,14 @@
 #include "effect-impl/EffectContext.h"
 #include "effect-impl/EffectThread.h"
 #include "effect-impl/EffectTypes.h"
+#include "effect-impl/InlineProcessingInterface.h"
 
 extern "C" binder_exception_t destroyEffect(
         const std::shared_ptr<aidl::android::hardware::audio::effect::IEffect>& instanceSp);
 
 namespace aidl::android::hardware::audio::effect {
 
-class EffectImpl : public BnEffect, public EffectThread {
+class EffectImpl : public BnEffect, public EffectThread, public InlineProcessingInterface {
   public:
     EffectImpl() = default;
     virtual ~EffectImpl() = default;
@@ -88,6 +89,24 @@ class EffectImpl : public BnEffect, public EffectThread {
      */
     void process() override;
 
+    /**
+     * Whether effectProcessImpl() can take distinct input and output buffers. Effects which can
+     * override it to return true, then process() passes the data MQ regions directly, without
+     * copying the data through the work buffer, as long as the input and output frame sizes are
+     * equal.
+     */
+    virtual bool isDirectProcessingSupported() { return false; }
+
+    /**
+     * processInline() calls effectProcessImpl() in place on the stream worker thread, bypassing
+     * the data MQs. It only processes in the PROCESSING and DRAINING states, and when both the
+     * input and the output of the effect have 'channelCount' float channels at 'sampleRate'.
+     * It waits for mImplMutex like process(), so mImplMutex must only be held for short,
+     * non-blocking work.
+     */
+    bool processInline(float* buffer, size_t frameCount, size_t channelCount,
+                       int sampleRate) override;
+
   protected:
     // current Hal version
     int mVersion = 0;
@@ -113,6 +132,14 @@ class EffectImpl : public BnEffect, public EffectThread {
 
     RetCode notifyEventFlag(uint32_t flag);
 
+    /**
+     * Processes the whole frames available in the input data MQ, directly from the input MQ
+     * memory to the output MQ memory. Returns false if the data must go through the work buffer
+     * instead.
+     */
+    bool processDirect_l(EffectContext::DataMQ& inputMQ, EffectContext::DataMQ& outputMQ,
+                         EffectContext::StatusMQ& statusMQ) REQUIRES(mImplMutex);
+
     std::string getEffectNameWithVersion() {
         return getEffectName() + "V" + std::to_string(mVersion);
     }
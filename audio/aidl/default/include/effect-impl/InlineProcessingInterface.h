@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace aidl::android::hardware::audio::effect {
+
+// Interface of effects which can process the data of an audio stream synchronously, on the
+// worker thread of the stream. It is only reachable when the effect lives in the same process
+// as the stream, see 'IStreamCommon.addEffect'.
+class InlineProcessingInterface {
+  public:
+    virtual ~InlineProcessingInterface() = default;
+
+    // Processes 'frameCount' interleaved float frames of 'channelCount' channels, sampled at
+    // 'sampleRate', in place. Returns false if the effect can not process the data, for example
+    // because it is not started, or its configuration does not match the channel count or the
+    // sample rate. The data may have been modified partially in that case. It may wait briefly
+    // for a concurrent reconfiguration of the effect, but never skips a started effect because
+    // of it.
+    virtual bool processInline(float* buffer, size_t frameCount, size_t channelCount,
+                               int sampleRate) = 0;
+};
+
+}  // namespace aidl::android::hardware::audio::effect
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <effect-impl/BiquadCascade.h>
+#include <gtest/gtest.h>
+
+using aidl::android::hardware::audio::effect::BiquadCascade;
+using aidl::android::hardware::audio::effect::BiquadCoefficients;
+
+namespace {
+
+constexpr float kSampleRate = 48000;
+// relative to the sample magnitude
+constexpr float kTolerance = 1e-4;
+
+// Direct form I filter of a single channel, sample by sample, section by section.
+class ReferenceCascade {
+  public:
+    ReferenceCascade(size_t channelCount, size_t sectionCount)
+        : mChannelCount(channelCount),
+          mSectionCount(sectionCount),
+          mCoefficients(sectionCount * channelCount),
+          mState(sectionCount * channelCount) {}
+
+    void setCoefficients(size_t section, size_t channel, const BiquadCoefficients& coefficients) {
+        mCoefficients[section * mChannelCount + channel] = coefficients;
+    }
+
+    void process(const float* in, float* out, size_t frameCount) {
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            for (size_t channel = 0; channel < mChannelCount; channel++) {
+                double x = in[frame * mChannelCount + channel];
+                for (size_t section = 0; section < mSectionCount; section++) {
+                    const auto& c = mCoefficients[section * mChannelCount + channel];
+                    auto& s = mState[section * mChannelCount + channel];
+                    const double y = c.b0 * x + c.b1 * s.x1 + c.b2 * s.x2 - c.a1 * s.y1 -
+                                     c.a2 * s.y2;
+                    s = {.x1 = x, .x2 = s.x1, .y1 = y, .y2 = s.y1};
+                    x = y;
+                }
+                out[frame * mChannelCount + channel] = x;
+            }
+        }
+    }
+
+  private:
+    struct State {
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    };
+    const size_t mChannelCount;
+    const size_t mSectionCount;
+    std::vector<BiquadCoefficients> mCoefficients;
+    std::vector<State> mState;
+};
+
+std::vector<float> makeNoise(size_t sampleCount) {
+    std::minstd_rand generator(42);
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    std::vector<float> noise(sampleCount);
+    for (auto& sample : noise) {
+        sample = distribution(generator);
+    }
+    return noise;
+}
+
+// A different filter for every section and channel.
+BiquadCoefficients makeCoefficients(size_t section, size_t channel) {
+    const float frequency = 100.f * (1 + section) + 300.f * channel;
+    switch ((section + channel) % 5) {
+        case 0:
+            return BiquadCoefficients::peaking(kSampleRate, frequency, 0.7f, 6.f);
+        case 1:
+            return BiquadCoefficients::lowShelf(kSampleRate, frequency, M_SQRT1_2, -4.f);
+        case 2:
+            return BiquadCoefficients::highShelf(kSampleRate, frequency, M_SQRT1_2, 3.f);
+        case 3:
+            return BiquadCoefficients::lowPass(kSampleRate, frequency * 4, M_SQRT1_2);
+        default:
+            return BiquadCoefficients::highPass(kSampleRate, frequency, M_SQRT1_2);
+    }
+}
+
+float getMagnitude(const BiquadCoefficients& c, float frequency) {
+    const double w = 2 * M_PI * frequency / kSampleRate;
+    const std::complex<double> z1 = std::polar(1., -w);
+    const std::complex<double> z2 = z1 * z1;
+    return std::abs((double{c.b0} + double{c.b1} * z1 + double{c.b2} * z2) /
+                    (1. + double{c.a1} * z1 + double{c.a2} * z2));
+}
+
+}  // namespace
+
+// channel count, section count
+class BiquadCascadeTest : public testing::TestWithParam<std::tuple<size_t, size_t>> {
+  protected:
+    const size_t mChannelCount = std::get<0>(GetParam());
+    const size_t mSectionCount = std::get<1>(GetParam());
+};
+
+TEST_P(BiquadCascadeTest, MatchesReference) {
+    BiquadCascade cascade(mChannelCount, mSectionCount);
+    ReferenceCascade reference(mChannelCount, mSectionCount);
+    for (size_t section = 0; section < mSectionCount; section++) {
+        for (size_t channel = 0; channel < mChannelCount; channel++) {
+            cascade.setCoefficients(section, channel, makeCoefficients(section, channel));
+            reference.setCoefficients(section, channel, makeCoefficients(section, channel));
+        }
+    }
+
+    // Odd block sizes, including blocks shorter than the cascade, and in place processing
+    const std::vector<float> input = makeNoise(1000 * mChannelCount);
+    std::vector<float> output(input.size());
+    std::vector<float> expected(input.size());
+    reference.process(input.data(), expected.data(), input.size() / mChannelCount);
+    size_t frame = 0;
+    for (size_t block : {1, 2, 3, 7, 64, 256, 667}) {
+        block = std::min(block, input.size() / mChannelCount - frame);
+        float* out = output.data() + frame * mChannelCount;
+        std::copy_n(input.data() + frame * mChannelCount, block * mChannelCount, out);
+        cascade.process(out, out, block);
+        frame += block;
+    }
+    ASSERT_EQ(input.size() / mChannelCount, frame);
+    for (size_t i = 0; i < output.size(); i++) {
+        ASSERT_NEAR(expected[i], output[i], kTolerance * std::max(1.f, std::abs(expected[i])))
+                << "sample " << i;
+    }
+}
+
+TEST_P(BiquadCascadeTest, RampReachesTarget) {
+    BiquadCascade cascade(mChannelCount, mSectionCount);
+    ReferenceCascade reference(mChannelCount, mSectionCount);
+    for (size_t section = 0; section < mSectionCount; section++) {
+        cascade.setCoefficients(section, makeCoefficients(section, 0), 480 /* rampFrames */);
+        for (size_t channel = 0; channel < mChannelCount; channel++) {
+            reference.setCoefficients(section, channel, makeCoefficients(section, 0));
+        }
+    }
+
+    // During the ramp the output is bounded. The ramp is driven by processing blocks which do not
+    // divide it evenly, the reference runs the target filter all along.
+    const std::vector<float> input = makeNoise(480 * mChannelCount);
+    std::vector<float> output(input.size());
+    std::vector<float> expected(input.size());
+    for (size_t frame = 0; frame < 480;) {
+        const size_t block = std::min<size_t>(100, 480 - frame);
+        cascade.process(input.data() + frame * mChannelCount, output.data() + frame * mChannelCount,
+                        block);
+        frame += block;
+    }
+    reference.process(input.data(), expected.data(), 480);
+    for (float sample : output) {
+        ASSERT_LT(std::abs(sample), 100.f);
+    }
+
+    // After the ramp the cascade is the target filter: once the difference of state left by the
+    // ramp has decayed, both filters produce the same output.
+    const std::vector<float> tail = makeNoise(4800 * mChannelCount);
+    output.resize(tail.size());
+    expected.resize(tail.size());
+    cascade.process(tail.data(), output.data(), 4800);
+    reference.process(tail.data(), expected.data(), 4800);
+    for (size_t i = 4320 * mChannelCount; i < output.size(); i++) {
+        ASSERT_NEAR(expected[i], output[i], kTolerance * std::max(1.f, std::abs(expected[i])))
+                << "sample " << i;
+    }
+}
+
+TEST_P(BiquadCascadeTest, RampIndependentOfBlockSize) {
+    BiquadCascade whole(mChannelCount, mSectionCount);
+    BiquadCascade blocks(mChannelCount, mSectionCount);
+    const std::vector<float> input = makeNoise(600 * mChannelCount);
+    std::vector<float> expected(input.size());
+    std::vector<float> output(input.size());
+    for (auto* cascade : {&whole, &blocks}) {
+        for (size_t section = 0; section < mSectionCount; section++) {
+            cascade->setCoefficients(section, makeCoefficients(section, 1));
+            // a ramp on a single channel, then a longer one restarting it on all channels
+            cascade->setCoefficients(section, 0, makeCoefficients(section, 2), 100);
+            cascade->setCoefficients(section, makeCoefficients(section, 3), 300);
+        }
+    }
+
+    whole.process(input.data(), expected.data(), 600);
+    for (size_t frame = 0; frame < 600; frame += 7) {
+        const size_t offset = frame * mChannelCount;
+        blocks.process(input.data() + offset, output.data() + offset,
+                       std::min<size_t>(7, 600 - frame));
+    }
+    for (size_t i = 0; i < output.size(); i++) {
+        ASSERT_NEAR(expected[i], output[i], kTolerance * std::max(1.f, std::abs(expected[i])))
+                << "sample " << i;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(BiquadCascade, BiquadCascadeTest,
+                         testing::Combine(testing::Values(1, 2, 3, 4, 6, 8),
+                                          testing::Values(0, 1, 2, 5)),
+                         [](const testing::TestParamInfo<BiquadCascadeTest::ParamType>& info) {
+                             return std::to_string(std::get<0>(info.param)) + "ch_" +
+                                    std::to_string(std::get<1>(info.param)) + "sections";
+                         });
+
+TEST(BiquadCoefficientsTest, PeakingGain) {
+    const auto peak = BiquadCoefficients::peaking(kSampleRate, 1000, 0.7f, 6.f);
+    EXPECT_NEAR(std::pow(10., 6. / 20.), getMagnitude(peak, 1000), 1e-3);
+    EXPECT_NEAR(1., getMagnitude(peak, 20), 1e-2);
+    EXPECT_NEAR(1., getMagnitude(peak, 20000), 1e-2);
+}
+
+TEST(BiquadCoefficientsTest, ShelfGain) {
+    const auto low = BiquadCoefficients::lowShelf(kSampleRate, 200, M_SQRT1_2, -6.f);
+    EXPECT_NEAR(std::pow(10., -6. / 20.), getMagnitude(low, 10), 1e-2);
+    EXPECT_NEAR(1., getMagnitude(low, 10000), 1e-2);
+    const auto high = BiquadCoefficients::highShelf(kSampleRate, 5000, M_SQRT1_2, 6.f);
+    EXPECT_NEAR(1., getMagnitude(high, 50), 1e-2);
+    EXPECT_NEAR(std::pow(10., 6. / 20.), getMagnitude(high, 23000), 2e-2);
+}
+
+TEST(BiquadCoefficientsTest, PassFilters) {
+    const auto lowPass = BiquadCoefficients::lowPass(kSampleRate, 1000, M_SQRT1_2);
+    EXPECT_NEAR(1., getMagnitude(lowPass, 10), 1e-3);
+    EXPECT_NEAR(M_SQRT1_2, getMagnitude(lowPass, 1000), 1e-3);
+    const auto highPass = BiquadCoefficients::highPass(kSampleRate, 1000, M_SQRT1_2);
+    EXPECT_NEAR(1., getMagnitude(highPass, 23000), 1e-2);
+    EXPECT_NEAR(M_SQRT1_2, getMagnitude(highPass, 1000), 1e-3);
+}
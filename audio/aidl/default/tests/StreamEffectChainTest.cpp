@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core-impl/StreamEffectChain.h"
+#include "effect-impl/EffectImpl.h"
+
+using aidl::android::hardware::audio::core::StreamEffectChain;
+using aidl::android::hardware::audio::effect::CommandId;
+using aidl::android::hardware::audio::effect::Descriptor;
+using aidl::android::hardware::audio::effect::EffectImpl;
+using aidl::android::hardware::audio::effect::IEffect;
+using aidl::android::hardware::audio::effect::IEffectDefault;
+using aidl::android::hardware::audio::effect::InlineProcessingInterface;
+using aidl::android::hardware::audio::effect::Parameter;
+using aidl::android::hardware::audio::effect::RetCode;
+using aidl::android::media::audio::common::AudioChannelLayout;
+using aidl::android::media::audio::common::AudioFormatDescription;
+using aidl::android::media::audio::common::AudioFormatType;
+using aidl::android::media::audio::common::PcmType;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+
+// Applies a gain to the channels and the sample rate it is configured for.
+class GainEffect : public IEffectDefault, public InlineProcessingInterface {
+  public:
+    GainEffect(float gain, size_t channelCount, int sampleRate = kSampleRate)
+        : mGain(gain), mChannelCount(channelCount), mSampleRate(sampleRate) {}
+
+    bool processInline(float* buffer, size_t frameCount, size_t channelCount,
+                       int sampleRate) override {
+        if (channelCount != mChannelCount || sampleRate != mSampleRate) {
+            return false;
+        }
+        for (size_t i = 0; i < frameCount * channelCount; i++) {
+            buffer[i] *= mGain;
+        }
+        mProcessedFrames += frameCount;
+        return true;
+    }
+
+    const float mGain;
+    const size_t mChannelCount;
+    const int mSampleRate;
+    size_t mProcessedFrames = 0;
+};
+
+// An EffectImpl living in the process of the stream, halving the samples.
+class HalfGainEffectImpl final : public EffectImpl {
+  public:
+    ~HalfGainEffectImpl() { cleanUp(); }
+
+    ndk::ScopedAStatus getDescriptor(Descriptor* desc) override {
+        *desc = {};
+        return ndk::ScopedAStatus::ok();
+    }
+    ndk::ScopedAStatus setParameterSpecific(const Parameter::Specific&)
+            REQUIRES(mImplMutex) override {
+        return ndk::ScopedAStatus::ok();
+    }
+    ndk::ScopedAStatus getParameterSpecific(const Parameter::Id&, Parameter::Specific*)
+            REQUIRES(mImplMutex) override {
+        return ndk::ScopedAStatus::ok();
+    }
+    std::string getEffectName() override { return "HalfGainEffectImpl"; }
+    RetCode releaseContext() REQUIRES(mImplMutex) override { return RetCode::SUCCESS; }
+
+    IEffect::Status effectProcessImpl(float* in, float* out, int samples)
+            REQUIRES(mImplMutex) override {
+        for (int i = 0; i < samples; i++) {
+            out[i] = in[i] * 0.5f;
+        }
+        return {STATUS_OK, samples, samples};
+    }
+
+    // Stands for a Binder thread reconfiguring the effect.
+    std::mutex& getImplMutex() { return mImplMutex; }
+};
+
+AudioFormatDescription makePcmFormat(PcmType pcm) {
+    AudioFormatDescription format;
+    format.type = AudioFormatType::PCM;
+    format.pcm = pcm;
+    return format;
+}
+
+AudioChannelLayout makeStereoLayout() {
+    return AudioChannelLayout::make<AudioChannelLayout::layoutMask>(
+            AudioChannelLayout::LAYOUT_STEREO);
+}
+
+}  // namespace
+
+TEST(StreamEffectChainTest, AddAndRemove) {
+    StreamEffectChain chain(makePcmFormat(PcmType::FLOAT_32_BIT), makeStereoLayout(),
+                            kSampleRate);
+    auto effect = ndk::SharedRefBase::make<GainEffect>(0.5f, 2);
+    EXPECT_EQ(EX_ILLEGAL_ARGUMENT, chain.addEffect(nullptr).getExceptionCode());
+    EXPECT_EQ(EX_ILLEGAL_ARGUMENT, chain.removeEffect(nullptr).getExceptionCode());
+    EXPECT_EQ(EX_ILLEGAL_ARGUMENT, chain.removeEffect(effect).getExceptionCode());
+    EXPECT_TRUE(chain.addEffect(effect).isOk());
+    EXPECT_EQ(EX_ILLEGAL_ARGUMENT, chain.addEffect(effect).getExceptionCode());
+    EXPECT_TRUE(chain.removeEffect(effect).isOk());
+    EXPECT_EQ(EX_ILLEGAL_ARGUMENT, chain.removeEffect(effect).getExceptionCode());
+}
+
+TEST(StreamEffectChainTest, RejectsEffectsWithoutInlineProcessing) {
+    StreamEffectChain chain(makePcmFormat(PcmType::FLOAT_32_BIT), makeStereoLayout(),
+                            kSampleRate);
+    std::shared_ptr<IEffect> effect = ndk::SharedRefBase::make<IEffectDefault>();
+    EXPECT_EQ(EX_UNSUPPORTED_OPERATION, chain.addEffect(effect).getExceptionCode());
+}
+
+TEST(StreamEffectChainTest, RejectsNonPcmStreams) {
+    AudioFormatDescription format;
+    format.type = AudioFormatType::NON_PCM;
+    format.encoding = "audio/mpeg";
+    StreamEffectChain chain(format, makeStereoLayout(), kSampleRate);
+    auto effect = ndk::SharedRefBase::make<GainEffect>(0.5f, 2);
+    EXPECT_EQ(EX_UNSUPPORTED_OPERATION, chain.addEffect(effect).getExceptionCode());
+}
+
+TEST(StreamEffectChainTest, ProcessesFloatInOrder) {
+    StreamEffectChain chain(makePcmFormat(PcmType::FLOAT_32_BIT), makeStereoLayout(),
+                            kSampleRate);
+    auto half = ndk::SharedRefBase::make<GainEffect>(0.5f, 2);
+    auto mono = ndk::SharedRefBase::make<GainEffect>(0.f, 1);
+    auto otherRate = ndk::SharedRefBase::make<GainEffect>(0.f, 2, 44100);
+    auto quarter = ndk::SharedRefBase::make<GainEffect>(0.25f, 2);
+    ASSERT_TRUE(chain.addEffect(half).isOk());
+    ASSERT_TRUE(chain.addEffect(mono).isOk());
+    ASSERT_TRUE(chain.addEffect(otherRate).isOk());
+    ASSERT_TRUE(chain.addEffect(quarter).isOk());
+
+    std::vector<float> buffer(2 * 100, 1.f);
+    chain.process(buffer.data(), 100);
+    for (float sample : buffer) {
+        EXPECT_EQ(0.125f, sample);
+    }
+    EXPECT_EQ(100u, half->mProcessedFrames);
+    // The effects configured for another channel count or sample rate are bypassed.
+    EXPECT_EQ(0u, mono->mProcessedFrames);
+    EXPECT_EQ(0u, otherRate->mProcessedFrames);
+
+    ASSERT_TRUE(chain.removeEffect(half).isOk());
+    chain.process(buffer.data(), 100);
+    for (float sample : buffer) {
+        EXPECT_EQ(0.03125f, sample);
+    }
+}
+
+TEST(StreamEffectChainTest, ConvertsPcm16InBlocks) {
+    StreamEffectChain chain(makePcmFormat(PcmType::INT_16_BIT), makeStereoLayout(),
+                            kSampleRate);
+    auto effect = ndk::SharedRefBase::make<GainEffect>(0.5f, 2);
+    ASSERT_TRUE(chain.addEffect(effect).isOk());
+
+    const size_t frameCount = StreamEffectChain::kWorkBufferFrames * 2 + 3;
+    std::vector<int16_t> buffer(2 * frameCount, 0x4000);
+    chain.process(buffer.data(), frameCount);
+    for (int16_t sample : buffer) {
+        EXPECT_EQ(0x2000, sample);
+    }
+    EXPECT_EQ(frameCount, effect->mProcessedFrames);
+}
+
+TEST(StreamEffectChainTest, ProcessesWithLocalEffectImpl) {
+    StreamEffectChain chain(makePcmFormat(PcmType::FLOAT_32_BIT), makeStereoLayout(),
+                            kSampleRate);
+    auto effect = ndk::SharedRefBase::make<HalfGainEffectImpl>();
+    Parameter::Common common;
+    common.input.base.sampleRate = kSampleRate;
+    common.input.base.channelMask = makeStereoLayout();
+    common.input.base.format = makePcmFormat(PcmType::FLOAT_32_BIT);
+    common.input.frameCount = 100;
+    common.output = common.input;
+    IEffect::OpenEffectReturn ret;
+    ASSERT_TRUE(effect->open(common, std::nullopt, &ret).isOk());
+    ASSERT_TRUE(chain.addEffect(effect).isOk());
+
+    // The effect is bypassed until it is started.
+    std::vector<float> buffer(2 * 100, 1.f);
+    chain.process(buffer.data(), 100);
+    for (float sample : buffer) {
+        EXPECT_EQ(1.f, sample);
+    }
+
+    ASSERT_TRUE(effect->command(CommandId::START).isOk());
+    chain.process(buffer.data(), 100);
+    for (float sample : buffer) {
+        EXPECT_EQ(0.5f, sample);
+    }
+
+    // The effect waits for a concurrent reconfiguration rather than being bypassed.
+    std::thread workerThread;
+    {
+        std::lock_guard lock(effect->getImplMutex());
+        workerThread = std::thread([&chain, &buffer] { chain.process(buffer.data(), 100); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    workerThread.join();
+    for (float sample : buffer) {
+        EXPECT_EQ(0.25f, sample);
+    }
+
+    ASSERT_TRUE(effect->command(CommandId::STOP).isOk());
+    chain.process(buffer.data(), 100);
+    for (float sample : buffer) {
+        EXPECT_EQ(0.25f, sample);
+    }
+    ASSERT_TRUE(chain.removeEffect(effect).isOk());
+    ASSERT_TRUE(effect->close().isOk());
+}
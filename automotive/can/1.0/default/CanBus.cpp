@@ -297,33 +297,49 @@ static ErrorEvent parseErrorFrame(const struct canfd_frame& frame) {
     return ErrorEvent::UNKNOWN_ERROR;
 }
 
-void CanBus::onRead(const struct canfd_frame& frame, std::chrono::nanoseconds timestamp) {
-    if ((frame.can_id & CAN_ERR_FLAG) != 0) {
-        // error bit is set
-        LOG(WARNING) << "CAN Error frame received";
-        notifyErrorListeners(parseErrorFrame(frame), false);
-        return;
-    }
+void CanBus::onRead(std::span<const struct canfd_frame> frames,
+                    std::chrono::nanoseconds timestamp) {
+    std::vector<CanMessage> messages;
+    messages.reserve(frames.size());
+    for (const auto& frame : frames) {
+        if ((frame.can_id & CAN_ERR_FLAG) != 0) {
+            // error bit is set
+            LOG(WARNING) << "CAN Error frame received";
+            // Deliver the messages received before the error first, to keep the receive order.
+            notifyMessageListeners(messages);
+            messages.clear();
+            notifyErrorListeners(parseErrorFrame(frame), false);
+            continue;
+        }
 
-    CanMessage message = {};
-    message.id = frame.can_id & CAN_EFF_MASK;  // mask out eff/rtr/err flags
-    message.payload = hidl_vec<uint8_t>(frame.data, frame.data + frame.len);
-    message.timestamp = timestamp.count();
-    message.isExtendedId = (frame.can_id & CAN_EFF_FLAG) != 0;
-    message.remoteTransmissionRequest = (frame.can_id & CAN_RTR_FLAG) != 0;
+        CanMessage& message = messages.emplace_back();
+        message.id = frame.can_id & CAN_EFF_MASK;  // mask out eff/rtr/err flags
+        message.payload = hidl_vec<uint8_t>(frame.data, frame.data + frame.len);
+        message.timestamp = timestamp.count();
+        message.isExtendedId = (frame.can_id & CAN_EFF_FLAG) != 0;
+        message.remoteTransmissionRequest = (frame.can_id & CAN_RTR_FLAG) != 0;
 
-    if (UNLIKELY(kSuperVerbose)) {
-        LOG(VERBOSE) << "Got message " << toString(message);
+        if (UNLIKELY(kSuperVerbose)) {
+            LOG(VERBOSE) << "Got message " << toString(message);
+        }
     }
+    notifyMessageListeners(messages);
+}
 
+void CanBus::notifyMessageListeners(const std::vector<CanMessage>& messages) {
+    if (messages.empty()) return;
+
+    // Take the lock once for the whole batch.
     std::lock_guard<std::mutex> lck(mMsgListenersGuard);
     for (auto& listener : mMsgListeners) {
-        if (!match(listener.filter, message.id, message.remoteTransmissionRequest,
-                   message.isExtendedId))
-            continue;
-        if (!listener.callback->onReceive(message).isOk() && !listener.failedOnce) {
-            listener.failedOnce = true;
-            LOG(WARNING) << "Failed to notify listener about message";
+        for (const auto& message : messages) {
+            if (!match(listener.filter, message.id, message.remoteTransmissionRequest,
+                       message.isExtendedId))
+                continue;
+            if (!listener.callback->onReceive(message).isOk() && !listener.failedOnce) {
+                listener.failedOnce = true;
+                LOG(WARNING) << "Failed to notify listener about message";
+            }
         }
     }
 }
@@ -87,7 +87,8 @@ struct CanBus : public ICanBus {
 
     void notifyErrorListeners(ErrorEvent err, bool isFatal);
 
-    void onRead(const struct canfd_frame& frame, std::chrono::nanoseconds timestamp);
+    void onRead(std::span<const struct canfd_frame> frames, std::chrono::nanoseconds timestamp);
+    void notifyMessageListeners(const std::vector<CanMessage>& messages);
     void onError(int errnoVal);
 
     std::mutex mMsgListenersGuard;
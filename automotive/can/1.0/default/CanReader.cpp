@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CanReader.h"
+
+#include <android-base/logging.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <utils/SystemClock.h>
+
+#include <vector>
+
+namespace android::hardware::automotive::can::V1_0::implementation {
+
+/** Registration ID reserved for the event used to wake up the reader thread. */
+static constexpr uint64_t kWakeupId = 0;
+
+/** Maximum number of ready sockets handled per epoll_wait(2) call. */
+static constexpr int kMaxEvents = 16;
+
+CanReader& CanReader::getInstance() {
+    // Never destroyed, so that buses brought down at exit don't race with a destroyed reader.
+    static CanReader* instance = new CanReader();
+    return *instance;
+}
+
+CanReader::CanReader()
+    : mEpoll(epoll_create1(EPOLL_CLOEXEC)),
+      mWakeupEvent(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      mNextId(kWakeupId + 1) {
+    PCHECK(mEpoll.ok()) << "Failed to create epoll instance";
+    PCHECK(mWakeupEvent.ok()) << "Failed to create wakeup event";
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeupId;
+    PCHECK(epoll_ctl(mEpoll.get(), EPOLL_CTL_ADD, mWakeupEvent.get(), &event) == 0)
+            << "Failed to watch wakeup event";
+
+    for (size_t i = 0; i < kMaxBatchSize; i++) {
+        mIovecs[i].iov_base = &mFrames[i];
+        mIovecs[i].iov_len = CAN_MTU;
+        mMessages[i] = {};
+        mMessages[i].msg_hdr.msg_iov = &mIovecs[i];
+        mMessages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    mReaderThread = std::thread(&CanReader::readerThread, this);
+}
+
+CanReader::~CanReader() {
+    mStopReaderThread = true;
+    const uint64_t one = 1;
+    if (write(mWakeupEvent.get(), &one, sizeof(one)) != sizeof(one)) {
+        PLOG(ERROR) << "Failed to wake up reader thread";
+    }
+    mReaderThread.join();
+
+    std::lock_guard<std::mutex> lck(mListenersGuard);
+    CHECK(mListeners.empty()) << "Sockets are still being read while reader is being destroyed";
+}
+
+std::optional<uint64_t> CanReader::add(const base::unique_fd& socket, ReadCallback rdcb,
+                                       ErrorCallback errcb) {
+    std::lock_guard<std::mutex> lck(mListenersGuard);
+    const auto id = mNextId++;
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(mEpoll.get(), EPOLL_CTL_ADD, socket.get(), &event) != 0) {
+        PLOG(ERROR) << "Failed to watch CAN socket";
+        return std::nullopt;
+    }
+
+    mListeners[id] = std::make_shared<const Listener>(Listener{socket.get(), rdcb, errcb});
+    return id;
+}
+
+void CanReader::remove(uint64_t id) {
+    detach(id);
+
+    /* A callback may remove its own socket (i.e. when bringing the interface down after an error),
+     * in which case there is no need to wait for it. */
+    if (std::this_thread::get_id() == mReaderThread.get_id()) return;
+
+    // Wait for the read callbacks in progress to finish.
+    std::lock_guard<std::mutex> lck(mDispatchGuard);
+}
+
+std::shared_ptr<const CanReader::Listener> CanReader::getListener(uint64_t id) {
+    std::lock_guard<std::mutex> lck(mListenersGuard);
+    const auto it = mListeners.find(id);
+    if (it == mListeners.end()) return nullptr;
+    return it->second;
+}
+
+bool CanReader::detach(uint64_t id) {
+    std::lock_guard<std::mutex> lck(mListenersGuard);
+    const auto it = mListeners.find(id);
+    if (it == mListeners.end()) return false;
+
+    if (epoll_ctl(mEpoll.get(), EPOLL_CTL_DEL, it->second->fd, nullptr) != 0) {
+        PLOG(WARNING) << "Failed to stop watching CAN socket";
+    }
+    mListeners.erase(it);
+    return true;
+}
+
+std::optional<int> CanReader::readBatch(const Listener& listener) {
+    const auto count =
+            recvmmsg(listener.fd, mMessages.data(), kMaxBatchSize, MSG_DONTWAIT, nullptr);
+
+    /* We could use SIOCGSTAMP to get a precise UNIX timestamp for a given packet, but what
+     * we really need is a time since boot. There is no direct way to convert between these
+     * clocks. We could implement a class to calculate the difference between the clocks
+     * (querying both several times and picking the smallest difference); apply the difference
+     * to a SIOCGSTAMP returned value; re-synchronize if the elapsed time is too much in the
+     * past (indicating the UNIX timestamp might have been adjusted).
+     *
+     * Apart from the added complexity, it's possible the added calculations and system calls
+     * would add so much time to the processing pipeline so the precision of the reported time
+     * was buried under the subsystem latency. Let's just use a local time since boot here and
+     * leave precise hardware timestamps for custom proprietary implementations (if needed).
+     *
+     * All frames of a batch were already queued when it was read, so they share the timestamp. */
+    const std::chrono::nanoseconds ts(elapsedRealtimeNano());
+
+    if (count < 0) {
+        const auto errnoCopy = errno;
+        if (errnoCopy == EAGAIN || errnoCopy == EINTR) return std::nullopt;
+
+        PLOG(ERROR) << "Failed to read CAN packets";
+        return errnoCopy;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const auto nbytes = mMessages[i].msg_len;
+        if (nbytes == CAN_MTU) continue;
+
+        // Deliver the frames read correctly before failing.
+        if (i > 0) listener.readCallback({mFrames.data(), static_cast<size_t>(i)}, ts);
+        LOG(ERROR) << "Failed to read CAN packet, got " << nbytes << " bytes";
+        return 0;
+    }
+
+    if (count > 0) listener.readCallback({mFrames.data(), static_cast<size_t>(count)}, ts);
+    return std::nullopt;
+}
+
+void CanReader::readerThread() {
+    LOG(VERBOSE) << "Reader thread started";
+    std::array<struct epoll_event, kMaxEvents> events;
+
+    while (!mStopReaderThread) {
+        /* Sockets are level-triggered and read one batch at a time, so a bus flooded with frames
+         * doesn't starve the others. */
+        const auto count = epoll_wait(mEpoll.get(), events.data(), kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            PLOG(FATAL) << "Failed to wait for CAN sockets";
+        }
+
+        std::vector<std::pair<ErrorCallback, int>> failures;
+        {
+            std::lock_guard<std::mutex> lck(mDispatchGuard);
+            for (int i = 0; i < count; i++) {
+                const auto id = events[i].data.u64;
+                if (id == kWakeupId) continue;
+
+                // The socket might have been removed by one of the previous callbacks.
+                const auto listener = getListener(id);
+                if (listener == nullptr) continue;
+
+                const auto error = readBatch(*listener);
+                if (error.has_value() && detach(id)) {
+                    failures.emplace_back(listener->errorCallback, *error);
+                }
+            }
+        }
+
+        /* Error callbacks typically bring the interface down, possibly waiting for a thread
+         * that is itself waiting for the read callbacks to finish - so call them last. */
+        for (const auto& [errcb, errnoVal] : failures) errcb(errnoVal);
+    }
+
+    LOG(VERBOSE) << "Reader thread stopped";
+}
+
+}  // namespace android::hardware::automotive::can::V1_0::implementation
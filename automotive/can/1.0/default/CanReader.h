@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/macros.h>
+#include <android-base/thread_annotations.h>
+#include <android-base/unique_fd.h>
+#include <linux/can.h>
+#include <sys/socket.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+
+namespace android::hardware::automotive::can::V1_0::implementation {
+
+/**
+ * Reader shared by SocketCAN sockets.
+ *
+ * A single thread waits for all registered sockets with epoll(7) and reads the frames of each
+ * readable socket in batches with recvmmsg(2). This way, a gateway with many busy buses uses one
+ * reader thread instead of one per bus, and one system call per batch instead of one per frame.
+ */
+class CanReader {
+  public:
+    using ReadCallback = std::function<void(std::span<const struct canfd_frame> frames,
+                                            std::chrono::nanoseconds timestamp)>;
+    using ErrorCallback = std::function<void(int errnoVal)>;
+
+    /** Maximum number of frames read from a socket with a single system call. */
+    static constexpr size_t kMaxBatchSize = 64;
+
+    /** Reader shared by all the buses of this process. */
+    static CanReader& getInstance();
+
+    CanReader();
+    ~CanReader();
+
+    /**
+     * Start reading from a socket.
+     *
+     * Callbacks are called from the reader thread, one at a time. Frames read from the same socket
+     * are delivered in order. If reading fails, the socket is removed before the error callback
+     * is called.
+     *
+     * \param socket SocketCAN socket to read from
+     * \param rdcb Callback on received frames
+     * \param errcb Callback on socket failure
+     * \return Registration ID to pass to remove(), or std::nullopt in case of failure
+     */
+    std::optional<uint64_t> add(const base::unique_fd& socket, ReadCallback rdcb,
+                                ErrorCallback errcb);
+
+    /**
+     * Stop reading from a socket.
+     *
+     * When this method returns, no read callback for the socket is running, so the socket may be
+     * closed. If called from a callback, only that very callback may still be running.
+     *
+     * \param id Registration ID returned by add()
+     */
+    void remove(uint64_t id);
+
+  private:
+    struct Listener {
+        int fd;
+        ReadCallback readCallback;
+        ErrorCallback errorCallback;
+    };
+
+    void readerThread();
+    std::shared_ptr<const Listener> getListener(uint64_t id);
+    bool detach(uint64_t id);
+
+    /**
+     * Read a batch of frames and deliver them to the listener.
+     *
+     * \return std::nullopt on success, or errno value in case of failure
+     */
+    std::optional<int> readBatch(const Listener& listener) REQUIRES(mDispatchGuard);
+
+    const base::unique_fd mEpoll;
+    const base::unique_fd mWakeupEvent;
+    std::atomic<bool> mStopReaderThread = false;
+
+    std::mutex mListenersGuard;
+    uint64_t mNextId GUARDED_BY(mListenersGuard);
+    std::map<uint64_t, std::shared_ptr<const Listener>> mListeners GUARDED_BY(mListenersGuard);
+
+    /** Held by the reader thread while read callbacks may be running. */
+    std::mutex mDispatchGuard;
+    std::array<struct canfd_frame, kMaxBatchSize> mFrames GUARDED_BY(mDispatchGuard);
+    std::array<struct iovec, kMaxBatchSize> mIovecs GUARDED_BY(mDispatchGuard);
+    std::array<struct mmsghdr, kMaxBatchSize> mMessages GUARDED_BY(mDispatchGuard);
+
+    std::thread mReaderThread;
+
+    DISALLOW_COPY_AND_ASSIGN(CanReader);
+};
+
+}  // namespace android::hardware::automotive::can::V1_0::implementation
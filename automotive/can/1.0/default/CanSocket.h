@@ -16,27 +16,24 @@
 
 #pragma once
 
+#include "CanReader.h"
+
 #include <android-base/macros.h>
 #include <android-base/unique_fd.h>
 #include <linux/can.h>
 
-#include <atomic>
-#include <chrono>
-#include <functional>
-#include <thread>
-
 namespace android::hardware::automotive::can::V1_0::implementation {
 
 /** Wrapper around SocketCAN socket. */
 struct CanSocket {
-    using ReadCallback = std::function<void(const struct canfd_frame&, std::chrono::nanoseconds)>;
-    using ErrorCallback = std::function<void(int errnoVal)>;
+    using ReadCallback = CanReader::ReadCallback;
+    using ErrorCallback = CanReader::ErrorCallback;
 
     /**
      * Open and bind SocketCAN socket.
      *
      * \param ifname SocketCAN network interface name (such as can0)
-     * \param rdcb Callback on received messages
+     * \param rdcb Callback on received batches of messages
      * \param errcb Callback on socket failure
      * \return Socket instance, or nullptr if it wasn't possible to open one
      */
@@ -53,16 +50,10 @@ struct CanSocket {
     bool send(const struct canfd_frame& frame);
 
   private:
-    CanSocket(base::unique_fd socket, ReadCallback rdcb, ErrorCallback errcb);
-    void readerThread();
-
-    ReadCallback mReadCallback;
-    ErrorCallback mErrorCallback;
+    CanSocket(base::unique_fd socket, uint64_t readerId);
 
     const base::unique_fd mSocket;
-    std::thread mReaderThread;
-    std::atomic<bool> mStopReaderThread = false;
-    std::atomic<bool> mReaderThreadFinished = false;
+    const uint64_t mReaderId;
 
     DISALLOW_COPY_AND_ASSIGN(CanSocket);
 };
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <libnetdevice/libnetdevice.h>
+#include <libnl++/MessageFactory.h>
+#include <libnl++/Socket.h>
+
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace android::netdevice {
+
+static constexpr char kSetupError[] =
+        "Can't set up dummy interfaces (requires root and dummy driver)";
+
+static std::vector<std::string> dummyNames(int64_t count) {
+    std::vector<std::string> ifnames;
+    for (int64_t i = 0; i < count; i++) ifnames.push_back("nlbench" + std::to_string(i));
+    return ifnames;
+}
+
+/**
+ * Sends one request per interface, pipelined over a single Netlink socket.
+ *
+ * \param ifnames Interfaces to send the requests for
+ * \param type Request type (such as RTM_NEWLINK)
+ * \param flags Request flags
+ * \param build Callback to fill the request for a given interface
+ * \return true if all requests succeeded, false otherwise
+ */
+static bool sendForEach(const std::vector<std::string>& ifnames, nl::nlmsgtype_t type,
+                        uint16_t flags,
+                        const std::function<void(nl::MessageFactory<ifinfomsg>&,
+                                                 const std::string&)>& build) {
+    // MessageFactory can't be moved, so it's kept in a node-based container.
+    std::list<nl::MessageFactory<ifinfomsg>> reqs;
+    std::vector<nl::Buffer<nlmsghdr>> msgs;
+    for (const auto& ifname : ifnames) {
+        auto& req = reqs.emplace_back(type, flags);
+        build(req, ifname);
+
+        const auto msg = req.build();
+        if (!msg.has_value()) return false;
+        msgs.push_back(*msg);
+    }
+
+    nl::Socket sock(NETLINK_ROUTE);
+    return sock.sendAndReceiveAcks(msgs);
+}
+
+static bool addPipelined(const std::vector<std::string>& ifnames) {
+    return sendForEach(ifnames, RTM_NEWLINK, nl::kCreateFlags, [](auto& req, const auto& ifname) {
+        req.add(IFLA_IFNAME, ifname);
+        auto linkinfo = req.addNested(IFLA_LINKINFO);
+        req.add(IFLA_INFO_KIND, std::string_view("dummy"));
+    });
+}
+
+static bool upPipelined(const std::vector<std::string>& ifnames) {
+    return sendForEach(ifnames, RTM_SETLINK, nl::kDefaultFlags, [](auto& req, const auto& ifname) {
+        // With no interface index, the Kernel looks the interface up by name.
+        req->ifi_flags = IFF_UP;
+        req->ifi_change = IFF_UP;
+        req.add(IFLA_IFNAME, ifname);
+    });
+}
+
+static bool delPipelined(const std::vector<std::string>& ifnames) {
+    return sendForEach(ifnames, RTM_DELLINK, nl::kDefaultFlags,
+                       [](auto& req, const auto& ifname) { req.add(IFLA_IFNAME, ifname); });
+}
+
+/** Adds, brings up and deletes dummy links one request at a time. */
+static void BM_ConfigureLinks_Sequential(benchmark::State& state) {
+    const auto ifnames = dummyNames(state.range(0));
+    for (auto _ : state) {
+        for (const auto& ifname : ifnames) {
+            if (!add(ifname, "dummy") || !up(ifname)) {
+                state.SkipWithError(kSetupError);
+                break;
+            }
+        }
+        for (const auto& ifname : ifnames) del(ifname);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ConfigureLinks_Sequential)->Arg(1)->Arg(16)->Arg(128);
+
+/** Adds, brings up and deletes dummy links with pipelined requests. */
+static void BM_ConfigureLinks_Pipelined(benchmark::State& state) {
+    const auto ifnames = dummyNames(state.range(0));
+    for (auto _ : state) {
+        const bool success = addPipelined(ifnames) && upPipelined(ifnames);
+        delPipelined(ifnames);
+        if (!success) {
+            state.SkipWithError(kSetupError);
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ConfigureLinks_Pipelined)->Arg(1)->Arg(16)->Arg(128);
+
+/** Walks a link dump in place. */
+static void BM_DumpLinks(benchmark::State& state) {
+    const auto ifnames = dummyNames(state.range(0));
+    if (!addPipelined(ifnames)) {
+        delPipelined(ifnames);
+        state.SkipWithError(kSetupError);
+        return;
+    }
+
+    nl::Socket sock(NETLINK_ROUTE);
+    size_t links = 0;
+    for (auto _ : state) {
+        nl::MessageFactory<ifinfomsg> req(RTM_GETLINK, NLM_F_REQUEST | NLM_F_DUMP);
+        if (!sock.send(req)) {
+            state.SkipWithError("Can't send dump request");
+            break;
+        }
+        auto dump = sock.receiveDump(req);
+        for (const auto rawMsg : dump) {
+            const auto msg = nl::Message<ifinfomsg>::parse(rawMsg, {RTM_NEWLINK});
+            if (msg.has_value()) links++;
+        }
+        if (!dump.ok()) {
+            state.SkipWithError("Dump failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(links);
+
+    delPipelined(ifnames);
+}
+BENCHMARK(BM_DumpLinks)->Arg(16)->Arg(128);
+
+}  // namespace android::netdevice
+
+BENCHMARK_MAIN();
@@ -20,6 +20,8 @@
 
 #include <android-base/logging.h>
 
+#include <algorithm>
+
 // Should be in sys/socket.h or linux/socket.h
 #define SOL_NETLINK 270
 
@@ -87,6 +89,88 @@ bool Socket::send(const Buffer<nlmsghdr>& msg, uint32_t destination) {
     return send(msg, sa);
 }
 
+std::optional<uint32_t> Socket::sendBatch(const std::vector<Buffer<nlmsghdr>>& msgs) {
+    sockaddr_nl sa = {};
+    sa.nl_family = AF_NETLINK;
+    sa.nl_pid = 0;  // Kernel
+    return sendBatch(msgs, sa);
+}
+
+std::optional<uint32_t> Socket::sendBatch(const std::vector<Buffer<nlmsghdr>>& msgs,
+                                          const sockaddr_nl& sa) {
+    if (mFailed) return std::nullopt;
+    if (msgs.empty() || msgs.size() > maxPipelinedRequests) {
+        LOG(ERROR) << "Can't send a batch of " << msgs.size() << " Netlink messages";
+        return std::nullopt;
+    }
+
+    static const uint8_t padding[NLMSG_ALIGNTO] = {};
+    const uint32_t firstSeq = mSeq + 1;
+
+    /* Message headers are copied to set sequence numbers, the rest is sent straight from the
+     * message buffers. Each message takes up to three I/O vectors: header, payload and padding
+     * (the Kernel expects messages to be aligned within a datagram). */
+    std::vector<nlmsghdr> headers(msgs.size());
+    std::vector<iovec> iovs;
+    iovs.reserve(msgs.size() * 3);
+    size_t totalLen = 0;
+    for (size_t i = 0; i < msgs.size(); i++) {
+        const auto rawMsg = msgs[i].getRaw();
+        if (rawMsg.len() < sizeof(nlmsghdr)) {
+            LOG(ERROR) << "Can't send Netlink message: buffer too small for a header";
+            return std::nullopt;
+        }
+
+        headers[i] = *rawMsg.ptr();
+        headers[i].nlmsg_seq = firstSeq + i;
+        iovs.push_back({&headers[i], sizeof(nlmsghdr)});
+
+        const auto payloadLen = rawMsg.len() - sizeof(nlmsghdr);
+        if (payloadLen > 0) {
+            iovs.push_back({const_cast<nlmsghdr*>(rawMsg.ptr()) + 1, payloadLen});
+        }
+
+        const auto paddingLen = NLMSG_ALIGN(rawMsg.len()) - rawMsg.len();
+        if (paddingLen > 0) iovs.push_back({const_cast<uint8_t*>(padding), paddingLen});
+        totalLen += NLMSG_ALIGN(rawMsg.len());
+
+        if constexpr (kSuperVerbose) {
+            LOG(VERBOSE) << "sending to " << sa.nl_pid << " (seq " << headers[i].nlmsg_seq
+                         << "): " << toString(msgs[i], mProtocol);
+        }
+    }
+
+    msghdr msg = {};
+    msg.msg_name = const_cast<sockaddr_nl*>(&sa);
+    msg.msg_namelen = sizeof(sa);
+    msg.msg_iov = iovs.data();
+    msg.msg_iovlen = iovs.size();
+
+    mSeq = firstSeq + msgs.size() - 1;
+    const auto bytesSent = sendmsg(mFd.get(), &msg, 0);
+    if (bytesSent < 0) {
+        PLOG(ERROR) << "Can't send Netlink messages";
+        return std::nullopt;
+    } else if (size_t(bytesSent) != totalLen) {
+        LOG(ERROR) << "Can't send Netlink messages: truncated batch";
+        return std::nullopt;
+    }
+    return firstSeq;
+}
+
+bool Socket::sendAndReceiveAcks(const std::vector<Buffer<nlmsghdr>>& msgs) {
+    bool success = true;
+    for (size_t first = 0; first < msgs.size(); first += maxPipelinedRequests) {
+        const auto last = std::min(first + maxPipelinedRequests, msgs.size());
+        const std::vector<Buffer<nlmsghdr>> batch(msgs.begin() + first, msgs.begin() + last);
+
+        const auto firstSeq = sendBatch(batch);
+        if (!firstSeq.has_value()) return false;
+        if (!receiveAcks(*firstSeq, batch.size())) success = false;
+    }
+    return success;
+}
+
 bool Socket::increaseReceiveBuffer(size_t maxSize) {
     if (maxSize == 0) {
         LOG(ERROR) << "Maximum receive size should not be zero";
@@ -150,6 +234,43 @@ bool Socket::receiveAck(uint32_t seq) {
     return false;
 }
 
+bool Socket::receiveAcks(uint32_t firstSeq, size_t count) {
+    if (mFailed) return false;
+
+    std::vector<bool> acked(count, false);
+    size_t remaining = count;
+    bool success = true;
+    while (remaining > 0) {
+        const auto buf = receive();
+        if (!buf.has_value()) return false;
+
+        for (const auto rawMsg : *buf) {
+            const auto nlerr = Message<nlmsgerr>::parse(rawMsg, {NLMSG_ERROR});
+            if (!nlerr.has_value()) {
+                LOG(WARNING) << "Received (and ignored) unexpected Netlink message of type "
+                             << rawMsg->nlmsg_type;
+                continue;
+            }
+
+            const auto seq = nlerr->data.msg.nlmsg_seq;
+            const size_t index = seq - firstSeq;  // wraps around for older messages
+            if (index >= count || acked[index]) {
+                LOG(WARNING) << "Received (and ignored) unexpected ACK for message " << seq;
+                continue;
+            }
+            acked[index] = true;
+            remaining--;
+
+            if (nlerr->data.error != 0) {
+                LOG(WARNING) << "Received Netlink error message for message " << seq << ": "
+                             << strerror(-nlerr->data.error);
+                success = false;
+            }
+        }
+    }
+    return success;
+}
+
 std::optional<Buffer<nlmsghdr>> Socket::receive(const std::set<nlmsgtype_t>& msgtypes,
                                                 size_t maxSize) {
     if (mFailed || !increaseReceiveBuffer(maxSize)) return std::nullopt;
@@ -247,4 +368,89 @@ Socket::receive_iterator Socket::end() {
     return {*this, true};
 }
 
+Socket::dump_view::dump_view(Socket& socket, uint32_t seq) : mSocket(socket), mSeq(seq) {}
+
+Socket::dump_view::iterator Socket::dump_view::begin() {
+    CHECK(!mCurrent.has_value()) << "Dump can only be iterated once";
+    if (mSocket.mFailed) {
+        mFinished = true;
+    } else {
+        mCurrent.emplace(mSocket, false);
+        settle();
+    }
+    return {this};
+}
+
+Socket::dump_view::iterator Socket::dump_view::end() {
+    return {nullptr};
+}
+
+bool Socket::dump_view::ok() const {
+    return mOk;
+}
+
+void Socket::dump_view::settle() {
+    const auto end = mSocket.end();
+    while (true) {
+        if (*mCurrent == end) {
+            // The error was already logged.
+            mFinished = true;
+            return;
+        }
+
+        const auto& rawMsg = **mCurrent;
+        if (rawMsg->nlmsg_seq != mSeq) {
+            LOG(WARNING) << "Received (and ignored) Netlink message for a different request ("
+                         << rawMsg->nlmsg_seq << ", expected " << mSeq << ")";
+            ++*mCurrent;
+            continue;
+        }
+
+        if (rawMsg->nlmsg_type == NLMSG_DONE) {
+            mFinished = true;
+            mOk = true;
+            return;
+        }
+        if (rawMsg->nlmsg_type == NLMSG_ERROR) {
+            const auto nlerr = Message<nlmsgerr>::parse(rawMsg);
+            if (nlerr.has_value()) {
+                LOG(WARNING) << "Received Netlink error message: "
+                             << strerror(-nlerr->data.error);
+            } else {
+                LOG(WARNING) << "Received malformed Netlink error message";
+            }
+            mFinished = true;
+            return;
+        }
+        return;
+    }
+}
+
+Socket::dump_view::iterator::iterator(dump_view* view) : mView(view) {}
+
+Socket::dump_view::iterator Socket::dump_view::iterator::operator++() {
+    CHECK(!isEnd()) << "Trying to increment end iterator";
+    ++*mView->mCurrent;
+    mView->settle();
+    return *this;
+}
+
+bool Socket::dump_view::iterator::operator==(const iterator& other) const {
+    if (isEnd() || other.isEnd()) return isEnd() == other.isEnd();
+    return mView == other.mView;
+}
+
+const Buffer<nlmsghdr>& Socket::dump_view::iterator::operator*() const {
+    CHECK(!isEnd()) << "Trying to dereference end iterator";
+    return **mView->mCurrent;
+}
+
+bool Socket::dump_view::iterator::isEnd() const {
+    return mView == nullptr || mView->mFinished;
+}
+
+Socket::dump_view Socket::receiveDump(uint32_t seq) {
+    return {*this, seq};
+}
+
 }  // namespace android::nl
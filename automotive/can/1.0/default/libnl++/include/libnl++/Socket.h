@@ -41,6 +41,14 @@ class Socket {
   public:
     static constexpr size_t defaultReceiveSize = 8192;
 
+    /**
+     * Maximum number of requests sent with a single system call.
+     *
+     * The Kernel processes the requests as soon as they're sent and queues their ACKs in the socket
+     * receive buffer - too many at once could overflow it.
+     */
+    static constexpr size_t maxPipelinedRequests = 64;
+
     /**
      * Socket constructor.
      *
@@ -109,6 +117,38 @@ class Socket {
      */
     bool send(const Buffer<nlmsghdr>& msg, uint32_t destination);
 
+    /**
+     * Send multiple Netlink messages to the Kernel with a single system call.
+     *
+     * The messages are sent with consecutive sequence numbers (without modifying the message
+     * buffers), so that their replies can be matched, i.e. with receiveAcks(uint32_t, size_t).
+     *
+     * \param msgs Messages to send, no more than maxPipelinedRequests.
+     * \return Sequence number of the first message, std::nullopt in case of failure.
+     */
+    std::optional<uint32_t> sendBatch(const std::vector<Buffer<nlmsghdr>>& msgs);
+
+    /**
+     * Send multiple Netlink messages with a single system call.
+     *
+     * \param msgs Messages to send, no more than maxPipelinedRequests.
+     * \param sa Destination address.
+     * \return Sequence number of the first message, std::nullopt in case of failure.
+     */
+    std::optional<uint32_t> sendBatch(const std::vector<Buffer<nlmsghdr>>& msgs,
+                                      const sockaddr_nl& sa);
+
+    /**
+     * Send multiple Netlink requests to the Kernel and wait for all of their ACKs.
+     *
+     * Instead of waiting for each ACK before sending the next request, requests are pipelined in
+     * batches of up to maxPipelinedRequests. A failing request doesn't stop the following ones.
+     *
+     * \param msgs Requests to send, with NLM_F_ACK flag set.
+     * \return true if all requests were ACKed without error, false otherwise.
+     */
+    bool sendAndReceiveAcks(const std::vector<Buffer<nlmsghdr>>& msgs);
+
     /**
      * Receive one or multiple Netlink messages.
      *
@@ -182,6 +222,18 @@ class Socket {
      */
     bool receiveAck(uint32_t seq);
 
+    /**
+     * Receive Netlink ACK messages for pipelined requests.
+     *
+     * ACKs may arrive in any order and batching. All of them are received, even if some report
+     * an error, so that they don't get mixed up with replies to later requests.
+     *
+     * \param firstSeq Sequence number of the first request, as returned by sendBatch().
+     * \param count Number of requests with consecutive sequence numbers.
+     * \return true if all requests were ACKed without error, false otherwise.
+     */
+    bool receiveAcks(uint32_t firstSeq, size_t count);
+
     /**
      * Fetches the socket PID.
      *
@@ -249,6 +301,87 @@ class Socket {
     receive_iterator begin();
     receive_iterator end();
 
+    /**
+     * Multipart reply, such as a response to NLM_F_DUMP request.
+     *
+     * Messages are not copied: each of them is a view of the socket receive buffer, valid until the
+     * iterator is incremented. Messages with other sequence numbers are skipped. Iteration ends at
+     * NLMSG_DONE, at NLMSG_ERROR reply, or when socket fails to receive a buffer - use ok() to
+     * tell these cases apart.
+     *
+     * Example:
+     * ```
+     *     nl::MessageFactory<ifinfomsg> req(RTM_GETLINK, NLM_F_REQUEST | NLM_F_DUMP);
+     *     if (!sock.send(req)) return false;
+     *     auto dump = sock.receiveDump(req);
+     *     for (const auto rawMsg : dump) {
+     *         const auto msg = nl::Message<ifinfomsg>::parse(rawMsg, {RTM_NEWLINK});
+     *         if (!msg.has_value()) continue;
+     *
+     *         LOG(INFO) << msg->attributes.get<std::string>(IFLA_IFNAME);
+     *     }
+     *     return dump.ok();
+     * ```
+     */
+    class dump_view {
+      public:
+        class iterator {
+          public:
+            iterator operator++();
+            bool operator==(const iterator& other) const;
+            const Buffer<nlmsghdr>& operator*() const;
+
+          private:
+            dump_view* mView;
+
+            iterator(dump_view* view);
+            bool isEnd() const;
+
+            friend class dump_view;
+        };
+        iterator begin();
+        iterator end();
+
+        /**
+         * Whether the whole reply was received.
+         *
+         * \return true if iteration ended at NLMSG_DONE, false otherwise.
+         */
+        bool ok() const;
+
+      private:
+        dump_view(Socket& socket, uint32_t seq);
+
+        Socket& mSocket;
+        const uint32_t mSeq;
+        std::optional<receive_iterator> mCurrent;
+        bool mFinished = false;
+        bool mOk = false;
+
+        void settle();
+
+        friend class Socket;
+    };
+
+    /**
+     * Receive multipart reply to a request.
+     *
+     * \param seq Sequence number of the request.
+     * \return Lazily received reply, see dump_view.
+     */
+    dump_view receiveDump(uint32_t seq);
+
+    /**
+     * Receive multipart reply to a request.
+     *
+     * \param req Message to match sequence number against.
+     * \return Lazily received reply, see dump_view.
+     */
+    template <typename T, unsigned BUFSIZE>
+    dump_view receiveDump(MessageFactory<T, BUFSIZE>& req) {
+        return receiveDump(req.header.nlmsg_seq);
+    }
+
   private:
     const int mProtocol;
     base::unique_fd mFd;
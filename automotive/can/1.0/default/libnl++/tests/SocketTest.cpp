@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libnl++/Socket.h>
+
+#include <gtest/gtest.h>
+#include <linux/rtnetlink.h>
+
+#include <cstring>
+#include <vector>
+
+namespace android::nl {
+
+/** Netlink messages packed into a single datagram, as the Kernel sends them. */
+class Datagram {
+  public:
+    Datagram& add(nlmsgtype_t type, uint32_t seq, const void* payload = nullptr,
+                  size_t payloadLen = 0) {
+        const auto offset = mData.size();
+        mData.resize(offset + NLMSG_SPACE(payloadLen));
+        nlmsghdr hdr = {};
+        hdr.nlmsg_len = NLMSG_LENGTH(payloadLen);
+        hdr.nlmsg_type = type;
+        hdr.nlmsg_seq = seq;
+        memcpy(mData.data() + offset, &hdr, sizeof(hdr));
+        if (payloadLen > 0) memcpy(mData.data() + offset + NLMSG_HDRLEN, payload, payloadLen);
+        return *this;
+    }
+
+    Datagram& addAck(uint32_t seq, int error = 0) {
+        nlmsgerr nlerr = {};
+        nlerr.error = error;
+        nlerr.msg.nlmsg_seq = seq;
+        return add(NLMSG_ERROR, seq, &nlerr, sizeof(nlerr));
+    }
+
+    Buffer<nlmsghdr> buffer() const {
+        return {reinterpret_cast<const nlmsghdr*>(mData.data()), mData.size()};
+    }
+
+    /** Each message as a separate buffer, for use with Socket::sendBatch(). */
+    std::vector<Buffer<nlmsghdr>> messages() const {
+        std::vector<Buffer<nlmsghdr>> msgs;
+        for (const auto msg : buffer()) msgs.emplace_back(msg.getRaw().ptr(), msg->nlmsg_len);
+        return msgs;
+    }
+
+  private:
+    std::vector<uint8_t> mData;
+};
+
+/**
+ * Unprivileged processes can send unicast messages over NETLINK_USERSOCK, so the peer socket plays
+ * the part of the Kernel.
+ */
+class SocketTest : public ::testing::Test {
+  protected:
+    Socket mSocket{NETLINK_USERSOCK};
+    Socket mPeer{NETLINK_USERSOCK};
+    sockaddr_nl mPeerAddr = {};
+
+    void SetUp() override {
+        const auto socketPid = mSocket.getPid();
+        const auto peerPid = mPeer.getPid();
+        ASSERT_TRUE(socketPid.has_value() && peerPid.has_value()) << "Can't open Netlink sockets";
+        mPeerAddr.nl_family = AF_NETLINK;
+        mPeerAddr.nl_pid = *peerPid;
+    }
+
+    /** Sends a batch of requests to the peer and drains them on the peer's side. */
+    uint32_t sendRequests(size_t count) {
+        Datagram reqs;
+        for (size_t i = 0; i < count; i++) reqs.add(RTM_NEWLINK, 0);
+        const auto firstSeq = mSocket.sendBatch(reqs.messages(), mPeerAddr);
+        EXPECT_TRUE(firstSeq.has_value());
+        EXPECT_TRUE(mPeer.receive().has_value());
+        return firstSeq.value_or(0);
+    }
+
+    void sendFromPeer(const Datagram& datagram) {
+        ASSERT_TRUE(mPeer.send(datagram.buffer(), *mSocket.getPid()));
+    }
+};
+
+TEST_F(SocketTest, SendBatchSetsConsecutiveSequenceNumbers) {
+    // The payload of the first message isn't aligned, so it has to be padded.
+    const uint8_t payload[] = {1, 2, 3, 4, 5};
+    Datagram reqs;
+    reqs.add(RTM_NEWLINK, 0, payload, sizeof(payload)).add(RTM_DELLINK, 0).add(RTM_SETLINK, 0);
+
+    const auto firstSeq = mSocket.sendBatch(reqs.messages(), mPeerAddr);
+    ASSERT_TRUE(firstSeq.has_value());
+
+    const auto received = mPeer.receive();
+    ASSERT_TRUE(received.has_value());
+    std::vector<Buffer<nlmsghdr>> msgs;
+    for (const auto msg : *received) msgs.push_back(msg);
+    ASSERT_EQ(3u, msgs.size());
+    EXPECT_EQ(RTM_NEWLINK, msgs[0]->nlmsg_type);
+    EXPECT_EQ(NLMSG_LENGTH(sizeof(payload)), msgs[0]->nlmsg_len);
+    EXPECT_EQ(0, memcmp(NLMSG_DATA(msgs[0].getRaw().ptr()), payload, sizeof(payload)));
+    EXPECT_EQ(RTM_DELLINK, msgs[1]->nlmsg_type);
+    EXPECT_EQ(RTM_SETLINK, msgs[2]->nlmsg_type);
+    for (size_t i = 0; i < msgs.size(); i++) {
+        EXPECT_EQ(*firstSeq + i, msgs[i]->nlmsg_seq);
+    }
+
+    // The following batch continues the sequence.
+    EXPECT_EQ(*firstSeq + 3, sendRequests(1));
+}
+
+TEST_F(SocketTest, ReceiveAcksOutOfOrder) {
+    const auto firstSeq = sendRequests(3);
+
+    sendFromPeer(Datagram().addAck(firstSeq + 2).addAck(firstSeq));
+    sendFromPeer(Datagram().addAck(firstSeq + 1));
+
+    EXPECT_TRUE(mSocket.receiveAcks(firstSeq, 3));
+}
+
+TEST_F(SocketTest, ReceiveAcksDrainsAllAfterError) {
+    const auto firstSeq = sendRequests(3);
+
+    sendFromPeer(Datagram().addAck(firstSeq + 1, -EEXIST));
+    // Duplicated and unknown ACKs are ignored.
+    sendFromPeer(Datagram()
+                         .addAck(firstSeq + 1)
+                         .addAck(firstSeq + 2)
+                         .addAck(firstSeq - 1)
+                         .addAck(firstSeq + 3)
+                         .addAck(firstSeq));
+
+    EXPECT_FALSE(mSocket.receiveAcks(firstSeq, 3));
+
+    // All ACKs of the failed batch were received, so the next ACK is the one of the next request.
+    const auto nextSeq = sendRequests(1);
+    sendFromPeer(Datagram().addAck(nextSeq));
+    EXPECT_TRUE(mSocket.receiveAck(nextSeq));
+}
+
+TEST_F(SocketTest, DumpEndsAtDone) {
+    const uint32_t seq = 42;
+    const int done = 0;
+    sendFromPeer(Datagram().add(RTM_NEWLINK, seq).add(RTM_NEWLINK, seq + 1).add(RTM_NEWLINK, seq));
+    sendFromPeer(Datagram().add(RTM_NEWLINK, seq).add(NLMSG_DONE, seq, &done, sizeof(done)));
+
+    auto dump = mSocket.receiveDump(seq);
+    size_t count = 0;
+    for (const auto msg : dump) {
+        EXPECT_EQ(RTM_NEWLINK, msg->nlmsg_type);
+        EXPECT_EQ(seq, msg->nlmsg_seq) << "messages for other requests must be skipped";
+        count++;
+    }
+
+    EXPECT_EQ(3u, count);
+    EXPECT_TRUE(dump.ok());
+}
+
+TEST_F(SocketTest, DumpEndsAtError) {
+    const uint32_t seq = 42;
+    sendFromPeer(Datagram().add(RTM_NEWLINK, seq));
+    sendFromPeer(Datagram().addAck(seq, -EBUSY));
+
+    auto dump = mSocket.receiveDump(seq);
+    size_t count = 0;
+    for (const auto msg : dump) {
+        EXPECT_EQ(RTM_NEWLINK, msg->nlmsg_type);
+        count++;
+    }
+
+    EXPECT_EQ(1u, count);
+    EXPECT_FALSE(dump.ok());
+}
+
+}  // namespace android::nl
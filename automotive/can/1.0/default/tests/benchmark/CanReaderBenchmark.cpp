@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CanReader.h>
+
+#include <android-base/logging.h>
+#include <benchmark/benchmark.h>
+#include <libnetdevice/can.h>
+#include <libnetdevice/libnetdevice.h>
+#include <sys/select.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android::hardware::automotive::can::V1_0::implementation {
+
+using namespace std::chrono_literals;
+
+/* Frames sent to each bus before waiting for all of them to be received. Small enough for the
+ * default socket receive buffer, so that no frame is dropped. */
+static constexpr int kFramesPerBusPerRound = 32;
+
+/** Counts the received frames and lets the sending thread wait for them. */
+class FrameCounter {
+  public:
+    void add(size_t count) {
+        std::lock_guard<std::mutex> lck(mGuard);
+        mCount += count;
+        mCondition.notify_all();
+    }
+
+    bool waitFor(size_t count) {
+        std::unique_lock<std::mutex> lck(mGuard);
+        return mCondition.wait_for(lck, 1s, [&] { return mCount >= count; });
+    }
+
+  private:
+    std::mutex mGuard;
+    std::condition_variable mCondition;
+    size_t mCount = 0;
+};
+
+/** A set of vcan interfaces, each with a socket to read from and a socket to write to. */
+class VirtualBuses {
+  public:
+    explicit VirtualBuses(int count) {
+        for (int i = 0; i < count; i++) {
+            const auto ifname = "vcanbench" + std::to_string(i);
+            if (!netdevice::exists(ifname)) {
+                if (!netdevice::add(ifname, "vcan")) return;
+                mCreated.push_back(ifname);
+            }
+            if (!netdevice::up(ifname)) return;
+            mReadSockets.push_back(netdevice::can::socket(ifname));
+            mWriteSockets.push_back(netdevice::can::socket(ifname));
+            if (!mReadSockets.back().ok() || !mWriteSockets.back().ok()) return;
+        }
+        mOk = true;
+    }
+
+    ~VirtualBuses() {
+        mReadSockets.clear();
+        mWriteSockets.clear();
+        for (const auto& ifname : mCreated) netdevice::del(ifname);
+    }
+
+    bool ok() const { return mOk; }
+
+    const std::vector<base::unique_fd>& readSockets() const { return mReadSockets; }
+
+    /** Sends one round of frames, interleaved between the buses. */
+    bool sendRound() {
+        struct canfd_frame frame = {};
+        frame.len = 8;
+        for (int i = 0; i < kFramesPerBusPerRound; i++) {
+            frame.can_id = i;
+            for (const auto& socket : mWriteSockets) {
+                if (write(socket.get(), &frame, CAN_MTU) != CAN_MTU) return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    bool mOk = false;
+    std::vector<std::string> mCreated;
+    std::vector<base::unique_fd> mReadSockets;
+    std::vector<base::unique_fd> mWriteSockets;
+};
+
+static void runRounds(benchmark::State& state, VirtualBuses& buses, FrameCounter& counter) {
+    const size_t framesPerRound = kFramesPerBusPerRound * buses.readSockets().size();
+    size_t expected = 0;
+    for (auto _ : state) {
+        if (!buses.sendRound()) {
+            state.SkipWithError("Failed to send CAN frames");
+            break;
+        }
+        expected += framesPerRound;
+        if (!counter.waitFor(expected)) {
+            state.SkipWithError("CAN frames were lost");
+            break;
+        }
+    }
+    state.SetItemsProcessed(expected);
+}
+
+/** Shared reader: one thread, one recvmmsg(2) per batch. */
+static void BM_SharedReader(benchmark::State& state) {
+    VirtualBuses buses(state.range(0));
+    if (!buses.ok()) {
+        state.SkipWithError("Can't set up vcan interfaces (requires root)");
+        return;
+    }
+
+    FrameCounter counter;
+    CanReader reader;
+    std::vector<uint64_t> ids;
+    for (const auto& socket : buses.readSockets()) {
+        const auto id = reader.add(
+                socket,
+                [&counter](std::span<const struct canfd_frame> frames, std::chrono::nanoseconds) {
+                    counter.add(frames.size());
+                },
+                [](int) {});
+        if (!id.has_value()) {
+            state.SkipWithError("Can't read from CAN socket");
+            break;
+        }
+        ids.push_back(*id);
+    }
+    if (ids.size() == buses.readSockets().size()) runRounds(state, buses, counter);
+
+    for (const auto id : ids) reader.remove(id);
+}
+BENCHMARK(BM_SharedReader)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+/** The reader used before CanReader, for comparison: a thread per bus, select(2) and read(2). */
+static void BM_ThreadPerBusReader(benchmark::State& state) {
+    VirtualBuses buses(state.range(0));
+    if (!buses.ok()) {
+        state.SkipWithError("Can't set up vcan interfaces (requires root)");
+        return;
+    }
+
+    FrameCounter counter;
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> threads;
+    for (const auto& socket : buses.readSockets()) {
+        threads.emplace_back([&counter, &stop, fd = socket.get()] {
+            while (!stop) {
+                struct timeval timeout = {.tv_sec = 0, .tv_usec = 100000};
+                fd_set readfds;
+                FD_ZERO(&readfds);
+                FD_SET(fd, &readfds);
+                if (select(fd + 1, &readfds, nullptr, nullptr, &timeout) <= 0) continue;
+
+                struct canfd_frame frame;
+                if (read(fd, &frame, CAN_MTU) == CAN_MTU) counter.add(1);
+            }
+        });
+    }
+    runRounds(state, buses, counter);
+
+    stop = true;
+    for (auto& thread : threads) thread.join();
+}
+BENCHMARK(BM_ThreadPerBusReader)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+}  // namespace android::hardware::automotive::can::V1_0::implementation
+
+BENCHMARK_MAIN();
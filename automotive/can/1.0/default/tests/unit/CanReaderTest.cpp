@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CanReader.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <vector>
+
+namespace android::hardware::automotive::can::V1_0::implementation {
+
+using namespace std::chrono_literals;
+
+static constexpr auto kTimeout = 5s;
+
+/**
+ * A pair of datagram sockets standing in for a CAN socket.
+ *
+ * The reader only relies on one frame being read per datagram, so there is no need for a vcan
+ * interface (and root privileges) to test it.
+ */
+class FakeCanSocket {
+  public:
+    FakeCanSocket() {
+        int fds[2];
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, fds), 0);
+        mReadEnd.reset(fds[0]);
+        mWriteEnd.reset(fds[1]);
+    }
+
+    const base::unique_fd& get() const { return mReadEnd; }
+
+    void send(canid_t id, size_t size = CAN_MTU) {
+        struct canfd_frame frame = {};
+        frame.can_id = id;
+        ASSERT_EQ(write(mWriteEnd.get(), &frame, size), static_cast<ssize_t>(size));
+    }
+
+  private:
+    base::unique_fd mReadEnd;
+    base::unique_fd mWriteEnd;
+};
+
+/** Collects the frames and errors reported by CanReader. */
+class Recorder {
+  public:
+    CanReader::ReadCallback readCallback() {
+        return [this](std::span<const struct canfd_frame> frames, std::chrono::nanoseconds) {
+            std::lock_guard<std::mutex> lck(mGuard);
+            for (const auto& frame : frames) mFrameIds.push_back(frame.can_id);
+            mCondition.notify_all();
+        };
+    }
+
+    CanReader::ErrorCallback errorCallback() {
+        return [this](int errnoVal) {
+            std::lock_guard<std::mutex> lck(mGuard);
+            mErrors.push_back(errnoVal);
+            mCondition.notify_all();
+        };
+    }
+
+    bool waitForFrames(size_t count) {
+        std::unique_lock<std::mutex> lck(mGuard);
+        return mCondition.wait_for(lck, kTimeout, [&] { return mFrameIds.size() >= count; });
+    }
+
+    bool waitForErrors(size_t count) {
+        std::unique_lock<std::mutex> lck(mGuard);
+        return mCondition.wait_for(lck, kTimeout, [&] { return mErrors.size() >= count; });
+    }
+
+    std::vector<canid_t> frameIds() {
+        std::lock_guard<std::mutex> lck(mGuard);
+        return mFrameIds;
+    }
+
+    std::vector<int> errors() {
+        std::lock_guard<std::mutex> lck(mGuard);
+        return mErrors;
+    }
+
+  private:
+    std::mutex mGuard;
+    std::condition_variable mCondition;
+    std::vector<canid_t> mFrameIds;
+    std::vector<int> mErrors;
+};
+
+TEST(CanReaderTest, ReadsFramesInOrder) {
+    CanReader reader;
+    FakeCanSocket socket;
+    Recorder recorder;
+
+    const auto id = reader.add(socket.get(), recorder.readCallback(), recorder.errorCallback());
+    ASSERT_TRUE(id.has_value());
+
+    // More than a single batch.
+    const size_t count = CanReader::kMaxBatchSize * 3 + 1;
+    std::vector<canid_t> expected;
+    for (canid_t i = 0; i < count; i++) {
+        socket.send(i);
+        expected.push_back(i);
+    }
+
+    ASSERT_TRUE(recorder.waitForFrames(count));
+    EXPECT_EQ(recorder.frameIds(), expected);
+    EXPECT_TRUE(recorder.errors().empty());
+
+    reader.remove(*id);
+}
+
+TEST(CanReaderTest, ReadsMultipleSockets) {
+    CanReader reader;
+    FakeCanSocket socket1, socket2;
+    Recorder recorder1, recorder2;
+
+    const auto id1 = reader.add(socket1.get(), recorder1.readCallback(), recorder1.errorCallback());
+    const auto id2 = reader.add(socket2.get(), recorder2.readCallback(), recorder2.errorCallback());
+    ASSERT_TRUE(id1.has_value());
+    ASSERT_TRUE(id2.has_value());
+    EXPECT_NE(*id1, *id2);
+
+    socket1.send(1);
+    socket2.send(2);
+
+    ASSERT_TRUE(recorder1.waitForFrames(1));
+    ASSERT_TRUE(recorder2.waitForFrames(1));
+    EXPECT_EQ(recorder1.frameIds(), std::vector<canid_t>{1});
+    EXPECT_EQ(recorder2.frameIds(), std::vector<canid_t>{2});
+
+    reader.remove(*id1);
+    reader.remove(*id2);
+}
+
+TEST(CanReaderTest, StopsReadingAfterRemove) {
+    CanReader reader;
+    FakeCanSocket removed, kept;
+    Recorder removedRecorder, keptRecorder;
+
+    const auto removedId = reader.add(removed.get(), removedRecorder.readCallback(),
+                                      removedRecorder.errorCallback());
+    const auto keptId =
+            reader.add(kept.get(), keptRecorder.readCallback(), keptRecorder.errorCallback());
+    ASSERT_TRUE(removedId.has_value());
+    ASSERT_TRUE(keptId.has_value());
+
+    removed.send(1);
+    ASSERT_TRUE(removedRecorder.waitForFrames(1));
+    reader.remove(*removedId);
+
+    // Let the reader thread go through another read before checking the removed socket is left
+    // alone.
+    removed.send(2);
+    kept.send(3);
+    ASSERT_TRUE(keptRecorder.waitForFrames(1));
+    EXPECT_EQ(removedRecorder.frameIds(), std::vector<canid_t>{1});
+
+    // Removing twice is harmless.
+    reader.remove(*removedId);
+    reader.remove(*keptId);
+}
+
+TEST(CanReaderTest, RemoveFromReadCallback) {
+    CanReader reader;
+    FakeCanSocket socket;
+    Recorder recorder;
+
+    std::optional<uint64_t> id;
+    auto rdcb = recorder.readCallback();
+    id = reader.add(
+            socket.get(),
+            [&](std::span<const struct canfd_frame> frames, std::chrono::nanoseconds timestamp) {
+                // Must not wait for itself to finish.
+                reader.remove(*id);
+                rdcb(frames, timestamp);
+            },
+            recorder.errorCallback());
+    ASSERT_TRUE(id.has_value());
+
+    socket.send(1);
+    ASSERT_TRUE(recorder.waitForFrames(1));
+
+    // The socket is not read anymore - as in StopsReadingAfterRemove, use another socket to know
+    // when the reader thread went through another read.
+    FakeCanSocket other;
+    Recorder otherRecorder;
+    const auto otherId =
+            reader.add(other.get(), otherRecorder.readCallback(), otherRecorder.errorCallback());
+    ASSERT_TRUE(otherId.has_value());
+    socket.send(2);
+    other.send(3);
+    ASSERT_TRUE(otherRecorder.waitForFrames(1));
+    EXPECT_EQ(recorder.frameIds(), std::vector<canid_t>{1});
+
+    reader.remove(*otherId);
+}
+
+TEST(CanReaderTest, ErrorOnWrongFrameSize) {
+    CanReader reader;
+    FakeCanSocket socket;
+    Recorder recorder;
+
+    const auto id = reader.add(socket.get(), recorder.readCallback(), recorder.errorCallback());
+    ASSERT_TRUE(id.has_value());
+
+    socket.send(1);
+    socket.send(2, CAN_MTU / 2);
+    socket.send(3);
+
+    // The frames read before the malformed one are still delivered, then the socket is dropped.
+    ASSERT_TRUE(recorder.waitForErrors(1));
+    EXPECT_EQ(recorder.frameIds(), std::vector<canid_t>{1});
+    EXPECT_EQ(recorder.errors(), std::vector<int>{0});
+
+    // Removing a socket that failed is harmless.
+    reader.remove(*id);
+}
+
+TEST(CanReaderTest, RemoveFromErrorCallback) {
+    CanReader reader;
+    FakeCanSocket socket;
+    Recorder recorder;
+
+    std::optional<uint64_t> id;
+    auto errcb = recorder.errorCallback();
+    id = reader.add(socket.get(), recorder.readCallback(), [&](int errnoVal) {
+        // Buses bring their interface down on errors, which removes the socket.
+        reader.remove(*id);
+        errcb(errnoVal);
+    });
+    ASSERT_TRUE(id.has_value());
+
+    socket.send(1, 1);
+    ASSERT_TRUE(recorder.waitForErrors(1));
+    EXPECT_TRUE(recorder.frameIds().empty());
+}
+
+TEST(CanReaderTest, AddWhileReaderIsWaiting) {
+    CanReader reader;
+
+    // Give the reader thread time to block waiting for the (so far empty) set of sockets.
+    std::this_thread::sleep_for(100ms);
+
+    FakeCanSocket socket;
+    Recorder recorder;
+    const auto id = reader.add(socket.get(), recorder.readCallback(), recorder.errorCallback());
+    ASSERT_TRUE(id.has_value());
+
+    socket.send(1);
+    ASSERT_TRUE(recorder.waitForFrames(1));
+
+    reader.remove(*id);
+}
+
+TEST(CanReaderTest, DestroyWakesUpReader) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        CanReader reader;
+        std::this_thread::sleep_for(100ms);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, kTimeout);
+}
+
+}  // namespace android::hardware::automotive::can::V1_0::implementation
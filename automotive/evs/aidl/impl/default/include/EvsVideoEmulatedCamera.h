@@ -26,11 +26,17 @@
 #include <aidl/android/hardware/automotive/evs/IEvsDisplay.h>
 #include <aidl/android/hardware/automotive/evs/ParameterRange.h>
 #include <aidl/android/hardware/automotive/evs/Stream.h>
+#include <android-base/thread_annotations.h>
 #include <media/NdkMediaExtractor.h>
 #include <ui/GraphicBuffer.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -73,6 +79,9 @@ class EvsVideoEmulatedCamera : public EvsCamera {
 
     const evs::CameraDesc& getDesc() { return mDescription; }
 
+    // Dumps the frame pipeline latency statistics.
+    binder_status_t dump(int fd, const char** args, uint32_t numArgs) override;
+
     static std::shared_ptr<EvsVideoEmulatedCamera> Create(const char* deviceName);
     static std::shared_ptr<EvsVideoEmulatedCamera> Create(
             const char* deviceName, std::unique_ptr<ConfigManager::CameraInfo>& camInfo,
@@ -92,20 +101,71 @@ class EvsVideoEmulatedCamera : public EvsCamera {
         int32_t value;
     };
 
+    using Clock = std::chrono::steady_clock;
+
+    // Frames flow through a pipeline of three stages: the decoder thread feeds the codec and
+    // collects the decoded frames, a pool of conversion threads converts them into the graphics
+    // buffers, and the delivery thread delivers them to the client in the decoding order, paced
+    // at the configured frame rate.
+
+    // The number of threads converting the decoded frames.
+    static constexpr std::size_t kNumConversionThreads = 2;
+
+    // The max number of decoded frames in the pipeline, not yet delivered nor dropped. This
+    // bounds the number of codec output buffers held by the pipeline.
+    static constexpr std::size_t kMaxFramesInPipeline = 4;
+
+    // A decoded frame moving through the pipeline.
+    struct PipelineFrame {
+        // The decoding order, which is also the delivery order.
+        uint64_t sequence = 0;
+        // The codec output buffer holding the decoded frame until it is converted.
+        int32_t codecBufferIndex = -1;
+        AMediaCodecBufferInfo info = {};
+        Clock::time_point decodedTime;
+        Clock::time_point convertedTime;
+        // The graphics buffer holding the converted frame. Null if the frame is dropped.
+        std::size_t bufferId = kInvalidBufferID;
+        buffer_handle_t bufferHandle = nullptr;
+    };
+
+    // The latencies of one pipeline stage.
+    struct StageStats {
+        uint64_t count = 0;
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+
+        void add(std::chrono::nanoseconds latency);
+    };
+
     bool initialize();
 
     bool initializeMediaCodec();
 
-    void generateFrames();
+    void initializeParameters();
 
-    void renderOneFrame();
+    // Pipeline stages, each running on its own threads.
+    void decodeFrames();
+    void convertFrames();
+    void deliverFrames();
 
-    void initializeParameters();
+    void queueCodecInputs();
 
     void onCodecInputAvailable(const int32_t index);
 
     void onCodecOutputAvailable(const int32_t index, const AMediaCodecBufferInfo& info);
 
+    // Converts the frame into a graphics buffer and returns the codec output buffer.
+    void convertFrame(PipelineFrame& frame);
+
+    void deliverFrame(const PipelineFrame& frame);
+
+    // Waits until the pipeline stops or the time is reached. Returns false if the pipeline stops.
+    bool waitUntil(Clock::time_point time);
+
+    // Returns the frames left in the pipeline once its threads are stopped.
+    void drainPipeline_unsafe();
+
     ::android::status_t allocateOneFrame(buffer_handle_t* handle) override;
 
     bool startVideoStreamImpl_locked(const std::shared_ptr<evs::IEvsCameraStream>& receiver,
@@ -125,13 +185,45 @@ class EvsVideoEmulatedCamera : public EvsCamera {
     // The properties of this camera.
     CameraDesc mDescription = {};
 
-    std::thread mCaptureThread;
+    std::thread mDecoderThread;
+    std::vector<std::thread> mConversionThreads;
+    std::thread mDeliveryThread;
+
+    std::mutex mPipelineMutex;
+    std::condition_variable mPipelineCondition;
+    bool mPipelineRunning GUARDED_BY(mPipelineMutex) = false;
+    // The decoded frames waiting for a conversion thread, in the decoding order.
+    std::deque<PipelineFrame> mDecodedFrames GUARDED_BY(mPipelineMutex);
+    // The converted frames waiting for the delivery thread, indexed by the sequence number.
+    std::map<uint64_t, PipelineFrame> mConvertedFrames GUARDED_BY(mPipelineMutex);
+    std::size_t mFramesInPipeline GUARDED_BY(mPipelineMutex) = 0;
+    std::size_t mCodecBuffersInPipeline GUARDED_BY(mPipelineMutex) = 0;
+
+    // Owned by the decoder thread.
+    uint64_t mNextSequence = 0;
+    // The time each sample was queued to the codec, indexed by the presentation time.
+    std::unordered_map<int64_t, Clock::time_point> mCodecInputTimes;
+
+    // The interval between two delivered frames. If zero, frames are paced by their presentation
+    // time.
+    std::chrono::nanoseconds mFrameInterval{0};
+
+    std::mutex mStatsMutex;
+    Clock::time_point mStreamStartTime GUARDED_BY(mStatsMutex);
+    // From queueing the sample to the codec to getting the decoded frame.
+    StageStats mDecodeStats GUARDED_BY(mStatsMutex);
+    // From getting the decoded frame to having it converted in a graphics buffer.
+    StageStats mConvertStats GUARDED_BY(mStatsMutex);
+    // From having the frame converted to the delivery, including the pacing.
+    StageStats mDeliverStats GUARDED_BY(mStatsMutex);
+    uint64_t mFramesDelivered GUARDED_BY(mStatsMutex) = 0;
+    uint64_t mFramesDropped GUARDED_BY(mStatsMutex) = 0;
 
     // The callback used to deliver each frame
     std::shared_ptr<evs::IEvsCameraStream> mStream;
 
     std::string mVideoFileName;
-    // Media decoder resources - Owned by mDecoderThead when thread is running.
+    // Media decoder resources - Owned by mDecoderThread when thread is running.
     int mVideoFd = 0;
 
     struct AMediaExtractorDeleter {
@@ -27,10 +27,13 @@
 
 #include <fcntl.h>
 #include <libyuv.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 #include <tuple>
@@ -43,6 +46,8 @@ namespace aidl::android::hardware::automotive::evs::implementation {
 
 namespace {
 
+using ::android::base::ScopedLockAssertion;
+
 struct FormatDeleter {
     void operator()(AMediaFormat* format) const { AMediaFormat_delete(format); }
 };
@@ -198,15 +203,82 @@ bool EvsVideoEmulatedCamera::initializeMediaCodec() {
     return true;
 }
 
-void EvsVideoEmulatedCamera::generateFrames() {
+void EvsVideoEmulatedCamera::StageStats::add(std::chrono::nanoseconds latency) {
+    ++count;
+    total += latency;
+    max = std::max(max, latency);
+}
+
+void EvsVideoEmulatedCamera::decodeFrames() {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using namespace std::chrono_literals;
+
     while (true) {
         {
-            std::lock_guard lock(mMutex);
-            if (mStreamState != StreamState::RUNNING) {
+            // Wait for the pipeline to have room for another frame.
+            std::unique_lock lock(mPipelineMutex);
+            ScopedLockAssertion lockAssertion(mPipelineMutex);
+            mPipelineCondition.wait(lock, [this]() REQUIRES(mPipelineMutex) {
+                return !mPipelineRunning || mFramesInPipeline < kMaxFramesInPipeline;
+            });
+            if (!mPipelineRunning) {
                 return;
             }
         }
-        renderOneFrame();
+
+        queueCodecInputs();
+
+        AMediaCodecBufferInfo info;
+        const int codecOutputBufferIdx = AMediaCodec_dequeueOutputBuffer(
+                mVideoCodec.get(), &info,
+                /* timeoutUs = */ duration_cast<microseconds>(1ms).count());
+        if (codecOutputBufferIdx < 0) {
+            if (codecOutputBufferIdx != AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+                LOG(ERROR) << __func__
+                           << ": Received error in AMediaCodec_dequeueOutputBuffer. Error code: "
+                           << codecOutputBufferIdx;
+            }
+            continue;
+        }
+        onCodecOutputAvailable(codecOutputBufferIdx, info);
+
+        if ((info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0) {
+            // Flushing the codec invalidates its output buffers, so wait for the conversion
+            // threads to be done with them.
+            {
+                std::unique_lock lock(mPipelineMutex);
+                ScopedLockAssertion lockAssertion(mPipelineMutex);
+                mPipelineCondition.wait(lock, [this]() REQUIRES(mPipelineMutex) {
+                    return !mPipelineRunning || mCodecBuffersInPipeline == 0;
+                });
+                if (!mPipelineRunning) {
+                    return;
+                }
+            }
+            LOG(INFO) << "Start video playback from the beginning.";
+            AMediaExtractor_seekTo(mVideoExtractor.get(), /* seekPosUs= */ 0,
+                                   AMEDIAEXTRACTOR_SEEK_CLOSEST_SYNC);
+            AMediaCodec_flush(mVideoCodec.get());
+            mCodecInputTimes.clear();
+        }
+    }
+}
+
+void EvsVideoEmulatedCamera::queueCodecInputs() {
+    while (true) {
+        int codecInputBufferIdx =
+                AMediaCodec_dequeueInputBuffer(mVideoCodec.get(), /* timeoutUs = */ 0);
+        if (codecInputBufferIdx < 0) {
+            if (codecInputBufferIdx != AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+                LOG(ERROR) << __func__
+                           << ": Received error in AMediaCodec_dequeueInputBuffer. Error code: "
+                           << codecInputBufferIdx;
+            }
+            break;
+        }
+        onCodecInputAvailable(codecInputBufferIdx);
+        AMediaExtractor_advance(mVideoExtractor.get());
     }
 }
 
@@ -228,6 +300,7 @@ void EvsVideoEmulatedCamera::onCodecInputAvailable(const int32_t index) {
     }
     const size_t readSize =
             AMediaExtractor_readSampleData(mVideoExtractor.get(), codecInputBuffer, sampleSize);
+    mCodecInputTimes[presentationTime] = Clock::now();
     const media_status_t status = AMediaCodec_queueInputBuffer(
             mVideoCodec.get(), index, /*offset = */ 0, readSize, presentationTime, /* flags = */ 0);
     if (status != AMEDIA_OK) {
@@ -238,51 +311,229 @@ void EvsVideoEmulatedCamera::onCodecInputAvailable(const int32_t index) {
 
 void EvsVideoEmulatedCamera::onCodecOutputAvailable(const int32_t index,
                                                     const AMediaCodecBufferInfo& info) {
-    using std::chrono::duration_cast;
-    using std::chrono::microseconds;
-    using std::chrono::nanoseconds;
-    using AidlPixelFormat = ::aidl::android::hardware::graphics::common::PixelFormat;
-    using ::aidl::android::hardware::graphics::common::BufferUsage;
-
-    size_t decodedOutSize = 0;
-    uint8_t* const codecOutputBuffer =
-            AMediaCodec_getOutputBuffer(mVideoCodec.get(), index, &decodedOutSize) + info.offset;
+    const auto now = Clock::now();
+    if (const auto it = mCodecInputTimes.find(info.presentationTimeUs);
+        it != mCodecInputTimes.end()) {
+        std::lock_guard lock(mStatsMutex);
+        mDecodeStats.add(now - it->second);
+        mCodecInputTimes.erase(it);
+    }
 
-    int color_format = 0;
-    const auto outFormat = AMediaCodec_getOutputFormat(mVideoCodec.get());
-    if (!AMediaFormat_getInt32(outFormat, AMEDIAFORMAT_KEY_COLOR_FORMAT, &color_format)) {
-        LOG(ERROR) << "Failed to get the color format.";
+    if (info.size <= 0) {
+        // Nothing to convert, i.e. an empty end of stream buffer.
+        AMediaCodec_releaseOutputBuffer(mVideoCodec.get(), index, /* render = */ false);
         return;
     }
 
-    int stride = 0;
-    if (!AMediaFormat_getInt32(outFormat, AMEDIAFORMAT_KEY_STRIDE, &stride)) {
-        LOG(WARNING) << "Cannot find stride in format. Set as frame width.";
-        stride = mWidth;
+    PipelineFrame frame;
+    frame.sequence = mNextSequence++;
+    frame.codecBufferIndex = index;
+    frame.info = info;
+    frame.decodedTime = now;
+    {
+        std::lock_guard lock(mPipelineMutex);
+        mDecodedFrames.push_back(frame);
+        ++mFramesInPipeline;
+        ++mCodecBuffersInPipeline;
     }
+    mPipelineCondition.notify_all();
+}
 
-    int slice_height = 0;
-    if (!AMediaFormat_getInt32(outFormat, AMEDIAFORMAT_KEY_SLICE_HEIGHT, &slice_height)) {
-        LOG(WARNING) << "Cannot find slice-height in format. Set as frame height.";
-        slice_height = mHeight;
-    }
+void EvsVideoEmulatedCamera::convertFrames() {
+    while (true) {
+        PipelineFrame frame;
+        {
+            std::unique_lock lock(mPipelineMutex);
+            ScopedLockAssertion lockAssertion(mPipelineMutex);
+            mPipelineCondition.wait(lock, [this]() REQUIRES(mPipelineMutex) {
+                return !mPipelineRunning || !mDecodedFrames.empty();
+            });
+            if (!mPipelineRunning) {
+                return;
+            }
+            frame = mDecodedFrames.front();
+            mDecodedFrames.pop_front();
+        }
 
-    LOG(DEBUG) << "COLOR FORMAT: " << color_format << " stride: " << stride
-               << " height: " << slice_height;
+        convertFrame(frame);
+        frame.convertedTime = Clock::now();
+        {
+            std::lock_guard lock(mStatsMutex);
+            mConvertStats.add(frame.convertedTime - frame.decodedTime);
+        }
 
-    std::size_t renderBufferId = static_cast<std::size_t>(-1);
-    buffer_handle_t renderBufferHandle = nullptr;
+        {
+            std::lock_guard lock(mPipelineMutex);
+            --mCodecBuffersInPipeline;
+            mConvertedFrames.emplace(frame.sequence, frame);
+        }
+        mPipelineCondition.notify_all();
+    }
+}
+
+void EvsVideoEmulatedCamera::convertFrame(PipelineFrame& frame) {
     {
         std::lock_guard lock(mMutex);
-        if (mStreamState != StreamState::RUNNING) {
-            return;
+        if (mStreamState == StreamState::RUNNING) {
+            std::tie(frame.bufferId, frame.bufferHandle) = useBuffer_unsafe();
         }
-        std::tie(renderBufferId, renderBufferHandle) = useBuffer_unsafe();
     }
-    if (!renderBufferHandle) {
+    if (!frame.bufferHandle) {
         LOG(DEBUG) << __func__ << ": Camera failed to get an available render buffer.";
-        return;
+    } else {
+        size_t decodedOutSize = 0;
+        uint8_t* const codecOutputBuffer =
+                AMediaCodec_getOutputBuffer(mVideoCodec.get(), frame.codecBufferIndex,
+                                            &decodedOutSize) +
+                frame.info.offset;
+
+        // Lock our output buffer for writing
+        uint8_t* pixels = nullptr;
+        auto& mapper = ::android::GraphicBufferMapper::get();
+        mapper.lock(frame.bufferHandle, GRALLOC_USAGE_SW_WRITE_OFTEN | GRALLOC_USAGE_SW_READ_NEVER,
+                    ::android::Rect(mWidth, mHeight), (void**)&pixels);
+
+        // If we failed to lock the pixel buffer, we're about to crash, but log it first
+        if (!pixels) {
+            LOG(ERROR) << __func__
+                       << ": Camera failed to gain access to image buffer for writing";
+        } else {
+            // Decoded output is in YUV4:2:0.
+            std::size_t ySize = mHeight * mWidth;
+            std::size_t uvSize = ySize / 4;
+
+            uint8_t* u_head = codecOutputBuffer + ySize;
+            uint8_t* v_head = u_head + uvSize;
+
+#if DUMP_FRAMES
+            // TODO: We may want to keep this "dump" option.
+            static int dumpCount = 0;
+            static bool dumpData = ++dumpCount < 10;
+            if (dumpData) {
+                std::string path = "/data/vendor/dump/";
+                path += "dump_" + std::to_string(dumpCount) + ".bin";
+
+                ::android::base::unique_fd fd(
+                        open(path.data(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP));
+                if (fd < 0) {
+                    LOG(ERROR) << "Failed to open " << path;
+                } else {
+                    auto len = write(fd.get(), codecOutputBuffer, frame.info.size);
+                    LOG(ERROR) << "Write " << len << " to " << path;
+                }
+            }
+#endif
+            if (auto result = mFillBuffer(codecOutputBuffer, mWidth, u_head, mUvStride, v_head,
+                                          mUvStride, pixels, mDstStride, mWidth, mHeight);
+                result != 0) {
+                LOG(ERROR) << "Failed to convert I420 to BGRA";
+            }
+#if DUMP_FRAMES
+            else if (dumpData) {
+                std::string path = "/data/vendor/dump/";
+                path += "dump_" + std::to_string(dumpCount) + "_rgba.bin";
+
+                ::android::base::unique_fd fd(
+                        open(path.data(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP));
+                if (fd < 0) {
+                    LOG(ERROR) << "Failed to open " << path;
+                } else {
+                    auto len = write(fd.get(), pixels, mStride * mHeight * 4);
+                    LOG(ERROR) << "Write " << len << " to " << path;
+                }
+            }
+#endif
+
+            // Release our output buffer
+            mapper.unlock(frame.bufferHandle);
+        }
     }
+
+    // The decoded frame is no longer needed.
+    const auto release_status = AMediaCodec_releaseOutputBuffer(
+            mVideoCodec.get(), frame.codecBufferIndex, /* render = */ false);
+    if (release_status != AMEDIA_OK) {
+        LOG(ERROR) << __func__
+                   << ": Received error in releasing output buffer. Error code: " << release_status;
+    }
+    frame.codecBufferIndex = -1;
+}
+
+void EvsVideoEmulatedCamera::deliverFrames() {
+    using namespace std::chrono_literals;
+
+    uint64_t nextSequence = 0;
+    Clock::time_point lastDeliveryTime;
+    int64_t lastPresentationTimeUs = -1;
+    while (true) {
+        PipelineFrame frame;
+        {
+            // Frames are converted concurrently, so they might be ready out of order.
+            std::unique_lock lock(mPipelineMutex);
+            ScopedLockAssertion lockAssertion(mPipelineMutex);
+            mPipelineCondition.wait(lock, [this, nextSequence]() REQUIRES(mPipelineMutex) {
+                return !mPipelineRunning || mConvertedFrames.count(nextSequence) > 0;
+            });
+            if (!mPipelineRunning) {
+                return;
+            }
+            auto node = mConvertedFrames.extract(nextSequence++);
+            frame = node.mapped();
+        }
+
+        if (frame.bufferHandle) {
+            // Pace the frames at the configured frame rate if any, or else as they were recorded.
+            auto interval = mFrameInterval;
+            const int64_t presentationTimeUs = frame.info.presentationTimeUs;
+            if (interval == 0ns && lastPresentationTimeUs >= 0 &&
+                presentationTimeUs > lastPresentationTimeUs) {
+                interval = std::chrono::microseconds(presentationTimeUs - lastPresentationTimeUs);
+            }
+            lastPresentationTimeUs = presentationTimeUs;
+
+            // If we are late, deliver right away and pace the next frames from now on rather than
+            // catching up with a burst of frames.
+            const auto deliveryTime = std::max(lastDeliveryTime + interval, Clock::now());
+            if (!waitUntil(deliveryTime)) {
+                std::lock_guard lock(mPipelineMutex);
+                mConvertedFrames.emplace(frame.sequence, frame);
+                return;
+            }
+            lastDeliveryTime = deliveryTime;
+            deliverFrame(frame);
+        }
+
+        {
+            std::lock_guard lock(mStatsMutex);
+            if (frame.bufferHandle) {
+                mDeliverStats.add(Clock::now() - frame.convertedTime);
+                ++mFramesDelivered;
+            } else {
+                ++mFramesDropped;
+            }
+        }
+        {
+            std::lock_guard lock(mPipelineMutex);
+            --mFramesInPipeline;
+        }
+        mPipelineCondition.notify_all();
+    }
+}
+
+bool EvsVideoEmulatedCamera::waitUntil(Clock::time_point time) {
+    std::unique_lock lock(mPipelineMutex);
+    ScopedLockAssertion lockAssertion(mPipelineMutex);
+    return !mPipelineCondition.wait_until(
+            lock, time, [this]() REQUIRES(mPipelineMutex) { return !mPipelineRunning; });
+}
+
+void EvsVideoEmulatedCamera::deliverFrame(const PipelineFrame& frame) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::nanoseconds;
+    using AidlPixelFormat = ::aidl::android::hardware::graphics::common::PixelFormat;
+    using ::aidl::android::hardware::graphics::common::BufferUsage;
+
     std::vector<BufferDesc> renderBufferDescs;
     renderBufferDescs.push_back({
             .buffer =
@@ -296,79 +547,18 @@ void EvsVideoEmulatedCamera::onCodecOutputAvailable(const int32_t index,
                                             .usage = static_cast<BufferUsage>(mUsage),
                                             .stride = static_cast<int32_t>(mStride),
                                     },
-                            .handle = ::android::dupToAidl(renderBufferHandle),
+                            .handle = ::android::dupToAidl(frame.bufferHandle),
                     },
-            .bufferId = static_cast<int32_t>(renderBufferId),
+            .bufferId = static_cast<int32_t>(frame.bufferId),
             .deviceId = mDescription.id,
             .timestamp = duration_cast<microseconds>(nanoseconds(::android::elapsedRealtimeNano()))
                                  .count(),
     });
 
-    // Lock our output buffer for writing
-    uint8_t* pixels = nullptr;
-    auto& mapper = ::android::GraphicBufferMapper::get();
-    mapper.lock(renderBufferHandle, GRALLOC_USAGE_SW_WRITE_OFTEN | GRALLOC_USAGE_SW_READ_NEVER,
-                ::android::Rect(mWidth, mHeight), (void**)&pixels);
-
-    // If we failed to lock the pixel buffer, we're about to crash, but log it first
-    if (!pixels) {
-        LOG(ERROR) << __func__ << ": Camera failed to gain access to image buffer for writing";
-        return;
-    }
-
-    // Decoded output is in YUV4:2:0.
-    std::size_t ySize = mHeight * mWidth;
-    std::size_t uvSize = ySize / 4;
-
-    uint8_t* u_head = codecOutputBuffer + ySize;
-    uint8_t* v_head = u_head + uvSize;
-
-#if DUMP_FRAMES
-    // TODO: We may want to keep this "dump" option.
-    static int dumpCount = 0;
-    static bool dumpData = ++dumpCount < 10;
-    if (dumpData) {
-        std::string path = "/data/vendor/dump/";
-        path += "dump_" + std::to_string(dumpCount) + ".bin";
-
-        ::android::base::unique_fd fd(
-                open(path.data(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP));
-        if (fd < 0) {
-            LOG(ERROR) << "Failed to open " << path;
-        } else {
-            auto len = write(fd.get(), codecOutputBuffer, info.size);
-            LOG(ERROR) << "Write " << len << " to " << path;
-        }
-    }
-#endif
-    if (auto result = mFillBuffer(codecOutputBuffer, mWidth, u_head, mUvStride, v_head, mUvStride,
-                                  pixels, mDstStride, mWidth, mHeight);
-        result != 0) {
-        LOG(ERROR) << "Failed to convert I420 to BGRA";
-    }
-#if DUMP_FRAMES
-    else if (dumpData) {
-        std::string path = "/data/vendor/dump/";
-        path += "dump_" + std::to_string(dumpCount) + "_rgba.bin";
-
-        ::android::base::unique_fd fd(
-                open(path.data(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP));
-        if (fd < 0) {
-            LOG(ERROR) << "Failed to open " << path;
-        } else {
-            auto len = write(fd.get(), pixels, mStride * mHeight * 4);
-            LOG(ERROR) << "Write " << len << " to " << path;
-        }
-    }
-#endif
-
-    // Release our output buffer
-    mapper.unlock(renderBufferHandle);
-
     // Issue the (asynchronous) callback to the client -- can't be holding the lock
     if (mStream && mStream->deliverFrame(renderBufferDescs).isOk()) {
-        LOG(DEBUG) << __func__ << ": Delivered " << renderBufferHandle
-                   << ", id = " << renderBufferId;
+        LOG(DEBUG) << __func__ << ": Delivered " << frame.bufferHandle
+                   << ", id = " << frame.bufferId;
     } else {
         // This can happen if the client dies and is likely unrecoverable.
         // To avoid consuming resources generating failing calls, we stop sending
@@ -379,54 +569,21 @@ void EvsVideoEmulatedCamera::onCodecOutputAvailable(const int32_t index,
     }
 }
 
-void EvsVideoEmulatedCamera::renderOneFrame() {
-    using std::chrono::duration_cast;
-    using std::chrono::microseconds;
-    using namespace std::chrono_literals;
-
-    // push to codec input
-    while (true) {
-        int codecInputBufferIdx =
-                AMediaCodec_dequeueInputBuffer(mVideoCodec.get(), /* timeoutUs = */ 0);
-        if (codecInputBufferIdx < 0) {
-            if (codecInputBufferIdx != AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
-                LOG(ERROR) << __func__
-                           << ": Received error in AMediaCodec_dequeueInputBuffer. Error code: "
-                           << codecInputBufferIdx;
-            }
-            break;
-        }
-        onCodecInputAvailable(codecInputBufferIdx);
-        AMediaExtractor_advance(mVideoExtractor.get());
+void EvsVideoEmulatedCamera::drainPipeline_unsafe() {
+    std::lock_guard lock(mPipelineMutex);
+    for (const auto& frame : mDecodedFrames) {
+        AMediaCodec_releaseOutputBuffer(mVideoCodec.get(), frame.codecBufferIndex,
+                                        /* render = */ false);
     }
-
-    // pop from codec output
-
-    AMediaCodecBufferInfo info;
-    int codecOutputputBufferIdx = AMediaCodec_dequeueOutputBuffer(
-            mVideoCodec.get(), &info, /* timeoutUs = */ duration_cast<microseconds>(1ms).count());
-    if (codecOutputputBufferIdx < 0) {
-        if (codecOutputputBufferIdx != AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
-            LOG(ERROR) << __func__
-                       << ": Received error in AMediaCodec_dequeueOutputBuffer. Error code: "
-                       << codecOutputputBufferIdx;
+    for (const auto& [_, frame] : mConvertedFrames) {
+        if (frame.bufferHandle) {
+            returnBuffer_unsafe(frame.bufferId);
         }
-        return;
-    }
-    onCodecOutputAvailable(codecOutputputBufferIdx, info);
-    const auto release_status = AMediaCodec_releaseOutputBuffer(
-            mVideoCodec.get(), codecOutputputBufferIdx, /* render = */ false);
-    if (release_status != AMEDIA_OK) {
-        LOG(ERROR) << __func__
-                   << ": Received error in releasing output buffer. Error code: " << release_status;
-    }
-
-    if ((info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0) {
-        LOG(INFO) << "Start video playback from the beginning.";
-        AMediaExtractor_seekTo(mVideoExtractor.get(), /* seekPosUs= */ 0,
-                               AMEDIAEXTRACTOR_SEEK_CLOSEST_SYNC);
-        AMediaCodec_flush(mVideoCodec.get());
     }
+    mDecodedFrames.clear();
+    mConvertedFrames.clear();
+    mFramesInPipeline = 0;
+    mCodecBuffersInPipeline = 0;
 }
 
 void EvsVideoEmulatedCamera::initializeParameters() {
@@ -479,19 +636,55 @@ bool EvsVideoEmulatedCamera::startVideoStreamImpl_locked(
             return false;
         }
     }
-    mCaptureThread = std::thread([this]() { generateFrames(); });
+
+    {
+        std::lock_guard lock(mStatsMutex);
+        mStreamStartTime = Clock::now();
+        mDecodeStats = {};
+        mConvertStats = {};
+        mDeliverStats = {};
+        mFramesDelivered = 0;
+        mFramesDropped = 0;
+    }
+    {
+        std::lock_guard lock(mPipelineMutex);
+        mPipelineRunning = true;
+    }
+    mNextSequence = 0;
+    mCodecInputTimes.clear();
+    mDecoderThread = std::thread([this]() { decodeFrames(); });
+    for (std::size_t i = 0; i < kNumConversionThreads; ++i) {
+        mConversionThreads.emplace_back([this]() { convertFrames(); });
+    }
+    mDeliveryThread = std::thread([this]() { deliverFrames(); });
 
     return true;
 }
 
 bool EvsVideoEmulatedCamera::stopVideoStreamImpl_locked(ndk::ScopedAStatus& /* status */,
                                                         std::unique_lock<std::mutex>& lck) {
-    const media_status_t status = AMediaCodec_stop(mVideoCodec.get());
+    {
+        std::lock_guard lock(mPipelineMutex);
+        mPipelineRunning = false;
+    }
+    mPipelineCondition.notify_all();
+
     lck.unlock();
-    if (mCaptureThread.joinable()) {
-        mCaptureThread.join();
+    if (mDecoderThread.joinable()) {
+        mDecoderThread.join();
+    }
+    for (auto& thread : mConversionThreads) {
+        thread.join();
+    }
+    mConversionThreads.clear();
+    if (mDeliveryThread.joinable()) {
+        mDeliveryThread.join();
     }
     lck.lock();
+
+    // The codec output buffers must be returned before stopping the codec.
+    drainPipeline_unsafe();
+    const media_status_t status = AMediaCodec_stop(mVideoCodec.get());
     return status == AMEDIA_OK;
 }
 
@@ -624,13 +817,17 @@ std::shared_ptr<EvsVideoEmulatedCamera> EvsVideoEmulatedCamera::Create(const cha
 
 std::shared_ptr<EvsVideoEmulatedCamera> EvsVideoEmulatedCamera::Create(
         const char* deviceName, std::unique_ptr<ConfigManager::CameraInfo>& camInfo,
-        const evs::Stream* /* streamCfg */) {
+        const evs::Stream* streamCfg) {
     std::shared_ptr<EvsVideoEmulatedCamera> c =
             ndk::SharedRefBase::make<EvsVideoEmulatedCamera>(Sigil{}, deviceName, camInfo);
     if (!c) {
         LOG(ERROR) << "Failed to instantiate EvsVideoEmulatedCamera.";
         return nullptr;
     }
+    if (streamCfg && streamCfg->framerate > 0) {
+        c->mFrameInterval =
+                std::chrono::nanoseconds(std::chrono::seconds(1)) / streamCfg->framerate;
+    }
     if (!c->initialize()) {
         LOG(ERROR) << "Failed to initialize EvsVideoEmulatedCamera.";
         return nullptr;
@@ -638,7 +835,33 @@ std::shared_ptr<EvsVideoEmulatedCamera> EvsVideoEmulatedCamera::Create(
     return c;
 }
 
+binder_status_t EvsVideoEmulatedCamera::dump(int fd, const char** /* args */,
+                                             uint32_t /* numArgs */) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::lock_guard lock(mStatsMutex);
+    dprintf(fd, "Video emulated camera %s\n", mDescription.id.c_str());
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - mStreamStartTime).count();
+    dprintf(fd, "  Frames delivered: %" PRIu64 " (%.2f fps), dropped: %" PRIu64 "\n",
+            mFramesDelivered, elapsed > 0 ? mFramesDelivered / elapsed : 0.0, mFramesDropped);
+    for (const auto& [name, stats] : {std::pair("decode", &mDecodeStats),
+                                      std::pair("convert", &mConvertStats),
+                                      std::pair("deliver", &mDeliverStats)}) {
+        const int64_t averageUs =
+                stats->count > 0 ? duration_cast<microseconds>(stats->total).count() /
+                                           static_cast<int64_t>(stats->count)
+                                 : 0;
+        dprintf(fd, "  %s latency: count %" PRIu64 ", average %" PRId64 " us, max %" PRId64
+                " us\n", name, stats->count, averageUs,
+                static_cast<int64_t>(duration_cast<microseconds>(stats->max).count()));
+    }
+    return STATUS_OK;
+}
+
 void EvsVideoEmulatedCamera::shutdown() {
+    // Stop the pipeline threads before releasing the codec they use.
+    stopVideoStream();
     mVideoCodec.reset();
     mVideoExtractor.reset();
     close(mVideoFd);
@@ -18,6 +18,10 @@
 
 #include "FormatConvert.h"
 
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
 namespace android {
 namespace hardware {
 namespace automotive {
@@ -35,30 +39,37 @@ int Utils::align(int value) {
 }
 
 
-// Limit the given value to the provided range.  :)
-inline float Utils::clamp(float v, float min, float max) {
-    if (v < min) return min;
-    if (v > max) return max;
+namespace {
+
+// The conversion is done in 16.16 fixed point.  The coefficients are those of the BT.601 YUV to
+// RGB conversion used by the original floating point implementation (1.140, 0.395, 0.581 and
+// 2.032), and the results match it within one LSB.
+constexpr int kFractionBits = 16;
+constexpr int32_t kCoefRV = 74711;
+constexpr int32_t kCoefGU = 25887;
+constexpr int32_t kCoefGV = 38076;
+constexpr int32_t kCoefBU = 133169;
+// Compensates the truncation of the coefficients so that the results do not drift below the
+// floating point ones.
+constexpr int32_t kRoundingBias = 64;
+
+// The number of pixels converted at once by the vector implementations.
+constexpr unsigned kVectorPixels = 16;
+
+inline int32_t clampToByte(int32_t v) {
+    if (v < 0) return 0;
+    if (v > 255) return 255;
     return v;
 }
 
+inline uint32_t convertPixel(uint8_t Y, uint8_t Uin, uint8_t Vin, bool bgrxFormat) {
+    const int32_t U = Uin - 128;
+    const int32_t V = Vin - 128;
+    const int32_t Yf = (Y << kFractionBits) + kRoundingBias;
 
-uint32_t Utils::yuvToRgbx(const unsigned char Y,
-                          const unsigned char Uin,
-                          const unsigned char Vin,
-                          bool bgrxFormat) {
-    // Don't use this if you want to see the best performance.  :)
-    // Better to do this in a pixel shader if we really have to, but on actual
-    // embedded hardware we expect to be able to texture directly from the YUV data
-    float U = Uin - 128.0f;
-    float V = Vin - 128.0f;
-
-    float Rf = Y + 1.140f*V;
-    float Gf = Y - 0.395f*U - 0.581f*V;
-    float Bf = Y + 2.032f*U;
-    unsigned char R = (unsigned char)clamp(Rf, 0.0f, 255.0f);
-    unsigned char G = (unsigned char)clamp(Gf, 0.0f, 255.0f);
-    unsigned char B = (unsigned char)clamp(Bf, 0.0f, 255.0f);
+    const uint32_t R = clampToByte((Yf + kCoefRV*V) >> kFractionBits);
+    const uint32_t G = clampToByte((Yf - kCoefGU*U - kCoefGV*V) >> kFractionBits);
+    const uint32_t B = clampToByte((Yf + kCoefBU*U) >> kFractionBits);
 
     if (!bgrxFormat) {
         return (R      ) |
@@ -74,6 +85,285 @@ uint32_t Utils::yuvToRgbx(const unsigned char Y,
 }
 
 
+// Row converters.  Each one converts a row of 'width' pixels, where 'width' is even, with one U
+// and one V sample for each pair of pixels.
+struct RowConverters {
+    void (*nv21)(const uint8_t* y, const uint8_t* vu, uint32_t* dst, unsigned width,
+                 bool bgrxFormat);
+    void (*yv12)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint32_t* dst,
+                 unsigned width, bool bgrxFormat);
+    void (*yuyv)(const uint8_t* yuyv, uint32_t* dst, unsigned width, bool bgrxFormat);
+};
+
+void convertNV21RowReference(const uint8_t* y, const uint8_t* vu, uint32_t* dst, unsigned width,
+                             bool bgrxFormat) {
+    for (unsigned c = 0; c < width; c++) {
+        unsigned uCol = (c & ~1);   // uCol is always even and repeats 1:2 with Y values
+        unsigned vCol = uCol | 1;   // vCol is always odd
+        dst[c] = convertPixel(y[c], vu[uCol], vu[vCol], bgrxFormat);
+    }
+}
+
+void convertYV12RowReference(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                             uint32_t* dst, unsigned width, bool bgrxFormat) {
+    for (unsigned c = 0; c < width; c++) {
+        dst[c] = convertPixel(y[c], u[c/2], v[c/2], bgrxFormat);
+    }
+}
+
+void convertYUYVRowReference(const uint8_t* yuyv, uint32_t* dst, unsigned width,
+                             bool bgrxFormat) {
+    // Note:  we're walking two pixels at a time here (even/odd)
+    for (unsigned c = 0; c < width; c += 2, yuyv += 4) {
+        dst[c]     = convertPixel(yuyv[0], yuyv[1], yuyv[3], bgrxFormat);
+        dst[c + 1] = convertPixel(yuyv[2], yuyv[1], yuyv[3], bgrxFormat);
+    }
+}
+
+
+// The vector implementation is written with the GCC/clang vector extensions, which are lowered to
+// SSE2 or NEON by default, and to AVX2 when built for it below.  It loads and deinterleaves 16
+// pixels at a time, then computes the exact same arithmetic as convertPixel() on 32bit lanes, in
+// chunks of kLanes pixels that fit a native register.
+typedef uint8_t  u8x4   __attribute__((vector_size(4)));
+typedef uint8_t  u8x8   __attribute__((vector_size(8)));
+typedef uint8_t  u8x16  __attribute__((vector_size(16)));
+typedef uint8_t  u8x32  __attribute__((vector_size(32)));
+typedef int32_t  i32x4  __attribute__((vector_size(16)));
+typedef int32_t  i32x8  __attribute__((vector_size(32)));
+
+template<typename V>
+__attribute__((always_inline)) inline V loadVector(const uint8_t* src) {
+    V v;
+    memcpy(&v, src, sizeof(v));
+    return v;
+}
+
+// Widens the given chunk of kLanes bytes to 32bit lanes.
+template<unsigned kLanes, unsigned kChunk>
+__attribute__((always_inline)) inline auto widenChunk(u8x16 v) {
+    constexpr unsigned i = kChunk * kLanes;
+    if constexpr (kLanes == 4) {
+        return __builtin_convertvector(
+                __builtin_shufflevector(v, v, i, i + 1, i + 2, i + 3), i32x4);
+    } else {
+        static_assert(kLanes == 8, "unsupported vector size");
+        return __builtin_convertvector(
+                __builtin_shufflevector(v, v, i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7),
+                i32x8);
+    }
+}
+
+template<typename I32>
+__attribute__((always_inline)) inline I32 clampToByte(I32 v) {
+    v &= (v > 0);
+    const I32 overflow = (v > 255);
+    return (v & ~overflow) | (overflow & 255);
+}
+
+template<unsigned kLanes, unsigned kChunk>
+__attribute__((always_inline)) inline void convertChunk(u8x16 y, u8x16 u, u8x16 v,
+                                                        uint32_t* dst, bool bgrxFormat) {
+    const auto U = widenChunk<kLanes, kChunk>(u) - 128;
+    const auto V = widenChunk<kLanes, kChunk>(v) - 128;
+    const auto Yf = (widenChunk<kLanes, kChunk>(y) << kFractionBits) + kRoundingBias;
+
+    const auto R = clampToByte((Yf + kCoefRV*V) >> kFractionBits);
+    const auto G = clampToByte((Yf - kCoefGU*U - kCoefGV*V) >> kFractionBits);
+    const auto B = clampToByte((Yf + kCoefBU*U) >> kFractionBits);
+
+    // The alpha channel is filled with ones; the sign bit does not matter for the stored bits.
+    std::remove_const_t<decltype(U)> pixels;
+    if (!bgrxFormat) {
+        pixels = R | (G << 8) | (B << 16) | (int32_t)0xFF000000;
+    } else {
+        pixels = (R << 16) | (G << 8) | B | (int32_t)0xFF000000;
+    }
+    memcpy(dst + kChunk * kLanes, &pixels, sizeof(pixels));
+}
+
+// Converts 16 pixels.  'u' and 'v' hold one sample per pixel.
+template<unsigned kLanes>
+__attribute__((always_inline)) inline void convertPixels(u8x16 y, u8x16 u, u8x16 v,
+                                                         uint32_t* dst, bool bgrxFormat) {
+    convertChunk<kLanes, 0>(y, u, v, dst, bgrxFormat);
+    convertChunk<kLanes, 1>(y, u, v, dst, bgrxFormat);
+    if constexpr (kLanes == 4) {
+        convertChunk<kLanes, 2>(y, u, v, dst, bgrxFormat);
+        convertChunk<kLanes, 3>(y, u, v, dst, bgrxFormat);
+    }
+}
+
+// Duplicates each of the 8 chroma samples for the two pixels sharing it.
+__attribute__((always_inline)) inline u8x16 upsampleChroma(u8x8 c) {
+    return __builtin_shufflevector(c, c, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+}
+
+template<unsigned kLanes>
+__attribute__((always_inline)) inline void convertNV21RowVector(
+        const uint8_t* y, const uint8_t* vu, uint32_t* dst, unsigned width, bool bgrxFormat) {
+    unsigned c = 0;
+    for (; c + kVectorPixels <= width; c += kVectorPixels) {
+        const u8x16 uv = loadVector<u8x16>(vu + c);
+        const u8x16 u = __builtin_shufflevector(uv, uv, 0, 0, 2, 2, 4, 4, 6, 6,
+                                                8, 8, 10, 10, 12, 12, 14, 14);
+        const u8x16 v = __builtin_shufflevector(uv, uv, 1, 1, 3, 3, 5, 5, 7, 7,
+                                                9, 9, 11, 11, 13, 13, 15, 15);
+        convertPixels<kLanes>(loadVector<u8x16>(y + c), u, v, dst + c, bgrxFormat);
+    }
+    convertNV21RowReference(y + c, vu + c, dst + c, width - c, bgrxFormat);
+}
+
+template<unsigned kLanes>
+__attribute__((always_inline)) inline void convertYV12RowVector(
+        const uint8_t* y, const uint8_t* u, const uint8_t* v, uint32_t* dst, unsigned width,
+        bool bgrxFormat) {
+    unsigned c = 0;
+    for (; c + kVectorPixels <= width; c += kVectorPixels) {
+        convertPixels<kLanes>(loadVector<u8x16>(y + c),
+                      upsampleChroma(loadVector<u8x8>(u + c/2)),
+                      upsampleChroma(loadVector<u8x8>(v + c/2)),
+                      dst + c, bgrxFormat);
+    }
+    convertYV12RowReference(y + c, u + c/2, v + c/2, dst + c, width - c, bgrxFormat);
+}
+
+template<unsigned kLanes>
+__attribute__((always_inline)) inline void convertYUYVRowVector(
+        const uint8_t* yuyv, uint32_t* dst, unsigned width, bool bgrxFormat) {
+    unsigned c = 0;
+    for (; c + kVectorPixels <= width; c += kVectorPixels) {
+        const u8x32 src = loadVector<u8x32>(yuyv + 2*c);
+        const u8x16 y = __builtin_shufflevector(src, src, 0, 2, 4, 6, 8, 10, 12, 14,
+                                                16, 18, 20, 22, 24, 26, 28, 30);
+        const u8x16 u = __builtin_shufflevector(src, src, 1, 1, 5, 5, 9, 9, 13, 13,
+                                                17, 17, 21, 21, 25, 25, 29, 29);
+        const u8x16 v = __builtin_shufflevector(src, src, 3, 3, 7, 7, 11, 11, 15, 15,
+                                                19, 19, 23, 23, 27, 27, 31, 31);
+        convertPixels<kLanes>(y, u, v, dst + c, bgrxFormat);
+    }
+    convertYUYVRowReference(yuyv + 2*c, dst + c, width - c, bgrxFormat);
+}
+
+void convertNV21RowBaseline(const uint8_t* y, const uint8_t* vu, uint32_t* dst, unsigned width,
+                            bool bgrxFormat) {
+    convertNV21RowVector<4>(y, vu, dst, width, bgrxFormat);
+}
+
+void convertYV12RowBaseline(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                            uint32_t* dst, unsigned width, bool bgrxFormat) {
+    convertYV12RowVector<4>(y, u, v, dst, width, bgrxFormat);
+}
+
+void convertYUYVRowBaseline(const uint8_t* yuyv, uint32_t* dst, unsigned width,
+                            bool bgrxFormat) {
+    convertYUYVRowVector<4>(yuyv, dst, width, bgrxFormat);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FORMAT_CONVERT_HAS_AVX2
+
+__attribute__((target("avx2")))
+void convertNV21RowAvx2(const uint8_t* y, const uint8_t* vu, uint32_t* dst, unsigned width,
+                        bool bgrxFormat) {
+    convertNV21RowVector<8>(y, vu, dst, width, bgrxFormat);
+}
+
+__attribute__((target("avx2")))
+void convertYV12RowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint32_t* dst,
+                        unsigned width, bool bgrxFormat) {
+    convertYV12RowVector<8>(y, u, v, dst, width, bgrxFormat);
+}
+
+__attribute__((target("avx2")))
+void convertYUYVRowAvx2(const uint8_t* yuyv, uint32_t* dst, unsigned width, bool bgrxFormat) {
+    convertYUYVRowVector<8>(yuyv, dst, width, bgrxFormat);
+}
+#endif
+
+constexpr RowConverters kReferenceConverters = {
+    convertNV21RowReference, convertYV12RowReference, convertYUYVRowReference,
+};
+constexpr RowConverters kVectorConverters = {
+    convertNV21RowBaseline, convertYV12RowBaseline, convertYUYVRowBaseline,
+};
+#ifdef FORMAT_CONVERT_HAS_AVX2
+constexpr RowConverters kAvx2Converters = {
+    convertNV21RowAvx2, convertYV12RowAvx2, convertYUYVRowAvx2,
+};
+#endif
+
+// The implementation selected by setImplementation(), or -1 to use the fastest one.
+std::atomic<int> sSelectedImplementation{-1};
+
+Utils::Implementation fastestImplementation() {
+    // Probed on first use rather than at static initialization, when the CPU feature detection
+    // may not be ready yet.
+    static const Utils::Implementation fastest =
+            Utils::isSupported(Utils::Implementation::VECTOR_AVX2)
+                    ? Utils::Implementation::VECTOR_AVX2
+                    : Utils::Implementation::VECTOR;
+    return fastest;
+}
+
+const RowConverters& getRowConverters() {
+    switch (Utils::getImplementation()) {
+        case Utils::Implementation::REFERENCE:
+            return kReferenceConverters;
+#ifdef FORMAT_CONVERT_HAS_AVX2
+        case Utils::Implementation::VECTOR_AVX2:
+            return kAvx2Converters;
+#endif
+        default:
+            return kVectorConverters;
+    }
+}
+
+} // namespace
+
+
+uint32_t Utils::yuvToRgbx(const unsigned char Y,
+                          const unsigned char Uin,
+                          const unsigned char Vin,
+                          bool bgrxFormat) {
+    return convertPixel(Y, Uin, Vin, bgrxFormat);
+}
+
+
+bool Utils::isSupported(Implementation impl) {
+    switch (impl) {
+        case Implementation::REFERENCE:
+        case Implementation::VECTOR:
+            return true;
+        case Implementation::VECTOR_AVX2:
+#ifdef FORMAT_CONVERT_HAS_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+
+bool Utils::setImplementation(Implementation impl) {
+    if (!isSupported(impl)) {
+        return false;
+    }
+    sSelectedImplementation = static_cast<int>(impl);
+    return true;
+}
+
+
+Utils::Implementation Utils::getImplementation() {
+    const int selected = sSelectedImplementation;
+    if (selected < 0) {
+        return fastestImplementation();
+    }
+    return static_cast<Implementation>(selected);
+}
+
+
 void Utils::copyNV21toRGB32(unsigned width, unsigned height,
                             uint8_t* src,
                             uint32_t* dst, unsigned dstStridePixels,
@@ -90,6 +380,7 @@ void Utils::copyNV21toRGB32(unsigned width, unsigned height,
     uint8_t* srcY = src;
     uint8_t* srcUV = src+offsetUV;
 
+    const RowConverters& converters = getRowConverters();
     for (unsigned r = 0; r < height; r++) {
         // Note that we're walking the same UV row twice for even/odd luminance rows
         uint8_t* rowY  = srcY  + r*strideLum;
@@ -97,11 +388,7 @@ void Utils::copyNV21toRGB32(unsigned width, unsigned height,
 
         uint32_t* rowDest = dst + r*dstStridePixels;
 
-        for (unsigned c = 0; c < width; c++) {
-            unsigned uCol = (c & ~1);   // uCol is always even and repeats 1:2 with Y values
-            unsigned vCol = uCol | 1;   // vCol is always odd
-            rowDest[c] = yuvToRgbx(rowY[c], rowUV[uCol], rowUV[vCol], bgrxFormat);
-        }
+        converters.nv21(rowY, rowUV, rowDest, width, bgrxFormat);
     }
 }
 
@@ -126,6 +413,7 @@ void Utils::copyYV12toRGB32(unsigned width, unsigned height,
     uint8_t* srcU = src+offsetU;
     uint8_t* srcV = src+offsetV;
 
+    const RowConverters& converters = getRowConverters();
     for (unsigned r = 0; r < height; r++) {
         // Note that we're walking the same U and V rows twice for even/odd luminance rows
         uint8_t* rowY = srcY + r*strideLum;
@@ -134,9 +422,7 @@ void Utils::copyYV12toRGB32(unsigned width, unsigned height,
 
         uint32_t* rowDest = dst + r*dstStridePixels;
 
-        for (unsigned c = 0; c < width; c++) {
-            rowDest[c] = yuvToRgbx(rowY[c], rowU[c], rowV[c], bgrxFormat);
-        }
+        converters.yv12(rowY, rowU, rowV, rowDest, width, bgrxFormat);
     }
 }
 
@@ -146,30 +432,12 @@ void Utils::copyYUYVtoRGB32(unsigned width, unsigned height,
                             uint32_t* dst, unsigned dstStridePixels,
                             bool bgrxFormat)
 {
-    uint32_t* srcWords = (uint32_t*)src;
-
-    const int srcRowPadding32 = srcStridePixels/2 - width/2;  // 2 bytes per pixel, 4 bytes per word
-    const int dstRowPadding32 = dstStridePixels   - width;    // 4 bytes per pixel, 4 bytes per word
+    // 2 bytes per pixel in the source, one U and one V sample per pair of pixels
+    const unsigned srcStrideBytes = srcStridePixels * 2;
 
+    const RowConverters& converters = getRowConverters();
     for (unsigned r = 0; r < height; r++) {
-        for (unsigned c = 0; c < width/2; c++) {
-            // Note:  we're walking two pixels at a time here (even/odd)
-            uint32_t srcPixel = *srcWords++;
-
-            uint8_t Y1 = (srcPixel)       & 0xFF;
-            uint8_t U  = (srcPixel >> 8)  & 0xFF;
-            uint8_t Y2 = (srcPixel >> 16) & 0xFF;
-            uint8_t V  = (srcPixel >> 24) & 0xFF;
-
-            // On the RGB output, we're writing one pixel at a time
-            *(dst+0) = yuvToRgbx(Y1, U, V, bgrxFormat);
-            *(dst+1) = yuvToRgbx(Y2, U, V, bgrxFormat);
-            dst += 2;
-        }
-
-        // Skip over any extra data or end of row alignment padding
-        srcWords += srcRowPadding32;
-        dst += dstRowPadding32;
+        converters.yuyv(src + r*srcStrideBytes, dst + r*dstStridePixels, width, bgrxFormat);
     }
 }
 
@@ -79,11 +79,30 @@ public:
                                               void* dst, unsigned dstStridePixels,
                                               unsigned pixelSize);
 
+
+    // Implementations of the YUV to RGBx/BGRx conversions above.  All of them produce exactly
+    // the same output; by default, the fastest one supported by the CPU is used.
+    enum class Implementation {
+        // Converts one pixel at a time.  This is the reference for the other implementations.
+        REFERENCE,
+        // Converts 16 pixels at a time with portable vector code.
+        VECTOR,
+        // Same as VECTOR, built for AVX2 capable CPUs (x86 only).
+        VECTOR_AVX2,
+    };
+
+    static bool isSupported(Implementation impl);
+
+    // Selects the implementation used by the conversion functions, i.e. to compare them in tests
+    // and benchmarks.  Returns false if the implementation is not supported by the CPU.
+    static bool setImplementation(Implementation impl);
+
+    static Implementation getImplementation();
+
 private:
     template<unsigned alignment>
     static int align(int value);
 
-    static inline float clamp(float v, float min, float max);
     static uint32_t yuvToRgbx(const unsigned char Y,
                               const unsigned char Uin,
                               const unsigned char Vin,
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FormatConvert.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace android::hardware::automotive::evs::common {
+namespace {
+
+using Implementation = Utils::Implementation;
+
+enum Format { NV21, YV12, YUYV };
+
+// Arguments: implementation, format, width, height.
+void BM_ConvertToRGB32(benchmark::State& state) {
+    const auto implementation = static_cast<Implementation>(state.range(0));
+    const auto format = static_cast<Format>(state.range(1));
+    const unsigned width = state.range(2);
+    const unsigned height = state.range(3);
+
+    if (!Utils::isSupported(implementation)) {
+        state.SkipWithError("Implementation not supported by this CPU");
+        return;
+    }
+    const Implementation defaultImplementation = Utils::getImplementation();
+    Utils::setImplementation(implementation);
+
+    // Large enough for all the formats; the widths below are multiples of 32 so that no stride
+    // padding is needed.
+    std::vector<uint8_t> src(width * height * 2);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = i * 7;
+    }
+    std::vector<uint32_t> dst(width * height);
+
+    for (auto _ : state) {
+        switch (format) {
+            case NV21:
+                Utils::copyNV21toRGB32(width, height, src.data(), dst.data(), width);
+                break;
+            case YV12:
+                Utils::copyYV12toRGB32(width, height, src.data(), dst.data(), width);
+                break;
+            case YUYV:
+                Utils::copyYUYVtoRGB32(width, height, src.data(), width, dst.data(), width);
+                break;
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+    state.SetBytesProcessed(state.iterations() * width * height * sizeof(uint32_t));
+    Utils::setImplementation(defaultImplementation);
+}
+
+void getArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"impl", "format", "width", "height"});
+    for (Implementation implementation :
+         {Implementation::REFERENCE, Implementation::VECTOR, Implementation::VECTOR_AVX2}) {
+        for (Format format : {NV21, YV12, YUYV}) {
+            for (auto [width, height] : {std::pair(640, 480), std::pair(1280, 720),
+                                         std::pair(1920, 1080)}) {
+                b->Args({static_cast<int>(implementation), format, width, height});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_ConvertToRGB32)->Apply(getArguments);
+
+}  // namespace
+}  // namespace android::hardware::automotive::evs::common
+
+BENCHMARK_MAIN();
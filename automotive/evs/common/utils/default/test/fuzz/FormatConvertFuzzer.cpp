@@ -21,6 +21,24 @@
 #include <ctime>
 #include "FormatConvert.h"
 
+using android::hardware::automotive::evs::common::Utils;
+
+static void convert(int width, int height, uint8_t* src, uint32_t* tgt) {
+#ifdef COPY_NV21_TO_RGB32
+    Utils::copyNV21toRGB32(width, height, src, tgt, width);
+#elif COPY_NV21_TO_BGR32
+    Utils::copyNV21toBGR32(width, height, src, tgt, width);
+#elif COPY_YV12_TO_RGB32
+    Utils::copyYV12toRGB32(width, height, src, tgt, width);
+#elif COPY_YV12_TO_BGR32
+    Utils::copyYV12toBGR32(width, height, src, tgt, width);
+#elif COPY_YUYV_TO_RGB32
+    Utils::copyYUYVtoRGB32(width, height, src, width, tgt, width);
+#elif COPY_YUYV_TO_BGR32
+    Utils::copyYUYVtoBGR32(width, height, src, width, tgt, width);
+#endif
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
     // 1 random value (4bytes) + min imagesize = 16*2 times bytes per pixel (worse case 2)
     if (size < (4 + 16 * 2 * 2)) {
@@ -40,26 +58,22 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
     uint8_t* src = (uint8_t*)(data + 4);
     uint32_t* tgt = (uint32_t*)malloc(sizeof(uint32_t) * image_pixel_size);
 
-#ifdef COPY_NV21_TO_RGB32
-    android::hardware::automotive::evs::common::Utils::copyNV21toRGB32(width, height, src, tgt,
-                                                                       width);
-#elif COPY_NV21_TO_BGR32
-    android::hardware::automotive::evs::common::Utils::copyNV21toBGR32(width, height, src, tgt,
-                                                                       width);
-#elif COPY_YV12_TO_RGB32
-    android::hardware::automotive::evs::common::Utils::copyYV12toRGB32(width, height, src, tgt,
-                                                                       width);
-#elif COPY_YV12_TO_BGR32
-    android::hardware::automotive::evs::common::Utils::copyYV12toBGR32(width, height, src, tgt,
-                                                                       width);
-#elif COPY_YUYV_TO_RGB32
-    android::hardware::automotive::evs::common::Utils::copyYUYVtoRGB32(width, height, src, width,
-                                                                       tgt, width);
-#elif COPY_YUYV_TO_BGR32
-    android::hardware::automotive::evs::common::Utils::copyYUYVtoBGR32(width, height, src, width,
-                                                                       tgt, width);
-#endif
+    // Every implementation must produce the same output as the reference one.
+    uint32_t* expected = (uint32_t*)malloc(sizeof(uint32_t) * image_pixel_size);
+    Utils::setImplementation(Utils::Implementation::REFERENCE);
+    convert(width, height, src, expected);
+
+    for (auto impl : {Utils::Implementation::VECTOR, Utils::Implementation::VECTOR_AVX2}) {
+        if (!Utils::setImplementation(impl)) {
+            continue;
+        }
+        convert(width, height, src, tgt);
+        if (memcmp(tgt, expected, sizeof(uint32_t) * width * height)) {
+            abort();
+        }
+    }
 
+    free(expected);
     free(tgt);
 
     return 0;
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FormatConvert.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace android::hardware::automotive::evs::common {
+namespace {
+
+using Implementation = Utils::Implementation;
+
+enum class Format { NV21, YV12, YUYV };
+
+struct TestParam {
+    Implementation implementation;
+    Format format;
+    bool bgrx;
+};
+
+unsigned alignTo16(unsigned value) {
+    return (value + 15) & ~15u;
+}
+
+// Returns the size of the source buffer for the given format and size, as laid out by Utils.
+size_t getSourceSize(Format format, unsigned width, unsigned height) {
+    const unsigned strideLum = alignTo16(width);
+    switch (format) {
+        case Format::NV21:
+            return strideLum * height + strideLum * height / 2;
+        case Format::YV12:
+            return strideLum * height + 2 * alignTo16(strideLum / 2) * height / 2;
+        case Format::YUYV:
+            return width * 2 * height;
+    }
+    return 0;
+}
+
+void convert(Format format, unsigned width, unsigned height, std::vector<uint8_t>& src,
+             std::vector<uint32_t>& dst, bool bgrx) {
+    switch (format) {
+        case Format::NV21:
+            Utils::copyNV21toRGB32(width, height, src.data(), dst.data(), width, bgrx);
+            break;
+        case Format::YV12:
+            Utils::copyYV12toRGB32(width, height, src.data(), dst.data(), width, bgrx);
+            break;
+        case Format::YUYV:
+            Utils::copyYUYVtoRGB32(width, height, src.data(), width, dst.data(), width, bgrx);
+            break;
+    }
+}
+
+class FormatConvertTest : public ::testing::TestWithParam<TestParam> {
+  protected:
+    void SetUp() override {
+        mDefaultImplementation = Utils::getImplementation();
+        if (!Utils::isSupported(GetParam().implementation)) {
+            GTEST_SKIP() << "Implementation not supported by this CPU";
+        }
+    }
+
+    void TearDown() override { Utils::setImplementation(mDefaultImplementation); }
+
+    // Converts the image with the reference and the tested implementations and returns the
+    // number of pixels that differ.
+    size_t countMismatches(std::vector<uint8_t>& src, unsigned width, unsigned height) {
+        const TestParam& param = GetParam();
+        std::vector<uint32_t> expected(width * height);
+        std::vector<uint32_t> actual(width * height);
+
+        Utils::setImplementation(Implementation::REFERENCE);
+        convert(param.format, width, height, src, expected, param.bgrx);
+        Utils::setImplementation(param.implementation);
+        convert(param.format, width, height, src, actual, param.bgrx);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (expected[i] != actual[i]) {
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+  private:
+    Implementation mDefaultImplementation;
+};
+
+TEST_P(FormatConvertTest, testMatchesReferenceOnRandomImages) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+
+    // Covers widths with and without a tail smaller than the vector size.
+    for (unsigned width : {2u, 14u, 16u, 18u, 46u, 64u, 640u, 1282u}) {
+        const unsigned height = 6;
+        std::vector<uint8_t> src(getSourceSize(GetParam().format, width, height));
+        std::generate(src.begin(), src.end(), [&] { return byteDist(rng); });
+
+        EXPECT_EQ(countMismatches(src, width, height), 0u) << "width: " << width;
+    }
+}
+
+TEST_P(FormatConvertTest, testMatchesReferenceForAllYuvValues) {
+    if (GetParam().format != Format::YUYV) {
+        GTEST_SKIP() << "Covered by the YUYV format, which has one chroma sample per pixel pair";
+    }
+
+    // One image per U value, with Y values in columns and V values in rows.
+    const unsigned width = 512;
+    const unsigned height = 256;
+    std::vector<uint8_t> src(getSourceSize(Format::YUYV, width, height));
+    for (unsigned u = 0; u < 256; u++) {
+        for (unsigned v = 0; v < height; v++) {
+            uint8_t* row = src.data() + v * width * 2;
+            for (unsigned y = 0; y < 256; y++) {
+                row[y * 4 + 0] = y;
+                row[y * 4 + 1] = u;
+                row[y * 4 + 2] = 255 - y;
+                row[y * 4 + 3] = v;
+            }
+        }
+
+        ASSERT_EQ(countMismatches(src, width, height), 0u) << "U: " << u;
+    }
+}
+
+std::vector<TestParam> getTestParams() {
+    std::vector<TestParam> params;
+    for (Implementation implementation : {Implementation::VECTOR, Implementation::VECTOR_AVX2}) {
+        for (Format format : {Format::NV21, Format::YV12, Format::YUYV}) {
+            for (bool bgrx : {false, true}) {
+                params.push_back({implementation, format, bgrx});
+            }
+        }
+    }
+    return params;
+}
+
+std::string getTestName(const ::testing::TestParamInfo<TestParam>& info) {
+    static const char* kImplementationNames[] = {"Reference", "Vector", "VectorAvx2"};
+    static const char* kFormatNames[] = {"NV21", "YV12", "YUYV"};
+    return std::string(kImplementationNames[static_cast<int>(info.param.implementation)]) + "_" +
+           kFormatNames[static_cast<int>(info.param.format)] +
+           (info.param.bgrx ? "_BGRx" : "_RGBx");
+}
+
+INSTANTIATE_TEST_SUITE_P(FormatConvertTests, FormatConvertTest,
+                         ::testing::ValuesIn(getTestParams()), getTestName);
+
+// The fixed point reference must stay within one LSB of the original floating point conversion.
+TEST(FormatConvertReferenceTest, testMatchesFloatingPointWithinOneLsb) {
+    const Implementation defaultImplementation = Utils::getImplementation();
+    Utils::setImplementation(Implementation::REFERENCE);
+
+    const unsigned width = 512;
+    const unsigned height = 256;
+    std::vector<uint8_t> src(width * height * 2);
+    std::vector<uint32_t> dst(width * height);
+    for (unsigned u = 0; u < 256; u++) {
+        for (unsigned v = 0; v < height; v++) {
+            uint8_t* row = src.data() + v * width * 2;
+            for (unsigned y = 0; y < 256; y++) {
+                row[y * 4 + 0] = y;
+                row[y * 4 + 1] = u;
+                row[y * 4 + 2] = y;
+                row[y * 4 + 3] = v;
+            }
+        }
+        Utils::copyYUYVtoRGB32(width, height, src.data(), width, dst.data(), width);
+
+        const float U = u - 128.0f;
+        for (unsigned v = 0; v < height; v++) {
+            const float V = v - 128.0f;
+            for (unsigned y = 0; y < 256; y++) {
+                const float expected[] = {y + 1.140f * V, y - 0.395f * U - 0.581f * V,
+                                          y + 2.032f * U};
+                const uint32_t pixel = dst[v * width + y * 2];
+                for (int channel = 0; channel < 3; channel++) {
+                    const int actual = (pixel >> (channel * 8)) & 0xFF;
+                    const int rounded = static_cast<int>(std::clamp(expected[channel], 0.f, 255.f));
+                    ASSERT_LE(std::abs(actual - rounded), 1)
+                            << "YUV: " << y << ", " << u << ", " << v << " channel: " << channel;
+                }
+            }
+        }
+    }
+
+    Utils::setImplementation(defaultImplementation);
+}
+
+}  // namespace
+}  // namespace android::hardware::automotive::evs::common
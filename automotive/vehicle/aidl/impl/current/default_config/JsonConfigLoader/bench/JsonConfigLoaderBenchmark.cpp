@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ConfigDeclarationCache.h>
+#include <JsonConfigLoader.h>
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+std::string getDefaultPropertiesPath() {
+    return android::base::GetExecutableDirectory() + "/DefaultProperties.json";
+}
+
+// Parses DefaultProperties.json, the cold boot path without a usable config cache.
+void BM_LoadPropConfig_Json(benchmark::State& state) {
+    std::string configPath = getDefaultPropertiesPath();
+    for (auto _ : state) {
+        JsonConfigLoader loader;
+        auto result = loader.loadPropConfig(configPath);
+        if (!result.ok()) {
+            state.SkipWithError(result.error().message().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_LoadPropConfig_Json)->Unit(benchmark::kMillisecond);
+
+// Loads DefaultProperties.json through the config cache, the boot path once the cache is built.
+// This includes reading and hashing the JSON file to validate the cache.
+void BM_LoadPropConfig_Cache(benchmark::State& state) {
+    std::string configPath = getDefaultPropertiesPath();
+    android::base::TemporaryDir cacheDir;
+    std::string cachePath = std::string(cacheDir.path) + "/DefaultProperties.bin";
+    {
+        JsonConfigLoader loader;
+        if (auto result = loader.loadPropConfig(configPath, cachePath); !result.ok()) {
+            state.SkipWithError(result.error().message().c_str());
+            return;
+        }
+    }
+    for (auto _ : state) {
+        JsonConfigLoader loader;
+        auto result = loader.loadPropConfig(configPath, cachePath);
+        benchmark::DoNotOptimize(result);
+    }
+    unlink(cachePath.c_str());
+}
+BENCHMARK(BM_LoadPropConfig_Cache)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef android_hardware_automotive_vehicle_aidl_impl_default_config_JsonConfigLoader_include_ConfigDeclarationCache_H_
+#define android_hardware_automotive_vehicle_aidl_impl_default_config_JsonConfigLoader_include_ConfigDeclarationCache_H_
+
+#include <ConfigDeclaration.h>
+
+#include <android-base/result.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+// ConfigDeclarationCache stores the ConfigDeclarations parsed from a JSON config file as a binary
+// snapshot, so that the following boots could load them directly instead of parsing the JSON
+// file again.
+//
+// A snapshot records the hash of the JSON content it is built from and is only loaded if the hash
+// matches, so the snapshot is rebuilt whenever the JSON file changes.
+class ConfigDeclarationCache final {
+  public:
+    // Returns the 64-bit FNV-1a hash of the content. {@code seed} could be the hash of the
+    // previous part to hash multiple parts.
+    static uint64_t hashContent(std::string_view content, uint64_t seed = FNV_OFFSET_BASIS);
+
+    // Writes the snapshot to {@code cachePath}. The snapshot is written to a temporary file first
+    // and renamed, so readers never see a partially written snapshot.
+    static android::base::Result<void> write(
+            const std::string& cachePath, uint64_t sourceHash,
+            const std::unordered_map<int32_t, ConfigDeclaration>& configsByPropId);
+
+    // Reads the snapshot from {@code cachePath}. Returns an error if the snapshot does not exist,
+    // is corrupted, or is not built from the content with {@code sourceHash}.
+    static android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>> read(
+            const std::string& cachePath, uint64_t sourceHash);
+
+  private:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325;
+};
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
+
+#endif  // android_hardware_automotive_vehicle_aidl_impl_default_config_JsonConfigLoader_include_ConfigDeclarationCache_H_
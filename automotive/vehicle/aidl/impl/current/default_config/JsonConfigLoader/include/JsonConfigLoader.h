@@ -22,6 +22,7 @@
 
 #include <android-base/result.h>
 #include <json/json.h>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -175,8 +176,18 @@ class JsonConfigParser {
 // A class to load vehicle property configs and initial values in JSON format.
 class JsonConfigLoader final {
   public:
+    // The version of the parsed output stored in the snapshots. Must be bumped whenever the parser
+    // could return different ConfigDeclarations for the same JSON content, so that the snapshots
+    // built by the previous version are rebuilt.
+    static constexpr uint32_t CACHE_LOADER_VERSION = 1;
+
     JsonConfigLoader();
 
+    // Returns the hash identifying the snapshots built from {@code content} by the loader at
+    // {@code loaderVersion} on the build {@code buildFingerprint}.
+    static uint64_t getCacheSourceHash(std::string_view content, uint32_t loaderVersion,
+                                       std::string_view buildFingerprint);
+
     // Loads a JSON file stream and parses it to a map from propId to ConfigDeclarations.
     android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>> loadPropConfig(
             std::istream& is);
@@ -185,6 +196,15 @@ class JsonConfigLoader final {
     android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>> loadPropConfig(
             const std::string& configPath);
 
+    // Same as {@code loadPropConfig(configPath)} except that the parsed configs are also stored
+    // as a binary snapshot at {@code cachePath}. The following calls load the configs from the
+    // snapshot directly without parsing the JSON file, as long as the JSON content, the loader
+    // version and the build fingerprint are unchanged.
+    //
+    // Failing to read or write the snapshot is not an error, the JSON file is parsed instead.
+    android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>> loadPropConfig(
+            const std::string& configPath, const std::string& cachePath);
+
   private:
     std::unique_ptr<jsonconfigloader_impl::JsonConfigParser> mParser;
 };
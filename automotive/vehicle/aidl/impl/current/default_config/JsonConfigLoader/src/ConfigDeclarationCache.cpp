@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ConfigDeclarationCache.h>
+
+#include <android-base/unique_fd.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::HasSupportedValueInfo;
+using ::aidl::android::hardware::automotive::vehicle::RawPropValues;
+using ::aidl::android::hardware::automotive::vehicle::VehicleAreaConfig;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropConfig;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyAccess;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyChangeMode;
+using ::android::base::Error;
+using ::android::base::ErrnoError;
+using ::android::base::Result;
+using ::android::base::unique_fd;
+
+constexpr char CACHE_MAGIC[8] = {'V', 'H', 'A', 'L', 'C', 'F', 'G', '\0'};
+// Must be increased whenever the layout below or ConfigDeclaration changes.
+constexpr uint32_t CACHE_VERSION = 1;
+constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t configCount;
+    uint64_t sourceHash;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+static_assert(sizeof(CacheHeader) == 40);
+
+// Appends the fields in the host byte order. The snapshot is only read by the device that wrote
+// it.
+class CacheWriter final {
+  public:
+    template <class T>
+    void write(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        mBuffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    void writeVector(const std::vector<T>& values) {
+        write<uint32_t>(values.size());
+        mBuffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        write<uint32_t>(value.size());
+        mBuffer.append(value);
+    }
+
+    void writeRawPropValues(const RawPropValues& values) {
+        writeVector(values.int32Values);
+        writeVector(values.floatValues);
+        writeVector(values.int64Values);
+        writeVector(values.byteValues);
+        writeString(values.stringValue);
+    }
+
+    void writeAreaConfig(const VehicleAreaConfig& areaConfig) {
+        write(areaConfig.areaId);
+        write(areaConfig.minInt32Value);
+        write(areaConfig.maxInt32Value);
+        write(areaConfig.minInt64Value);
+        write(areaConfig.maxInt64Value);
+        write(areaConfig.minFloatValue);
+        write(areaConfig.maxFloatValue);
+        write<uint8_t>(areaConfig.supportedEnumValues.has_value());
+        if (areaConfig.supportedEnumValues.has_value()) {
+            writeVector(*areaConfig.supportedEnumValues);
+        }
+        write(areaConfig.access);
+        write<uint8_t>(areaConfig.supportVariableUpdateRate);
+        write<uint8_t>(areaConfig.hasSupportedValueInfo.has_value());
+        if (areaConfig.hasSupportedValueInfo.has_value()) {
+            write<uint8_t>(areaConfig.hasSupportedValueInfo->hasMinSupportedValue);
+            write<uint8_t>(areaConfig.hasSupportedValueInfo->hasMaxSupportedValue);
+            write<uint8_t>(areaConfig.hasSupportedValueInfo->hasSupportedValuesList);
+        }
+    }
+
+    void writeConfigDeclaration(const ConfigDeclaration& configDeclaration) {
+        const VehiclePropConfig& config = configDeclaration.config;
+        write(config.prop);
+        write(config.access);
+        write(config.changeMode);
+        write<uint32_t>(config.areaConfigs.size());
+        for (const auto& areaConfig : config.areaConfigs) {
+            writeAreaConfig(areaConfig);
+        }
+        writeVector(config.configArray);
+        writeString(config.configString);
+        write(config.minSampleRate);
+        write(config.maxSampleRate);
+
+        writeRawPropValues(configDeclaration.initialValue);
+        write<uint32_t>(configDeclaration.initialAreaValues.size());
+        for (const auto& [areaId, values] : configDeclaration.initialAreaValues) {
+            write(areaId);
+            writeRawPropValues(values);
+        }
+        write<uint32_t>(configDeclaration.supportedValuesForAreaId.size());
+        for (const auto& [areaId, values] : configDeclaration.supportedValuesForAreaId) {
+            write(areaId);
+            writeVector(values);
+        }
+    }
+
+    const std::string& buffer() const { return mBuffer; }
+
+  private:
+    std::string mBuffer;
+};
+
+// Reads the fields written by CacheWriter. Once a read runs past the end, all the following reads
+// fail and ok() returns false.
+class CacheReader final {
+  public:
+    CacheReader(const uint8_t* data, size_t size) : mData(data), mRemaining(size) {}
+
+    bool ok() const { return mOk; }
+
+    template <class T>
+    T read() {
+        T value = {};
+        if (!consume(sizeof(T))) {
+            return value;
+        }
+        memcpy(&value, mData - sizeof(T), sizeof(T));
+        return value;
+    }
+
+    template <class T>
+    void readVector(std::vector<T>* values) {
+        uint32_t count = read<uint32_t>();
+        if (!mOk || count > mRemaining / sizeof(T)) {
+            mOk = false;
+            return;
+        }
+        values->resize(count);
+        if (count > 0) {
+            memcpy(values->data(), mData, count * sizeof(T));
+        }
+        consume(count * sizeof(T));
+    }
+
+    void readString(std::string* value) {
+        uint32_t size = read<uint32_t>();
+        if (!mOk || size > mRemaining) {
+            mOk = false;
+            return;
+        }
+        value->assign(reinterpret_cast<const char*>(mData), size);
+        consume(size);
+    }
+
+    void readRawPropValues(RawPropValues* values) {
+        readVector(&values->int32Values);
+        readVector(&values->floatValues);
+        readVector(&values->int64Values);
+        readVector(&values->byteValues);
+        readString(&values->stringValue);
+    }
+
+    void readAreaConfig(VehicleAreaConfig* areaConfig) {
+        areaConfig->areaId = read<int32_t>();
+        areaConfig->minInt32Value = read<int32_t>();
+        areaConfig->maxInt32Value = read<int32_t>();
+        areaConfig->minInt64Value = read<int64_t>();
+        areaConfig->maxInt64Value = read<int64_t>();
+        areaConfig->minFloatValue = read<float>();
+        areaConfig->maxFloatValue = read<float>();
+        if (read<uint8_t>()) {
+            readVector(&areaConfig->supportedEnumValues.emplace());
+        }
+        areaConfig->access = read<VehiclePropertyAccess>();
+        areaConfig->supportVariableUpdateRate = read<uint8_t>();
+        if (read<uint8_t>()) {
+            HasSupportedValueInfo& info = areaConfig->hasSupportedValueInfo.emplace();
+            info.hasMinSupportedValue = read<uint8_t>();
+            info.hasMaxSupportedValue = read<uint8_t>();
+            info.hasSupportedValuesList = read<uint8_t>();
+        }
+    }
+
+    void readConfigDeclaration(ConfigDeclaration* configDeclaration) {
+        VehiclePropConfig& config = configDeclaration->config;
+        config.prop = read<int32_t>();
+        config.access = read<VehiclePropertyAccess>();
+        config.changeMode = read<VehiclePropertyChangeMode>();
+        uint32_t areaConfigCount = read<uint32_t>();
+        // Each area config takes more than one byte.
+        if (!mOk || areaConfigCount > mRemaining) {
+            mOk = false;
+            return;
+        }
+        config.areaConfigs.resize(areaConfigCount);
+        for (auto& areaConfig : config.areaConfigs) {
+            readAreaConfig(&areaConfig);
+        }
+        readVector(&config.configArray);
+        readString(&config.configString);
+        config.minSampleRate = read<float>();
+        config.maxSampleRate = read<float>();
+
+        readRawPropValues(&configDeclaration->initialValue);
+        uint32_t initialAreaValueCount = read<uint32_t>();
+        for (uint32_t i = 0; mOk && i < initialAreaValueCount; i++) {
+            int32_t areaId = read<int32_t>();
+            readRawPropValues(&configDeclaration->initialAreaValues[areaId]);
+        }
+        uint32_t supportedValuesCount = read<uint32_t>();
+        for (uint32_t i = 0; mOk && i < supportedValuesCount; i++) {
+            int32_t areaId = read<int32_t>();
+            readVector(&configDeclaration->supportedValuesForAreaId[areaId]);
+        }
+    }
+
+    size_t remaining() const { return mRemaining; }
+
+  private:
+    const uint8_t* mData;
+    size_t mRemaining;
+    bool mOk = true;
+
+    bool consume(size_t size) {
+        if (!mOk || size > mRemaining) {
+            mOk = false;
+            return false;
+        }
+        mData += size;
+        mRemaining -= size;
+        return true;
+    }
+};
+
+// Unmaps the snapshot when the read finishes.
+class MappedFile final {
+  public:
+    MappedFile(void* data, size_t size) : mData(data), mSize(size) {}
+    ~MappedFile() { munmap(mData, mSize); }
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(mData); }
+
+  private:
+    void* mData;
+    size_t mSize;
+};
+
+}  // namespace
+
+uint64_t ConfigDeclarationCache::hashContent(std::string_view content, uint64_t seed) {
+    uint64_t hash = seed;
+    for (char c : content) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+Result<void> ConfigDeclarationCache::write(
+        const std::string& cachePath, uint64_t sourceHash,
+        const std::unordered_map<int32_t, ConfigDeclaration>& configsByPropId) {
+    CacheWriter writer;
+    for (const auto& [_, configDeclaration] : configsByPropId) {
+        writer.writeConfigDeclaration(configDeclaration);
+    }
+    const std::string& payload = writer.buffer();
+    CacheHeader header = {
+            .version = CACHE_VERSION,
+            .configCount = static_cast<uint32_t>(configsByPropId.size()),
+            .sourceHash = sourceHash,
+            .payloadSize = payload.size(),
+            .payloadHash = hashContent(payload),
+    };
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+
+    std::string tmpPath = cachePath + ".tmp";
+    unique_fd fd(TEMP_FAILURE_RETRY(
+            ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)));
+    if (fd.get() < 0) {
+        return ErrnoError() << "failed to create config cache: " << tmpPath;
+    }
+    for (std::string_view data : {std::string_view(reinterpret_cast<const char*>(&header),
+                                                   sizeof(header)),
+                                  std::string_view(payload)}) {
+        while (!data.empty()) {
+            ssize_t written = TEMP_FAILURE_RETRY(::write(fd.get(), data.data(), data.size()));
+            if (written < 0) {
+                unlink(tmpPath.c_str());
+                return ErrnoError() << "failed to write config cache: " << tmpPath;
+            }
+            data.remove_prefix(written);
+        }
+    }
+    if (fsync(fd.get()) != 0 || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return ErrnoError() << "failed to commit config cache: " << cachePath;
+    }
+    return {};
+}
+
+Result<std::unordered_map<int32_t, ConfigDeclaration>> ConfigDeclarationCache::read(
+        const std::string& cachePath, uint64_t sourceHash) {
+    unique_fd fd(TEMP_FAILURE_RETRY(::open(cachePath.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return ErrnoError() << "failed to open config cache: " << cachePath;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0) {
+        return ErrnoError() << "failed to stat config cache: " << cachePath;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(CacheHeader)) {
+        return Error() << "config cache: " << cachePath << " is too small";
+    }
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (mapped == MAP_FAILED) {
+        return ErrnoError() << "failed to mmap config cache: " << cachePath;
+    }
+    MappedFile file(mapped, fileSize);
+
+    CacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) {
+        return Error() << "file: " << cachePath << " is not a config cache";
+    }
+    if (header.version != CACHE_VERSION) {
+        return Error() << "unsupported config cache version: " << header.version;
+    }
+    if (header.sourceHash != sourceHash) {
+        return Error() << "config cache: " << cachePath << " is outdated";
+    }
+    std::string_view payload(reinterpret_cast<const char*>(file.data()) + sizeof(header),
+                             fileSize - sizeof(header));
+    if (header.payloadSize != payload.size() || header.payloadHash != hashContent(payload)) {
+        return Error() << "config cache: " << cachePath << " is corrupted";
+    }
+
+    std::unordered_map<int32_t, ConfigDeclaration> configsByPropId;
+    configsByPropId.reserve(header.configCount);
+    CacheReader reader(file.data() + sizeof(header), payload.size());
+    for (uint32_t i = 0; i < header.configCount && reader.ok(); i++) {
+        ConfigDeclaration configDeclaration;
+        reader.readConfigDeclaration(&configDeclaration);
+        int32_t propId = configDeclaration.config.prop;
+        configsByPropId[propId] = std::move(configDeclaration);
+    }
+    if (!reader.ok() || reader.remaining() != 0) {
+        return Error() << "config cache: " << cachePath << " is corrupted";
+    }
+    return configsByPropId;
+}
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
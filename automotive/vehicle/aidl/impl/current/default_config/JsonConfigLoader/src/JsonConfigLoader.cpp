@@ -14,18 +14,26 @@
  * limitations under the License.
  */
 
+#define LOG_TAG "JsonConfigLoader"
+
 #include <JsonConfigLoader.h>
 
 #include <AccessForVehicleProperty.h>
 #include <ChangeModeForVehicleProperty.h>
+#include <ConfigDeclarationCache.h>
 #include <PropertyUtils.h>
 
 #ifdef ENABLE_VEHICLE_HAL_TEST_PROPERTIES
 #include <android/hardware/automotive/vehicle/TestVendorProperty.h>
 #endif  // ENABLE_VEHICLE_HAL_TEST_PROPERTIES
 
+#include <android-base/file.h>
+#include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <utils/Log.h>
+
 #include <fstream>
+#include <sstream>
 
 namespace android {
 namespace hardware {
@@ -828,6 +836,23 @@ JsonConfigLoader::JsonConfigLoader() {
     mParser = std::make_unique<jsonconfigloader_impl::JsonConfigParser>();
 }
 
+uint64_t JsonConfigLoader::getCacheSourceHash(std::string_view content, uint32_t loaderVersion,
+                                              std::string_view buildFingerprint) {
+    // The constant names resolved while parsing depend on whether the test properties are
+    // enabled, so the snapshots built by the two variants must not be shared.
+#ifdef ENABLE_VEHICLE_HAL_TEST_PROPERTIES
+    uint64_t sourceHash = ConfigDeclarationCache::hashContent("test-properties:");
+#else
+    uint64_t sourceHash = ConfigDeclarationCache::hashContent("default:");
+#endif  // ENABLE_VEHICLE_HAL_TEST_PROPERTIES
+    // The constants and the parser could change with an OTA even if the JSON file does not.
+    sourceHash = ConfigDeclarationCache::hashContent(std::to_string(loaderVersion) + ":",
+                                                     sourceHash);
+    sourceHash = ConfigDeclarationCache::hashContent(buildFingerprint, sourceHash);
+    sourceHash = ConfigDeclarationCache::hashContent(":", sourceHash);
+    return ConfigDeclarationCache::hashContent(content, sourceHash);
+}
+
 android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>>
 JsonConfigLoader::loadPropConfig(std::istream& is) {
     return mParser->parseJsonConfig(is);
@@ -843,6 +868,35 @@ JsonConfigLoader::loadPropConfig(const std::string& configPath) {
     return loadPropConfig(ifs);
 }
 
+android::base::Result<std::unordered_map<int32_t, ConfigDeclaration>>
+JsonConfigLoader::loadPropConfig(const std::string& configPath, const std::string& cachePath) {
+    std::string content;
+    if (!android::base::ReadFileToString(configPath, &content)) {
+        return android::base::Error() << "couldn't open " << configPath << " for parsing.";
+    }
+    uint64_t sourceHash = getCacheSourceHash(content, CACHE_LOADER_VERSION,
+                                             android::base::GetProperty("ro.build.fingerprint", ""));
+
+    auto cachedResult = ConfigDeclarationCache::read(cachePath, sourceHash);
+    if (cachedResult.ok()) {
+        return cachedResult;
+    }
+    ALOGI("config cache is not usable, parsing %s, reason: %s", configPath.c_str(),
+          cachedResult.error().message().c_str());
+
+    std::istringstream is(content);
+    auto result = loadPropConfig(is);
+    if (!result.ok()) {
+        return result;
+    }
+    if (auto writeResult = ConfigDeclarationCache::write(cachePath, sourceHash, *result);
+        !writeResult.ok()) {
+        ALOGW("failed to write config cache for %s, error: %s", configPath.c_str(),
+              writeResult.error().message().c_str());
+    }
+    return result;
+}
+
 }  // namespace vehicle
 }  // namespace automotive
 }  // namespace hardware
@@ -16,8 +16,11 @@
 
 #include <JsonConfigLoader.h>
 
+#include <ConfigDeclarationCache.h>
 #include <PropertyUtils.h>
 
+#include <android-base/file.h>
+#include <android-base/properties.h>
 #include <gtest/gtest.h>
 #include <sstream>
 
@@ -34,11 +37,69 @@ using ::aidl::android::hardware::automotive::vehicle::VehicleProperty;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyAccess;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyChangeMode;
 
+namespace {
+
+constexpr char CACHE_TEST_CONFIG[] = R"(
+{
+    "properties": [
+        {
+            "property": "VehicleProperty::INFO_FUEL_CAPACITY",
+            "defaultValue": {
+                "floatValues": [1.5]
+            },
+            "configArray": [1, 2],
+            "configString": "config"
+        },
+        {
+            "property": "VehicleProperty::HVAC_FAN_SPEED",
+            "areas": [
+                {
+                    "areaId": 1,
+                    "minInt32Value": 1,
+                    "maxInt32Value": 7,
+                    "supportedEnumValues": [1, 2, 3],
+                    "defaultValue": {
+                        "int32Values": [3]
+                    },
+                    "hasSupportedValueInfo": {
+                        "hasMinSupportedValue": true,
+                        "hasMaxSupportedValue": true,
+                        "hasSupportedValuesList": false
+                    }
+                },
+                {
+                    "areaId": 2,
+                    "defaultValue": {
+                        "int64Values": [4],
+                        "stringValue": "area"
+                    }
+                }
+            ]
+        }
+    ]
+}
+)";
+
+}  // namespace
+
 class JsonConfigLoaderUnitTest : public ::testing::Test {
   protected:
     JsonConfigLoader mLoader;
 };
 
+class JsonConfigLoaderCacheUnitTest : public JsonConfigLoaderUnitTest {
+  protected:
+    void SetUp() override {
+        mConfigPath = std::string(mTempDir.path) + "/config.json";
+        mCachePath = std::string(mTempDir.path) + "/config.bin";
+        ASSERT_TRUE(android::base::WriteStringToFile(CACHE_TEST_CONFIG, mConfigPath));
+    }
+
+    android::base::TemporaryDir mTempDir;
+    std::string mConfigPath;
+    std::string mCachePath;
+};
+
 TEST_F(JsonConfigLoaderUnitTest, testBasic) {
     std::istringstream iss(R"(
     {
@@ -1075,6 +1136,140 @@ TEST_F(JsonConfigLoaderUnitTest, testHasSupportedValueInfo_unspecified) {
     ASSERT_EQ(areaConfig.hasSupportedValueInfo, std::nullopt);
 }
 
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache) {
+    auto result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_TRUE(access(mCachePath.c_str(), F_OK) == 0) << "the cache must be written";
+
+    auto cachedResult = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(cachedResult.ok()) << cachedResult.error().message();
+
+    std::istringstream iss(CACHE_TEST_CONFIG);
+    auto expectedResult = mLoader.loadPropConfig(iss);
+    ASSERT_TRUE(expectedResult.ok()) << expectedResult.error().message();
+
+    ASSERT_EQ(*result, *expectedResult);
+    ASSERT_EQ(*cachedResult, *expectedResult);
+    for (const auto& [propId, configDeclaration] : *expectedResult) {
+        EXPECT_EQ(cachedResult->at(propId).supportedValuesForAreaId,
+                  configDeclaration.supportedValuesForAreaId);
+    }
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testConfigDeclarationCache_readWrite) {
+    std::string content;
+    ASSERT_TRUE(android::base::ReadFileToString(mConfigPath, &content));
+    std::istringstream iss(content);
+    auto expectedResult = mLoader.loadPropConfig(iss);
+    ASSERT_TRUE(expectedResult.ok()) << expectedResult.error().message();
+    ASSERT_TRUE(ConfigDeclarationCache::write(mCachePath, /*sourceHash=*/1, *expectedResult).ok());
+
+    auto result = ConfigDeclarationCache::read(mCachePath, /*sourceHash=*/1);
+
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(*result, *expectedResult);
+    ASSERT_FALSE(ConfigDeclarationCache::read(mCachePath, /*sourceHash=*/2).ok())
+            << "cache built from a different source must not be loaded";
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache_outdatedCache) {
+    ASSERT_TRUE(mLoader.loadPropConfig(mConfigPath, mCachePath).ok());
+
+    ASSERT_TRUE(android::base::WriteStringToFile(R"(
+    {
+        "properties": [{
+            "property": 291504388
+        }]
+    }
+    )",
+                                                 mConfigPath));
+
+    auto result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(result->size(), 1u);
+    ASSERT_EQ(result->begin()->second.config.prop, 291504388);
+
+    // The cache must be rebuilt from the new content.
+    auto cachedResult = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(cachedResult.ok()) << cachedResult.error().message();
+    ASSERT_EQ(*cachedResult, *result);
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache_loaderVersionChanged) {
+    std::string content;
+    ASSERT_TRUE(android::base::ReadFileToString(mConfigPath, &content));
+    std::string fingerprint = android::base::GetProperty("ro.build.fingerprint", "");
+    // An empty snapshot, so that loading it could be told apart from parsing the JSON file.
+    std::unordered_map<int32_t, ConfigDeclaration> emptyConfigs;
+
+    ASSERT_TRUE(ConfigDeclarationCache::write(
+                        mCachePath,
+                        JsonConfigLoader::getCacheSourceHash(
+                                content, JsonConfigLoader::CACHE_LOADER_VERSION, fingerprint),
+                        emptyConfigs)
+                        .ok());
+    auto result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_TRUE(result->empty()) << "snapshot built by the same loader must be loaded";
+
+    ASSERT_TRUE(ConfigDeclarationCache::write(
+                        mCachePath,
+                        JsonConfigLoader::getCacheSourceHash(
+                                content, JsonConfigLoader::CACHE_LOADER_VERSION - 1, fingerprint),
+                        emptyConfigs)
+                        .ok());
+    result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(result->size(), 2u) << "snapshot built by another loader version must be rebuilt";
+
+    ASSERT_TRUE(ConfigDeclarationCache::write(
+                        mCachePath,
+                        JsonConfigLoader::getCacheSourceHash(
+                                content, JsonConfigLoader::CACHE_LOADER_VERSION,
+                                fingerprint + ".old"),
+                        emptyConfigs)
+                        .ok());
+    result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(result->size(), 2u) << "snapshot built on another build must be rebuilt";
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache_corruptedCache) {
+    ASSERT_TRUE(mLoader.loadPropConfig(mConfigPath, mCachePath).ok());
+    std::string cache;
+    ASSERT_TRUE(android::base::ReadFileToString(mCachePath, &cache));
+
+    std::string corrupted = cache;
+    corrupted[corrupted.size() - 1] ^= 0xff;
+    ASSERT_TRUE(android::base::WriteStringToFile(corrupted, mCachePath));
+
+    auto result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(result->size(), 2u);
+    std::string rebuiltCache;
+    ASSERT_TRUE(android::base::ReadFileToString(mCachePath, &rebuiltCache));
+    ASSERT_EQ(rebuiltCache, cache) << "corrupted cache must be rebuilt";
+
+    ASSERT_TRUE(android::base::WriteStringToFile(cache.substr(0, cache.size() / 2), mCachePath));
+
+    result = mLoader.loadPropConfig(mConfigPath, mCachePath);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    ASSERT_EQ(result->size(), 2u);
+    ASSERT_TRUE(android::base::ReadFileToString(mCachePath, &rebuiltCache));
+    ASSERT_EQ(rebuiltCache, cache) << "truncated cache must be rebuilt";
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache_cacheNotWritable) {
+    auto result = mLoader.loadPropConfig(mConfigPath, "/non/existing/dir/config.bin");
+
+    ASSERT_TRUE(result.ok()) << "failing to write the cache must not cause error";
+    ASSERT_EQ(result->size(), 2u);
+}
+
+TEST_F(JsonConfigLoaderCacheUnitTest, testLoadPropConfigWithCache_missingConfig) {
+    ASSERT_FALSE(mLoader.loadPropConfig(mConfigPath + ".missing", mCachePath).ok());
+}
+
 }  // namespace vehicle
 }  // namespace automotive
 }  // namespace hardware
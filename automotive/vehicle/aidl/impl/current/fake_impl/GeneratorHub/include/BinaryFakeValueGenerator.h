@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_BinaryFakeValueGenerator_H_
+#define android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_BinaryFakeValueGenerator_H_
+
+#include "FakeValueGenerator.h"
+#include "FakeValueRecording.h"
+
+#include <memory>
+#include <string>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+namespace fake {
+
+// Replays the events in a binary recording (see {@code FakeValueRecording}) the same way as
+// {@code JsonFakeValueGenerator}, but streams the events from the memory mapped file instead of
+// loading all of them into memory.
+class BinaryFakeValueGenerator : public FakeValueGenerator {
+  public:
+    // Create a new binary fake value generator. {@code request.value.stringValue} is the recording
+    // file name. {@code request.value.int32Values[1]} if exists, is the number of iterations. If
+    // {@code int32Values} has less than 2 elements, number of iterations would be set to -1, which
+    // means iterate indefinitely.
+    explicit BinaryFakeValueGenerator(
+            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& request);
+    // Create a new binary fake value generator using the specified recording file path. All the
+    // events in the recording would be generated for number of {@code iteration}. If iteration is
+    // 0, no value would be generated. If iteration is less than 0, it would iterate indefinitely.
+    explicit BinaryFakeValueGenerator(const std::string& path, int32_t iteration);
+
+    ~BinaryFakeValueGenerator() = default;
+
+    std::optional<aidl::android::hardware::automotive::vehicle::VehiclePropValue> nextEvent()
+            override;
+
+    // Whether there are events left to replay for this generator.
+    bool hasNext();
+
+    // Continues the replay from the first event recorded at or after {@code timestamp}. The event
+    // is generated 1ms after the last generated event. If there is no such event, the current
+    // iteration ends.
+    void seekToTimestamp(int64_t timestamp);
+
+  private:
+    std::unique_ptr<FakeValueRecording> mRecording;
+    size_t mEventIndex = 0;
+    int64_t mLastEventTimestamp = 0;
+    // The recorded timestamp of the last generated event, if the next event follows it in the
+    // recording.
+    std::optional<int64_t> mLastRecordedTimestamp;
+    int32_t mNumOfIterations = 0;
+
+    void init(const std::string& path, int32_t iteration);
+    void endIteration();
+};
+
+}  // namespace fake
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
+
+#endif  // android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_BinaryFakeValueGenerator_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_FakeValueRecording_H_
+#define android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_FakeValueRecording_H_
+
+#include <VehicleHalTypes.h>
+
+#include <android-base/result.h>
+
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+namespace fake {
+
+// A binary recording of VHAL property events. Unlike the JSON format, a recording is replayed
+// directly from a memory mapped file, so the memory usage does not depend on the recording length.
+//
+// A recording file consists of:
+//   * A header: the magic "VHALREC\0", the format version, the event count and the index offset.
+//   * The events. Each event is a fixed size header with timestamp, prop, areaId, status and the
+//     value vector sizes, followed by the int64Values, int32Values, floatValues, byteValues and
+//     stringValue. Each event is padded to 8 bytes.
+//   * The index: the file offset of each event as uint64_t.
+// All the numbers are in the host byte order. The events are ordered by timestamp.
+class FakeValueRecording final {
+  public:
+    // Maps the recording file at path.
+    static android::base::Result<std::unique_ptr<FakeValueRecording>> open(
+            const std::string& path);
+    // Returns whether the file at path starts with the recording magic.
+    static bool isRecordingFile(const std::string& path);
+
+    ~FakeValueRecording();
+
+    FakeValueRecording(const FakeValueRecording&) = delete;
+    FakeValueRecording& operator=(const FakeValueRecording&) = delete;
+
+    // Returns the number of events in the recording.
+    size_t size() const;
+
+    // Returns the recorded timestamp of the event at index.
+    int64_t getTimestamp(size_t index) const;
+
+    // Returns the event at index, or {@code std::nullopt} if the event is corrupted.
+    std::optional<aidl::android::hardware::automotive::vehicle::VehiclePropValue> getEvent(
+            size_t index) const;
+
+    // Returns the index of the first event with timestamp equal to or larger than the given
+    // timestamp, or {@code size()} if there is none.
+    size_t lowerBound(int64_t timestamp) const;
+
+  private:
+    FakeValueRecording(const uint8_t* data, size_t fileSize, size_t eventCount,
+                       uint64_t indexOffset);
+
+    uint64_t getEventOffset(size_t index) const;
+
+    const uint8_t* mData;
+    const size_t mFileSize;
+    const size_t mEventCount;
+    const uint64_t mIndexOffset;
+};
+
+// Writes events into a binary recording file. The events must be appended in timestamp order.
+class FakeValueRecordingWriter final {
+  public:
+    // Creates the recording file at path. An existing file would be overwritten.
+    static android::base::Result<std::unique_ptr<FakeValueRecordingWriter>> create(
+            const std::string& path);
+
+    // Appends an event to the recording.
+    android::base::Result<void> append(
+            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& event);
+
+    // Writes the index and the header. No event could be appended after this.
+    android::base::Result<void> finish();
+
+  private:
+    explicit FakeValueRecordingWriter(std::ofstream&& ofs);
+
+    std::ofstream mOfs;
+    uint64_t mOffset;
+    std::optional<int64_t> mLastTimestamp;
+    // The event offsets, written to the end of the file by {@code finish}.
+    std::vector<uint64_t> mEventOffsets;
+    bool mFinished = false;
+};
+
+}  // namespace fake
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
+
+#endif  // android_hardware_automotive_vehicle_aidl_impl_fake_impl_GeneratorHub_include_FakeValueRecording_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BinaryFakeValueGenerator"
+
+#include "BinaryFakeValueGenerator.h"
+
+#include <utils/Log.h>
+#include <utils/SystemClock.h>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+namespace fake {
+
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+
+BinaryFakeValueGenerator::BinaryFakeValueGenerator(const std::string& path, int32_t iteration) {
+    init(path, iteration);
+}
+
+BinaryFakeValueGenerator::BinaryFakeValueGenerator(const VehiclePropValue& request) {
+    const auto& v = request.value;
+    // Iterate infinitely if iteration number is not provided
+    int32_t numOfIterations = v.int32Values.size() < 2 ? -1 : v.int32Values[1];
+
+    init(v.stringValue, numOfIterations);
+}
+
+void BinaryFakeValueGenerator::init(const std::string& path, int32_t iteration) {
+    auto result = FakeValueRecording::open(path);
+    if (!result.ok()) {
+        ALOGE("%s: failed to open recording, error: %s", __func__,
+              result.error().message().c_str());
+        return;
+    }
+    mRecording = std::move(result.value());
+    mNumOfIterations = iteration;
+}
+
+std::optional<VehiclePropValue> BinaryFakeValueGenerator::nextEvent() {
+    if (!hasNext()) {
+        return std::nullopt;
+    }
+
+    std::optional<VehiclePropValue> generatedValue = mRecording->getEvent(mEventIndex);
+    if (!generatedValue.has_value()) {
+        // The recording is corrupted from here, stop generating.
+        mNumOfIterations = 0;
+        return std::nullopt;
+    }
+
+    if (mLastEventTimestamp == 0) {
+        mLastEventTimestamp = elapsedRealtimeNano();
+    } else if (mLastRecordedTimestamp.has_value()) {
+        // The event is supposed to happen with a delay equals to the duration between the previous
+        // and the current event.
+        mLastEventTimestamp += generatedValue->timestamp - *mLastRecordedTimestamp;
+    } else {
+        // We are starting another iteration or have seeked, immediately send the next event
+        // after 1ms.
+        mLastEventTimestamp += 1000000;
+    }
+    mLastRecordedTimestamp = generatedValue->timestamp;
+
+    mEventIndex++;
+    if (mEventIndex == mRecording->size()) {
+        endIteration();
+    }
+    generatedValue->timestamp = mLastEventTimestamp;
+
+    return generatedValue;
+}
+
+bool BinaryFakeValueGenerator::hasNext() {
+    return mRecording != nullptr && mNumOfIterations != 0 && mRecording->size() > 0;
+}
+
+void BinaryFakeValueGenerator::seekToTimestamp(int64_t timestamp) {
+    if (!hasNext()) {
+        return;
+    }
+    mEventIndex = mRecording->lowerBound(timestamp);
+    mLastRecordedTimestamp.reset();
+    if (mEventIndex == mRecording->size()) {
+        endIteration();
+    }
+}
+
+void BinaryFakeValueGenerator::endIteration() {
+    mEventIndex = 0;
+    mLastRecordedTimestamp.reset();
+    if (mNumOfIterations > 0) {
+        mNumOfIterations--;
+    }
+}
+
+}  // namespace fake
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FakeValueRecording"
+
+#include "FakeValueRecording.h"
+
+#include <android-base/unique_fd.h>
+#include <utils/Log.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+namespace fake {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyStatus;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+using ::android::base::Error;
+using ::android::base::ErrnoError;
+using ::android::base::Result;
+using ::android::base::unique_fd;
+
+constexpr char RECORDING_MAGIC[8] = {'V', 'H', 'A', 'L', 'R', 'E', 'C', '\0'};
+constexpr uint32_t RECORDING_VERSION = 1;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t eventCount;
+    uint64_t indexOffset;
+};
+
+struct RecordedEventHeader {
+    int64_t timestamp;
+    int32_t prop;
+    int32_t areaId;
+    int32_t status;
+    uint32_t int32Count;
+    uint32_t int64Count;
+    uint32_t floatCount;
+    uint32_t byteCount;
+    uint32_t stringSize;
+};
+
+static_assert(sizeof(RecordingHeader) == 32);
+static_assert(sizeof(RecordedEventHeader) == 40);
+
+uint64_t alignTo8(uint64_t size) {
+    return (size + 7) & ~static_cast<uint64_t>(7);
+}
+
+uint64_t getPayloadSize(const RecordedEventHeader& header) {
+    return static_cast<uint64_t>(header.int64Count) * sizeof(int64_t) +
+           static_cast<uint64_t>(header.int32Count) * sizeof(int32_t) +
+           static_cast<uint64_t>(header.floatCount) * sizeof(float) + header.byteCount +
+           header.stringSize;
+}
+
+// The recording is memory mapped, so the data might not be aligned for T.
+template <typename T>
+T readAt(const uint8_t* data, uint64_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+const uint8_t* readVector(const uint8_t* data, size_t count, std::vector<T>* dest) {
+    dest->resize(count);
+    if (count > 0) {
+        memcpy(dest->data(), data, count * sizeof(T));
+    }
+    return data + count * sizeof(T);
+}
+
+template <typename T>
+void writeVector(std::ofstream& ofs, const std::vector<T>& values) {
+    ofs.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+}  // namespace
+
+Result<std::unique_ptr<FakeValueRecording>> FakeValueRecording::open(const std::string& path) {
+    unique_fd fd(TEMP_FAILURE_RETRY(::open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return ErrnoError() << "failed to open recording: " << path;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0) {
+        return ErrnoError() << "failed to stat recording: " << path;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(RecordingHeader)) {
+        return Error() << "recording: " << path << " is too small";
+    }
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (mapped == MAP_FAILED) {
+        return ErrnoError() << "failed to mmap recording: " << path;
+    }
+    // The events are mostly read in order.
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+
+    const uint8_t* data = static_cast<const uint8_t*>(mapped);
+    auto header = readAt<RecordingHeader>(data, 0);
+    // The recording unmaps the file if it is invalid.
+    std::unique_ptr<FakeValueRecording> recording(
+            new FakeValueRecording(data, fileSize, header.eventCount, header.indexOffset));
+    if (memcmp(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        return Error() << "file: " << path << " is not a recording";
+    }
+    if (header.version != RECORDING_VERSION) {
+        return Error() << "unsupported recording version: " << header.version;
+    }
+    // The events, if any, are stored between the header and the index.
+    uint64_t minIndexOffset =
+            sizeof(RecordingHeader) + (header.eventCount > 0 ? sizeof(RecordedEventHeader) : 0);
+    if (header.indexOffset < minIndexOffset || header.indexOffset > fileSize ||
+        header.eventCount > (fileSize - header.indexOffset) / sizeof(uint64_t)) {
+        return Error() << "recording: " << path << " has an invalid index";
+    }
+    // Only checks the index here, each event is checked when it is read. There must be space for
+    // each event header before the next event.
+    uint64_t minOffset = sizeof(RecordingHeader);
+    for (size_t i = 0; i < recording->size(); i++) {
+        uint64_t offset = recording->getEventOffset(i);
+        if (offset < minOffset || offset + sizeof(RecordedEventHeader) > header.indexOffset) {
+            return Error() << "recording: " << path << " has an invalid offset for event: " << i;
+        }
+        minOffset = offset + sizeof(RecordedEventHeader);
+    }
+    return recording;
+}
+
+bool FakeValueRecording::isRecordingFile(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    char magic[sizeof(RECORDING_MAGIC)];
+    if (!ifs.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return memcmp(magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) == 0;
+}
+
+FakeValueRecording::FakeValueRecording(const uint8_t* data, size_t fileSize, size_t eventCount,
+                                       uint64_t indexOffset)
+    : mData(data), mFileSize(fileSize), mEventCount(eventCount), mIndexOffset(indexOffset) {}
+
+FakeValueRecording::~FakeValueRecording() {
+    munmap(const_cast<uint8_t*>(mData), mFileSize);
+}
+
+size_t FakeValueRecording::size() const {
+    return mEventCount;
+}
+
+uint64_t FakeValueRecording::getEventOffset(size_t index) const {
+    return readAt<uint64_t>(mData, mIndexOffset + index * sizeof(uint64_t));
+}
+
+int64_t FakeValueRecording::getTimestamp(size_t index) const {
+    return readAt<int64_t>(mData,
+                           getEventOffset(index) + offsetof(RecordedEventHeader, timestamp));
+}
+
+std::optional<VehiclePropValue> FakeValueRecording::getEvent(size_t index) const {
+    uint64_t offset = getEventOffset(index);
+    auto header = readAt<RecordedEventHeader>(mData, offset);
+    uint64_t end = (index + 1 < mEventCount) ? getEventOffset(index + 1) : mIndexOffset;
+    if (getPayloadSize(header) > end - offset - sizeof(RecordedEventHeader)) {
+        ALOGE("%s: event %zu in the recording is corrupted", __func__, index);
+        return std::nullopt;
+    }
+
+    VehiclePropValue event = {
+            .timestamp = header.timestamp,
+            .areaId = header.areaId,
+            .prop = header.prop,
+            .status = static_cast<VehiclePropertyStatus>(header.status),
+    };
+    auto& value = event.value;
+    const uint8_t* payload = mData + offset + sizeof(RecordedEventHeader);
+    payload = readVector(payload, header.int64Count, &value.int64Values);
+    payload = readVector(payload, header.int32Count, &value.int32Values);
+    payload = readVector(payload, header.floatCount, &value.floatValues);
+    payload = readVector(payload, header.byteCount, &value.byteValues);
+    value.stringValue.assign(reinterpret_cast<const char*>(payload), header.stringSize);
+    return event;
+}
+
+size_t FakeValueRecording::lowerBound(int64_t timestamp) const {
+    size_t low = 0;
+    size_t high = mEventCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (getTimestamp(mid) < timestamp) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+Result<std::unique_ptr<FakeValueRecordingWriter>> FakeValueRecordingWriter::create(
+        const std::string& path) {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        return Error() << "failed to create recording: " << path;
+    }
+    std::unique_ptr<FakeValueRecordingWriter> writer(
+            new FakeValueRecordingWriter(std::move(ofs)));
+    // The header is written again with the event count and index offset in finish.
+    RecordingHeader header = {};
+    writer->mOfs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!writer->mOfs) {
+        return Error() << "failed to write recording: " << path;
+    }
+    return writer;
+}
+
+FakeValueRecordingWriter::FakeValueRecordingWriter(std::ofstream&& ofs)
+    : mOfs(std::move(ofs)), mOffset(sizeof(RecordingHeader)) {}
+
+Result<void> FakeValueRecordingWriter::append(const VehiclePropValue& event) {
+    if (mFinished) {
+        return Error() << "the recording is already finished";
+    }
+    if (mLastTimestamp.has_value() && event.timestamp < *mLastTimestamp) {
+        return Error() << "event timestamp: " << event.timestamp
+                       << " is earlier than the previous event: " << *mLastTimestamp;
+    }
+    const auto& value = event.value;
+    RecordedEventHeader header = {
+            .timestamp = event.timestamp,
+            .prop = event.prop,
+            .areaId = event.areaId,
+            .status = static_cast<int32_t>(event.status),
+            .int32Count = static_cast<uint32_t>(value.int32Values.size()),
+            .int64Count = static_cast<uint32_t>(value.int64Values.size()),
+            .floatCount = static_cast<uint32_t>(value.floatValues.size()),
+            .byteCount = static_cast<uint32_t>(value.byteValues.size()),
+            .stringSize = static_cast<uint32_t>(value.stringValue.size()),
+    };
+    mOfs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeVector(mOfs, value.int64Values);
+    writeVector(mOfs, value.int32Values);
+    writeVector(mOfs, value.floatValues);
+    writeVector(mOfs, value.byteValues);
+    mOfs.write(value.stringValue.data(), value.stringValue.size());
+    uint64_t size = sizeof(header) + getPayloadSize(header);
+    uint64_t paddedSize = alignTo8(size);
+    static constexpr char padding[8] = {};
+    mOfs.write(padding, paddedSize - size);
+    if (!mOfs) {
+        return Error() << "failed to write event for prop: " << event.prop;
+    }
+
+    mEventOffsets.push_back(mOffset);
+    mOffset += paddedSize;
+    mLastTimestamp = event.timestamp;
+    return {};
+}
+
+Result<void> FakeValueRecordingWriter::finish() {
+    if (mFinished) {
+        return Error() << "the recording is already finished";
+    }
+    mFinished = true;
+    writeVector(mOfs, mEventOffsets);
+
+    RecordingHeader header = {
+            .version = RECORDING_VERSION,
+            .eventCount = mEventOffsets.size(),
+            .indexOffset = mOffset,
+    };
+    memcpy(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    mOfs.seekp(0);
+    mOfs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    mOfs.close();
+    if (!mOfs) {
+        return Error() << "failed to write the recording index";
+    }
+    return {};
+}
+
+}  // namespace fake
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
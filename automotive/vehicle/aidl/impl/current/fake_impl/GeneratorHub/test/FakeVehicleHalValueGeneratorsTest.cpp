@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <BinaryFakeValueGenerator.h>
+#include <FakeValueRecording.h>
 #include <GeneratorHub.h>
 #include <JsonFakeValueGenerator.h>
 #include <LinearFakeValueGenerator.h>
@@ -25,6 +27,7 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -82,6 +85,19 @@ class FakeVehicleHalValueGeneratorsTest : public ::testing::Test {
         return baseDir + "/" + filename;
     }
 
+    static void writeRecording(const std::vector<VehiclePropValue>& events,
+                               const std::string& path) {
+        auto writerResult = FakeValueRecordingWriter::create(path);
+        ASSERT_TRUE(writerResult.ok()) << writerResult.error().message();
+        auto writer = std::move(writerResult.value());
+        for (const auto& event : events) {
+            auto result = writer->append(event);
+            ASSERT_TRUE(result.ok()) << result.error().message();
+        }
+        auto result = writer->finish();
+        ASSERT_TRUE(result.ok()) << result.error().message();
+    }
+
   private:
     void onHalEvent(const VehiclePropValue& event) {
         VehiclePropValue eventCopy = event;
@@ -476,6 +492,127 @@ TEST_F(FakeVehicleHalValueGeneratorsTest, testJsonFakeValueGeneratorDifferentTyp
     EXPECT_EQ(events, expectedValues);
 }
 
+TEST_F(FakeVehicleHalValueGeneratorsTest, testFakeValueRecording) {
+    JsonFakeValueGenerator jsonGenerator(getTestFilePath("prop_different_types.json"), 1);
+    const auto& expectedEvents = jsonGenerator.getAllEvents();
+    android::base::TemporaryFile recordingFile;
+    writeRecording(expectedEvents, recordingFile.path);
+
+    ASSERT_TRUE(FakeValueRecording::isRecordingFile(recordingFile.path));
+    auto result = FakeValueRecording::open(recordingFile.path);
+    ASSERT_TRUE(result.ok()) << result.error().message();
+    auto recording = std::move(result.value());
+
+    ASSERT_EQ(recording->size(), expectedEvents.size());
+    for (size_t i = 0; i < expectedEvents.size(); i++) {
+        EXPECT_EQ(recording->getTimestamp(i), expectedEvents[i].timestamp);
+        EXPECT_EQ(recording->getEvent(i), expectedEvents[i]);
+    }
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testFakeValueRecordingWriterEventsOutOfOrder) {
+    android::base::TemporaryFile recordingFile;
+    auto writer = std::move(FakeValueRecordingWriter::create(recordingFile.path).value());
+
+    ASSERT_TRUE(writer->append(VehiclePropValue{.timestamp = 2}).ok());
+    ASSERT_FALSE(writer->append(VehiclePropValue{.timestamp = 1}).ok());
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testFakeValueRecordingOpenJsonFile) {
+    ASSERT_FALSE(FakeValueRecording::isRecordingFile(getTestFilePath("prop.json")));
+    ASSERT_FALSE(FakeValueRecording::open(getTestFilePath("prop.json")).ok());
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testFakeValueRecordingOpenMalformedIndex) {
+    // Writes a 32 bytes recording header followed by the index.
+    auto writeMalformedRecording = [](const std::string& path, uint64_t indexOffset,
+                                      const std::vector<uint64_t>& eventOffsets) {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        const char magic[8] = {'V', 'H', 'A', 'L', 'R', 'E', 'C', '\0'};
+        uint32_t version = 1;
+        uint32_t reserved = 0;
+        uint64_t eventCount = eventOffsets.size();
+        ofs.write(magic, sizeof(magic));
+        ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        ofs.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+        ofs.write(reinterpret_cast<const char*>(&eventCount), sizeof(eventCount));
+        ofs.write(reinterpret_cast<const char*>(&indexOffset), sizeof(indexOffset));
+        // Pads up to the index. An event header is 40 bytes.
+        std::vector<char> padding(indexOffset > 32 ? indexOffset - 32 : 0, 0);
+        ofs.write(padding.data(), padding.size());
+        ofs.write(reinterpret_cast<const char*>(eventOffsets.data()),
+                  eventOffsets.size() * sizeof(uint64_t));
+    };
+    android::base::TemporaryFile recordingFile;
+
+    // The index right after the header leaves no space for the event.
+    writeMalformedRecording(recordingFile.path, /*indexOffset=*/32, {32});
+    ASSERT_TRUE(FakeValueRecording::isRecordingFile(recordingFile.path));
+    EXPECT_FALSE(FakeValueRecording::open(recordingFile.path).ok());
+
+    // The event header would overlap the index.
+    writeMalformedRecording(recordingFile.path, /*indexOffset=*/72, {40});
+    EXPECT_FALSE(FakeValueRecording::open(recordingFile.path).ok());
+
+    // The second event header would start at the index.
+    writeMalformedRecording(recordingFile.path, /*indexOffset=*/72, {32, 72});
+    EXPECT_FALSE(FakeValueRecording::open(recordingFile.path).ok());
+
+    // A single event without payload and an empty recording are valid.
+    writeMalformedRecording(recordingFile.path, /*indexOffset=*/72, {32});
+    EXPECT_TRUE(FakeValueRecording::open(recordingFile.path).ok());
+    writeMalformedRecording(recordingFile.path, /*indexOffset=*/32, {});
+    EXPECT_TRUE(FakeValueRecording::open(recordingFile.path).ok());
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testBinaryFakeValueGenerator) {
+    JsonFakeValueGenerator jsonGenerator(getTestFilePath("prop.json"), 1);
+    android::base::TemporaryFile recordingFile;
+    writeRecording(jsonGenerator.getAllEvents(), recordingFile.path);
+    int64_t currentTime = elapsedRealtimeNano();
+
+    getHub()->registerGenerator(
+            0, std::make_unique<BinaryFakeValueGenerator>(recordingFile.path, 2));
+
+    std::vector<int32_t> expectedValues = {8, 4, 16, 10, 8, 4, 16, 10};
+    waitForEvents(expectedValues.size());
+    auto events = getEvents();
+
+    ASSERT_EQ(events.size(), expectedValues.size());
+    int64_t lastEventTime = currentTime;
+    for (size_t i = 0; i < events.size(); i++) {
+        EXPECT_GT(events[i].timestamp, lastEventTime);
+        lastEventTime = events[i].timestamp;
+        EXPECT_EQ(events[i].prop, 289408000);
+        EXPECT_EQ(events[i].value.int32Values, std::vector<int32_t>({expectedValues[i]}));
+    }
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testBinaryFakeValueGeneratorSeekToTimestamp) {
+    JsonFakeValueGenerator jsonGenerator(getTestFilePath("prop.json"), 1);
+    android::base::TemporaryFile recordingFile;
+    writeRecording(jsonGenerator.getAllEvents(), recordingFile.path);
+    BinaryFakeValueGenerator generator(recordingFile.path, 1);
+
+    generator.seekToTimestamp(2500000);
+
+    auto event = generator.nextEvent();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->value.int32Values, std::vector<int32_t>({16}));
+    event = generator.nextEvent();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->value.int32Values, std::vector<int32_t>({10}));
+    EXPECT_FALSE(generator.hasNext());
+    EXPECT_FALSE(generator.nextEvent().has_value());
+}
+
+TEST_F(FakeVehicleHalValueGeneratorsTest, testBinaryFakeValueGeneratorInvalidFile) {
+    BinaryFakeValueGenerator generator(getTestFilePath("prop.json"), 1);
+
+    ASSERT_FALSE(generator.hasNext());
+    ASSERT_FALSE(generator.nextEvent().has_value());
+}
+
 }  // namespace fake
 }  // namespace vehicle
 }  // namespace automotive
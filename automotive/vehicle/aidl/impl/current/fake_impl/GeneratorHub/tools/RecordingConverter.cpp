@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Converts a JSON fake value file used by JsonFakeValueGenerator into a binary recording that
+// could be replayed by BinaryFakeValueGenerator.
+//
+// Usage: FakeVehicleHalRecordingConverter [input JSON file] [output recording file]
+
+#include <FakeValueRecording.h>
+#include <JsonFakeValueGenerator.h>
+
+#include <iostream>
+
+using ::android::hardware::automotive::vehicle::fake::FakeValueRecordingWriter;
+using ::android::hardware::automotive::vehicle::fake::JsonFakeValueGenerator;
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " [input JSON file] [output recording file]"
+                  << std::endl;
+        return 1;
+    }
+
+    // The JSON parser needs the whole file in memory anyway.
+    JsonFakeValueGenerator generator(argv[1], /*iteration=*/1);
+    const auto& events = generator.getAllEvents();
+    if (events.empty()) {
+        std::cerr << "No valid event in: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    auto writerResult = FakeValueRecordingWriter::create(argv[2]);
+    if (!writerResult.ok()) {
+        std::cerr << writerResult.error().message() << std::endl;
+        return 1;
+    }
+    auto writer = std::move(writerResult.value());
+    for (const auto& event : events) {
+        if (auto result = writer->append(event); !result.ok()) {
+            std::cerr << "Failed to convert event, error: " << result.error().message()
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (auto result = writer->finish(); !result.ok()) {
+        std::cerr << result.error().message() << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << events.size() << " events to: " << argv[2] << std::endl;
+    return 0;
+}
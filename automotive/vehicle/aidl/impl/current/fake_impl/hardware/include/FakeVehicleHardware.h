@@ -85,6 +85,14 @@ class FakeVehicleHardware : public IVehicleHardware {
             const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&
                     requests) const override;
 
+    // Answers the requests from the property store in the caller's thread, unless a requested
+    // property is provided by the external power controller service.
+    bool getValuesInline(
+            const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&
+                    requests,
+            std::vector<aidl::android::hardware::automotive::vehicle::GetValueResult>* results)
+            const override;
+
     // Dump debug information in the server.
     DumpResult dump(const std::vector<std::string>& options) override;
 
@@ -316,7 +324,7 @@ class FakeVehicleHardware : public IVehicleHardware {
     android::base::Result<void> checkArgumentsSize(const std::vector<std::string>& options,
                                                    size_t minSize);
     aidl::android::hardware::automotive::vehicle::GetValueResult handleGetValueRequest(
-            const aidl::android::hardware::automotive::vehicle::GetValueRequest& request);
+            const aidl::android::hardware::automotive::vehicle::GetValueRequest& request) const;
     aidl::android::hardware::automotive::vehicle::SetValueResult handleSetValueRequest(
             const aidl::android::hardware::automotive::vehicle::SetValueRequest& request);
 
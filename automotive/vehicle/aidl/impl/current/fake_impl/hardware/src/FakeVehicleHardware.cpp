@@ -20,6 +20,7 @@
 
 #include "FakeVehicleHardware.h"
 
+#include <BinaryFakeValueGenerator.h>
 #include <FakeObd2Frame.h>
 #include <JsonFakeValueGenerator.h>
 #include <LinearFakeValueGenerator.h>
@@ -39,6 +40,7 @@
 #include <dirent.h>
 #include <inttypes.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <regex>
 #include <unordered_set>
 #include <vector>
@@ -124,6 +126,9 @@ constexpr char GRPC_SERVICE_CONFIG_FILE[] = "/vendor/etc/automotive/powercontrol
 // overwrite the default configs.
 constexpr char OVERRIDE_PROPERTY[] = "persist.vendor.vhal_init_value_override";
 constexpr char POWER_STATE_REQ_CONFIG_PROPERTY[] = "ro.vendor.fake_vhal.ap_power_state_req.config";
+// If CONFIG_CACHE_DIR_PROPERTY is set to a writable directory, the parsed configuration files are
+// stored there as binary snapshots and loaded directly on the following boots.
+constexpr char CONFIG_CACHE_DIR_PROPERTY[] = "ro.vendor.fake_vhal.config_cache_dir";
 // The value to be returned if VENDOR_PROPERTY_FOR_ERROR_CODE_TESTING is set as the property
 constexpr int VENDOR_ERROR_CODE = 0x00ab0005;
 // A list of supported options for "--set" command.
@@ -382,7 +387,7 @@ FakeVehicleHardware::FakeVehicleHardware(std::string defaultConfigDir,
       mOverrideConfigDir(overrideConfigDir),
       mFakeObd2Frame(new obd2frame::FakeObd2Frame(mServerSidePropStore)),
       mFakeUserHal(new FakeUserHal(mValuePool)),
-      mRecurrentTimer(new RecurrentTimer()),
+      mRecurrentTimer(new RecurrentTimer(RecurrentTimer::Mode::COALESCED)),
       mGeneratorHub(new GeneratorHub(
               [this](const VehiclePropValue& value) { eventFromVehicleBus(value); })),
       mPendingGetValueRequests(this),
@@ -1429,7 +1434,27 @@ StatusCode FakeVehicleHardware::getValues(std::shared_ptr<const GetValuesCallbac
     return StatusCode::OK;
 }
 
-GetValueResult FakeVehicleHardware::handleGetValueRequest(const GetValueRequest& request) {
+bool FakeVehicleHardware::getValuesInline(const std::vector<GetValueRequest>& requests,
+                                          std::vector<GetValueResult>* results) const {
+    // Getting the power properties from the external service requires a blocking grpc call.
+    if (mPowerControllerServiceAddress != "") {
+        for (const auto& request : requests) {
+            if (mPowerPropIds.find(request.prop.prop) != mPowerPropIds.end()) {
+                return false;
+            }
+        }
+    }
+
+    for (const auto& request : requests) {
+        if (FAKE_VEHICLEHARDWARE_DEBUG) {
+            ALOGD("getValuesInline(%s)", PROP_ID_TO_CSTR(request.prop.prop));
+        }
+        results->push_back(handleGetValueRequest(request));
+    }
+    return true;
+}
+
+GetValueResult FakeVehicleHardware::handleGetValueRequest(const GetValueRequest& request) const {
     GetValueResult getValueResult;
     getValueResult.requestId = request.requestId;
 
@@ -1554,6 +1579,8 @@ jsonFilePath(string): The path to a JSON file. The JSON content must be in the f
 }, {...}]
 Each event in the JSON file would be generated by the same interval their timestamp is relative to
 the first event's timestamp.
+jsonFilePath could also be a binary recording converted from a JSON file by
+FakeVehicleHalRecordingConverter, which is replayed without loading all the events into memory.
 repetition(int32, optional): how many iterations the events would be generated. If it is not
 provided, it would iterate indefinitely.
 
@@ -1669,20 +1696,31 @@ std::string FakeVehicleHardware::genFakeDataCommand(const std::vector<std::strin
                 return parseErrMsg("repetition", options[4], "int");
             }
         }
-        std::unique_ptr<JsonFakeValueGenerator> generator;
+        std::unique_ptr<FakeValueGenerator> generator;
         if (options[2] == "--path") {
             const std::string& fileName = options[3];
-            generator = std::make_unique<JsonFakeValueGenerator>(fileName, repetition);
-            if (!generator->hasNext()) {
-                return "invalid JSON file, no events";
+            if (FakeValueRecording::isRecordingFile(fileName)) {
+                auto binaryGenerator =
+                        std::make_unique<BinaryFakeValueGenerator>(fileName, repetition);
+                if (!binaryGenerator->hasNext()) {
+                    return "invalid recording file, no events";
+                }
+                generator = std::move(binaryGenerator);
+            } else {
+                auto jsonGenerator = std::make_unique<JsonFakeValueGenerator>(fileName, repetition);
+                if (!jsonGenerator->hasNext()) {
+                    return "invalid JSON file, no events";
+                }
+                generator = std::move(jsonGenerator);
             }
         } else if (options[2] == "--content") {
             const std::string& content = options[3];
-            generator =
+            auto jsonGenerator =
                     std::make_unique<JsonFakeValueGenerator>(/*unused=*/true, content, repetition);
-            if (!generator->hasNext()) {
+            if (!jsonGenerator->hasNext()) {
                 return "invalid JSON content, no events";
             }
+            generator = std::move(jsonGenerator);
         }
         int32_t cookie = std::hash<std::string>()(options[3]);
         mGeneratorHub->registerGenerator(cookie, std::move(generator));
@@ -2909,6 +2947,7 @@ bool FakeVehicleHardware::loadPropConfigsFromDir(
         return false;
     }
 
+    std::string cacheDir = android::base::GetProperty(CONFIG_CACHE_DIR_PROPERTY, "");
     std::regex regJson(".*[.]json", std::regex::icase);
     while (auto f = readdir(dir)) {
         if (!std::regex_match(f->d_name, regJson)) {
@@ -2916,7 +2955,15 @@ bool FakeVehicleHardware::loadPropConfigsFromDir(
         }
         std::string filePath = dirPath + "/" + std::string(f->d_name);
         ALOGI("loading properties from %s", filePath.c_str());
-        auto result = mLoader.loadPropConfig(filePath);
+        Result<std::unordered_map<int32_t, ConfigDeclaration>> result;
+        if (cacheDir.empty()) {
+            result = mLoader.loadPropConfig(filePath);
+        } else {
+            // One snapshot per config file, named after the config file path.
+            std::string cacheName = filePath;
+            std::replace(cacheName.begin(), cacheName.end(), '/', '_');
+            result = mLoader.loadPropConfig(filePath, cacheDir + "/" + cacheName + ".bin");
+        }
         if (!result.ok()) {
             ALOGE("failed to load config file: %s, error: %s", filePath.c_str(),
                   result.error().message().c_str());
@@ -66,10 +66,16 @@ std::vector<AidlResultType> convertSupportedValueProtoResultToAidlResults(
 }  // namespace
 
 GRPCVehicleHardware::GRPCVehicleHardware(std::string service_addr)
+    : GRPCVehicleHardware(std::move(service_addr), /*useStreaming=*/false) {}
+
+GRPCVehicleHardware::GRPCVehicleHardware(std::string service_addr, bool useStreaming)
     : mServiceAddr(std::move(service_addr)),
       mGrpcChannel(CreateChannel(mServiceAddr, getChannelCredentials())),
       mGrpcStub(proto::VehicleServer::NewStub(mGrpcChannel)),
-      mValuePollingThread([this] { ValuePollingLoop(); }) {}
+      mUseStreaming(useStreaming) {
+    // Start the thread after all the members are initialized.
+    mValuePollingThread = std::thread([this] { ValuePollingLoop(); });
+}
 
 // Only used for unit testing.
 GRPCVehicleHardware::GRPCVehicleHardware(std::unique_ptr<proto::VehicleServer::StubInterface> stub,
@@ -123,6 +129,12 @@ std::optional<aidlvhal::VehiclePropConfig> GRPCVehicleHardware::getPropertyConfi
 aidlvhal::StatusCode GRPCVehicleHardware::setValues(
         std::shared_ptr<const SetValuesCallback> callback,
         const std::vector<aidlvhal::SetValueRequest>& requests) {
+    if (mUseStreaming) {
+        if (auto status = setValuesThroughStream(callback, requests); status.has_value()) {
+            return *status;
+        }
+    }
+
     ClientContext context;
     proto::VehiclePropValueRequests protoRequests;
     proto::SetValueResults protoResults;
@@ -156,6 +168,12 @@ aidlvhal::StatusCode GRPCVehicleHardware::setValues(
 aidlvhal::StatusCode GRPCVehicleHardware::getValues(
         std::shared_ptr<const GetValuesCallback> callback,
         const std::vector<aidlvhal::GetValueRequest>& requests) const {
+    if (mUseStreaming) {
+        if (auto status = getValuesThroughStream(callback, requests); status.has_value()) {
+            return *status;
+        }
+    }
+
     std::vector<aidlvhal::GetValueResult> results;
     auto status = getValuesWithRetry(requests, &results, /*retryCount=*/0);
     if (status != aidlvhal::StatusCode::OK) {
@@ -377,7 +395,11 @@ bool GRPCVehicleHardware::waitForConnected(std::chrono::milliseconds waitTime) {
 
 void GRPCVehicleHardware::ValuePollingLoop() {
     while (!mShuttingDownFlag.load()) {
-        pollValue();
+        if (mUseStreaming && mStreamingSupported.load()) {
+            streamValues();
+        } else {
+            pollValue();
+        }
         // try to reconnect
     }
 }
@@ -397,30 +419,112 @@ void GRPCVehicleHardware::pollValue() {
     LOG(INFO) << __func__ << ": GRPC Value Streaming Started";
     proto::VehiclePropValues protoValues;
     while (!mShuttingDownFlag.load() && value_stream->Read(&protoValues)) {
-        std::vector<aidlvhal::VehiclePropValue> values;
-        for (const auto protoValue : protoValues.values()) {
-            aidlvhal::VehiclePropValue aidlValue = {};
-            proto_msg_converter::protoToAidl(protoValue, &aidlValue);
-
-            // VHAL proxy server uses a different timestamp then AAOS timestamp, so we have to
-            // reset the timestamp.
-            // TODO(b/350822044): Remove this once we use timestamp from proxy server.
-            if (!setAndroidTimestamp(&aidlValue)) {
-                LOG(WARNING) << __func__ << ": property event for propId: " << aidlValue.prop
-                             << " areaId: " << aidlValue.areaId << " is outdated, ignore";
-                continue;
-            }
+        onPropertyEvents(protoValues);
+    }
 
-            values.push_back(std::move(aidlValue));
-        }
-        if (values.empty()) {
+    {
+        std::lock_guard lck(mShutdownMutex);
+        rpc_stopped = true;
+    }
+    mShutdownCV.notify_all();
+    shuttingdown_watcher.join();
+
+    auto grpc_status = value_stream->Finish();
+    // never reach here until connection lost
+    LOG(ERROR) << __func__ << ": GRPC Value Streaming Failed: " << grpc_status.error_message();
+}
+
+void GRPCVehicleHardware::onPropertyEvents(const proto::VehiclePropValues& protoValues) {
+    std::vector<aidlvhal::VehiclePropValue> values;
+    values.reserve(protoValues.values_size());
+    for (const auto& protoValue : protoValues.values()) {
+        aidlvhal::VehiclePropValue aidlValue = {};
+        proto_msg_converter::protoToAidl(protoValue, &aidlValue);
+
+        // VHAL proxy server uses a different timestamp then AAOS timestamp, so we have to
+        // reset the timestamp.
+        // TODO(b/350822044): Remove this once we use timestamp from proxy server.
+        if (!setAndroidTimestamp(&aidlValue)) {
+            LOG(WARNING) << __func__ << ": property event for propId: " << aidlValue.prop
+                         << " areaId: " << aidlValue.areaId << " is outdated, ignore";
             continue;
         }
-        std::shared_lock lck(mCallbackMutex);
-        if (mOnPropChange) {
-            (*mOnPropChange)(values);
+
+        values.push_back(std::move(aidlValue));
+    }
+    if (values.empty()) {
+        return;
+    }
+    std::shared_lock lck(mCallbackMutex);
+    if (mOnPropChange) {
+        (*mOnPropChange)(values);
+    }
+}
+
+void GRPCVehicleHardware::streamValues() {
+    ClientContext context;
+
+    bool rpc_stopped{false};
+    std::thread shuttingdown_watcher([this, &rpc_stopped, &context]() {
+        std::unique_lock<std::mutex> lck(mShutdownMutex);
+        mShutdownCV.wait(
+                lck, [this, &rpc_stopped]() { return rpc_stopped || mShuttingDownFlag.load(); });
+        context.TryCancel();
+    });
+
+    std::unique_ptr<VehicleStream> stream = mGrpcStub->StreamVehicle(&context);
+    {
+        std::scoped_lock lockGuard(mStreamMutex);
+        mStream = stream.get();
+    }
+    LOG(INFO) << __func__ << ": GRPC Vehicle Streaming Started";
+
+    // The response is reused across reads so that its sub-messages are only allocated once.
+    proto::VehicleStreamResponse response;
+    while (!mShuttingDownFlag.load() && stream->Read(&response)) {
+        handleStreamResponse(response);
+    }
+
+    std::unordered_map<int64_t, PendingStreamRequest> failedRequests;
+    {
+        std::unique_lock<std::mutex> lockGuard(mStreamMutex);
+        android::base::ScopedLockAssertion lockAssertion(mStreamMutex);
+        mStream = nullptr;
+        // The stream must not be destroyed while another thread is writing to it.
+        mStreamWriteCV.wait(lockGuard, [this] {
+            android::base::ScopedLockAssertion lockAssertion(mStreamMutex);
+            return !mStreamWriting;
+        });
+        mStreamRequestBatch.Clear();
+        failedRequests = std::move(mPendingStreamRequests);
+        mPendingStreamRequests.clear();
+    }
+
+    // The results for the pending requests will never arrive, fail them so that the callers could
+    // retry.
+    std::unordered_map<const GetValuesCallback*, std::vector<aidlvhal::GetValueResult>> getResults;
+    std::unordered_map<const SetValuesCallback*, std::vector<aidlvhal::SetValueResult>> setResults;
+    for (const auto& [_, request] : failedRequests) {
+        if (request.getValuesCallback != nullptr) {
+            getResults[request.getValuesCallback.get()].push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::TRY_AGAIN,
+            });
+        } else {
+            setResults[request.setValuesCallback.get()].push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::TRY_AGAIN,
+            });
         }
     }
+    for (auto& [callback, results] : getResults) {
+        (*callback)(std::move(results));
+    }
+    for (auto& [callback, results] : setResults) {
+        (*callback)(std::move(results));
+    }
+    // The callbacks must outlive the calls above.
+    failedRequests.clear();
 
     {
         std::lock_guard lck(mShutdownMutex);
@@ -429,9 +533,212 @@ void GRPCVehicleHardware::pollValue() {
     mShutdownCV.notify_all();
     shuttingdown_watcher.join();
 
-    auto grpc_status = value_stream->Finish();
-    // never reach here until connection lost
-    LOG(ERROR) << __func__ << ": GRPC Value Streaming Failed: " << grpc_status.error_message();
+    // Half-close the stream before finishing it, the server might still be reading requests.
+    stream->WritesDone();
+    auto grpc_status = stream->Finish();
+    if (grpc_status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        // This is a legacy server, fall back to StartPropertyValuesStream and unary calls.
+        LOG(INFO) << __func__ << ": GRPC StreamVehicle is not supported by the server";
+        mStreamingSupported.store(false);
+        return;
+    }
+    LOG(ERROR) << __func__ << ": GRPC Vehicle Streaming Failed: " << grpc_status.error_message();
+}
+
+std::optional<aidlvhal::StatusCode> GRPCVehicleHardware::getValuesThroughStream(
+        const std::shared_ptr<const GetValuesCallback>& callback,
+        const std::vector<aidlvhal::GetValueRequest>& requests) const {
+    {
+        std::scoped_lock lockGuard(mStreamMutex);
+        if (mStream == nullptr) {
+            return std::nullopt;
+        }
+        if (mPendingStreamRequests.size() + requests.size() > MAX_IN_FLIGHT_STREAM_REQUESTS) {
+            LOG(WARNING) << __func__ << ": too many in-flight requests, try again later";
+            return aidlvhal::StatusCode::TRY_AGAIN;
+        }
+        for (const auto& request : requests) {
+            addGetValueRequestLocked(callback, request, /*retryCount=*/0);
+        }
+    }
+    flushStreamRequests();
+    return aidlvhal::StatusCode::OK;
+}
+
+std::optional<aidlvhal::StatusCode> GRPCVehicleHardware::setValuesThroughStream(
+        const std::shared_ptr<const SetValuesCallback>& callback,
+        const std::vector<aidlvhal::SetValueRequest>& requests) {
+    {
+        std::scoped_lock lockGuard(mStreamMutex);
+        if (mStream == nullptr) {
+            return std::nullopt;
+        }
+        if (mPendingStreamRequests.size() + requests.size() > MAX_IN_FLIGHT_STREAM_REQUESTS) {
+            LOG(WARNING) << __func__ << ": too many in-flight requests, try again later";
+            return aidlvhal::StatusCode::TRY_AGAIN;
+        }
+        for (const auto& request : requests) {
+            int64_t streamRequestId = mNextStreamRequestId++;
+            auto& protoRequest = *mStreamRequestBatch.mutable_set_value_requests()->add_requests();
+            protoRequest.set_request_id(streamRequestId);
+            proto_msg_converter::aidlToProto(request.value, protoRequest.mutable_value());
+            mPendingStreamRequests[streamRequestId] = {
+                    .setValuesCallback = callback,
+                    .requestId = request.requestId,
+                    .retryCount = 0,
+            };
+        }
+    }
+    flushStreamRequests();
+    return aidlvhal::StatusCode::OK;
+}
+
+void GRPCVehicleHardware::addGetValueRequestLocked(
+        const std::shared_ptr<const GetValuesCallback>& callback,
+        const aidlvhal::GetValueRequest& request, size_t retryCount) const {
+    int64_t streamRequestId = mNextStreamRequestId++;
+    auto& protoRequest = *mStreamRequestBatch.mutable_get_value_requests()->add_requests();
+    protoRequest.set_request_id(streamRequestId);
+    proto_msg_converter::aidlToProto(request.prop, protoRequest.mutable_value());
+    mPendingStreamRequests[streamRequestId] = {
+            .getValuesCallback = callback,
+            .getValueRequest = request,
+            .requestId = request.requestId,
+            .retryCount = retryCount,
+    };
+}
+
+void GRPCVehicleHardware::flushStreamRequests() const {
+    std::unique_lock<std::mutex> lockGuard(mStreamMutex);
+    android::base::ScopedLockAssertion lockAssertion(mStreamMutex);
+    if (mStreamWriting) {
+        // The writing thread sends the new requests once it finishes the current write.
+        return;
+    }
+    mStreamWriting = true;
+    // Requests added while this thread is writing are combined into the next batch. The two
+    // messages are swapped so that their repeated fields are reused.
+    proto::VehicleStreamRequest batch;
+    while (mStream != nullptr && (mStreamRequestBatch.has_get_value_requests() ||
+                                  mStreamRequestBatch.has_set_value_requests())) {
+        batch.Swap(&mStreamRequestBatch);
+        VehicleStream* stream = mStream;
+        lockGuard.unlock();
+        bool ok = stream->Write(batch);
+        batch.Clear();
+        lockGuard.lock();
+        if (!ok) {
+            // The value polling thread fails the pending requests once the stream is closed.
+            LOG(ERROR) << __func__ << ": failed to write to the GRPC vehicle stream";
+            break;
+        }
+    }
+    mStreamWriting = false;
+    mStreamWriteCV.notify_all();
+}
+
+void GRPCVehicleHardware::handleStreamResponse(const proto::VehicleStreamResponse& response) {
+    if (response.has_get_value_results()) {
+        handleGetValueResults(response.get_value_results());
+    }
+    if (response.has_set_value_results()) {
+        handleSetValueResults(response.set_value_results());
+    }
+    if (response.has_property_events()) {
+        onPropertyEvents(response.property_events());
+    }
+}
+
+void GRPCVehicleHardware::handleGetValueResults(const proto::GetValueResults& protoResults) {
+    // Results in one batch might belong to different getValues calls, deliver them per callback.
+    std::unordered_map<const GetValuesCallback*,
+                       std::pair<std::shared_ptr<const GetValuesCallback>,
+                                 std::vector<aidlvhal::GetValueResult>>>
+            resultsByCallback;
+    bool hasRetry = false;
+    for (const auto& protoResult : protoResults.results()) {
+        int64_t streamRequestId = protoResult.request_id();
+        PendingStreamRequest request;
+        {
+            std::scoped_lock lockGuard(mStreamMutex);
+            auto it = mPendingStreamRequests.find(streamRequestId);
+            if (it == mPendingStreamRequests.end() || it->second.getValuesCallback == nullptr) {
+                LOG(ERROR) << __func__ << ": Invalid getValue result with unknown request ID: "
+                           << streamRequestId << ", ignore";
+                continue;
+            }
+            request = std::move(it->second);
+            mPendingStreamRequests.erase(it);
+        }
+
+        aidlvhal::GetValueResult result = {
+                .requestId = request.requestId,
+                .status = static_cast<aidlvhal::StatusCode>(protoResult.status()),
+        };
+        if (protoResult.has_value()) {
+            aidlvhal::VehiclePropValue value;
+            proto_msg_converter::protoToAidl(protoResult.value(), &value);
+            // See getValuesWithRetry for why outdated results are retried.
+            if (!setAndroidTimestamp(&value)) {
+                if (request.retryCount + 1 < MAX_RETRY_COUNT) {
+                    LOG(WARNING) << __func__ << ": getValue result for propId: " << value.prop
+                                 << " areaId: " << value.areaId << " is outdated, retry";
+                    std::scoped_lock lockGuard(mStreamMutex);
+                    if (mStream != nullptr) {
+                        addGetValueRequestLocked(request.getValuesCallback,
+                                                 request.getValueRequest, request.retryCount + 1);
+                        hasRetry = true;
+                        continue;
+                    }
+                }
+                LOG(ERROR) << __func__ << ": failed to get the latest value for propId: "
+                           << value.prop << " areaId: " << value.areaId;
+                result.status = aidlvhal::StatusCode::TRY_AGAIN;
+            } else {
+                result.prop = std::move(value);
+            }
+        }
+        auto& [callback, results] = resultsByCallback[request.getValuesCallback.get()];
+        callback = std::move(request.getValuesCallback);
+        results.push_back(std::move(result));
+    }
+    if (hasRetry) {
+        flushStreamRequests();
+    }
+    for (auto& [_, callbackAndResults] : resultsByCallback) {
+        (*callbackAndResults.first)(std::move(callbackAndResults.second));
+    }
+}
+
+void GRPCVehicleHardware::handleSetValueResults(const proto::SetValueResults& protoResults) {
+    std::unordered_map<const SetValuesCallback*,
+                       std::pair<std::shared_ptr<const SetValuesCallback>,
+                                 std::vector<aidlvhal::SetValueResult>>>
+            resultsByCallback;
+    for (const auto& protoResult : protoResults.results()) {
+        int64_t streamRequestId = protoResult.request_id();
+        PendingStreamRequest request;
+        {
+            std::scoped_lock lockGuard(mStreamMutex);
+            auto it = mPendingStreamRequests.find(streamRequestId);
+            if (it == mPendingStreamRequests.end() || it->second.setValuesCallback == nullptr) {
+                LOG(ERROR) << __func__ << ": Invalid setValue result with unknown request ID: "
+                           << streamRequestId << ", ignore";
+                continue;
+            }
+            request = std::move(it->second);
+            mPendingStreamRequests.erase(it);
+        }
+        auto& [callback, results] = resultsByCallback[request.setValuesCallback.get()];
+        callback = std::move(request.setValuesCallback);
+        results.push_back({
+                .requestId = request.requestId,
+                .status = static_cast<aidlvhal::StatusCode>(protoResult.status()),
+        });
+    }
+    for (auto& [_, callbackAndResults] : resultsByCallback) {
+        (*callbackAndResults.first)(std::move(callbackAndResults.second));
+    }
 }
 
 std::vector<aidlvhal::MinMaxSupportedValueResult> GRPCVehicleHardware::getMinMaxSupportedValues(
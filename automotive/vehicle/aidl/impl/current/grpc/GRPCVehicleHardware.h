@@ -31,6 +31,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <memory>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <thread>
@@ -45,6 +46,11 @@ class GRPCVehicleHardware : public IVehicleHardware {
   public:
     explicit GRPCVehicleHardware(std::string service_addr);
 
+    // If {@code useStreaming} is true, get/set requests, their results and property change events
+    // are batched through the bidirectional StreamVehicle RPC. The unary RPCs are still used while
+    // the stream is not connected, or if the server does not support StreamVehicle.
+    GRPCVehicleHardware(std::string service_addr, bool useStreaming);
+
     ~GRPCVehicleHardware();
 
     // Get all the property configs.
@@ -105,6 +111,24 @@ class GRPCVehicleHardware : public IVehicleHardware {
   private:
     friend class GRPCVehicleHardwareUnitTest;
 
+    // The max number of get/set requests sent through the stream that are still waiting for
+    // results. New requests are rejected with TRY_AGAIN once the limit is reached.
+    static constexpr size_t MAX_IN_FLIGHT_STREAM_REQUESTS = 1024;
+
+    using VehicleStream = ::grpc::ClientReaderWriterInterface<proto::VehicleStreamRequest,
+                                                              proto::VehicleStreamResponse>;
+
+    // A get/set request sent through the stream, identified by a stream request ID.
+    struct PendingStreamRequest {
+        std::shared_ptr<const GetValuesCallback> getValuesCallback;
+        std::shared_ptr<const SetValuesCallback> setValuesCallback;
+        // The original get request, used to retry if the result is outdated.
+        aidlvhal::GetValueRequest getValueRequest;
+        // The request ID assigned by the caller.
+        int64_t requestId;
+        size_t retryCount;
+    };
+
     std::string mServiceAddr;
     std::shared_ptr<::grpc::Channel> mGrpcChannel;
     std::unique_ptr<proto::VehicleServer::StubInterface> mGrpcStub;
@@ -116,6 +140,22 @@ class GRPCVehicleHardware : public IVehicleHardware {
     std::condition_variable mShutdownCV;
     std::atomic<bool> mShuttingDownFlag{false};
 
+    const bool mUseStreaming = false;
+    // Set to false if the server does not support StreamVehicle.
+    std::atomic<bool> mStreamingSupported{true};
+
+    mutable std::mutex mStreamMutex;
+    mutable std::condition_variable mStreamWriteCV;
+    // The stream owned by the value polling thread, null if the stream is not connected.
+    VehicleStream* mStream GUARDED_BY(mStreamMutex) = nullptr;
+    // The requests waiting to be written. Requests added while another thread is writing to the
+    // stream are sent by the writing thread in the next batch.
+    mutable proto::VehicleStreamRequest mStreamRequestBatch GUARDED_BY(mStreamMutex);
+    mutable bool mStreamWriting GUARDED_BY(mStreamMutex) = false;
+    mutable int64_t mNextStreamRequestId GUARDED_BY(mStreamMutex) = 0;
+    mutable std::unordered_map<int64_t, PendingStreamRequest> mPendingStreamRequests
+            GUARDED_BY(mStreamMutex);
+
     mutable std::mutex mLatestUpdateTimestampsMutex;
 
     // A map from [propId, areaId] to the latest timestamp this property is updated.
@@ -130,6 +170,28 @@ class GRPCVehicleHardware : public IVehicleHardware {
 
     void ValuePollingLoop();
     void pollValue();
+    void streamValues();
+
+    // Converts the property change events, resets their timestamps and delivers them to the
+    // property change callback.
+    void onPropertyEvents(const proto::VehiclePropValues& protoValues);
+
+    // Returns std::nullopt if the stream is not connected and the requests must be sent through
+    // the unary RPC.
+    std::optional<aidlvhal::StatusCode> getValuesThroughStream(
+            const std::shared_ptr<const GetValuesCallback>& callback,
+            const std::vector<aidlvhal::GetValueRequest>& requests) const;
+    std::optional<aidlvhal::StatusCode> setValuesThroughStream(
+            const std::shared_ptr<const SetValuesCallback>& callback,
+            const std::vector<aidlvhal::SetValueRequest>& requests);
+    void addGetValueRequestLocked(const std::shared_ptr<const GetValuesCallback>& callback,
+                                  const aidlvhal::GetValueRequest& request, size_t retryCount) const
+            REQUIRES(mStreamMutex);
+    // Writes the pending request batch to the stream unless another thread is already writing.
+    void flushStreamRequests() const;
+    void handleStreamResponse(const proto::VehicleStreamResponse& response);
+    void handleGetValueResults(const proto::GetValueResults& protoResults);
+    void handleSetValueResults(const proto::SetValueResults& protoResults);
 
     aidlvhal::StatusCode getValuesWithRetry(const std::vector<aidlvhal::GetValueRequest>& requests,
                                             std::vector<aidlvhal::GetValueResult>* results,
@@ -21,6 +21,7 @@
 #include <grpc++/grpc++.h>
 
 #include <android-base/logging.h>
+#include <google/protobuf/arena.h>
 
 #include <algorithm>
 #include <condition_variable>
@@ -263,6 +264,113 @@ GrpcVehicleProxyServer::GrpcVehicleProxyServer(std::vector<std::string> serverAd
     return ::grpc::Status(::grpc::StatusCode::ABORTED, "Connection lost.");
 }
 
+::grpc::Status GrpcVehicleProxyServer::StreamVehicle(
+        ::grpc::ServerContext* context,
+        ::grpc::ServerReaderWriter<proto::VehicleStreamResponse, proto::VehicleStreamRequest>*
+                stream) {
+    auto writer = std::make_shared<VehicleStreamWriter>(context, stream);
+    auto conn = std::make_shared<ConnectionDescriptor>(writer);
+    {
+        std::lock_guard lck(mConnectionMutex);
+        mValueStreamingConnections.push_back(conn);
+    }
+    proto::VehicleStreamRequest request;
+    while (stream->Read(&request)) {
+        if (request.has_get_value_requests()) {
+            StreamGetValues(writer, request.get_value_requests());
+        }
+        if (request.has_set_value_requests()) {
+            StreamSetValues(writer, request.set_value_requests());
+        }
+    }
+    conn->Shutdown();
+    writer->Close();
+    LOG(ERROR) << __func__ << ": Stream lost, ID : " << conn->ID();
+    return ::grpc::Status(::grpc::StatusCode::ABORTED, "Connection lost.");
+}
+
+void GrpcVehicleProxyServer::StreamGetValues(const std::shared_ptr<VehicleStreamWriter>& writer,
+                                             const proto::VehiclePropValueRequests& requests) {
+    std::vector<aidlvhal::GetValueRequest> aidlRequests;
+    aidlRequests.reserve(requests.requests_size());
+    for (const auto& protoRequest : requests.requests()) {
+        auto& aidlRequest = aidlRequests.emplace_back();
+        aidlRequest.requestId = protoRequest.request_id();
+        proto_msg_converter::protoToAidl(protoRequest.value(), &aidlRequest.prop);
+    }
+    auto aidlStatus = mHardware->getValues(
+            std::make_shared<const IVehicleHardware::GetValuesCallback>(
+                    [writer](std::vector<aidlvhal::GetValueResult> getValueResults) {
+                        proto::VehicleStreamResponse response;
+                        auto* protoResults = response.mutable_get_value_results();
+                        for (const auto& aidlResult : getValueResults) {
+                            auto& protoResult = *protoResults->add_results();
+                            protoResult.set_request_id(aidlResult.requestId);
+                            protoResult.set_status(
+                                    static_cast<proto::StatusCode>(aidlResult.status));
+                            if (aidlResult.prop) {
+                                proto_msg_converter::aidlToProto(*aidlResult.prop,
+                                                                 protoResult.mutable_value());
+                            }
+                        }
+                        writer->Write(response);
+                    }),
+            aidlRequests);
+    if (aidlStatus == aidlvhal::StatusCode::OK) {
+        return;
+    }
+    LOG(ERROR) << __func__
+               << ": The underlying hardware fails to get values, VHAL status: "
+               << toString(aidlStatus);
+    proto::VehicleStreamResponse response;
+    auto* protoResults = response.mutable_get_value_results();
+    for (const auto& aidlRequest : aidlRequests) {
+        auto& protoResult = *protoResults->add_results();
+        protoResult.set_request_id(aidlRequest.requestId);
+        protoResult.set_status(static_cast<proto::StatusCode>(aidlStatus));
+    }
+    writer->Write(response);
+}
+
+void GrpcVehicleProxyServer::StreamSetValues(const std::shared_ptr<VehicleStreamWriter>& writer,
+                                             const proto::VehiclePropValueRequests& requests) {
+    std::vector<aidlvhal::SetValueRequest> aidlRequests;
+    aidlRequests.reserve(requests.requests_size());
+    for (const auto& protoRequest : requests.requests()) {
+        auto& aidlRequest = aidlRequests.emplace_back();
+        aidlRequest.requestId = protoRequest.request_id();
+        proto_msg_converter::protoToAidl(protoRequest.value(), &aidlRequest.value);
+    }
+    auto aidlStatus = mHardware->setValues(
+            std::make_shared<const IVehicleHardware::SetValuesCallback>(
+                    [writer](std::vector<aidlvhal::SetValueResult> setValueResults) {
+                        proto::VehicleStreamResponse response;
+                        auto* protoResults = response.mutable_set_value_results();
+                        for (const auto& aidlResult : setValueResults) {
+                            auto& protoResult = *protoResults->add_results();
+                            protoResult.set_request_id(aidlResult.requestId);
+                            protoResult.set_status(
+                                    static_cast<proto::StatusCode>(aidlResult.status));
+                        }
+                        writer->Write(response);
+                    }),
+            aidlRequests);
+    if (aidlStatus == aidlvhal::StatusCode::OK) {
+        return;
+    }
+    LOG(ERROR) << __func__
+               << ": The underlying hardware fails to set values, VHAL status: "
+               << toString(aidlStatus);
+    proto::VehicleStreamResponse response;
+    auto* protoResults = response.mutable_set_value_results();
+    for (const auto& aidlRequest : aidlRequests) {
+        auto& protoResult = *protoResults->add_results();
+        protoResult.set_request_id(aidlRequest.requestId);
+        protoResult.set_status(static_cast<proto::StatusCode>(aidlStatus));
+    }
+    writer->Write(response);
+}
+
 ::grpc::Status GrpcVehicleProxyServer::GetMinMaxSupportedValues(
         ::grpc::ServerContext* context, const proto::GetMinMaxSupportedValuesRequest* request,
         proto::GetMinMaxSupportedValuesResult* result) {
@@ -286,15 +394,15 @@ GrpcVehicleProxyServer::GrpcVehicleProxyServer(std::vector<std::string> serverAd
 void GrpcVehicleProxyServer::OnVehiclePropChange(
         const std::vector<aidlvhal::VehiclePropValue>& values) {
     std::unordered_set<uint64_t> brokenConn;
-    proto::VehiclePropValues protoValues;
-    for (const auto& value : values) {
-        auto* protoValuePtr = protoValues.add_values();
-        proto_msg_converter::aidlToProto(value, protoValuePtr);
-    }
+    // The batch is converted once for all the connections. All its sub-messages are allocated on
+    // the arena and freed together.
+    ::google::protobuf::Arena arena;
+    auto* response = ::google::protobuf::Arena::Create<proto::VehicleStreamResponse>(&arena);
+    proto_msg_converter::aidlToProto(values, response->mutable_property_events());
     {
         std::shared_lock read_lock(mConnectionMutex);
         for (auto& connection : mValueStreamingConnections) {
-            auto writeOK = connection->Write(protoValues);
+            auto writeOK = connection->Write(*response);
             if (!writeOK) {
                 LOG(ERROR) << __func__
                            << ": Server Write failed, connection lost. ID: " << connection->ID();
@@ -352,15 +460,17 @@ GrpcVehicleProxyServer::ConnectionDescriptor::~ConnectionDescriptor() {
     Shutdown();
 }
 
-bool GrpcVehicleProxyServer::ConnectionDescriptor::Write(const proto::VehiclePropValues& values) {
-    if (!mStream) {
+bool GrpcVehicleProxyServer::ConnectionDescriptor::Write(
+        const proto::VehicleStreamResponse& response) {
+    if (!mStream && !mVehicleStreamWriter) {
         LOG(ERROR) << __func__ << ": Empty stream. ID: " << ID();
         Shutdown();
         return false;
     }
     {
         std::lock_guard lck(*mMtx);
-        if (!mShutdownFlag && mStream->Write(values)) {
+        if (!mShutdownFlag && (mStream ? mStream->Write(response.property_events())
+                                       : mVehicleStreamWriter->Write(response))) {
             return true;
         } else {
             LOG(ERROR) << __func__ << ": Server Write failed, connection lost. ID: " << ID();
@@ -381,6 +491,35 @@ void GrpcVehicleProxyServer::ConnectionDescriptor::Shutdown() {
         mShutdownFlag = true;
     }
     mCV->notify_all();
+    if (mVehicleStreamWriter) {
+        mVehicleStreamWriter->Cancel();
+    }
+}
+
+bool GrpcVehicleProxyServer::VehicleStreamWriter::Write(
+        const proto::VehicleStreamResponse& response) {
+    std::lock_guard lck(mMtx);
+    if (mStream == nullptr) {
+        return false;
+    }
+    if (!mStream->Write(response)) {
+        LOG(ERROR) << __func__ << ": Server Write failed, connection lost";
+        return false;
+    }
+    return true;
+}
+
+void GrpcVehicleProxyServer::VehicleStreamWriter::Cancel() {
+    std::lock_guard lck(mMtx);
+    if (mContext != nullptr) {
+        mContext->TryCancel();
+    }
+}
+
+void GrpcVehicleProxyServer::VehicleStreamWriter::Close() {
+    std::lock_guard lck(mMtx);
+    mContext = nullptr;
+    mStream = nullptr;
 }
 
 }  // namespace android::hardware::automotive::vehicle::virtualization
@@ -18,6 +18,8 @@
 
 #include "IVehicleHardware.h"
 
+#include <android-base/thread_annotations.h>
+
 #include "VehicleServer.grpc.pb.h"
 #include "VehicleServer.pb.h"
 
@@ -28,6 +30,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <utility>
@@ -77,6 +80,11 @@ class GrpcVehicleProxyServer : public proto::VehicleServer::Service {
             ::grpc::ServerContext* context, const ::google::protobuf::Empty* request,
             ::grpc::ServerWriter<proto::VehiclePropValues>* stream) override;
 
+    ::grpc::Status StreamVehicle(
+            ::grpc::ServerContext* context,
+            ::grpc::ServerReaderWriter<proto::VehicleStreamResponse, proto::VehicleStreamRequest>*
+                    stream) override;
+
     ::grpc::Status GetMinMaxSupportedValues(
             ::grpc::ServerContext* context, const proto::GetMinMaxSupportedValuesRequest* requests,
             proto::GetMinMaxSupportedValuesResult* results) override;
@@ -92,8 +100,39 @@ class GrpcVehicleProxyServer : public proto::VehicleServer::Service {
     void Wait();
 
   private:
+    // Serializes the writes to a StreamVehicle stream. The results are delivered from the hardware
+    // threads, possibly after StreamVehicle returns, so the writer is closed before that and the
+    // later writes are dropped.
+    class VehicleStreamWriter {
+      public:
+        VehicleStreamWriter(::grpc::ServerContext* context,
+                            ::grpc::ServerReaderWriter<proto::VehicleStreamResponse,
+                                                       proto::VehicleStreamRequest>* stream)
+            : mContext(context), mStream(stream) {}
+
+        bool Write(const proto::VehicleStreamResponse& response);
+
+        // Cancels the RPC so that StreamVehicle stops reading.
+        void Cancel();
+
+        void Close();
+
+      private:
+        std::mutex mMtx;
+        ::grpc::ServerContext* mContext GUARDED_BY(mMtx);
+        ::grpc::ServerReaderWriter<proto::VehicleStreamResponse, proto::VehicleStreamRequest>*
+                mStream GUARDED_BY(mMtx);
+    };
+
     void OnVehiclePropChange(const std::vector<aidlvhal::VehiclePropValue>& values);
 
+    // Sends the requests to the hardware without waiting for the results, the results are written
+    // to the stream once they are ready.
+    void StreamGetValues(const std::shared_ptr<VehicleStreamWriter>& writer,
+                         const proto::VehiclePropValueRequests& requests);
+    void StreamSetValues(const std::shared_ptr<VehicleStreamWriter>& writer,
+                         const proto::VehiclePropValueRequests& requests);
+
     // We keep long-lasting connection for streaming the prop values.
     struct ConnectionDescriptor {
         explicit ConnectionDescriptor(::grpc::ServerWriter<proto::VehiclePropValues>* stream)
@@ -102,6 +141,14 @@ class GrpcVehicleProxyServer : public proto::VehicleServer::Service {
               mMtx(std::make_unique<std::mutex>()),
               mCV(std::make_unique<std::condition_variable>()) {}
 
+        // A connection from StreamVehicle, the prop values are sent as property_events.
+        explicit ConnectionDescriptor(std::shared_ptr<VehicleStreamWriter> writer)
+            : mStream(nullptr),
+              mVehicleStreamWriter(std::move(writer)),
+              mConnectionID(connection_id_counter_.fetch_add(1) + 1),
+              mMtx(std::make_unique<std::mutex>()),
+              mCV(std::make_unique<std::condition_variable>()) {}
+
         ConnectionDescriptor(const ConnectionDescriptor&) = delete;
         ConnectionDescriptor(ConnectionDescriptor&& cd) = default;
         ConnectionDescriptor& operator=(const ConnectionDescriptor&) = delete;
@@ -111,7 +158,8 @@ class GrpcVehicleProxyServer : public proto::VehicleServer::Service {
 
         uint64_t ID() const { return mConnectionID; }
 
-        bool Write(const proto::VehiclePropValues& values);
+        // Writes response.property_events(), or the whole response for a StreamVehicle connection.
+        bool Write(const proto::VehicleStreamResponse& response);
 
         void Wait();
 
@@ -119,6 +167,7 @@ class GrpcVehicleProxyServer : public proto::VehicleServer::Service {
 
       private:
         ::grpc::ServerWriter<proto::VehiclePropValues>* mStream;
+        std::shared_ptr<VehicleStreamWriter> mVehicleStreamWriter;
         uint64_t mConnectionID{0};
         std::unique_ptr<std::mutex> mMtx;
         std::unique_ptr<std::condition_variable> mCV;
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "GRPCVehicleHardware.h"
+#include "GRPCVehicleProxyServer.h"
+#include "IVehicleHardware.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android::hardware::automotive::vehicle::virtualization {
+
+namespace {
+
+namespace aidlvhal = ::aidl::android::hardware::automotive::vehicle;
+
+const std::string kLoopbackServerAddr = "127.0.0.1:54330";
+constexpr auto kWaitForConnectionMaxTime = std::chrono::seconds(5);
+constexpr auto kWaitForStreamStartTime = std::chrono::seconds(1);
+
+// An IVehicleHardware that returns the requested value for every get request.
+class EchoVehicleHardware final : public IVehicleHardware {
+  public:
+    std::vector<aidlvhal::VehiclePropConfig> getAllPropertyConfigs() const override { return {}; }
+
+    aidlvhal::StatusCode setValues(
+            std::shared_ptr<const SetValuesCallback> callback,
+            const std::vector<aidlvhal::SetValueRequest>& requests) override {
+        std::vector<aidlvhal::SetValueResult> results;
+        for (const auto& request : requests) {
+            results.push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::OK,
+            });
+        }
+        (*callback)(std::move(results));
+        return aidlvhal::StatusCode::OK;
+    }
+
+    aidlvhal::StatusCode getValues(
+            std::shared_ptr<const GetValuesCallback> callback,
+            const std::vector<aidlvhal::GetValueRequest>& requests) const override {
+        std::vector<aidlvhal::GetValueResult> results;
+        for (const auto& request : requests) {
+            results.push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::OK,
+                    .prop = request.prop,
+            });
+        }
+        (*callback)(std::move(results));
+        return aidlvhal::StatusCode::OK;
+    }
+
+    DumpResult dump(const std::vector<std::string>& options) override { return {}; }
+
+    aidlvhal::StatusCode checkHealth() override { return aidlvhal::StatusCode::OK; }
+
+    void registerOnPropertyChangeEvent(
+            std::unique_ptr<const PropertyChangeCallback> callback) override {}
+
+    void registerOnPropertySetErrorEvent(
+            std::unique_ptr<const PropertySetErrorCallback> callback) override {}
+};
+
+// Counts the results delivered to the callbacks.
+class ResultWaiter final {
+  public:
+    void add(size_t count) {
+        {
+            std::lock_guard lck(mMutex);
+            mCount += count;
+        }
+        mCV.notify_all();
+    }
+
+    void waitFor(size_t count) {
+        std::unique_lock lck(mMutex);
+        mCV.wait(lck, [this, count] { return mCount >= count; });
+        mCount -= count;
+    }
+
+  private:
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    size_t mCount = 0;
+};
+
+// A proxy server and two clients connected through the loopback interface.
+struct Loopback {
+    std::unique_ptr<GrpcVehicleProxyServer> server;
+    std::unique_ptr<GRPCVehicleHardware> unaryClient;
+    std::unique_ptr<GRPCVehicleHardware> streamingClient;
+};
+
+Loopback& getLoopback() {
+    // Intentionally leaked, the server and the clients are shared by all the benchmarks.
+    static Loopback* loopback = [] {
+        auto* loopback = new Loopback();
+        loopback->server = std::make_unique<GrpcVehicleProxyServer>(
+                kLoopbackServerAddr, std::make_unique<EchoVehicleHardware>());
+        loopback->server->Start();
+        loopback->unaryClient = std::make_unique<GRPCVehicleHardware>(kLoopbackServerAddr,
+                                                                      /*useStreaming=*/false);
+        loopback->streamingClient = std::make_unique<GRPCVehicleHardware>(kLoopbackServerAddr,
+                                                                          /*useStreaming=*/true);
+        loopback->unaryClient->waitForConnected(kWaitForConnectionMaxTime);
+        loopback->streamingClient->waitForConnected(kWaitForConnectionMaxTime);
+        std::this_thread::sleep_for(kWaitForStreamStartTime);
+        return loopback;
+    }();
+    return *loopback;
+}
+
+// Issues state.range(0) independent single-value getValues calls per iteration, the same as
+// DefaultVehicleHal does for unrelated client requests, and waits for all the results.
+void BM_GetValues(benchmark::State& state, bool useStreaming) {
+    Loopback& loopback = getLoopback();
+    GRPCVehicleHardware* client =
+            useStreaming ? loopback.streamingClient.get() : loopback.unaryClient.get();
+    size_t callCount = static_cast<size_t>(state.range(0));
+    // Shared with the callback since results might still arrive if the benchmark is skipped.
+    auto waiter = std::make_shared<ResultWaiter>();
+    auto callback = std::make_shared<const IVehicleHardware::GetValuesCallback>(
+            [waiter](std::vector<aidlvhal::GetValueResult> results) {
+                waiter->add(results.size());
+            });
+    std::vector<std::vector<aidlvhal::GetValueRequest>> requests(callCount);
+    for (size_t i = 0; i < callCount; i++) {
+        requests[i].push_back({
+                .requestId = static_cast<int64_t>(i),
+                .prop = {.prop = static_cast<int32_t>(i), .value = {.int32Values = {1, 2, 3}}},
+        });
+    }
+
+    for (auto _ : state) {
+        for (const auto& request : requests) {
+            if (client->getValues(callback, request) != aidlvhal::StatusCode::OK) {
+                state.SkipWithError("getValues failed");
+                return;
+            }
+        }
+        waiter->waitFor(callCount);
+    }
+    state.SetItemsProcessed(state.iterations() * callCount);
+}
+
+void BM_SetValues(benchmark::State& state, bool useStreaming) {
+    Loopback& loopback = getLoopback();
+    GRPCVehicleHardware* client =
+            useStreaming ? loopback.streamingClient.get() : loopback.unaryClient.get();
+    size_t callCount = static_cast<size_t>(state.range(0));
+    auto waiter = std::make_shared<ResultWaiter>();
+    auto callback = std::make_shared<const IVehicleHardware::SetValuesCallback>(
+            [waiter](std::vector<aidlvhal::SetValueResult> results) {
+                waiter->add(results.size());
+            });
+    std::vector<std::vector<aidlvhal::SetValueRequest>> requests(callCount);
+    for (size_t i = 0; i < callCount; i++) {
+        requests[i].push_back({
+                .requestId = static_cast<int64_t>(i),
+                .value = {.prop = static_cast<int32_t>(i), .value = {.int32Values = {1, 2, 3}}},
+        });
+    }
+
+    for (auto _ : state) {
+        for (const auto& request : requests) {
+            if (client->setValues(callback, request) != aidlvhal::StatusCode::OK) {
+                state.SkipWithError("setValues failed");
+                return;
+            }
+        }
+        waiter->waitFor(callCount);
+    }
+    state.SetItemsProcessed(state.iterations() * callCount);
+}
+
+BENCHMARK_CAPTURE(BM_GetValues, Unary, /*useStreaming=*/false)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK_CAPTURE(BM_GetValues, Streaming, /*useStreaming=*/true)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+BENCHMARK_CAPTURE(BM_SetValues, Unary, /*useStreaming=*/false)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK_CAPTURE(BM_SetValues, Streaming, /*useStreaming=*/true)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+
+}  // namespace
+
+}  // namespace android::hardware::automotive::vehicle::virtualization
@@ -34,6 +34,7 @@ namespace aidlvhal = ::aidl::android::hardware::automotive::vehicle;
 using ::testing::_;
 using ::testing::DoAll;
 using ::testing::ElementsAre;
+using ::testing::InSequence;
 using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::SaveArg;
@@ -41,6 +42,7 @@ using ::testing::SetArgPointee;
 using ::testing::SizeIs;
 
 using ::grpc::testing::MockClientReader;
+using ::grpc::testing::MockClientReaderWriter;
 
 using proto::MockVehicleServerStub;
 
@@ -62,6 +64,10 @@ class GRPCVehicleHardwareUnitTest : public ::testing::Test {
     // Access GRPCVehicleHardware private method.
     void pollValue() { mHardware->pollValue(); }
 
+    void streamValues() { mHardware->streamValues(); }
+
+    bool isStreamingSupported() { return mHardware->mStreamingSupported.load(); }
+
     void startValuePollingLoop(std::unique_ptr<proto::VehicleServer::StubInterface> stub) {
         mHardware = std::unique_ptr<GRPCVehicleHardware>(
                 new GRPCVehicleHardware(std::move(stub), /*startValuePollingLoop=*/true));
@@ -274,6 +280,65 @@ TEST_F(GRPCVehicleHardwareUnitTest, TestPollValueIgnoreOutdatedValue) {
     EXPECT_THAT(propertyEvents[0].value.int32Values, ElementsAre(value1));
 }
 
+TEST_F(GRPCVehicleHardwareUnitTest, TestStreamValues) {
+    int64_t testTimestamp = 12345;
+    int32_t testPropId = 54321;
+
+    // This will be converted to a unique_ptr in StreamVehicle. The ownership is passed there.
+    auto stream =
+            new MockClientReaderWriter<proto::VehicleStreamRequest, proto::VehicleStreamResponse>();
+    EXPECT_CALL(*mGrpcStub, StreamVehicleRaw(_)).WillOnce(Return(stream));
+    {
+        InSequence sequence;
+        EXPECT_CALL(*stream, Read(_))
+                .WillOnce([testTimestamp, testPropId](proto::VehicleStreamResponse* response) {
+                    response->Clear();
+                    auto value = response->mutable_property_events()->add_values();
+                    value->set_timestamp(testTimestamp);
+                    value->set_prop(testPropId);
+                    return true;
+                })
+                .WillOnce(Return(false));
+        // The stream must be half-closed before it is finished.
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish()).WillOnce(Return(::grpc::Status::OK));
+    }
+
+    std::vector<aidlvhal::VehiclePropValue> propertyEvents;
+
+    mHardware->registerOnPropertyChangeEvent(
+            std::make_unique<GRPCVehicleHardware::PropertyChangeCallback>(
+                    [&propertyEvents](const std::vector<aidlvhal::VehiclePropValue>& events) {
+                        for (const auto& event : events) {
+                            propertyEvents.push_back(event);
+                        }
+                    }));
+
+    streamValues();
+
+    ASSERT_THAT(propertyEvents, SizeIs(1));
+    EXPECT_EQ(propertyEvents[0].prop, testPropId);
+    EXPECT_TRUE(isStreamingSupported());
+}
+
+TEST_F(GRPCVehicleHardwareUnitTest, TestStreamValuesLegacyServer) {
+    // This will be converted to a unique_ptr in StreamVehicle. The ownership is passed there.
+    auto stream =
+            new MockClientReaderWriter<proto::VehicleStreamRequest, proto::VehicleStreamResponse>();
+    EXPECT_CALL(*mGrpcStub, StreamVehicleRaw(_)).WillOnce(Return(stream));
+    {
+        InSequence sequence;
+        EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(false));
+        EXPECT_CALL(*stream, Finish())
+                .WillOnce(Return(::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "")));
+    }
+
+    streamValues();
+
+    EXPECT_FALSE(isStreamingSupported());
+}
+
 TEST_F(GRPCVehicleHardwareUnitTest, TestValuePollingLoop) {
     int64_t testTimestamp = 12345;
     int32_t testPropId = 54321;
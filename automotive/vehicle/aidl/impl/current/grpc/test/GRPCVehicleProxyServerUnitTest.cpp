@@ -22,8 +22,11 @@
 #include <grpc++/grpc++.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
@@ -52,21 +55,40 @@ class VehicleHardwareForTest : public IVehicleHardware {
         }
     }
 
-    // Functions that we do not care.
-    std::vector<aidlvhal::VehiclePropConfig> getAllPropertyConfigs() const override { return {}; }
-
+    // Sets always succeed.
     aidlvhal::StatusCode setValues(
             std::shared_ptr<const SetValuesCallback> callback,
             const std::vector<aidlvhal::SetValueRequest>& requests) override {
+        std::vector<aidlvhal::SetValueResult> results;
+        for (const auto& request : requests) {
+            results.push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::OK,
+            });
+        }
+        (*callback)(std::move(results));
         return aidlvhal::StatusCode::OK;
     }
 
+    // Gets return the requested value.
     aidlvhal::StatusCode getValues(
             std::shared_ptr<const GetValuesCallback> callback,
             const std::vector<aidlvhal::GetValueRequest>& requests) const override {
+        std::vector<aidlvhal::GetValueResult> results;
+        for (const auto& request : requests) {
+            results.push_back({
+                    .requestId = request.requestId,
+                    .status = aidlvhal::StatusCode::OK,
+                    .prop = request.prop,
+            });
+        }
+        (*callback)(std::move(results));
         return aidlvhal::StatusCode::OK;
     }
 
+    // Functions that we do not care.
+    std::vector<aidlvhal::VehiclePropConfig> getAllPropertyConfigs() const override { return {}; }
+
     DumpResult dump(const std::vector<std::string>& options) override { return {}; }
 
     aidlvhal::StatusCode checkHealth() override { return aidlvhal::StatusCode::OK; }
@@ -176,6 +198,85 @@ TEST(GRPCVehicleProxyServerUnitTest, ClientConnectDisconnect) {
     vehicleServer->Shutdown().Wait();
 }
 
+TEST(GRPCVehicleProxyServerUnitTest, StreamingGetSetValues) {
+    auto testHardware = std::make_unique<VehicleHardwareForTest>();
+    auto* testHardwareRaw = testHardware.get();
+    auto vehicleServer =
+            std::make_unique<GrpcVehicleProxyServer>(kFakeServerAddr, std::move(testHardware));
+    vehicleServer->Start();
+
+    constexpr auto kWaitForConnectionMaxTime = std::chrono::seconds(5);
+    constexpr auto kWaitForStreamStartTime = std::chrono::seconds(1);
+    constexpr auto kWaitForResultsMaxTime = std::chrono::seconds(1);
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::vector<aidlvhal::GetValueResult> getValueResults;
+    std::vector<aidlvhal::SetValueResult> setValueResults;
+    std::vector<aidlvhal::VehiclePropValue> events;
+
+    auto vehicleHardware = std::make_unique<GRPCVehicleHardware>(kFakeServerAddr,
+                                                                 /*useStreaming=*/true);
+    vehicleHardware->registerOnPropertyChangeEvent(
+            std::make_unique<const IVehicleHardware::PropertyChangeCallback>(
+                    [&](std::vector<aidlvhal::VehiclePropValue> values) {
+                        std::lock_guard lck(lock);
+                        events.insert(events.end(), values.begin(), values.end());
+                        cv.notify_all();
+                    }));
+    ASSERT_TRUE(vehicleHardware->waitForConnected(kWaitForConnectionMaxTime));
+    std::this_thread::sleep_for(kWaitForStreamStartTime);
+
+    auto getValuesCallback = std::make_shared<const IVehicleHardware::GetValuesCallback>(
+            [&](std::vector<aidlvhal::GetValueResult> results) {
+                std::lock_guard lck(lock);
+                for (auto& result : results) {
+                    getValueResults.push_back(std::move(result));
+                }
+                cv.notify_all();
+            });
+    auto setValuesCallback = std::make_shared<const IVehicleHardware::SetValuesCallback>(
+            [&](std::vector<aidlvhal::SetValueResult> results) {
+                std::lock_guard lck(lock);
+                for (auto& result : results) {
+                    setValueResults.push_back(std::move(result));
+                }
+                cv.notify_all();
+            });
+
+    ASSERT_EQ(vehicleHardware->getValues(
+                      getValuesCallback,
+                      {{.requestId = 1, .prop = {.areaId = 2, .prop = 1}},
+                       {.requestId = 2, .prop = {.areaId = 4, .prop = 3}}}),
+              aidlvhal::StatusCode::OK);
+    ASSERT_EQ(vehicleHardware->setValues(setValuesCallback,
+                                         {{.requestId = 3, .value = {.areaId = 6, .prop = 5}}}),
+              aidlvhal::StatusCode::OK);
+    testHardwareRaw->onPropertyEvent({aidlvhal::VehiclePropValue{.prop = 7}});
+
+    std::unique_lock lck(lock);
+    ASSERT_TRUE(cv.wait_for(lck, kWaitForResultsMaxTime, [&] {
+        return getValueResults.size() == 2 && setValueResults.size() == 1 && events.size() == 1;
+    }));
+    std::sort(getValueResults.begin(), getValueResults.end(),
+              [](const auto& a, const auto& b) { return a.requestId < b.requestId; });
+    EXPECT_EQ(getValueResults[0].requestId, 1);
+    EXPECT_EQ(getValueResults[0].status, aidlvhal::StatusCode::OK);
+    ASSERT_TRUE(getValueResults[0].prop.has_value());
+    EXPECT_EQ(getValueResults[0].prop->prop, 1);
+    EXPECT_EQ(getValueResults[0].prop->areaId, 2);
+    EXPECT_EQ(getValueResults[1].requestId, 2);
+    ASSERT_TRUE(getValueResults[1].prop.has_value());
+    EXPECT_EQ(getValueResults[1].prop->prop, 3);
+    EXPECT_EQ(setValueResults[0].requestId, 3);
+    EXPECT_EQ(setValueResults[0].status, aidlvhal::StatusCode::OK);
+    EXPECT_EQ(events[0].prop, 7);
+    lck.unlock();
+
+    vehicleHardware.reset();
+    vehicleServer->Shutdown().Wait();
+}
+
 TEST(GRPCVehicleProxyServerUnitTest, Subscribe) {
     auto mockHardware = std::make_unique<MockVehicleHardware>();
     // We make sure this is alive inside the function scope.
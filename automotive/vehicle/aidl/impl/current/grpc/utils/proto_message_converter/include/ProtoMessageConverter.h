@@ -31,6 +31,8 @@
 #include <android/hardware/automotive/vehicle/VehiclePropertyChangeMode.pb.h>
 #include <android/hardware/automotive/vehicle/VehiclePropertyStatus.pb.h>
 
+#include <vector>
+
 namespace android {
 namespace hardware {
 namespace automotive {
@@ -52,6 +54,17 @@ void aidlToProto(const ::aidl::android::hardware::automotive::vehicle::VehiclePr
 void protoToAidl(
         const ::android::hardware::automotive::vehicle::proto::VehiclePropValue& inProtoVal,
         ::aidl::android::hardware::automotive::vehicle::VehiclePropValue* outAidlVal);
+// Convert a batch of AIDL VehiclePropValues to Protobuf VehiclePropValues. The elements already
+// allocated in outProtoVals, e.g. on an arena or by a previous batch, are reused.
+void aidlToProto(
+        const std::vector<::aidl::android::hardware::automotive::vehicle::VehiclePropValue>&
+                inAidlVals,
+        ::android::hardware::automotive::vehicle::proto::VehiclePropValues* outProtoVals);
+// Convert Protobuf VehiclePropValues to a batch of AIDL VehiclePropValues.
+void protoToAidl(
+        const ::android::hardware::automotive::vehicle::proto::VehiclePropValues& inProtoVals,
+        std::vector<::aidl::android::hardware::automotive::vehicle::VehiclePropValue>*
+                outAidlVals);
 // Convert AIDL SubscribeOptions to Protobuf SubscribeOptions.
 void aidlToProto(const ::aidl::android::hardware::automotive::vehicle::SubscribeOptions& in,
                  ::android::hardware::automotive::vehicle::proto::SubscribeOptions* out);
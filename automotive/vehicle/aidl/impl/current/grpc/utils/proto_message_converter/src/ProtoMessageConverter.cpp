@@ -173,6 +173,25 @@ void protoToAidl(const proto::VehiclePropValue& in, aidl_vehicle::VehiclePropVal
     COPY_PROTOBUF_VEC_TO_VHAL_TYPE(in, float_values, out, value.floatValues);
 }
 
+void aidlToProto(const std::vector<aidl_vehicle::VehiclePropValue>& in,
+                 proto::VehiclePropValues* out) {
+    // Clearing a repeated message field keeps the cleared elements, add_values reuses them.
+    out->clear_values();
+    out->mutable_values()->Reserve(in.size());
+    for (const auto& value : in) {
+        aidlToProto(value, out->add_values());
+    }
+}
+
+void protoToAidl(const proto::VehiclePropValues& in,
+                 std::vector<aidl_vehicle::VehiclePropValue>* out) {
+    out->clear();
+    out->reserve(in.values_size());
+    for (const auto& value : in.values()) {
+        protoToAidl(value, &out->emplace_back());
+    }
+}
+
 void aidlToProto(const aidl_vehicle::SubscribeOptions& in, proto::SubscribeOptions* out) {
     out->set_prop_id(in.propId);
     for (int areaId : in.areaIds) {
@@ -115,6 +115,19 @@ INSTANTIATE_TEST_SUITE_P(TestValues, PropValueConversionTest,
                              return ::fmt::format("property_{:d}", info.param.prop);
                          });
 
+TEST_F(PropValueConversionTest, testConvertPropValues) {
+    std::vector<aidl_vehicle::VehiclePropValue> testValues = prepareTestValues();
+    proto::VehiclePropValues protoVals;
+    std::vector<aidl_vehicle::VehiclePropValue> aidlVals;
+
+    // Convert twice to make sure the reused elements do not keep the previous values.
+    aidlToProto(testValues, &protoVals);
+    aidlToProto(testValues, &protoVals);
+    protoToAidl(protoVals, &aidlVals);
+
+    EXPECT_EQ(aidlVals, testValues);
+}
+
 TEST_F(PropValueConversionTest, testConvertSubscribeOption) {
     proto::SubscribeOptions protoOptions;
     aidl_vehicle::SubscribeOptions aidlOptions = {.propId = 1,
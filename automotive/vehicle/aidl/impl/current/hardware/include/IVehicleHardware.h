@@ -118,6 +118,24 @@ class IVehicleHardware {
             const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&
                     requests) const = 0;
 
+    // Tries to get property values synchronously, in the caller's thread.
+    //
+    // Implementations that could answer the requests right away without blocking, e.g. from a
+    // local value cache, could override this to skip the asynchronous result delivery for small
+    // requests.
+    //
+    // Returns true if all the requests are answered. In that case one result for each request is
+    // appended to {@code results}. Returns false if any request must be answered asynchronously,
+    // {@code results} must not be modified and the caller sends all the requests through
+    // {@code getValues} instead.
+    //
+    // The default implementation always returns false.
+    virtual bool getValuesInline(
+            [[maybe_unused]] const std::vector<aidlvhal::GetValueRequest>& requests,
+            [[maybe_unused]] std::vector<aidlvhal::GetValueResult>* results) const {
+        return false;
+    }
+
     // Dump debug information in the server.
     virtual DumpResult dump(const std::vector<std::string>& options) = 0;
 
@@ -153,6 +171,19 @@ class IVehicleHardware {
         return std::chrono::nanoseconds(0);
     }
 
+    // Whether DefaultVehicleHal should only deliver the latest property change event for each
+    // [propId, areaId] of a continuous property within one batching window.
+    //
+    // This reduces the binder traffic to the VHAL clients when a continuous property is updated
+    // several times within one batching window. Events for other properties, e.g. HW_KEY_INPUT,
+    // are never coalesced since every event matters.
+    //
+    // Only takes effect if getPropertyOnChangeEventBatchingWindow returns a non-zero window.
+    virtual bool isContinuousPropertyEventCoalescingEnabled() {
+        // By default coalescing is disabled.
+        return false;
+    }
+
     // A [propId, areaId] is newly subscribed or the subscribe options are changed.
     //
     // The subscribe options contain sample rate in Hz or enable/disable variable update rate.
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ConcurrentQueue.h>
+#include <VehicleHalTypes.h>
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+
+constexpr size_t kQueueCapacity = 16384;
+
+// Pushes property change events from state.range(0) producer threads while one consumer thread
+// keeps flushing the queue, the same as DefaultVehicleHal::batchPropertyChangeEvent.
+template <typename QueueType>
+void runProducersAndConsumer(benchmark::State& state, QueueType* queue) {
+    int producerCount = static_cast<int>(state.range(0));
+    std::atomic<bool> stop = false;
+    std::atomic<size_t> consumedCount = 0;
+
+    std::thread consumer([queue, &stop, &consumedCount] {
+        std::vector<VehiclePropValue> items;
+        while (!stop) {
+            queue->waitForItems();
+            queue->flush(&items);
+            consumedCount += items.size();
+        }
+        queue->flush(&items);
+        consumedCount += items.size();
+    });
+
+    size_t producedCount = 0;
+    for (auto _ : state) {
+        std::vector<std::thread> producers;
+        for (int i = 0; i < producerCount; i++) {
+            producers.emplace_back([queue, i] {
+                for (int j = 0; j < 1000; j++) {
+                    queue->push(VehiclePropValue{
+                            .prop = i,
+                            .value = {.floatValues = {static_cast<float>(j)}},
+                    });
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        producedCount += producerCount * 1000;
+    }
+
+    stop = true;
+    queue->deactivate();
+    consumer.join();
+    state.SetItemsProcessed(producedCount);
+    state.counters["consumed"] = consumedCount;
+}
+
+void BM_ConcurrentQueue(benchmark::State& state) {
+    ConcurrentQueue<VehiclePropValue> queue;
+    runProducersAndConsumer(state, &queue);
+}
+
+BENCHMARK(BM_ConcurrentQueue)->ArgName("producers")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+void BM_BoundedConcurrentQueue(benchmark::State& state) {
+    BoundedConcurrentQueue<VehiclePropValue> queue(kQueueCapacity, OverflowPolicy::DROP_OLDEST);
+    runProducersAndConsumer(state, &queue);
+    state.counters["dropped"] = queue.getDroppedItemCount();
+}
+
+BENCHMARK(BM_BoundedConcurrentQueue)
+        ->ArgName("producers")
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->Arg(8)
+        ->UseRealTime();
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
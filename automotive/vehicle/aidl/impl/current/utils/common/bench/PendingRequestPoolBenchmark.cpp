@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <PendingRequestPool.h>
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+// Long enough that no request times out while measuring the finish path.
+constexpr int64_t kLongTimeoutInNanos = 60'000'000'000;
+constexpr int64_t kShortTimeoutInNanos = 1'000'000;
+
+const void* getClientId() {
+    return reinterpret_cast<const void*>(1);
+}
+
+// Keeps state.range(0) single-request batches pending for one client, the same as a client
+// sending many getValues calls, and measures adding and finishing one more request.
+void BM_PendingRequestPool_AddAndFinish(benchmark::State& state) {
+    PendingRequestPool pool(kLongTimeoutInNanos);
+    auto callback = std::make_shared<PendingRequestPool::TimeoutCallbackFunc>(
+            [](const std::unordered_set<int64_t>&) {});
+    int64_t pendingCount = state.range(0);
+    for (int64_t i = 0; i < pendingCount; i++) {
+        pool.addRequests(getClientId(), {i}, callback);
+    }
+
+    int64_t requestId = pendingCount;
+    for (auto _ : state) {
+        std::unordered_set<int64_t> requestIds = {requestId++};
+        pool.addRequests(getClientId(), requestIds, callback);
+        benchmark::DoNotOptimize(pool.tryFinishRequests(getClientId(), requestIds));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PendingRequestPool_AddAndFinish)
+        ->ArgName("pending")
+        ->Arg(1)
+        ->Arg(100)
+        ->Arg(1000)
+        ->Arg(9000);
+
+// Finishes the oldest pending request while state.range(0) requests stay pending, the order in
+// which results usually arrive. Each iteration adds one request so the pending count is stable.
+void BM_PendingRequestPool_FinishOldest(benchmark::State& state) {
+    PendingRequestPool pool(kLongTimeoutInNanos);
+    auto callback = std::make_shared<PendingRequestPool::TimeoutCallbackFunc>(
+            [](const std::unordered_set<int64_t>&) {});
+    int64_t pendingCount = state.range(0);
+    for (int64_t i = 0; i < pendingCount; i++) {
+        pool.addRequests(getClientId(), {i}, callback);
+    }
+
+    int64_t oldestRequestId = 0;
+    for (auto _ : state) {
+        pool.addRequests(getClientId(), {oldestRequestId + pendingCount}, callback);
+        benchmark::DoNotOptimize(pool.tryFinishRequests(getClientId(), {oldestRequestId++}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PendingRequestPool_FinishOldest)
+        ->ArgName("pending")
+        ->Arg(1)
+        ->Arg(100)
+        ->Arg(1000)
+        ->Arg(9000);
+
+// Adds state.range(0) single-request batches with a short timeout and measures the time until the
+// timeout callbacks for all of them are called.
+void BM_PendingRequestPool_Timeout(benchmark::State& state) {
+    PendingRequestPool pool(kShortTimeoutInNanos);
+    std::atomic<int64_t> timeoutCount = 0;
+    auto callback = std::make_shared<PendingRequestPool::TimeoutCallbackFunc>(
+            [&timeoutCount](const std::unordered_set<int64_t>& requestIds) {
+                timeoutCount += requestIds.size();
+            });
+    int64_t requestCount = state.range(0);
+
+    int64_t requestId = 0;
+    for (auto _ : state) {
+        timeoutCount = 0;
+        for (int64_t i = 0; i < requestCount; i++) {
+            pool.addRequests(getClientId(), {requestId++}, callback);
+        }
+        while (timeoutCount < requestCount) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * requestCount);
+}
+
+BENCHMARK(BM_PendingRequestPool_Timeout)
+        ->ArgName("requests")
+        ->Arg(100)
+        ->Arg(1000)
+        ->Arg(9000)
+        ->UseRealTime();
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <RecurrentTimer.h>
+#include <benchmark/benchmark.h>
+#include <utils/SystemClock.h>
+
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+// Sample rates commonly used by continuous property subscriptions: 100hz, 50hz, 20hz, 10hz.
+constexpr int64_t kIntervalsInNanos[] = {10'000'000, 20'000'000, 50'000'000, 100'000'000};
+constexpr auto kMeasureDuration = std::chrono::seconds(1);
+
+// Records the jitter for one registered callback. Only accessed from the timer thread.
+struct CallbackStats {
+    int64_t intervalInNanos = 0;
+    int64_t lastCallTimeInNanos = 0;
+    int64_t totalJitterInNanos = 0;
+    int64_t maxJitterInNanos = 0;
+    int64_t callCount = 0;
+};
+
+int64_t getProcessCpuTimeNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+// Registers state.range(1) callbacks with different intervals, lets the timer run for one second
+// and reports the jitter between consecutive invocations and the CPU time used per second.
+// state.range(0) is the timer mode, 0 for PER_CALLBACK, 1 for COALESCED.
+void BM_RecurrentTimer(benchmark::State& state) {
+    auto mode = state.range(0) == 0 ? RecurrentTimer::Mode::PER_CALLBACK
+                                    : RecurrentTimer::Mode::COALESCED;
+    size_t callbackCount = static_cast<size_t>(state.range(1));
+
+    for (auto _ : state) {
+        std::vector<CallbackStats> stats(callbackCount);
+        std::vector<std::shared_ptr<RecurrentTimer::Callback>> callbacks;
+        callbacks.reserve(callbackCount);
+        auto timer = std::make_unique<RecurrentTimer>(mode);
+        for (size_t i = 0; i < callbackCount; i++) {
+            CallbackStats* stat = &stats[i];
+            stat->intervalInNanos = kIntervalsInNanos[i % std::size(kIntervalsInNanos)];
+            callbacks.push_back(std::make_shared<RecurrentTimer::Callback>([stat] {
+                int64_t now = uptimeNanos();
+                if (stat->lastCallTimeInNanos != 0) {
+                    int64_t jitter = std::abs(now - stat->lastCallTimeInNanos -
+                                              stat->intervalInNanos);
+                    stat->totalJitterInNanos += jitter;
+                    stat->maxJitterInNanos = std::max(stat->maxJitterInNanos, jitter);
+                    stat->callCount++;
+                }
+                stat->lastCallTimeInNanos = now;
+            }));
+            timer->registerTimerCallback(stat->intervalInNanos, callbacks.back());
+        }
+
+        int64_t cpuStartNanos = getProcessCpuTimeNanos();
+        std::this_thread::sleep_for(kMeasureDuration);
+        int64_t cpuNanos = getProcessCpuTimeNanos() - cpuStartNanos;
+
+        // Stops the timer thread before reading the stats.
+        timer.reset();
+
+        int64_t totalJitterInNanos = 0;
+        int64_t maxJitterInNanos = 0;
+        int64_t callCount = 0;
+        for (const auto& stat : stats) {
+            totalJitterInNanos += stat.totalJitterInNanos;
+            maxJitterInNanos = std::max(maxJitterInNanos, stat.maxJitterInNanos);
+            callCount += stat.callCount;
+        }
+        state.counters["calls"] = callCount;
+        state.counters["avg_jitter_us"] =
+                callCount == 0 ? 0 : totalJitterInNanos / callCount / 1000.0;
+        state.counters["max_jitter_us"] = maxJitterInNanos / 1000.0;
+        state.counters["cpu_ms_per_s"] =
+                cpuNanos / 1'000'000.0 /
+                std::chrono::duration_cast<std::chrono::duration<double>>(kMeasureDuration).count();
+    }
+}
+
+BENCHMARK(BM_RecurrentTimer)
+        ->ArgNames({"coalesced", "callbacks"})
+        ->ArgsProduct({{0, 1}, {10, 100, 1000, 10000}})
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
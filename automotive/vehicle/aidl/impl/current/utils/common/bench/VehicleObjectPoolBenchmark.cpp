@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ConcurrentQueue.h>
+#include <VehicleHalTypes.h>
+#include <VehicleObjectPool.h>
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyType;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+
+// The number of values each thread holds before releasing them, the same as a batch of property
+// events waiting to be delivered.
+constexpr size_t kBatchSize = 64;
+
+VehiclePropValuePool* getPool() {
+    static VehiclePropValuePool pool;
+    return &pool;
+}
+
+// Obtains and releases a single value in each iteration from all the threads.
+void BM_ObtainRecycle(benchmark::State& state) {
+    VehiclePropValuePool* pool = getPool();
+    for (auto _ : state) {
+        auto value = pool->obtain(VehiclePropertyType::FLOAT);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ObtainRecycle)->ThreadRange(1, 16)->UseRealTime();
+
+// Obtains a batch of values with mixed types and vector sizes and releases the batch at once, so
+// the magazines are regularly exchanged with the shared pool.
+void BM_ObtainRecycleBatch(benchmark::State& state) {
+    VehiclePropValuePool* pool = getPool();
+    std::vector<VehiclePropValuePool::RecyclableType> values;
+    values.reserve(kBatchSize);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kBatchSize; i++) {
+            values.push_back(i % 2 == 0 ? pool->obtain(VehiclePropertyType::INT32)
+                                        : pool->obtain(VehiclePropertyType::FLOAT_VEC, i % 4 + 1));
+        }
+        values.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+BENCHMARK(BM_ObtainRecycleBatch)->ThreadRange(1, 16)->UseRealTime();
+
+// Obtains values in the benchmark thread and releases them in a consumer thread, the same as
+// values written by the generator threads and delivered from the binder threads.
+void BM_ObtainRecycleCrossThread(benchmark::State& state) {
+    VehiclePropValuePool* pool = getPool();
+    ConcurrentQueue<VehiclePropValuePool::RecyclableType> queue;
+    std::thread consumer([&queue] {
+        std::vector<VehiclePropValuePool::RecyclableType> values;
+        while (queue.waitForItems()) {
+            // The values are released when the buffer is cleared by the next flush.
+            queue.flush(&values);
+        }
+        queue.flush(&values);
+    });
+
+    std::vector<VehiclePropValuePool::RecyclableType> values;
+    for (auto _ : state) {
+        for (size_t i = 0; i < kBatchSize; i++) {
+            values.push_back(pool->obtain(VehiclePropertyType::INT32));
+        }
+        queue.push(std::move(values));
+        values.clear();
+    }
+
+    queue.deactivate();
+    consumer.join();
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+BENCHMARK(BM_ObtainRecycleCrossThread)->UseRealTime();
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <VehicleHalTypes.h>
+#include <VehiclePropertyStore.h>
+#include <VehicleUtils.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::VehicleArea;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropConfig;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyAccess;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyChangeMode;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyGroup;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyType;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+
+// The number of global float properties registered in the store.
+constexpr int32_t kPropCount = 256;
+// The number of writer threads for each benchmark. All the other threads are readers.
+constexpr int kWriterCount = 2;
+
+int32_t getTestPropId(int32_t index) {
+    return (index + 1) | toInt(VehiclePropertyGroup::VENDOR) | toInt(VehicleArea::GLOBAL) |
+           toInt(VehiclePropertyType::FLOAT);
+}
+
+// Creates a store shared by all the benchmark threads. A store is created for each shard count
+// and kept alive for the lifetime of the benchmark process.
+VehiclePropertyStore* getStore(size_t shardCount) {
+    static std::mutex lock;
+    static std::unordered_map<size_t, std::unique_ptr<VehiclePropertyStore>> storeByShardCount;
+
+    std::scoped_lock<std::mutex> lockGuard(lock);
+    if (auto it = storeByShardCount.find(shardCount); it != storeByShardCount.end()) {
+        return it->second.get();
+    }
+    auto valuePool = std::make_shared<VehiclePropValuePool>();
+    auto store = std::make_unique<VehiclePropertyStore>(valuePool, shardCount);
+    for (int32_t i = 0; i < kPropCount; i++) {
+        int32_t propId = getTestPropId(i);
+        store->registerProperty(VehiclePropConfig{
+                .prop = propId,
+                .access = VehiclePropertyAccess::READ,
+                .changeMode = VehiclePropertyChangeMode::CONTINUOUS,
+        });
+        auto result = store->writeValue(valuePool->obtain(VehiclePropValue{
+                .prop = propId,
+                .value = {.floatValues = {0.0}},
+        }));
+        if (!result.ok()) {
+            return nullptr;
+        }
+    }
+    VehiclePropertyStore* storePtr = store.get();
+    storeByShardCount[shardCount] = std::move(store);
+    return storePtr;
+}
+
+// Runs kWriterCount writer threads that refresh values with the current timestamp, the same
+// as the continuous property refresh in FakeVehicleHardware. The other threads read values the
+// same as binder getValues threads. The first argument is the shard count, use 1 to get the
+// single-lock behavior.
+void BM_ReadWrite(benchmark::State& state) {
+    VehiclePropertyStore* store = getStore(static_cast<size_t>(state.range(0)));
+    if (store == nullptr) {
+        state.SkipWithError("failed to initialize the property store");
+        return;
+    }
+    auto valuePool = store->getValuePool();
+    bool isWriter = state.thread_index() < kWriterCount;
+    size_t index = static_cast<size_t>(state.thread_index());
+    float value = 0;
+
+    for (auto _ : state) {
+        int32_t propId = getTestPropId(static_cast<int32_t>(index % kPropCount));
+        if (isWriter) {
+            auto result = store->writeValue(valuePool->obtain(VehiclePropValue{
+                                                    .prop = propId,
+                                                    .value = {.floatValues = {value++}},
+                                            }),
+                                            /*updateStatus=*/false,
+                                            VehiclePropertyStore::EventMode::NEVER,
+                                            /*useCurrentTimestamp=*/true);
+            benchmark::DoNotOptimize(result);
+        } else {
+            auto result = store->readValue(propId);
+            benchmark::DoNotOptimize(result);
+        }
+        index += 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(isWriter ? "writer" : "reader");
+}
+
+BENCHMARK(BM_ReadWrite)
+        ->ArgName("shards")
+        ->Arg(1)
+        ->Arg(VehiclePropertyStore::DEFAULT_SHARD_COUNT)
+        ->ThreadRange(kWriterCount + 1, 32)
+        ->UseRealTime();
+
+// Refreshes the timestamps for all the properties, the same as the RecurrentTimer action for
+// continuous properties, while the other threads keep reading.
+void BM_RefreshTimestamps(benchmark::State& state) {
+    VehiclePropertyStore* store = getStore(static_cast<size_t>(state.range(0)));
+    if (store == nullptr) {
+        state.SkipWithError("failed to initialize the property store");
+        return;
+    }
+    std::unordered_map<PropIdAreaId, VehiclePropertyStore::EventMode, PropIdAreaIdHash>
+            eventModeByPropIdAreaId;
+    for (int32_t i = 0; i < kPropCount; i++) {
+        eventModeByPropIdAreaId[PropIdAreaId{
+                .propId = getTestPropId(i),
+                .areaId = 0,
+        }] = VehiclePropertyStore::EventMode::NEVER;
+    }
+    size_t index = static_cast<size_t>(state.thread_index());
+
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            store->refreshTimestamps(eventModeByPropIdAreaId);
+        } else {
+            auto result = store->readValue(getTestPropId(static_cast<int32_t>(index % kPropCount)));
+            benchmark::DoNotOptimize(result);
+            index += 7;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RefreshTimestamps)
+        ->ArgName("shards")
+        ->Arg(1)
+        ->Arg(VehiclePropertyStore::DEFAULT_SHARD_COUNT)
+        ->ThreadRange(2, 32)
+        ->UseRealTime();
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
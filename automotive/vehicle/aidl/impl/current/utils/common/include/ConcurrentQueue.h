@@ -21,9 +21,15 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <queue>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace android {
 namespace hardware {
@@ -44,18 +50,22 @@ class ConcurrentQueue {
 
     std::vector<T> flush() {
         std::vector<T> items;
+        flush(&items);
+        return items;
+    }
+
+    // Moves all the items into 'items'. 'items' is cleared first, but its capacity is kept so the
+    // caller could reuse the same buffer for every flush.
+    void flush(std::vector<T>* items) {
+        items->clear();
 
         std::scoped_lock<std::mutex> lockGuard(mLock);
-        if (mQueue.empty()) {
-            return items;
-        }
         while (!mQueue.empty()) {
             // Even if the queue is deactivated, we should still flush all the remaining values
             // in the queue.
-            items.push_back(std::move(mQueue.front()));
+            items->push_back(std::move(mQueue.front()));
             mQueue.pop();
         }
-        return items;
     }
 
     void push(T&& item) {
@@ -105,7 +115,289 @@ class ConcurrentQueue {
     std::queue<T> mQueue GUARDED_BY(mLock);
 };
 
+// What to do when an item is pushed into a full BoundedConcurrentQueue.
+enum class OverflowPolicy {
+    // Drops the item being pushed.
+    DROP_NEWEST,
+    // Drops the oldest item in the queue to make room for the item being pushed.
+    DROP_OLDEST,
+    // Only keeps the latest item for each [propId, areaId]. Items pushed into a full ring go to
+    // an overflow list under a lock until the consumer flushes, an item there is replaced by a
+    // newer item with the same [propId, areaId]. The overflow list holds at most 'capacity'
+    // items, the oldest one is dropped beyond that.
+    COALESCE_BY_PROP_ID,
+};
+
+// A bounded lock-free queue that could be used in place of ConcurrentQueue.
+//
+// push() never takes a lock, so producers never block each other or the consumer. Only the
+// consumer waiting in waitForItems() sleeps on a condition variable, which producers only signal
+// when the consumer is actually waiting. The queue is designed for a single consumer calling
+// waitForItems() and flush(), although the underlying ring (a bounded queue with per-slot
+// sequence numbers) is safe for concurrent pops, which is what DROP_OLDEST relies on. With
+// COALESCE_BY_PROP_ID, push() only takes a lock once the ring is full.
 template <typename T>
+class BoundedConcurrentQueue {
+  public:
+    // Returns the [propId, areaId] of an item packed into one key, used by COALESCE_BY_PROP_ID.
+    using PropIdAreaIdKeyFunc = std::function<uint64_t(const T&)>;
+
+    // 'capacity' is rounded up to the next power of 2. 'getPropIdAreaIdKey' must be set for
+    // COALESCE_BY_PROP_ID.
+    explicit BoundedConcurrentQueue(size_t capacity,
+                                    OverflowPolicy policy = OverflowPolicy::DROP_OLDEST,
+                                    PropIdAreaIdKeyFunc getPropIdAreaIdKey = nullptr)
+        : mCapacity(roundUpToPowerOf2(capacity)),
+          mMask(mCapacity - 1),
+          mPolicy(policy),
+          mGetPropIdAreaIdKey(std::move(getPropIdAreaIdKey)),
+          mCells(new Cell[mCapacity]) {
+        for (size_t i = 0; i < mCapacity; i++) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedConcurrentQueue(const BoundedConcurrentQueue&) = delete;
+    BoundedConcurrentQueue& operator=(const BoundedConcurrentQueue&) = delete;
+
+    bool waitForItems() {
+        std::unique_lock<std::mutex> lockGuard(mWaitLock);
+        mConsumerWaiting.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in notifyConsumer, either we see the pushed item or the producer
+        // sees that we are waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        mCond.wait(lockGuard, [this] { return hasItems() || mOverflowing || !mIsActive; });
+        mConsumerWaiting.store(false, std::memory_order_relaxed);
+        return mIsActive;
+    }
+
+    std::vector<T> flush() {
+        std::vector<T> items;
+        flush(&items);
+        return items;
+    }
+
+    // Moves all the items into 'items'. 'items' is cleared first, but its capacity is kept so the
+    // caller could reuse the same buffer for every flush.
+    void flush(std::vector<T>* items) {
+        items->clear();
+        // Even if the queue is deactivated, we should still flush all the remaining values in the
+        // queue.
+        T item;
+        while (tryPop(&item)) {
+            items->push_back(std::move(item));
+        }
+        if (!mOverflowing.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::scoped_lock<std::mutex> lockGuard(mOverflowLock);
+        // The items pushed into the ring before the overflow started are older than the
+        // overflowed items, so they go first.
+        while (tryPop(&item)) {
+            items->push_back(std::move(item));
+        }
+        std::move(mOverflowItems.begin(), mOverflowItems.end(), std::back_inserter(*items));
+        mOverflowItems.clear();
+        mOverflowIndexByKey.clear();
+        mOverflowing = false;
+    }
+
+    void push(T&& item) {
+        if (!mIsActive) {
+            return;
+        }
+        pushInternal(std::move(item));
+        notifyConsumer();
+    }
+
+    void push(std::vector<T>&& items) {
+        if (!mIsActive) {
+            return;
+        }
+        for (T& item : items) {
+            pushInternal(std::move(item));
+        }
+        notifyConsumer();
+    }
+
+    // Deactivates the queue, thus no one can push items to it, also notifies all waiting thread.
+    // The items already in the queue could still be flushed even after the queue is deactivated.
+    void deactivate() {
+        mIsActive = false;
+        {
+            // Makes sure the consumer is either waiting or would see mIsActive is false.
+            std::scoped_lock<std::mutex> lockGuard(mWaitLock);
+        }
+        mCond.notify_all();
+    }
+
+    // Returns the number of items dropped because the queue was full.
+    uint64_t getDroppedItemCount() const { return mDroppedItemCount; }
+
+    // Returns the number of items replaced by a newer item for the same [propId, areaId] because
+    // the ring was full with the COALESCE_BY_PROP_ID policy.
+    uint64_t getCoalescedItemCount() const { return mCoalescedItemCount; }
+
+    size_t getCapacity() const { return mCapacity; }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    static size_t roundUpToPowerOf2(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mCapacity;
+    const size_t mMask;
+    const OverflowPolicy mPolicy;
+    const PropIdAreaIdKeyFunc mGetPropIdAreaIdKey;
+    std::unique_ptr<Cell[]> mCells;
+    // Keeps the producer and consumer positions on different cache lines.
+    alignas(64) std::atomic<size_t> mEnqueuePos = 0;
+    alignas(64) std::atomic<size_t> mDequeuePos = 0;
+    std::atomic<bool> mIsActive = true;
+    std::atomic<bool> mConsumerWaiting = false;
+    std::atomic<uint64_t> mDroppedItemCount = 0;
+    std::atomic<uint64_t> mCoalescedItemCount = 0;
+    std::mutex mWaitLock;
+    std::condition_variable mCond;
+    // Whether mOverflowItems is not empty. Once an item overflows, all the following items go to
+    // mOverflowItems until the consumer flushes, so the items stay in order.
+    std::atomic<bool> mOverflowing = false;
+    std::mutex mOverflowLock;
+    std::vector<T> mOverflowItems GUARDED_BY(mOverflowLock);
+    // The index in mOverflowItems for each [propId, areaId] key.
+    std::unordered_map<uint64_t, size_t> mOverflowIndexByKey GUARDED_BY(mOverflowLock);
+
+    void pushInternal(T&& item) {
+        if (mPolicy == OverflowPolicy::COALESCE_BY_PROP_ID) {
+            pushOrCoalesce(std::move(item));
+            return;
+        }
+        while (!tryPush(&item)) {
+            if (mPolicy == OverflowPolicy::DROP_NEWEST) {
+                mDroppedItemCount++;
+                return;
+            }
+            T droppedItem;
+            if (tryPop(&droppedItem)) {
+                mDroppedItemCount++;
+            }
+        }
+    }
+
+    void pushOrCoalesce(T&& item) {
+        if (mOverflowing.load(std::memory_order_acquire)) {
+            std::scoped_lock<std::mutex> lockGuard(mOverflowLock);
+            if (mOverflowing) {
+                overflowLocked(std::move(item));
+                return;
+            }
+        }
+        if (tryPush(&item)) {
+            return;
+        }
+        std::scoped_lock<std::mutex> lockGuard(mOverflowLock);
+        overflowLocked(std::move(item));
+        mOverflowing = true;
+    }
+
+    void overflowLocked(T&& item) REQUIRES(mOverflowLock) {
+        uint64_t key = mGetPropIdAreaIdKey(item);
+        if (auto it = mOverflowIndexByKey.find(key); it != mOverflowIndexByKey.end()) {
+            mOverflowItems[it->second] = std::move(item);
+            mCoalescedItemCount++;
+            return;
+        }
+        if (mOverflowItems.size() >= mCapacity) {
+            // Only happens if more than 'capacity' different [propId, areaId]s overflow.
+            mOverflowItems.erase(mOverflowItems.begin());
+            mDroppedItemCount++;
+            mOverflowIndexByKey.clear();
+            for (size_t i = 0; i < mOverflowItems.size(); i++) {
+                mOverflowIndexByKey[mGetPropIdAreaIdKey(mOverflowItems[i])] = i;
+            }
+        }
+        mOverflowIndexByKey[key] = mOverflowItems.size();
+        mOverflowItems.push_back(std::move(item));
+    }
+
+    // Only moves from 'item' if the push succeeds.
+    bool tryPush(T* item) {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &mCells[pos & mMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The queue is full.
+                return false;
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(*item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T* item) {
+        size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &mCells[pos & mMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The queue is empty.
+                return false;
+            } else {
+                pos = mDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        *item = std::move(cell->data);
+        cell->sequence.store(pos + mMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool hasItems() const {
+        size_t pos = mDequeuePos.load(std::memory_order_acquire);
+        return mCells[pos & mMask].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    void notifyConsumer() {
+        // Pairs with the fence in waitForItems.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!mConsumerWaiting.load(std::memory_order_relaxed)) {
+            return;
+        }
+        {
+            // Makes sure the consumer is already waiting on mCond, otherwise the notification
+            // might get lost.
+            std::scoped_lock<std::mutex> lockGuard(mWaitLock);
+        }
+        mCond.notify_one();
+    }
+};
+
+// QueueType could either be ConcurrentQueue<T> or BoundedConcurrentQueue<T>.
+template <typename T, typename QueueType = ConcurrentQueue<T>>
 class BatchingConsumer {
   private:
     enum class State {
@@ -121,14 +413,16 @@ class BatchingConsumer {
     BatchingConsumer(const BatchingConsumer&) = delete;
     BatchingConsumer& operator=(const BatchingConsumer&) = delete;
 
-    using OnBatchReceivedFunc = std::function<void(std::vector<T> vec)>;
+    // The callback could move the items out of 'vec', but 'vec' itself is reused for the next
+    // batch, so its capacity is only allocated once.
+    using OnBatchReceivedFunc = std::function<void(std::vector<T>& vec)>;
 
-    void run(ConcurrentQueue<T>* queue, std::chrono::nanoseconds batchInterval,
+    void run(QueueType* queue, std::chrono::nanoseconds batchInterval,
              const OnBatchReceivedFunc& func) {
         mQueue = queue;
         mBatchInterval = batchInterval;
 
-        mWorkerThread = std::thread(&BatchingConsumer<T>::runInternal, this, func);
+        mWorkerThread = std::thread(&BatchingConsumer<T, QueueType>::runInternal, this, func);
     }
 
     void requestStop() { mState = State::STOP_REQUESTED; }
@@ -142,6 +436,7 @@ class BatchingConsumer {
   private:
     void runInternal(const OnBatchReceivedFunc& onBatchReceived) {
         if (mState.exchange(State::RUNNING) == State::INIT) {
+            std::vector<T> items;
             while (State::RUNNING == mState) {
                 mQueue->waitForItems();
                 if (State::STOP_REQUESTED == mState) break;
@@ -149,10 +444,10 @@ class BatchingConsumer {
                 std::this_thread::sleep_for(mBatchInterval);
                 if (State::STOP_REQUESTED == mState) break;
 
-                std::vector<T> items = mQueue->flush();
+                mQueue->flush(&items);
 
                 if (items.size() > 0) {
-                    onBatchReceived(std::move(items));
+                    onBatchReceived(items);
                 }
             }
         }
@@ -165,7 +460,7 @@ class BatchingConsumer {
 
     std::atomic<State> mState;
     std::chrono::nanoseconds mBatchInterval;
-    ConcurrentQueue<T>* mQueue;
+    QueueType* mQueue;
 };
 
 }  // namespace vehicle
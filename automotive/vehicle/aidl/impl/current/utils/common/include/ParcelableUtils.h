@@ -29,12 +29,12 @@ namespace hardware {
 namespace automotive {
 namespace vehicle {
 
-// Turns the values into a stable large parcelable that could be sent via binder.
-// If values is small enough, it would be put into output.payloads, otherwise a shared memory file
-// would be created and output.sharedMemoryFd would be filled in.
-template <class T1, class T2>
-ndk::ScopedAStatus vectorToStableLargeParcelable(std::vector<T1>&& values, T2* output) {
-    output->payloads = std::move(values);
+// Turns the values already in output.payloads into a stable large parcelable that could be sent
+// via binder. If the values are small enough, they are kept in output.payloads, otherwise a shared
+// memory file would be created, output.sharedMemoryFd would be filled in and output.payloads would
+// be cleared. This allows the caller to reuse the payloads buffer.
+template <class T>
+ndk::ScopedAStatus payloadsToStableLargeParcelable(T* output) {
     auto result = android::automotive::car_binder_lib::LargeParcelableBase::
             parcelableToStableLargeParcelable(*output);
     if (!result.ok()) {
@@ -54,6 +54,15 @@ ndk::ScopedAStatus vectorToStableLargeParcelable(std::vector<T1>&& values, T2* o
     return ndk::ScopedAStatus::ok();
 }
 
+// Turns the values into a stable large parcelable that could be sent via binder.
+// If values is small enough, it would be put into output.payloads, otherwise a shared memory file
+// would be created and output.sharedMemoryFd would be filled in.
+template <class T1, class T2>
+ndk::ScopedAStatus vectorToStableLargeParcelable(std::vector<T1>&& values, T2* output) {
+    output->payloads = std::move(values);
+    return payloadsToStableLargeParcelable(output);
+}
+
 template <class T1, class T2>
 ndk::ScopedAStatus vectorToStableLargeParcelable(const std::vector<T1>& values, T2* output) {
     // Because 'values' is passed in as const reference, we have to do a copy here.
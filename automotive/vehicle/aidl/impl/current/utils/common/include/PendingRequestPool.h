@@ -21,11 +21,13 @@
 #include <android-base/result.h>
 #include <android-base/thread_annotations.h>
 
+#include <condition_variable>
 #include <list>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace android {
 namespace hardware {
@@ -73,25 +75,38 @@ class PendingRequestPool final {
     // more requests would fail. This is to prevent spamming from client.
     static constexpr size_t MAX_PENDING_REQUEST_PER_CLIENT = 10000;
 
+    // A batch of requests added by one {@code addRequests} call. They share the timeout timestamp
+    // and the callback.
     struct PendingRequest {
+        const void* clientId;
         std::unordered_set<int64_t> requestIds;
         int64_t timeoutTimestamp;
         std::shared_ptr<const TimeoutCallbackFunc> callback;
     };
 
-    int64_t mTimeoutInNano;
+    using PendingRequestIterator = std::list<PendingRequest>::iterator;
+
+    const int64_t mTimeoutInNano;
     mutable std::mutex mLock;
-    std::unordered_map<const void*, std::list<PendingRequest>> mPendingRequestsByClient
-            GUARDED_BY(mLock);
+    // All the pending request batches, ordered by their timeout timestamps. Since every batch
+    // uses the same timeout, a new batch always times out last and is appended to the end, so
+    // the timeout thread only needs to look at the front.
+    std::list<PendingRequest> mPendingRequests GUARDED_BY(mLock);
+    // Maps each pending request ID of a client to the batch containing it.
+    std::unordered_map<const void*, std::unordered_map<int64_t, PendingRequestIterator>>
+            mPendingRequestIndexByClient GUARDED_BY(mLock);
     std::thread mThread;
-    bool mThreadStop = false;
+    bool mThreadStop GUARDED_BY(mLock) = false;
     std::condition_variable mCv;
-    std::mutex mCvLock;
 
     bool isRequestPendingLocked(const void* clientId, int64_t requestId) const REQUIRES(mLock);
 
-    // Checks whether the requests in the pool has timed-out, run periodically in a separate thread.
-    void checkTimeout();
+    // Removes the timed-out request batches from the pool and returns them.
+    std::vector<PendingRequest> popTimeoutRequestsLocked(int64_t currentTime) REQUIRES(mLock);
+
+    // Waits for the earliest timeout timestamp and invokes the callbacks for the timed-out
+    // requests, run in a separate thread.
+    void checkTimeoutLoop();
 };
 
 }  // namespace vehicle
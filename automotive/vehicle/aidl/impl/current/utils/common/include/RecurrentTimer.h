@@ -21,6 +21,7 @@
 
 #include <utils/Looper.h>
 #include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -42,7 +43,17 @@ class RecurrentTimer final {
     // The class for the function that would be called recurrently.
     using Callback = std::function<void()>;
 
-    RecurrentTimer();
+    enum class Mode {
+        // Each registered callback has its own looper message.
+        PER_CALLBACK,
+        // Callbacks sharing the same deadline are grouped together and there is only one looper
+        // message for the earliest deadline. All the callbacks due at that time are invoked in one
+        // batch. This scales better when a large number of callbacks are registered since the
+        // deadlines are aligned to multiples of the interval.
+        COALESCED,
+    };
+
+    explicit RecurrentTimer(Mode mode = Mode::PER_CALLBACK);
 
     ~RecurrentTimer();
 
@@ -65,6 +76,7 @@ class RecurrentTimer final {
         int64_t nextTimeInNanos;
     };
 
+    const Mode mMode;
     android::sp<Looper> mLooper;
     android::sp<RecurrentMessageHandler> mHandler;
 
@@ -74,9 +86,18 @@ class RecurrentTimer final {
     std::thread mThread;
     std::unordered_map<std::shared_ptr<Callback>, int> mIdByCallback GUARDED_BY(mLock);
     std::unordered_map<int, std::unique_ptr<CallbackInfo>> mCallbackInfoById GUARDED_BY(mLock);
+    // Only used in COALESCED mode. The callback IDs grouped by their next deadline.
+    std::map<int64_t, std::vector<int>> mCallbackIdsByDeadline GUARDED_BY(mLock);
+    // Only used in COALESCED mode. The time for the currently scheduled looper message, or
+    // 0 if no message is scheduled.
+    int64_t mScheduledTimeInNanos GUARDED_BY(mLock) = 0;
 
     void handleMessage(const android::Message& message) EXCLUDES(mLock);
+    void handleCoalescedMessage() EXCLUDES(mLock);
     int getCallbackIdLocked(std::shared_ptr<Callback> callback) REQUIRES(mLock);
+    void scheduleLocked(int callbackId, int64_t nextTimeInNanos) REQUIRES(mLock);
+    void unscheduleLocked(int callbackId) REQUIRES(mLock);
+    void rescheduleCoalescedMessageLocked() REQUIRES(mLock);
 };
 
 class RecurrentMessageHandler final : public android::MessageHandler {
@@ -17,10 +17,14 @@
 #ifndef android_hardware_automotive_vehicle_utils_include_VehicleObjectPool_H_
 #define android_hardware_automotive_vehicle_utils_include_VehicleObjectPool_H_
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <VehicleHalTypes.h>
 
@@ -31,8 +35,14 @@ namespace hardware {
 namespace automotive {
 namespace vehicle {
 
-// Handy metric mostly for unit tests and debug.
+// Handy metric mostly for unit tests and debug. The metrics are atomics shared by all the pools
+// and updated on every obtain and recycle, define VEHICLE_OBJECT_POOL_DISABLE_STATS to compile
+// them out.
+#ifdef VEHICLE_OBJECT_POOL_DISABLE_STATS
+#define INC_METRIC_IF_DEBUG(val)
+#else
 #define INC_METRIC_IF_DEBUG(val) PoolStats::instance()->val++;
+#endif
 
 struct PoolStats {
     std::atomic<uint32_t> Obtained{0};
@@ -68,6 +78,13 @@ using recyclable_ptr = typename std::unique_ptr<T, Deleter<T>>;
 
 // Generic abstract object pool class. Users of this class must implement {@Code createObject}.
 //
+// Each thread keeps a small magazine of at most {@Code MAGAZINE_CAPACITY} objects in front of the
+// shared pool. {@Code obtain} and {@Code recycle} only use the calling thread's magazine, the
+// shared pool lock is only taken to move half a magazine of objects at once when the magazine is
+// empty or full. {@Code maxPoolObjectsSize} only bounds the shared pool, the magazines are bounded
+// by their capacity. The magazines of a destroyed pool are freed when the thread exits or next
+// uses a new pool.
+//
 // This class is thread-safe. Concurrent calls to {@Code obtain} from multiple threads is OK, also
 // client can obtain an object in one thread and then move ownership to another thread.
 template <typename T>
@@ -75,21 +92,40 @@ class ObjectPool {
   public:
     using GetSizeFunc = std::function<size_t(const T&)>;
 
+    // The max number of objects each thread caches for each pool.
+    static constexpr size_t MAGAZINE_CAPACITY = 16;
+
     ObjectPool(size_t maxPoolObjectsSize, GetSizeFunc getSizeFunc)
-        : mMaxPoolObjectsSize(maxPoolObjectsSize), mGetSizeFunc(getSizeFunc) {};
-    virtual ~ObjectPool() = default;
+        : mMaxPoolObjectsSize(maxPoolObjectsSize),
+          mPoolId(sNextPoolId++),
+          mAliveToken(std::make_shared<char>()),
+          mPoolObjectsSize(0),
+          mGetSizeFunc(getSizeFunc),
+          mDeleter(std::bind(&ObjectPool::recycle, this, std::placeholders::_1)) {};
+
+    virtual ~ObjectPool() {
+        // Frees the current thread's magazine right away, the other threads drop theirs lazily.
+        std::vector<Magazine>& magazines = getThreadMagazines();
+        magazines.erase(std::remove_if(magazines.begin(), magazines.end(),
+                                       [this](const Magazine& magazine) {
+                                           return magazine.poolId == mPoolId;
+                                       }),
+                        magazines.end());
+    }
 
     virtual recyclable_ptr<T> obtain() {
-        std::scoped_lock<std::mutex> lock(mLock);
         INC_METRIC_IF_DEBUG(Obtained)
-        if (mObjects.empty()) {
+        std::vector<std::unique_ptr<T>>& magazine = getMagazine();
+        if (magazine.empty()) {
+            refillMagazine(&magazine);
+        }
+        if (magazine.empty()) {
             INC_METRIC_IF_DEBUG(Created)
             return wrap(createObject());
         }
 
-        auto o = wrap(mObjects.front().release());
-        mObjects.pop_front();
-        mPoolObjectsSize -= mGetSizeFunc(*o);
+        auto o = wrap(magazine.back().release());
+        magazine.pop_back();
         return o;
     }
 
@@ -100,11 +136,12 @@ class ObjectPool {
     virtual T* createObject() = 0;
 
     virtual void recycle(T* o) {
-        std::scoped_lock<std::mutex> lock(mLock);
-        size_t objectSize = mGetSizeFunc(*o);
+        std::vector<std::unique_ptr<T>>& magazine = getMagazine();
+        if (magazine.size() >= MAGAZINE_CAPACITY) {
+            flushMagazine(&magazine);
+        }
 
-        if (objectSize > mMaxPoolObjectsSize ||
-            mPoolObjectsSize > mMaxPoolObjectsSize - objectSize) {
+        if (mGetSizeFunc(*o) > mMaxPoolObjectsSize || magazine.size() >= MAGAZINE_CAPACITY) {
             INC_METRIC_IF_DEBUG(Deleted)
 
             // We have no space left in the pool.
@@ -114,29 +151,84 @@ class ObjectPool {
 
         INC_METRIC_IF_DEBUG(Recycled)
 
-        mObjects.push_back(std::unique_ptr<T>{o});
-        mPoolObjectsSize += objectSize;
+        magazine.push_back(std::unique_ptr<T>{o});
     }
 
     const size_t mMaxPoolObjectsSize;
 
   private:
-    const Deleter<T>& getDeleter() {
-        if (!mDeleter.get()) {
-            Deleter<T>* d =
-                    new Deleter<T>(std::bind(&ObjectPool::recycle, this, std::placeholders::_1));
-            mDeleter.reset(d);
+    struct Magazine {
+        uint64_t poolId;
+        // Expires once the pool owning this magazine is destroyed.
+        std::weak_ptr<char> aliveToken;
+        std::vector<std::unique_ptr<T>> objects;
+    };
+
+    static inline std::atomic<uint64_t> sNextPoolId{0};
+
+    static std::vector<Magazine>& getThreadMagazines() {
+        static thread_local std::vector<Magazine> magazines;
+        return magazines;
+    }
+
+    std::vector<std::unique_ptr<T>>& getMagazine() {
+        std::vector<Magazine>& magazines = getThreadMagazines();
+        for (Magazine& magazine : magazines) {
+            if (magazine.poolId == mPoolId) {
+                return magazine.objects;
+            }
+        }
+
+        // Drops the magazines of the destroyed pools before adding a new one.
+        magazines.erase(std::remove_if(magazines.begin(), magazines.end(),
+                                       [](const Magazine& magazine) {
+                                           return magazine.aliveToken.expired();
+                                       }),
+                        magazines.end());
+        Magazine& magazine = magazines.emplace_back();
+        magazine.poolId = mPoolId;
+        magazine.aliveToken = mAliveToken;
+        magazine.objects.reserve(MAGAZINE_CAPACITY);
+        return magazine.objects;
+    }
+
+    // Moves up to half a magazine of objects from the shared pool to the magazine.
+    void refillMagazine(std::vector<std::unique_ptr<T>>* magazine) {
+        std::scoped_lock<std::mutex> lock(mLock);
+        while (!mObjects.empty() && magazine->size() < MAGAZINE_CAPACITY / 2) {
+            mPoolObjectsSize -= mGetSizeFunc(*mObjects.back());
+            magazine->push_back(std::move(mObjects.back()));
+            mObjects.pop_back();
         }
-        return *mDeleter.get();
     }
 
-    recyclable_ptr<T> wrap(T* raw) { return recyclable_ptr<T>{raw, getDeleter()}; }
+    // Moves the least recently recycled half of the magazine to the shared pool, as long as the
+    // shared pool has space left for them.
+    void flushMagazine(std::vector<std::unique_ptr<T>>* magazine) {
+        std::scoped_lock<std::mutex> lock(mLock);
+        size_t flushedCount = 0;
+        for (; flushedCount < magazine->size() / 2; flushedCount++) {
+            const std::unique_ptr<T>& o = (*magazine)[flushedCount];
+            size_t objectSize = mGetSizeFunc(*o);
+            if (objectSize > mMaxPoolObjectsSize ||
+                mPoolObjectsSize > mMaxPoolObjectsSize - objectSize) {
+                break;
+            }
+            mPoolObjectsSize += objectSize;
+            mObjects.push_back(std::move((*magazine)[flushedCount]));
+        }
+        magazine->erase(magazine->begin(), magazine->begin() + flushedCount);
+    }
 
+    recyclable_ptr<T> wrap(T* raw) { return recyclable_ptr<T>{raw, mDeleter}; }
+
+    const uint64_t mPoolId;
+    const std::shared_ptr<char> mAliveToken;
     mutable std::mutex mLock;
     std::deque<std::unique_ptr<T>> mObjects GUARDED_BY(mLock);
-    std::unique_ptr<Deleter<T>> mDeleter;
     size_t mPoolObjectsSize GUARDED_BY(mLock);
     GetSizeFunc mGetSizeFunc;
+    const Deleter<T> mDeleter;
 };
 
 #undef INC_METRIC_IF_DEBUG
@@ -155,6 +247,10 @@ class ObjectPool {
 // immediately once the go out of scope. There's no synchronization penalty for these objects since
 // we do not store them in the pool.
 //
+// Vector values are pooled by size class: the vector size is rounded up to the next power of two,
+// so values with 3 and 4 elements share the same pool. The value vector of an obtained object is
+// always resized to the requested size.
+//
 // This class is thread-safe. Users can obtain an object in one thread and pass it to another.
 //
 // Sample usage:
@@ -178,11 +274,10 @@ class VehiclePropValuePool {
     // unique pointer instead of a recyclable pointer. The object would not be recycled once it
     // goes out of scope, but would be deleted.
     // @param maxPoolObjectsSize - The approximate upper bound of memory each internal recycling
-    // pool could take. We have 4 different type pools, each with 4 different vector size, so
-    // approximately this pool would at-most take 4 * 4 * 10240 = 160k memory.
-    VehiclePropValuePool(size_t maxRecyclableVectorSize = 4, size_t maxPoolObjectsSize = 10240)
-        : mMaxRecyclableVectorSize(maxRecyclableVectorSize),
-          mMaxPoolObjectsSize(maxPoolObjectsSize) {};
+    // pool could take. With the default maxRecyclableVectorSize, we have 4 single value type pools
+    // and 4 vector type pools with 3 size classes (1, 2 and 4) each, so approximately this pool
+    // would at-most take 16 * 10240 = 160k memory, plus the per-thread magazines.
+    VehiclePropValuePool(size_t maxRecyclableVectorSize = 4, size_t maxPoolObjectsSize = 10240);
 
     // Obtain a recyclable VehiclePropertyValue object from the pool for the given type. If the
     // given type is not MIXED or STRING, the internal value vector size would be set to 1.
@@ -244,16 +339,27 @@ class VehiclePropValuePool {
     RecyclableType obtainRecyclable(
             aidl::android::hardware::automotive::vehicle::VehiclePropertyType type,
             size_t vectorSize);
+    void addPool(aidl::android::hardware::automotive::vehicle::VehiclePropertyType type,
+                 size_t sizeClass);
+
+    // Returns the smallest power of two that is not smaller than vectorSize.
+    static size_t getSizeClass(size_t vectorSize);
+    // VehiclePropertyType is not overlapping with the size class.
+    static int32_t getPoolKey(
+            aidl::android::hardware::automotive::vehicle::VehiclePropertyType type,
+            size_t sizeClass) {
+        return static_cast<int32_t>(type) | static_cast<int32_t>(sizeClass);
+    }
 
     class InternalPool
         : public ObjectPool<aidl::android::hardware::automotive::vehicle::VehiclePropValue> {
       public:
         InternalPool(aidl::android::hardware::automotive::vehicle::VehiclePropertyType type,
-                     size_t vectorSize, size_t maxPoolObjectsSize,
+                     size_t sizeClass, size_t maxPoolObjectsSize,
                      ObjectPool::GetSizeFunc getSizeFunc)
             : ObjectPool(maxPoolObjectsSize, getSizeFunc),
               mPropType(type),
-              mVectorSize(vectorSize) {}
+              mVectorSize(sizeClass) {}
 
       protected:
         aidl::android::hardware::automotive::vehicle::VehiclePropValue* createObject() override;
@@ -264,11 +370,12 @@ class VehiclePropValuePool {
 
         template <typename VecType>
         bool check(std::vector<VecType>* vec, bool isVectorType) {
-            return vec->size() == (isVectorType ? mVectorSize : 0);
+            return isVectorType ? vec->size() <= mVectorSize : vec->size() == 0;
         }
 
       private:
         aidl::android::hardware::automotive::vehicle::VehiclePropertyType mPropType;
+        // The size class, objects in this pool have at most this vector size.
         size_t mVectorSize;
     };
     const Deleter<aidl::android::hardware::automotive::vehicle::VehiclePropValue>
@@ -277,12 +384,12 @@ class VehiclePropValuePool {
                         delete v;
                     }};
 
-    mutable std::mutex mLock;
     const size_t mMaxRecyclableVectorSize;
     const size_t mMaxPoolObjectsSize;
-    // A map with 'property_type' | 'value_vector_size' as key and a recyclable object pool as
-    // value. We would create a recyclable pool for each property type and vector size combination.
-    std::map<int32_t, std::unique_ptr<InternalPool>> mValueTypePools GUARDED_BY(mLock);
+    // A map with 'property_type' | 'size_class' as key and a recyclable object pool as value. All
+    // the pools are created in the constructor and the map is never modified after that, so it is
+    // read without a lock.
+    std::map<int32_t, std::unique_ptr<InternalPool>> mValueTypePools;
 };
 
 }  // namespace vehicle
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include <VehicleHalTypes.h>
@@ -40,9 +41,15 @@ namespace vehicle {
 // VehiclePropertyValues stored in a sorted map thus it makes easier to get range of values, e.g.
 // to get value for all areas for particular property.
 //
-// This class is thread-safe, however it uses blocking synchronization across all methods.
+// This class is thread-safe. Records are partitioned into shards by property ID and each shard is
+// guarded by its own reader-writer lock, so readers never block each other and a writer only
+// blocks access to the properties in the same shard.
 class VehiclePropertyStore final {
   public:
+    // The default number of shards. Must be larger than 0. Using 1 shard makes all the operations
+    // serialize on a single lock.
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
     using ValueResultType = VhalResult<VehiclePropValuePool::RecyclableType>;
     using ValuesResultType = VhalResult<std::vector<VehiclePropValuePool::RecyclableType>>;
 
@@ -73,8 +80,8 @@ class VehiclePropertyStore final {
         NEVER,
     };
 
-    explicit VehiclePropertyStore(std::shared_ptr<VehiclePropValuePool> valuePool)
-        : mValuePool(valuePool) {}
+    explicit VehiclePropertyStore(std::shared_ptr<VehiclePropValuePool> valuePool,
+                                  size_t shardCount = DEFAULT_SHARD_COUNT);
 
     ~VehiclePropertyStore();
 
@@ -96,7 +103,7 @@ class VehiclePropertyStore final {
     // used as the key.
     void registerProperty(
             const aidl::android::hardware::automotive::vehicle::VehiclePropConfig& config,
-            TokenFunction tokenFunc = nullptr) EXCLUDES(mLock);
+            TokenFunction tokenFunc = nullptr);
 
     // Stores provided value. Returns error if config wasn't registered. If 'updateStatus' is
     // true, the 'status' in 'propValue' would be stored. Otherwise, if this is a new value,
@@ -109,70 +116,69 @@ class VehiclePropertyStore final {
     VhalResult<void> writeValue(VehiclePropValuePool::RecyclableType propValue,
                                 bool updateStatus = false,
                                 EventMode mode = EventMode::ON_VALUE_CHANGE,
-                                bool useCurrentTimestamp = false) EXCLUDES(mLock);
+                                bool useCurrentTimestamp = false) EXCLUDES(mCallbackLock);
 
     // Refresh the timestamp for the stored property value for [propId, areaId]. If eventMode is
     // always, generates the property update event, otherwise, only update the stored timestamp
     // without generating event. This operation is atomic with other writeValue operations.
-    void refreshTimestamp(int32_t propId, int32_t areaId, EventMode eventMode) EXCLUDES(mLock);
+    void refreshTimestamp(int32_t propId, int32_t areaId, EventMode eventMode)
+            EXCLUDES(mCallbackLock);
 
     // Refresh the timestamp for multiple [propId, areaId]s.
     void refreshTimestamps(
             std::unordered_map<PropIdAreaId, EventMode, PropIdAreaIdHash> eventModeByPropIdAreaId)
-            EXCLUDES(mLock);
+            EXCLUDES(mCallbackLock);
 
     // Remove a given property value from the property store. The 'propValue' would be used to
     // generate the key for the value to remove.
     void removeValue(
-            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& propValue)
-            EXCLUDES(mLock);
+            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& propValue);
 
     // Remove all the values for the property.
-    void removeValuesForProperty(int32_t propId) EXCLUDES(mLock);
+    void removeValuesForProperty(int32_t propId);
 
     // Read all the stored values.
-    std::vector<VehiclePropValuePool::RecyclableType> readAllValues() const EXCLUDES(mLock);
+    std::vector<VehiclePropValuePool::RecyclableType> readAllValues() const;
 
     // Read all the values for the property.
-    ValuesResultType readValuesForProperty(int32_t propId) const EXCLUDES(mLock);
+    ValuesResultType readValuesForProperty(int32_t propId) const;
 
     // Read the value for the requested property. Returns {@code StatusCode::NOT_AVAILABLE} if the
     // value has not been set yet. Returns {@code StatusCode::INVALID_ARG} if the property is
     // not configured.
     ValueResultType readValue(
-            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& request) const
-            EXCLUDES(mLock);
+            const aidl::android::hardware::automotive::vehicle::VehiclePropValue& request) const;
 
     // Read the value for the requested property. Returns {@code StatusCode::NOT_AVAILABLE} if the
     // value has not been set yet. Returns {@code StatusCode::INVALID_ARG} if the property is
     // not configured.
-    ValueResultType readValue(int32_t prop, int32_t area = 0, int64_t token = 0) const
-            EXCLUDES(mLock);
+    ValueResultType readValue(int32_t prop, int32_t area = 0, int64_t token = 0) const;
 
     // Get all property configs.
     std::vector<aidl::android::hardware::automotive::vehicle::VehiclePropConfig> getAllConfigs()
-            const EXCLUDES(mLock);
+            const;
 
     // Deprecated, use getPropConfig instead. This is unsafe to use if registerProperty overwrites
     // an existing config.
     android::base::Result<const aidl::android::hardware::automotive::vehicle::VehiclePropConfig*,
                           VhalError>
-    getConfig(int32_t propId) const EXCLUDES(mLock);
+    getConfig(int32_t propId) const;
 
     // Get the property config for the requested property.
     android::base::Result<aidl::android::hardware::automotive::vehicle::VehiclePropConfig,
                           VhalError>
-    getPropConfig(int32_t propId) const EXCLUDES(mLock);
+    getPropConfig(int32_t propId) const;
 
     // Set a callback that would be called when a property value has been updated.
-    void setOnValueChangeCallback(const OnValueChangeCallback& callback) EXCLUDES(mLock);
+    void setOnValueChangeCallback(const OnValueChangeCallback& callback) EXCLUDES(mCallbackLock);
 
     // Set a callback that would be called when one or more property values have been updated.
     // For backward compatibility, this is optional. If this is not set, then multiple property
     // updates will be delivered through multiple OnValueChangeCallback instead.
     // It is recommended to set this and batch the property update events for better performance.
     // If this is set, then OnValueChangeCallback will not be used.
-    void setOnValuesChangeCallback(const OnValuesChangeCallback& callback) EXCLUDES(mLock);
+    void setOnValuesChangeCallback(const OnValuesChangeCallback& callback)
+            EXCLUDES(mCallbackLock);
 
     inline std::shared_ptr<VehiclePropValuePool> getValuePool() { return mValuePool; }
 
@@ -198,14 +204,25 @@ class VehiclePropertyStore final {
 
     // {@code VehiclePropValuePool} is thread-safe.
     std::shared_ptr<VehiclePropValuePool> mValuePool;
-    mutable std::mutex mLock;
-    std::unordered_map<int32_t, Record> mRecordsByPropId GUARDED_BY(mLock);
-    OnValueChangeCallback mOnValueChangeCallback GUARDED_BY(mLock);
-    OnValuesChangeCallback mOnValuesChangeCallback GUARDED_BY(mLock);
+    // A partition of the records. A property always belongs to the shard chosen by its ID.
+    // 'recordsByPropId' must only be accessed with 'lock' held, either shared for reading or
+    // exclusively for writing. std::shared_lock is not annotated so we cannot use GUARDED_BY here.
+    struct Shard {
+        mutable std::shared_mutex lock;
+        std::unordered_map<int32_t, Record> recordsByPropId;
+    };
+
+    // The shards are allocated once in the constructor and never resized.
+    std::vector<std::unique_ptr<Shard>> mShards;
+    mutable std::mutex mCallbackLock;
+    OnValueChangeCallback mOnValueChangeCallback GUARDED_BY(mCallbackLock);
+    OnValuesChangeCallback mOnValuesChangeCallback GUARDED_BY(mCallbackLock);
+
+    Shard& getShard(int32_t propId) const;
 
-    const Record* getRecordLocked(int32_t propId) const;
+    const Record* getRecordLocked(const Shard& shard, int32_t propId) const;
 
-    Record* getRecordLocked(int32_t propId);
+    Record* getRecordLocked(Shard& shard, int32_t propId);
 
     RecordId getRecordIdLocked(
             const aidl::android::hardware::automotive::vehicle::VehiclePropValue& propValue,
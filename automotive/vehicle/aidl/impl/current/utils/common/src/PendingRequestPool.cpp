@@ -19,9 +19,12 @@
 #include <VehicleHalTypes.h>
 #include <VehicleUtils.h>
 
+#include <android-base/thread_annotations.h>
 #include <utils/Log.h>
 #include <utils/SystemClock.h>
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 namespace android {
@@ -40,24 +43,14 @@ constexpr int64_t CHECK_TIME_IN_NANO = 1'000'000'000;
 }  // namespace
 
 PendingRequestPool::PendingRequestPool(int64_t timeoutInNano) : mTimeoutInNano(timeoutInNano) {
-    mThread = std::thread([this] {
-        // [this] must be alive within this thread because destructor would wait for this thread
-        // to exit.
-        int64_t sleepTime = std::min(mTimeoutInNano, static_cast<int64_t>(CHECK_TIME_IN_NANO));
-        std::unique_lock<std::mutex> lk(mCvLock);
-        while (!mCv.wait_for(lk, std::chrono::nanoseconds(sleepTime),
-                             [this] { return mThreadStop; })) {
-            checkTimeout();
-        }
-    });
+    // [this] must be alive within this thread because destructor would wait for this thread to
+    // exit.
+    mThread = std::thread([this] { checkTimeoutLoop(); });
 }
 
 PendingRequestPool::~PendingRequestPool() {
     {
-        // Even if the shared variable is atomic, it must be modified under the
-        // mutex in order to correctly publish the modification to the waiting
-        // thread.
-        std::unique_lock<std::mutex> lk(mCvLock);
+        std::scoped_lock<std::mutex> lockGuard(mLock);
         mThreadStop = true;
     }
     mCv.notify_all();
@@ -69,51 +62,60 @@ PendingRequestPool::~PendingRequestPool() {
     {
         std::scoped_lock<std::mutex> lockGuard(mLock);
 
-        for (auto& [_, pendingRequests] : mPendingRequestsByClient) {
-            for (const auto& request : pendingRequests) {
-                (*request.callback)(request.requestIds);
-            }
+        for (const auto& request : mPendingRequests) {
+            (*request.callback)(request.requestIds);
         }
-        mPendingRequestsByClient.clear();
+        mPendingRequests.clear();
+        mPendingRequestIndexByClient.clear();
     }
 }
 
 VhalResult<void> PendingRequestPool::addRequests(
         const void* clientId, const std::unordered_set<int64_t>& requestIds,
         std::shared_ptr<const TimeoutCallbackFunc> callback) {
-    std::scoped_lock<std::mutex> lockGuard(mLock);
-    std::list<PendingRequest>* pendingRequests;
-    size_t pendingRequestCount = 0;
-    if (mPendingRequestsByClient.find(clientId) != mPendingRequestsByClient.end()) {
-        pendingRequests = &mPendingRequestsByClient[clientId];
-        for (const auto& pendingRequest : *pendingRequests) {
-            const auto& pendingRequestIds = pendingRequest.requestIds;
-            for (int64_t requestId : requestIds) {
-                if (pendingRequestIds.find(requestId) != pendingRequestIds.end()) {
-                    return StatusError(StatusCode::INVALID_ARG)
-                           << "duplicate request ID: " << requestId;
+    bool wasEmpty = false;
+    {
+        std::scoped_lock<std::mutex> lockGuard(mLock);
+        auto& requestIndex = mPendingRequestIndexByClient[clientId];
+        for (int64_t requestId : requestIds) {
+            if (requestIndex.find(requestId) != requestIndex.end()) {
+                if (requestIndex.empty()) {
+                    mPendingRequestIndexByClient.erase(clientId);
                 }
+                return StatusError(StatusCode::INVALID_ARG)
+                       << "duplicate request ID: " << requestId;
             }
-            pendingRequestCount += pendingRequestIds.size();
         }
-    } else {
-        // Create a new empty list for this client.
-        pendingRequests = &mPendingRequestsByClient[clientId];
-    }
-
-    if (requestIds.size() > MAX_PENDING_REQUEST_PER_CLIENT - pendingRequestCount) {
-        return StatusError(StatusCode::TRY_AGAIN) << "too many pending requests";
-    }
 
-    int64_t currentTime = elapsedRealtimeNano();
-    int64_t timeoutTimestamp = currentTime + mTimeoutInNano;
+        if (requestIds.size() > MAX_PENDING_REQUEST_PER_CLIENT - requestIndex.size()) {
+            if (requestIndex.empty()) {
+                mPendingRequestIndexByClient.erase(clientId);
+            }
+            return StatusError(StatusCode::TRY_AGAIN) << "too many pending requests";
+        }
 
-    pendingRequests->push_back({
-            .requestIds = std::unordered_set<int64_t>(requestIds.begin(), requestIds.end()),
-            .timeoutTimestamp = timeoutTimestamp,
-            .callback = callback,
-    });
+        int64_t currentTime = elapsedRealtimeNano();
+        int64_t timeoutTimestamp = currentTime + mTimeoutInNano;
+
+        wasEmpty = mPendingRequests.empty();
+        auto it = mPendingRequests.insert(mPendingRequests.end(),
+                                          {
+                                                  .clientId = clientId,
+                                                  .requestIds = requestIds,
+                                                  .timeoutTimestamp = timeoutTimestamp,
+                                                  .callback = callback,
+                                          });
+        requestIndex.reserve(requestIndex.size() + requestIds.size());
+        for (int64_t requestId : requestIds) {
+            requestIndex[requestId] = it;
+        }
+    }
 
+    // Other batches time out before this one, so the timeout thread only needs to be woken up
+    // if it is waiting for the first batch.
+    if (wasEmpty) {
+        mCv.notify_one();
+    }
     return {};
 }
 
@@ -127,10 +129,8 @@ size_t PendingRequestPool::countPendingRequests() const {
     std::scoped_lock<std::mutex> lockGuard(mLock);
 
     size_t count = 0;
-    for (const auto& [clientId, requests] : mPendingRequestsByClient) {
-        for (const auto& request : requests) {
-            count += request.requestIds.size();
-        }
+    for (const auto& [_, requestIndex] : mPendingRequestIndexByClient) {
+        count += requestIndex.size();
     }
     return count;
 }
@@ -138,65 +138,72 @@ size_t PendingRequestPool::countPendingRequests() const {
 size_t PendingRequestPool::countPendingRequests(const void* clientId) const {
     std::scoped_lock<std::mutex> lockGuard(mLock);
 
-    auto it = mPendingRequestsByClient.find(clientId);
-    if (it == mPendingRequestsByClient.end()) {
+    auto it = mPendingRequestIndexByClient.find(clientId);
+    if (it == mPendingRequestIndexByClient.end()) {
         return 0;
     }
-
-    size_t count = 0;
-    for (const auto& pendingRequest : it->second) {
-        count += pendingRequest.requestIds.size();
-    }
-
-    return count;
+    return it->second.size();
 }
 
 bool PendingRequestPool::isRequestPendingLocked(const void* clientId, int64_t requestId) const {
-    auto it = mPendingRequestsByClient.find(clientId);
-    if (it == mPendingRequestsByClient.end()) {
+    auto it = mPendingRequestIndexByClient.find(clientId);
+    if (it == mPendingRequestIndexByClient.end()) {
         return false;
     }
-    for (const auto& pendingRequest : it->second) {
-        const auto& requestIds = pendingRequest.requestIds;
-        if (requestIds.find(requestId) != requestIds.end()) {
-            return true;
-        }
-    }
-    return false;
+    return it->second.find(requestId) != it->second.end();
 }
 
-void PendingRequestPool::checkTimeout() {
+std::vector<PendingRequestPool::PendingRequest> PendingRequestPool::popTimeoutRequestsLocked(
+        int64_t currentTime) {
     std::vector<PendingRequest> timeoutRequests;
-    {
-        std::scoped_lock<std::mutex> lockGuard(mLock);
-
-        int64_t currentTime = elapsedRealtimeNano();
-
-        std::vector<const void*> clientsWithEmptyRequests;
-
-        for (auto& [clientId, pendingRequests] : mPendingRequestsByClient) {
-            auto it = pendingRequests.begin();
-            while (it != pendingRequests.end()) {
-                if (it->timeoutTimestamp >= currentTime) {
-                    break;
-                }
-                timeoutRequests.push_back(std::move(*it));
-                it = pendingRequests.erase(it);
+    while (!mPendingRequests.empty() && mPendingRequests.front().timeoutTimestamp < currentTime) {
+        PendingRequest& request = mPendingRequests.front();
+        auto indexIt = mPendingRequestIndexByClient.find(request.clientId);
+        if (indexIt != mPendingRequestIndexByClient.end()) {
+            auto& requestIndex = indexIt->second;
+            for (int64_t requestId : request.requestIds) {
+                requestIndex.erase(requestId);
             }
-
-            if (pendingRequests.empty()) {
-                clientsWithEmptyRequests.push_back(clientId);
+            if (requestIndex.empty()) {
+                mPendingRequestIndexByClient.erase(indexIt);
             }
         }
+        timeoutRequests.push_back(std::move(request));
+        mPendingRequests.pop_front();
+    }
+    return timeoutRequests;
+}
+
+void PendingRequestPool::checkTimeoutLoop() {
+    std::unique_lock<std::mutex> lk(mLock);
+    while (true) {
+        android::base::ScopedLockAssertion lockAssertion(mLock);
 
-        for (const void* clientId : clientsWithEmptyRequests) {
-            mPendingRequestsByClient.erase(clientId);
+        if (mThreadStop) {
+            return;
         }
-    }
+        if (mPendingRequests.empty()) {
+            mCv.wait(lk);
+            continue;
+        }
+        int64_t currentTime = elapsedRealtimeNano();
+        int64_t timeoutTimestamp = mPendingRequests.front().timeoutTimestamp;
+        if (timeoutTimestamp >= currentTime) {
+            // The condition variable uses a clock that does not advance during suspend while
+            // the timestamps do, so wake up at least every CHECK_TIME_IN_NANO to recheck.
+            int64_t sleepTime = std::min(timeoutTimestamp - currentTime + 1, CHECK_TIME_IN_NANO);
+            mCv.wait_for(lk, std::chrono::nanoseconds(sleepTime));
+            continue;
+        }
+
+        std::vector<PendingRequest> timeoutRequests = popTimeoutRequestsLocked(currentTime);
 
-    // Call the callback outside the lock.
-    for (const auto& request : timeoutRequests) {
-        (*request.callback)(request.requestIds);
+        // Call the callback outside the lock.
+        lk.unlock();
+        for (const auto& request : timeoutRequests) {
+            (*request.callback)(request.requestIds);
+        }
+        lk.lock();
     }
 }
 
@@ -206,27 +213,27 @@ std::unordered_set<int64_t> PendingRequestPool::tryFinishRequests(
 
     std::unordered_set<int64_t> foundIds;
 
-    if (mPendingRequestsByClient.find(clientId) == mPendingRequestsByClient.end()) {
+    auto indexIt = mPendingRequestIndexByClient.find(clientId);
+    if (indexIt == mPendingRequestIndexByClient.end()) {
         return foundIds;
     }
 
-    auto& pendingRequests = mPendingRequestsByClient[clientId];
-    auto it = pendingRequests.begin();
-    while (it != pendingRequests.end()) {
-        auto& pendingRequestIds = it->requestIds;
-        for (int64_t requestId : requestIds) {
-            auto idIt = pendingRequestIds.find(requestId);
-            if (idIt == pendingRequestIds.end()) {
-                continue;
-            }
-            pendingRequestIds.erase(idIt);
-            foundIds.insert(requestId);
-        }
-        if (pendingRequestIds.empty()) {
-            it = pendingRequests.erase(it);
+    auto& requestIndex = indexIt->second;
+    for (int64_t requestId : requestIds) {
+        auto it = requestIndex.find(requestId);
+        if (it == requestIndex.end()) {
             continue;
         }
-        it++;
+        PendingRequestIterator requestIt = it->second;
+        requestIndex.erase(it);
+        requestIt->requestIds.erase(requestId);
+        if (requestIt->requestIds.empty()) {
+            mPendingRequests.erase(requestIt);
+        }
+        foundIds.insert(requestId);
+    }
+    if (requestIndex.empty()) {
+        mPendingRequestIndexByClient.erase(indexIt);
     }
 
     return foundIds;
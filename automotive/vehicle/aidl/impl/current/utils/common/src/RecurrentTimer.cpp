@@ -22,6 +22,7 @@
 
 #include <inttypes.h>
 #include <math.h>
+#include <algorithm>
 
 namespace android {
 namespace hardware {
@@ -33,10 +34,12 @@ namespace {
 using ::android::base::ScopedLockAssertion;
 
 constexpr int INVALID_ID = -1;
+// The looper message ID used in COALESCED mode. Must not collide with any callback ID.
+constexpr int COALESCED_MESSAGE_ID = -2;
 
 }  // namespace
 
-RecurrentTimer::RecurrentTimer() {
+RecurrentTimer::RecurrentTimer(RecurrentTimer::Mode mode) : mMode(mode) {
     mHandler = sp<RecurrentMessageHandler>::make(this);
     mLooper = sp<Looper>::make(/*allowNonCallbacks=*/false);
     mThread = std::thread([this] {
@@ -65,6 +68,56 @@ int RecurrentTimer::getCallbackIdLocked(std::shared_ptr<RecurrentTimer::Callback
     return INVALID_ID;
 }
 
+void RecurrentTimer::scheduleLocked(int callbackId, int64_t nextTimeInNanos) {
+    if (mMode == Mode::PER_CALLBACK) {
+        mLooper->sendMessageAtTime(nextTimeInNanos, mHandler, Message(callbackId));
+        return;
+    }
+    mCallbackIdsByDeadline[nextTimeInNanos].push_back(callbackId);
+    rescheduleCoalescedMessageLocked();
+}
+
+void RecurrentTimer::unscheduleLocked(int callbackId) {
+    if (mMode == Mode::PER_CALLBACK) {
+        mLooper->removeMessages(mHandler, callbackId);
+        return;
+    }
+    auto infoIt = mCallbackInfoById.find(callbackId);
+    if (infoIt == mCallbackInfoById.end()) {
+        return;
+    }
+    auto groupIt = mCallbackIdsByDeadline.find(infoIt->second->nextTimeInNanos);
+    if (groupIt == mCallbackIdsByDeadline.end()) {
+        return;
+    }
+    std::vector<int>& callbackIds = groupIt->second;
+    callbackIds.erase(std::remove(callbackIds.begin(), callbackIds.end(), callbackId),
+                      callbackIds.end());
+    if (callbackIds.empty()) {
+        mCallbackIdsByDeadline.erase(groupIt);
+        rescheduleCoalescedMessageLocked();
+    }
+}
+
+void RecurrentTimer::rescheduleCoalescedMessageLocked() {
+    if (mCallbackIdsByDeadline.empty()) {
+        if (mScheduledTimeInNanos != 0) {
+            mLooper->removeMessages(mHandler, COALESCED_MESSAGE_ID);
+            mScheduledTimeInNanos = 0;
+        }
+        return;
+    }
+    int64_t earliestTimeInNanos = mCallbackIdsByDeadline.begin()->first;
+    if (mScheduledTimeInNanos == earliestTimeInNanos) {
+        return;
+    }
+    if (mScheduledTimeInNanos != 0) {
+        mLooper->removeMessages(mHandler, COALESCED_MESSAGE_ID);
+    }
+    mLooper->sendMessageAtTime(earliestTimeInNanos, mHandler, Message(COALESCED_MESSAGE_ID));
+    mScheduledTimeInNanos = earliestTimeInNanos;
+}
+
 void RecurrentTimer::registerTimerCallback(int64_t intervalInNanos,
                                            std::shared_ptr<RecurrentTimer::Callback> callback) {
     {
@@ -79,7 +132,7 @@ void RecurrentTimer::registerTimerCallback(int64_t intervalInNanos,
             ALOGI("Replacing an existing timer callback with a new interval, current: %" PRId64
                   " ns, new: %" PRId64 " ns",
                   mCallbackInfoById[callbackId]->intervalInNanos, intervalInNanos);
-            mLooper->removeMessages(mHandler, callbackId);
+            unscheduleLocked(callbackId);
         }
 
         // Aligns the nextTime to multiply of interval.
@@ -89,9 +142,9 @@ void RecurrentTimer::registerTimerCallback(int64_t intervalInNanos,
         info->callback = callback;
         info->intervalInNanos = intervalInNanos;
         info->nextTimeInNanos = nextTimeInNanos;
-        mCallbackInfoById.insert({callbackId, std::move(info)});
+        mCallbackInfoById[callbackId] = std::move(info);
 
-        mLooper->sendMessageAtTime(nextTimeInNanos, mHandler, Message(callbackId));
+        scheduleLocked(callbackId, nextTimeInNanos);
     }
 }
 
@@ -106,13 +159,18 @@ void RecurrentTimer::unregisterTimerCallback(std::shared_ptr<RecurrentTimer::Cal
             return;
         }
 
-        mLooper->removeMessages(mHandler, callbackId);
+        unscheduleLocked(callbackId);
         mCallbackInfoById.erase(callbackId);
         mIdByCallback.erase(callback);
     }
 }
 
 void RecurrentTimer::handleMessage(const Message& message) {
+    if (message.what == COALESCED_MESSAGE_ID) {
+        handleCoalescedMessage();
+        return;
+    }
+
     std::shared_ptr<RecurrentTimer::Callback> callback;
     {
         std::scoped_lock<std::mutex> lockGuard(mLock);
@@ -139,6 +197,45 @@ void RecurrentTimer::handleMessage(const Message& message) {
     (*callback)();
 }
 
+void RecurrentTimer::handleCoalescedMessage() {
+    std::vector<std::shared_ptr<RecurrentTimer::Callback>> callbacks;
+    {
+        std::scoped_lock<std::mutex> lockGuard(mLock);
+
+        mScheduledTimeInNanos = 0;
+        int64_t nowNanos = uptimeNanos();
+        while (!mCallbackIdsByDeadline.empty() &&
+               mCallbackIdsByDeadline.begin()->first <= nowNanos) {
+            std::vector<int> callbackIds = std::move(mCallbackIdsByDeadline.begin()->second);
+            mCallbackIdsByDeadline.erase(mCallbackIdsByDeadline.begin());
+
+            for (int callbackId : callbackIds) {
+                auto it = mCallbackInfoById.find(callbackId);
+                if (it == mCallbackInfoById.end()) {
+                    continue;
+                }
+                CallbackInfo* callbackInfo = it->second.get();
+                callbacks.push_back(callbackInfo->callback);
+                // intervalCount is the number of interval we have to advance until we pass now.
+                size_t intervalCount = (nowNanos - callbackInfo->nextTimeInNanos) /
+                                               callbackInfo->intervalInNanos +
+                                       1;
+                callbackInfo->nextTimeInNanos += intervalCount * callbackInfo->intervalInNanos;
+                // The new deadline is always after now, so this group would not be visited again
+                // in this loop.
+                mCallbackIdsByDeadline[callbackInfo->nextTimeInNanos].push_back(callbackId);
+            }
+        }
+
+        rescheduleCoalescedMessageLocked();
+    }
+
+    // Invoke all the callbacks due at this time in one batch outside the lock.
+    for (const auto& callback : callbacks) {
+        (*callback)();
+    }
+}
+
 void RecurrentMessageHandler::handleMessage(const Message& message) {
     mTimer->handleMessage(message);
 }
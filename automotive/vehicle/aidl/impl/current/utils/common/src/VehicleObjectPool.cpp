@@ -33,6 +33,72 @@ using ::aidl::android::hardware::automotive::vehicle::VehicleProperty;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyType;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
 
+namespace {
+
+void setValueVectorSize(VehiclePropertyType type, size_t vectorSize, RawPropValues* value) {
+    switch (type) {
+        case VehiclePropertyType::BOOLEAN:
+            [[fallthrough]];
+        case VehiclePropertyType::INT32:
+            [[fallthrough]];
+        case VehiclePropertyType::INT32_VEC:
+            value->int32Values.assign(vectorSize, 0);
+            return;
+        case VehiclePropertyType::FLOAT:
+            [[fallthrough]];
+        case VehiclePropertyType::FLOAT_VEC:
+            value->floatValues.assign(vectorSize, 0);
+            return;
+        case VehiclePropertyType::INT64:
+            [[fallthrough]];
+        case VehiclePropertyType::INT64_VEC:
+            value->int64Values.assign(vectorSize, 0);
+            return;
+        case VehiclePropertyType::BYTES:
+            value->byteValues.assign(vectorSize, 0);
+            return;
+        default:
+            return;
+    }
+}
+
+}  // namespace
+
+VehiclePropValuePool::VehiclePropValuePool(size_t maxRecyclableVectorSize,
+                                           size_t maxPoolObjectsSize)
+    : mMaxRecyclableVectorSize(maxRecyclableVectorSize), mMaxPoolObjectsSize(maxPoolObjectsSize) {
+    for (VehiclePropertyType type :
+         {VehiclePropertyType::BOOLEAN, VehiclePropertyType::INT32, VehiclePropertyType::INT64,
+          VehiclePropertyType::FLOAT}) {
+        addPool(type, 1);
+    }
+    if (maxRecyclableVectorSize == 0) {
+        return;
+    }
+    for (VehiclePropertyType type :
+         {VehiclePropertyType::INT32_VEC, VehiclePropertyType::INT64_VEC,
+          VehiclePropertyType::FLOAT_VEC, VehiclePropertyType::BYTES}) {
+        size_t maxSizeClass = getSizeClass(maxRecyclableVectorSize);
+        for (size_t sizeClass = 1; sizeClass <= maxSizeClass; sizeClass <<= 1) {
+            addPool(type, sizeClass);
+        }
+    }
+}
+
+void VehiclePropValuePool::addPool(VehiclePropertyType type, size_t sizeClass) {
+    mValueTypePools.emplace(getPoolKey(type, sizeClass),
+                            std::make_unique<InternalPool>(type, sizeClass, mMaxPoolObjectsSize,
+                                                           getVehiclePropValueSize));
+}
+
+size_t VehiclePropValuePool::getSizeClass(size_t vectorSize) {
+    size_t sizeClass = 1;
+    while (sizeClass < vectorSize) {
+        sizeClass <<= 1;
+    }
+    return sizeClass;
+}
+
 VehiclePropValuePool::RecyclableType VehiclePropValuePool::obtain(VehiclePropertyType type) {
     if (isComplexType(type)) {
         return obtain(type, 0);
@@ -96,19 +162,18 @@ VehiclePropValuePool::RecyclableType VehiclePropValuePool::obtainComplex() {
 
 VehiclePropValuePool::RecyclableType VehiclePropValuePool::obtainRecyclable(
         VehiclePropertyType type, size_t vectorSize) {
-    std::scoped_lock<std::mutex> lock(mLock);
     assert(vectorSize > 0);
 
-    // VehiclePropertyType is not overlapping with vectorSize.
-    int32_t key = static_cast<int32_t>(type) | static_cast<int32_t>(vectorSize);
-    auto it = mValueTypePools.find(key);
-
+    auto it = mValueTypePools.find(getPoolKey(type, getSizeClass(vectorSize)));
     if (it == mValueTypePools.end()) {
-        auto newPool(std::make_unique<InternalPool>(type, vectorSize, mMaxPoolObjectsSize,
-                                                    getVehiclePropValueSize));
-        it = mValueTypePools.emplace(key, std::move(newPool)).first;
+        // All the recyclable types have a pool created in the constructor.
+        ALOGE("No pool for type: %d, vector size: %zu", toInt(type), vectorSize);
+        return obtainDisposable(type, vectorSize);
     }
-    return it->second->obtain();
+
+    auto value = it->second->obtain();
+    setValueVectorSize(type, vectorSize, &value->value);
+    return value;
 }
 
 VehiclePropValuePool::RecyclableType VehiclePropValuePool::obtainBoolean(bool value) {
@@ -55,29 +55,46 @@ size_t VehiclePropertyStore::RecordIdHash::operator()(RecordId const& recordId)
     return res;
 }
 
-VehiclePropertyStore::~VehiclePropertyStore() {
-    std::scoped_lock<std::mutex> lockGuard(mLock);
+VehiclePropertyStore::VehiclePropertyStore(std::shared_ptr<VehiclePropValuePool> valuePool,
+                                           size_t shardCount)
+    : mValuePool(valuePool) {
+    if (shardCount == 0) {
+        ALOGW("shard count must be larger than 0, use 1 instead");
+        shardCount = 1;
+    }
+    mShards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; i++) {
+        mShards.push_back(std::make_unique<Shard>());
+    }
+}
 
+VehiclePropertyStore::~VehiclePropertyStore() {
     // Recycling record requires mValuePool, so need to recycle them before destroying mValuePool.
-    mRecordsByPropId.clear();
+    for (auto& shard : mShards) {
+        std::unique_lock<std::shared_mutex> lockGuard(shard->lock);
+        shard->recordsByPropId.clear();
+    }
     mValuePool.reset();
 }
 
-const VehiclePropertyStore::Record* VehiclePropertyStore::getRecordLocked(int32_t propId) const
-        REQUIRES(mLock) {
-    auto RecordIt = mRecordsByPropId.find(propId);
-    return RecordIt == mRecordsByPropId.end() ? nullptr : &RecordIt->second;
+VehiclePropertyStore::Shard& VehiclePropertyStore::getShard(int32_t propId) const {
+    return *mShards[static_cast<uint32_t>(propId) % mShards.size()];
+}
+
+const VehiclePropertyStore::Record* VehiclePropertyStore::getRecordLocked(const Shard& shard,
+                                                                          int32_t propId) const {
+    auto RecordIt = shard.recordsByPropId.find(propId);
+    return RecordIt == shard.recordsByPropId.end() ? nullptr : &RecordIt->second;
 }
 
-VehiclePropertyStore::Record* VehiclePropertyStore::getRecordLocked(int32_t propId)
-        REQUIRES(mLock) {
-    auto RecordIt = mRecordsByPropId.find(propId);
-    return RecordIt == mRecordsByPropId.end() ? nullptr : &RecordIt->second;
+VehiclePropertyStore::Record* VehiclePropertyStore::getRecordLocked(Shard& shard,
+                                                                    int32_t propId) {
+    auto RecordIt = shard.recordsByPropId.find(propId);
+    return RecordIt == shard.recordsByPropId.end() ? nullptr : &RecordIt->second;
 }
 
 VehiclePropertyStore::RecordId VehiclePropertyStore::getRecordIdLocked(
-        const VehiclePropValue& propValue, const VehiclePropertyStore::Record& record) const
-        REQUIRES(mLock) {
+        const VehiclePropValue& propValue, const VehiclePropertyStore::Record& record) const {
     VehiclePropertyStore::RecordId recId{
             .area = isGlobalProp(propValue.prop) ? 0 : propValue.areaId, .token = 0};
 
@@ -88,7 +105,7 @@ VehiclePropertyStore::RecordId VehiclePropertyStore::getRecordIdLocked(
 }
 
 VhalResult<VehiclePropValuePool::RecyclableType> VehiclePropertyStore::readValueLocked(
-        const RecordId& recId, const Record& record) const REQUIRES(mLock) {
+        const RecordId& recId, const Record& record) const {
     if (auto it = record.values.find(recId); it != record.values.end()) {
         return mValuePool->obtain(*(it->second));
     }
@@ -98,9 +115,10 @@ VhalResult<VehiclePropValuePool::RecyclableType> VehiclePropertyStore::readValue
 
 void VehiclePropertyStore::registerProperty(const VehiclePropConfig& config,
                                             VehiclePropertyStore::TokenFunction tokenFunc) {
-    std::scoped_lock<std::mutex> g(mLock);
+    Shard& shard = getShard(config.prop);
+    std::unique_lock<std::shared_mutex> g(shard.lock);
 
-    mRecordsByPropId[config.prop] = Record{
+    shard.recordsByPropId[config.prop] = Record{
             .propConfig = config,
             .tokenFunction = tokenFunc,
     };
@@ -114,10 +132,10 @@ VhalResult<void> VehiclePropertyStore::writeValue(VehiclePropValuePool::Recyclab
     VehiclePropValue updatedValue;
     OnValueChangeCallback onValueChangeCallback = nullptr;
     OnValuesChangeCallback onValuesChangeCallback = nullptr;
-    int32_t propId;
-    int32_t areaId;
+    int32_t propId = propValue->prop;
     {
-        std::scoped_lock<std::mutex> g(mLock);
+        Shard& shard = getShard(propId);
+        std::unique_lock<std::shared_mutex> g(shard.lock);
 
         // Must set timestamp inside the lock to make sure no other writeValue will update the
         // the timestamp to a newer one while we are writing this value.
@@ -125,10 +143,7 @@ VhalResult<void> VehiclePropertyStore::writeValue(VehiclePropValuePool::Recyclab
             propValue->timestamp = elapsedRealtimeNano();
         }
 
-        propId = propValue->prop;
-        areaId = propValue->areaId;
-
-        VehiclePropertyStore::Record* record = getRecordLocked(propId);
+        VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
         if (record == nullptr) {
             return StatusError(StatusCode::INVALID_ARG)
                    << "property: " << propId << " not registered";
@@ -166,6 +181,10 @@ VhalResult<void> VehiclePropertyStore::writeValue(VehiclePropValuePool::Recyclab
             return {};
         }
         updatedValue = *(record->values[recId]);
+    }
+
+    {
+        std::scoped_lock<std::mutex> g(mCallbackLock);
 
         onValuesChangeCallback = mOnValuesChangeCallback;
         onValueChangeCallback = mOnValueChangeCallback;
@@ -203,34 +222,39 @@ void VehiclePropertyStore::refreshTimestamps(
     OnValuesChangeCallback onValuesChangeCallback = nullptr;
     OnValueChangeCallback onValueChangeCallback = nullptr;
     {
-        std::scoped_lock<std::mutex> g(mLock);
+        std::scoped_lock<std::mutex> g(mCallbackLock);
 
         onValuesChangeCallback = mOnValuesChangeCallback;
         onValueChangeCallback = mOnValueChangeCallback;
+    }
 
-        for (const auto& [propIdAreaId, eventMode] : eventModeByPropIdAreaId) {
-            int32_t propId = propIdAreaId.propId;
-            int32_t areaId = propIdAreaId.areaId;
-            VehiclePropertyStore::Record* record = getRecordLocked(propId);
-            if (record == nullptr) {
-                continue;
-            }
+    // Only lock the shard for one property at a time so that readers for other properties are
+    // not blocked while we refresh a large number of properties.
+    for (const auto& [propIdAreaId, eventMode] : eventModeByPropIdAreaId) {
+        int32_t propId = propIdAreaId.propId;
+        int32_t areaId = propIdAreaId.areaId;
+        Shard& shard = getShard(propId);
+        std::unique_lock<std::shared_mutex> g(shard.lock);
 
-            VehiclePropValue propValue = {
-                    .areaId = areaId,
-                    .prop = propId,
-                    .value = {},
-            };
-
-            VehiclePropertyStore::RecordId recId = getRecordIdLocked(propValue, *record);
-            if (auto it = record->values.find(recId); it != record->values.end()) {
-                it->second->timestamp = elapsedRealtimeNano();
-                if (eventMode == EventMode::ALWAYS) {
-                    updatedValues.push_back(*(it->second));
-                }
-            } else {
-                continue;
+        VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
+        if (record == nullptr) {
+            continue;
+        }
+
+        VehiclePropValue propValue = {
+                .areaId = areaId,
+                .prop = propId,
+                .value = {},
+        };
+
+        VehiclePropertyStore::RecordId recId = getRecordIdLocked(propValue, *record);
+        if (auto it = record->values.find(recId); it != record->values.end()) {
+            it->second->timestamp = elapsedRealtimeNano();
+            if (eventMode == EventMode::ALWAYS) {
+                updatedValues.push_back(*(it->second));
             }
+        } else {
+            continue;
         }
     }
 
@@ -258,9 +282,10 @@ void VehiclePropertyStore::refreshTimestamps(
 }
 
 void VehiclePropertyStore::removeValue(const VehiclePropValue& propValue) {
-    std::scoped_lock<std::mutex> g(mLock);
+    Shard& shard = getShard(propValue.prop);
+    std::unique_lock<std::shared_mutex> g(shard.lock);
 
-    VehiclePropertyStore::Record* record = getRecordLocked(propValue.prop);
+    VehiclePropertyStore::Record* record = getRecordLocked(shard, propValue.prop);
     if (record == nullptr) {
         return;
     }
@@ -272,9 +297,10 @@ void VehiclePropertyStore::removeValue(const VehiclePropValue& propValue) {
 }
 
 void VehiclePropertyStore::removeValuesForProperty(int32_t propId) {
-    std::scoped_lock<std::mutex> g(mLock);
+    Shard& shard = getShard(propId);
+    std::unique_lock<std::shared_mutex> g(shard.lock);
 
-    VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return;
     }
@@ -283,13 +309,15 @@ void VehiclePropertyStore::removeValuesForProperty(int32_t propId) {
 }
 
 std::vector<VehiclePropValuePool::RecyclableType> VehiclePropertyStore::readAllValues() const {
-    std::scoped_lock<std::mutex> g(mLock);
-
     std::vector<VehiclePropValuePool::RecyclableType> allValues;
 
-    for (auto const& [_, record] : mRecordsByPropId) {
-        for (auto const& [_, value] : record.values) {
-            allValues.push_back(mValuePool->obtain(*value));
+    for (const auto& shard : mShards) {
+        std::shared_lock<std::shared_mutex> g(shard->lock);
+
+        for (auto const& [_, record] : shard->recordsByPropId) {
+            for (auto const& [_, value] : record.values) {
+                allValues.push_back(mValuePool->obtain(*value));
+            }
         }
     }
 
@@ -298,11 +326,12 @@ std::vector<VehiclePropValuePool::RecyclableType> VehiclePropertyStore::readAllV
 
 VehiclePropertyStore::ValuesResultType VehiclePropertyStore::readValuesForProperty(
         int32_t propId) const {
-    std::scoped_lock<std::mutex> g(mLock);
+    const Shard& shard = getShard(propId);
+    std::shared_lock<std::shared_mutex> g(shard.lock);
 
     std::vector<VehiclePropValuePool::RecyclableType> values;
 
-    const VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    const VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return StatusError(StatusCode::INVALID_ARG) << "property: " << propId << " not registered";
     }
@@ -315,10 +344,11 @@ VehiclePropertyStore::ValuesResultType VehiclePropertyStore::readValuesForProper
 
 VehiclePropertyStore::ValueResultType VehiclePropertyStore::readValue(
         const VehiclePropValue& propValue) const {
-    std::scoped_lock<std::mutex> g(mLock);
-
     int32_t propId = propValue.prop;
-    const VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    const Shard& shard = getShard(propId);
+    std::shared_lock<std::shared_mutex> g(shard.lock);
+
+    const VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return StatusError(StatusCode::INVALID_ARG) << "property: " << propId << " not registered";
     }
@@ -330,9 +360,10 @@ VehiclePropertyStore::ValueResultType VehiclePropertyStore::readValue(
 VehiclePropertyStore::ValueResultType VehiclePropertyStore::readValue(int32_t propId,
                                                                       int32_t areaId,
                                                                       int64_t token) const {
-    std::scoped_lock<std::mutex> g(mLock);
+    const Shard& shard = getShard(propId);
+    std::shared_lock<std::shared_mutex> g(shard.lock);
 
-    const VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    const VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return StatusError(StatusCode::INVALID_ARG) << "property: " << propId << " not registered";
     }
@@ -342,20 +373,23 @@ VehiclePropertyStore::ValueResultType VehiclePropertyStore::readValue(int32_t pr
 }
 
 std::vector<VehiclePropConfig> VehiclePropertyStore::getAllConfigs() const {
-    std::scoped_lock<std::mutex> g(mLock);
-
     std::vector<VehiclePropConfig> configs;
-    configs.reserve(mRecordsByPropId.size());
-    for (auto& [_, config] : mRecordsByPropId) {
-        configs.push_back(config.propConfig);
+
+    for (const auto& shard : mShards) {
+        std::shared_lock<std::shared_mutex> g(shard->lock);
+
+        for (auto& [_, config] : shard->recordsByPropId) {
+            configs.push_back(config.propConfig);
+        }
     }
     return configs;
 }
 
 VhalResult<const VehiclePropConfig*> VehiclePropertyStore::getConfig(int32_t propId) const {
-    std::scoped_lock<std::mutex> g(mLock);
+    const Shard& shard = getShard(propId);
+    std::shared_lock<std::shared_mutex> g(shard.lock);
 
-    const VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    const VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return StatusError(StatusCode::INVALID_ARG) << "property: " << propId << " not registered";
     }
@@ -364,9 +398,10 @@ VhalResult<const VehiclePropConfig*> VehiclePropertyStore::getConfig(int32_t pro
 }
 
 VhalResult<VehiclePropConfig> VehiclePropertyStore::getPropConfig(int32_t propId) const {
-    std::scoped_lock<std::mutex> g(mLock);
+    const Shard& shard = getShard(propId);
+    std::shared_lock<std::shared_mutex> g(shard.lock);
 
-    const VehiclePropertyStore::Record* record = getRecordLocked(propId);
+    const VehiclePropertyStore::Record* record = getRecordLocked(shard, propId);
     if (record == nullptr) {
         return StatusError(StatusCode::INVALID_ARG) << "property: " << propId << " not registered";
     }
@@ -376,14 +411,14 @@ VhalResult<VehiclePropConfig> VehiclePropertyStore::getPropConfig(int32_t propId
 
 void VehiclePropertyStore::setOnValueChangeCallback(
         const VehiclePropertyStore::OnValueChangeCallback& callback) {
-    std::scoped_lock<std::mutex> g(mLock);
+    std::scoped_lock<std::mutex> g(mCallbackLock);
 
     mOnValueChangeCallback = callback;
 }
 
 void VehiclePropertyStore::setOnValuesChangeCallback(
         const VehiclePropertyStore::OnValuesChangeCallback& callback) {
-    std::scoped_lock<std::mutex> g(mLock);
+    std::scoped_lock<std::mutex> g(mCallbackLock);
 
     mOnValuesChangeCallback = callback;
 }
@@ -268,6 +268,38 @@ TEST_F(PendingRequestPoolTest, testPendingRequestCountLimit) {
     getPool()->tryFinishRequests(reinterpret_cast<const void*>(0), requests);
 }
 
+TEST_F(PendingRequestPoolTest, testFinishRequestsAcrossBatches) {
+    std::mutex lock;
+    std::vector<int64_t> timeoutRequestIds;
+    auto callback = std::make_shared<PendingRequestPool::TimeoutCallbackFunc>(
+            [&lock, &timeoutRequestIds](const std::unordered_set<int64_t>& requests) {
+                std::scoped_lock<std::mutex> lockGuard(lock);
+                for (int64_t request : requests) {
+                    timeoutRequestIds.push_back(request);
+                }
+            });
+
+    ASSERT_RESULT_OK(getPool()->addRequests(getTestClientId(), {0, 1, 2}, callback));
+    ASSERT_RESULT_OK(getPool()->addRequests(getTestClientId(), {3, 4, 5}, callback));
+    ASSERT_RESULT_OK(getPool()->addRequests(getTestClientId(), {6, 7, 8}, callback));
+
+    ASSERT_EQ(getPool()->countPendingRequests(getTestClientId()), static_cast<size_t>(9));
+
+    // Finish the whole second batch and part of the other batches.
+    std::unordered_set<int64_t> requestIds = {0, 3, 4, 5, 8, 100};
+    ASSERT_THAT(getPool()->tryFinishRequests(getTestClientId(), requestIds),
+                UnorderedElementsAre(0, 3, 4, 5, 8));
+    ASSERT_EQ(getPool()->countPendingRequests(getTestClientId()), static_cast<size_t>(4));
+    for (int64_t i : {1, 2, 6, 7}) {
+        ASSERT_TRUE(getPool()->isRequestPending(getTestClientId(), i));
+    }
+
+    std::this_thread::sleep_for(2 * std::chrono::nanoseconds(getTimeout()));
+
+    std::scoped_lock<std::mutex> lockGuard(lock);
+    ASSERT_THAT(timeoutRequestIds, WhenSorted(ElementsAre(1, 2, 6, 7)));
+}
+
 }  // namespace vehicle
 }  // namespace automotive
 }  // namespace hardware
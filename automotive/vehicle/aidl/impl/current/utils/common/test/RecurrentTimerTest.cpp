@@ -70,6 +70,15 @@ class RecurrentTimerTest : public testing::Test {
         return timer->mIdByCallback.size();
     }
 
+    size_t countCallbackIdsByDeadline(RecurrentTimer* timer) {
+        std::scoped_lock<std::mutex> lockGuard(timer->mLock);
+        size_t count = 0;
+        for (const auto& [_, callbackIds] : timer->mCallbackIdsByDeadline) {
+            count += callbackIds.size();
+        }
+        return count;
+    }
+
   private:
     std::condition_variable mCond;
     std::mutex mLock;
@@ -237,6 +246,110 @@ TEST_F(RecurrentTimerTest, testRegisterCallbackMultipleTimesNoDeadLock) {
     timer.reset();
 }
 
+TEST_F(RecurrentTimerTest, testRegisterMultipleCallbacks_coalesced) {
+    RecurrentTimer timer(RecurrentTimer::Mode::COALESCED);
+    // 0.1s
+    int64_t interval1 = 100000000;
+    auto action1 = getCallback(1);
+    timer.registerTimerCallback(interval1, action1);
+    // 0.05s
+    int64_t interval2 = 50000000;
+    auto action2 = getCallback(2);
+    timer.registerTimerCallback(interval2, action2);
+    // Same interval as action2 so they always share the same deadline.
+    auto action3 = getCallback(3);
+    timer.registerTimerCallback(interval2, action3);
+
+    // In 1s, we should generate 10 + 20 + 20 = 50 events.
+    // Here we are waiting for more events to make sure we receive enough events for each actions.
+    // Use 5s as timeout to be safe.
+    ASSERT_TRUE(waitForCalledCallbacks(/* count= */ 55u, /* timeoutInMs= */ 5000))
+            << "Not enough callbacks called before timeout";
+
+    timer.unregisterTimerCallback(action1);
+    timer.unregisterTimerCallback(action2);
+    timer.unregisterTimerCallback(action3);
+
+    size_t action1Count = 0;
+    size_t action2Count = 0;
+    size_t action3Count = 0;
+    for (size_t token : getCalledCallbacks()) {
+        if (token == 1) {
+            action1Count++;
+        }
+        if (token == 2) {
+            action2Count++;
+        }
+        if (token == 3) {
+            action3Count++;
+        }
+    }
+
+    ASSERT_GE(action1Count, static_cast<size_t>(10));
+    ASSERT_GE(action2Count, static_cast<size_t>(20));
+    ASSERT_GE(action3Count, static_cast<size_t>(20));
+    ASSERT_EQ(countCallbackIdsByDeadline(&timer), 0u);
+}
+
+TEST_F(RecurrentTimerTest, testRegisterUnregisterRegister_coalesced) {
+    RecurrentTimer timer(RecurrentTimer::Mode::COALESCED);
+    // 0.1s
+    int64_t interval = 100000000;
+
+    auto action = getCallback(0);
+    timer.registerTimerCallback(interval, action);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    timer.unregisterTimerCallback(action);
+
+    ASSERT_EQ(countCallbackIdsByDeadline(&timer), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    clearCalledCallbacks();
+
+    timer.registerTimerCallback(interval, action);
+
+    // Should only takes 1s, use 5s as timeout to be safe.
+    ASSERT_TRUE(waitForCalledCallbacks(/* count= */ 10u, /* timeoutInMs= */ 5000))
+            << "Not enough callbacks called before timeout";
+
+    timer.unregisterTimerCallback(action);
+
+    ASSERT_EQ(countCallbackInfoById(&timer), 0u);
+    ASSERT_EQ(countIdByCallback(&timer), 0u);
+    ASSERT_EQ(countCallbackIdsByDeadline(&timer), 0u);
+}
+
+TEST_F(RecurrentTimerTest, testRegisterSameCallbackMultipleTimes_coalesced) {
+    RecurrentTimer timer(RecurrentTimer::Mode::COALESCED);
+    // 0.2s
+    int64_t interval1 = 200'000'000;
+    // 0.1s
+    int64_t interval2 = 100'000'000;
+
+    auto action = getCallback(0);
+    for (int i = 0; i < 10; i++) {
+        timer.registerTimerCallback(interval1, action);
+        timer.registerTimerCallback(interval2, action);
+    }
+
+    ASSERT_EQ(countCallbackIdsByDeadline(&timer), 1u);
+
+    clearCalledCallbacks();
+
+    // Should only takes 1s, use 5s as timeout to be safe.
+    ASSERT_TRUE(waitForCalledCallbacks(/* count= */ 10u, /* timeoutInMs= */ 5000))
+            << "Not enough callbacks called before timeout";
+
+    timer.unregisterTimerCallback(action);
+
+    ASSERT_EQ(countCallbackInfoById(&timer), 0u);
+    ASSERT_EQ(countIdByCallback(&timer), 0u);
+    ASSERT_EQ(countCallbackIdsByDeadline(&timer), 0u);
+}
+
 }  // namespace vehicle
 }  // namespace automotive
 }  // namespace hardware
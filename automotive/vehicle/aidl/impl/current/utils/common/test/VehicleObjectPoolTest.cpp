@@ -187,6 +187,41 @@ TEST_F(VehicleObjectPoolTest, testObtainNewObject) {
     ASSERT_EQ(mStats->Created, 2u);
 }
 
+TEST_F(VehicleObjectPoolTest, testObtainSameSizeClass) {
+    auto value = mValuePool->obtain(VehiclePropertyType::INT32_VEC, 3);
+    void* raw = value.get();
+    value.reset();
+
+    // 3 and 4 are in the same size class, so the recycled object should be reused.
+    auto sameClassValue = mValuePool->obtain(VehiclePropertyType::INT32_VEC, 4);
+    ASSERT_EQ(sameClassValue.get(), raw);
+    ASSERT_EQ(sameClassValue->value.int32Values, std::vector<int32_t>({0, 0, 0, 0}));
+    // 2 is in a different size class.
+    ASSERT_NE(mValuePool->obtain(VehiclePropertyType::INT32_VEC, 2).get(), raw);
+
+    ASSERT_EQ(mStats->Obtained, 3u);
+    ASSERT_EQ(mStats->Created, 2u);
+}
+
+TEST_F(VehicleObjectPoolTest, testRecycleInAnotherThread) {
+    const size_t count = 100;
+    std::vector<recyclable_ptr<VehiclePropValue>> vec;
+    for (size_t i = 0; i < count; i++) {
+        vec.push_back(mValuePool->obtain(VehiclePropertyType::INT32));
+    }
+    // Objects beyond the other thread's magazine go back to the shared pool.
+    std::thread([&vec] { vec.clear(); }).join();
+
+    for (size_t i = 0; i < count; i++) {
+        vec.push_back(mValuePool->obtain(VehiclePropertyType::INT32));
+    }
+    vec.clear();
+
+    ASSERT_EQ(mStats->Obtained, 2 * count);
+    // Only the objects kept in the other thread's magazine are not reused.
+    ASSERT_LE(mStats->Created, count + ObjectPool<VehiclePropValue>::MAGAZINE_CAPACITY);
+}
+
 TEST_F(VehicleObjectPoolTest, testObtainStrings) {
     mValuePool->obtain(VehiclePropertyType::STRING);
     auto stringProp = mValuePool->obtain(VehiclePropertyType::STRING);
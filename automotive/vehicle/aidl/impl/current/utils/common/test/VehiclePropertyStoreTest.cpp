@@ -22,6 +22,8 @@
 #include <gtest/gtest.h>
 #include <utils/SystemClock.h>
 
+#include <thread>
+
 namespace android {
 namespace hardware {
 namespace automotive {
@@ -655,6 +657,71 @@ TEST_F(VehiclePropertyStoreTest, testRefreshTimestamps) {
     ASSERT_GE(updatedValues[1].timestamp, now);
 }
 
+TEST_F(VehiclePropertyStoreTest, testSingleShard) {
+    VehiclePropertyStore store(mValuePool, /*shardCount=*/1);
+    store.registerProperty(mConfigFuelCapacity);
+    VehiclePropValue fuelCapacity = {
+            .prop = toInt(VehicleProperty::INFO_FUEL_CAPACITY),
+            .value = {.floatValues = {1.0}},
+    };
+
+    ASSERT_RESULT_OK(store.writeValue(mValuePool->obtain(fuelCapacity)));
+
+    auto result = store.readValue(fuelCapacity);
+
+    ASSERT_RESULT_OK(result);
+    ASSERT_EQ(*(result.value()), fuelCapacity);
+    ASSERT_EQ(store.getAllConfigs().size(), 1u);
+}
+
+TEST_F(VehiclePropertyStoreTest, testConcurrentReadWrite) {
+    constexpr int kIterations = 1000;
+    int propId = toInt(VehicleProperty::TIRE_PRESSURE);
+    for (int32_t areaId : {WHEEL_FRONT_LEFT, WHEEL_FRONT_RIGHT}) {
+        ASSERT_RESULT_OK(mStore->writeValue(mValuePool->obtain(VehiclePropValue{
+                .prop = propId,
+                .areaId = areaId,
+                .value = {.floatValues = {0.0}},
+        })));
+    }
+
+    std::vector<std::thread> threads;
+    for (int32_t areaId : {WHEEL_FRONT_LEFT, WHEEL_FRONT_RIGHT}) {
+        threads.emplace_back([this, propId, areaId] {
+            for (int i = 1; i <= kIterations; i++) {
+                auto result = mStore->writeValue(
+                        mValuePool->obtain(VehiclePropValue{
+                                .prop = propId,
+                                .areaId = areaId,
+                                .value = {.floatValues = {static_cast<float>(i)}},
+                        }),
+                        /*updateStatus=*/false, VehiclePropertyStore::EventMode::ON_VALUE_CHANGE,
+                        /*useCurrentTimestamp=*/true);
+                EXPECT_TRUE(result.ok()) << "failed to write value: " << result.error().message();
+            }
+        });
+        threads.emplace_back([this, propId, areaId] {
+            float lastValue = 0;
+            for (int i = 0; i < kIterations; i++) {
+                auto result = mStore->readValue(propId, areaId);
+                ASSERT_RESULT_OK(result);
+                float value = result.value()->value.floatValues[0];
+                EXPECT_GE(value, lastValue) << "values must never go backwards";
+                lastValue = value;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int32_t areaId : {WHEEL_FRONT_LEFT, WHEEL_FRONT_RIGHT}) {
+        auto result = mStore->readValue(propId, areaId);
+        ASSERT_RESULT_OK(result);
+        ASSERT_EQ(result.value()->value.floatValues[0], static_cast<float>(kIterations));
+    }
+}
+
 }  // namespace vehicle
 }  // namespace automotive
 }  // namespace hardware
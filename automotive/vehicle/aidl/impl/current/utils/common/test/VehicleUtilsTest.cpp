@@ -764,6 +764,185 @@ TEST(VehicleUtilsTest, testConcurrentQueueDeactivateNotifyWaitingThread) {
     t.join();
 }
 
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueOneThread) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4);
+
+    queue.push(1);
+    queue.push(2);
+    std::vector<int> result;
+    queue.flush(&result);
+
+    ASSERT_EQ(result, std::vector<int>({1, 2}));
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueDropOldest) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4, OverflowPolicy::DROP_OLDEST);
+
+    queue.push(std::vector<int>({0, 1, 2, 3, 4, 5}));
+
+    ASSERT_EQ(queue.flush(), std::vector<int>({2, 3, 4, 5}));
+    ASSERT_EQ(queue.getDroppedItemCount(), 2u);
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueDropNewest) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4, OverflowPolicy::DROP_NEWEST);
+
+    queue.push(std::vector<int>({0, 1, 2, 3, 4, 5}));
+
+    ASSERT_EQ(queue.flush(), std::vector<int>({0, 1, 2, 3}));
+    ASSERT_EQ(queue.getDroppedItemCount(), 2u);
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueCoalesceByPropId) {
+    // Uses the tens digit as the [propId, areaId] key.
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4, OverflowPolicy::COALESCE_BY_PROP_ID,
+                                      [](int value) { return static_cast<uint64_t>(value / 10); });
+
+    queue.push(std::vector<int>({0, 1, 2, 3, 10, 20, 11, 21}));
+    queue.push(12);
+
+    // The ring keeps every item, only the overflowed items are coalesced.
+    ASSERT_EQ(queue.flush(), std::vector<int>({0, 1, 2, 3, 12, 21}));
+    ASSERT_EQ(queue.getCoalescedItemCount(), 3u);
+    ASSERT_EQ(queue.getDroppedItemCount(), 0u);
+
+    // The ring is used again after the overflowed items are flushed.
+    queue.push(std::vector<int>({4, 5}));
+    ASSERT_EQ(queue.flush(), std::vector<int>({4, 5}));
+    ASSERT_EQ(queue.getCoalescedItemCount(), 3u);
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueCoalesceByPropIdIsBounded) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4, OverflowPolicy::COALESCE_BY_PROP_ID,
+                                      [](int value) { return static_cast<uint64_t>(value / 10); });
+
+    queue.push(std::vector<int>({0, 1, 2, 3, 10, 20, 30, 40, 50, 21}));
+
+    // The overflow holds at most 'capacity' items, the oldest one is dropped.
+    ASSERT_EQ(queue.flush(), std::vector<int>({0, 1, 2, 3, 21, 30, 40, 50}));
+    ASSERT_EQ(queue.getCoalescedItemCount(), 1u);
+    ASSERT_EQ(queue.getDroppedItemCount(), 1u);
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueCoalesceByPropIdMultipleThreads) {
+    // Uses the producer as the [propId, areaId] key.
+    BoundedConcurrentQueue<int> queue(
+            /*capacity=*/16, OverflowPolicy::COALESCE_BY_PROP_ID,
+            [](int value) { return static_cast<uint64_t>(value / 10000); });
+    std::vector<int> results;
+    std::atomic<bool> stop = false;
+
+    // Each producer pushes increasing values, so the values of a producer must stay in order.
+    auto produce = [&queue](int producer) {
+        for (int i = 0; i < 10000; i++) {
+            queue.push(producer * 10000 + i);
+        }
+    };
+    std::thread t1(produce, 0);
+    std::thread t2(produce, 1);
+    std::thread t3([&queue, &results, &stop]() {
+        std::vector<int> items;
+        while (!stop) {
+            queue.waitForItems();
+            queue.flush(&items);
+            results.insert(results.end(), items.begin(), items.end());
+        }
+
+        // After we stop, get all the remaining values in the queue.
+        queue.flush(&items);
+        results.insert(results.end(), items.begin(), items.end());
+    });
+
+    t1.join();
+    t2.join();
+
+    stop = true;
+    queue.deactivate();
+    t3.join();
+
+    ASSERT_EQ(results.size() + queue.getCoalescedItemCount(), static_cast<size_t>(20000));
+    ASSERT_EQ(queue.getDroppedItemCount(), 0u);
+    std::vector<int> lastValues = {-1, 9999};
+    for (int value : results) {
+        ASSERT_GT(value, lastValues[value / 10000]);
+        lastValues[value / 10000] = value;
+    }
+    ASSERT_EQ(lastValues, std::vector<int>({9999, 19999})) << "the latest values must be kept";
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueMultipleThreads) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/256);
+    std::vector<int> results;
+    std::atomic<bool> stop = false;
+
+    std::thread t1([&queue]() {
+        for (int i = 0; i < 100; i++) {
+            queue.push(0);
+        }
+    });
+    std::thread t2([&queue]() {
+        for (int i = 0; i < 100; i++) {
+            queue.push(1);
+        }
+    });
+    std::thread t3([&queue, &results, &stop]() {
+        std::vector<int> items;
+        while (!stop) {
+            queue.waitForItems();
+            queue.flush(&items);
+            results.insert(results.end(), items.begin(), items.end());
+        }
+
+        // After we stop, get all the remaining values in the queue.
+        queue.flush(&items);
+        results.insert(results.end(), items.begin(), items.end());
+    });
+
+    t1.join();
+    t2.join();
+
+    stop = true;
+    queue.deactivate();
+    t3.join();
+
+    size_t zeroCount = 0;
+    size_t oneCount = 0;
+    for (int i : results) {
+        if (i == 0) {
+            zeroCount++;
+        }
+        if (i == 1) {
+            oneCount++;
+        }
+    }
+
+    EXPECT_EQ(results.size(), static_cast<size_t>(200));
+    EXPECT_EQ(zeroCount, static_cast<size_t>(100));
+    EXPECT_EQ(oneCount, static_cast<size_t>(100));
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueuePushAfterDeactivate) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4);
+
+    queue.deactivate();
+    queue.push(1);
+
+    ASSERT_TRUE(queue.flush().empty());
+}
+
+TEST(VehicleUtilsTest, testBoundedConcurrentQueueDeactivateNotifyWaitingThread) {
+    BoundedConcurrentQueue<int> queue(/*capacity=*/4);
+
+    std::thread t([&queue]() {
+        // This would block until queue is deactivated.
+        queue.waitForItems();
+    });
+
+    queue.deactivate();
+
+    t.join();
+}
+
 TEST(VehicleUtilsTest, testVhalError) {
     VhalResult<void> result = Error<VhalError>(StatusCode::INVALID_ARG) << "error message";
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <DefaultVehicleHal.h>
+#include <IVehicleHardware.h>
+#include <VehicleHalTypes.h>
+
+#include <aidl/android/hardware/automotive/vehicle/BnVehicleCallback.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::BnVehicleCallback;
+using ::aidl::android::hardware::automotive::vehicle::GetValueRequest;
+using ::aidl::android::hardware::automotive::vehicle::GetValueRequests;
+using ::aidl::android::hardware::automotive::vehicle::GetValueResult;
+using ::aidl::android::hardware::automotive::vehicle::GetValueResults;
+using ::aidl::android::hardware::automotive::vehicle::IVehicleCallback;
+using ::aidl::android::hardware::automotive::vehicle::PropIdAreaId;
+using ::aidl::android::hardware::automotive::vehicle::SetValueRequest;
+using ::aidl::android::hardware::automotive::vehicle::SetValueResults;
+using ::aidl::android::hardware::automotive::vehicle::StatusCode;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropConfig;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropConfigs;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropErrors;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyAccess;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropertyChangeMode;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValues;
+using ::ndk::ScopedAStatus;
+using ::ndk::SpAIBinder;
+
+constexpr int32_t kPropCount = 100;
+
+int32_t benchmarkPropId(int32_t i) {
+    // VehiclePropertyGroup:VENDOR,VehicleArea:GLOBAL,VehiclePropertyType:INT32
+    return i + 0x20000000 + 0x01000000 + 0x00400000;
+}
+
+// An IVehicleHardware with kPropCount readable global properties. getValues calls the callback
+// before returning, so that the benchmark only measures the overhead in DefaultVehicleHal.
+class InMemoryVehicleHardware final : public IVehicleHardware {
+  public:
+    explicit InMemoryVehicleHardware(bool answerInline) : mAnswerInline(answerInline) {}
+
+    std::vector<VehiclePropConfig> getAllPropertyConfigs() const override {
+        std::vector<VehiclePropConfig> configs;
+        for (int32_t i = 0; i < kPropCount; i++) {
+            configs.push_back({
+                    .prop = benchmarkPropId(i),
+                    .access = VehiclePropertyAccess::READ,
+                    .changeMode = VehiclePropertyChangeMode::ON_CHANGE,
+            });
+        }
+        return configs;
+    }
+
+    StatusCode setValues(std::shared_ptr<const SetValuesCallback>,
+                         const std::vector<SetValueRequest>&) override {
+        return StatusCode::OK;
+    }
+
+    StatusCode getValues(std::shared_ptr<const GetValuesCallback> callback,
+                         const std::vector<GetValueRequest>& requests) const override {
+        std::vector<GetValueResult> results;
+        for (const auto& request : requests) {
+            results.push_back(getValue(request));
+        }
+        (*callback)(std::move(results));
+        return StatusCode::OK;
+    }
+
+    bool getValuesInline(const std::vector<GetValueRequest>& requests,
+                         std::vector<GetValueResult>* results) const override {
+        if (!mAnswerInline) {
+            return false;
+        }
+        for (const auto& request : requests) {
+            results->push_back(getValue(request));
+        }
+        return true;
+    }
+
+    DumpResult dump(const std::vector<std::string>&) override { return {}; }
+
+    StatusCode checkHealth() override { return StatusCode::OK; }
+
+    void registerOnPropertyChangeEvent(std::unique_ptr<const PropertyChangeCallback>) override {}
+
+    void registerOnPropertySetErrorEvent(
+            std::unique_ptr<const PropertySetErrorCallback>) override {}
+
+  private:
+    const bool mAnswerInline;
+
+    static GetValueResult getValue(const GetValueRequest& request) {
+        return {
+                .requestId = request.requestId,
+                .status = StatusCode::OK,
+                .prop =
+                        VehiclePropValue{
+                                .prop = request.prop.prop,
+                                .value.int32Values = {1},
+                        },
+        };
+    }
+};
+
+class NoOpVehicleCallback final : public BnVehicleCallback {
+  public:
+    ScopedAStatus onGetValues(const GetValueResults&) override { return ScopedAStatus::ok(); }
+
+    ScopedAStatus onSetValues(const SetValueResults&) override { return ScopedAStatus::ok(); }
+
+    ScopedAStatus onPropertyEvent(const VehiclePropValues&, int32_t) override {
+        return ScopedAStatus::ok();
+    }
+
+    ScopedAStatus onPropertySetError(const VehiclePropErrors&) override {
+        return ScopedAStatus::ok();
+    }
+
+    ScopedAStatus onSupportedValueChange(const std::vector<PropIdAreaId>&) override {
+        return ScopedAStatus::ok();
+    }
+};
+
+}  // namespace
+
+// Sets up a DefaultVehicleHal whose clients never die, since linking to death does not work for
+// the local binders used in the benchmark.
+class DefaultVehicleHalBenchmark final {
+  public:
+    static std::shared_ptr<DefaultVehicleHal> createVhal(bool answerInline) {
+        auto vhal = ndk::SharedRefBase::make<DefaultVehicleHal>(
+                std::make_unique<InMemoryVehicleHardware>(answerInline));
+        vhal->setBinderLifecycleHandler(std::make_unique<AlwaysAliveBinderLifecycleHandler>());
+        VehiclePropConfigs configs;
+        vhal->getAllPropConfigs(&configs);
+        return vhal;
+    }
+
+  private:
+    class AlwaysAliveBinderLifecycleHandler final
+        : public DefaultVehicleHal::BinderLifecycleInterface {
+      public:
+        binder_status_t linkToDeath(AIBinder*, AIBinder_DeathRecipient*, void*) override {
+            return STATUS_OK;
+        }
+
+        bool isAlive(const AIBinder*) override { return true; }
+    };
+};
+
+namespace {
+
+// state.range(0): whether the hardware answers inline, state.range(1): the number of properties
+// in one getValues call.
+void BM_GetValues(benchmark::State& state) {
+    std::shared_ptr<DefaultVehicleHal> vhal = DefaultVehicleHalBenchmark::createVhal(
+            /*answerInline=*/state.range(0) != 0);
+    SpAIBinder binder = ndk::SharedRefBase::make<NoOpVehicleCallback>()->asBinder();
+    std::shared_ptr<IVehicleCallback> callback = IVehicleCallback::fromBinder(binder);
+
+    GetValueRequests requests;
+    for (int32_t i = 0; i < state.range(1); i++) {
+        requests.payloads.push_back({
+                .requestId = i,
+                .prop = {.prop = benchmarkPropId(i)},
+        });
+    }
+    int64_t nextRequestId = 0;
+    for (auto _ : state) {
+        for (auto& request : requests.payloads) {
+            request.requestId = nextRequestId++;
+        }
+        ScopedAStatus status = vhal->getValues(callback, requests);
+        if (!status.isOk()) {
+            state.SkipWithError(status.getMessage());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_GetValues)->ArgsProduct({{0, 1}, {1, 10, 100}});
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <IVehicleHardware.h>
+#include <SubscriptionManager.h>
+#include <VehicleHalTypes.h>
+#include <VehicleUtils.h>
+
+#include <aidl/android/hardware/automotive/vehicle/BnVehicleCallback.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+namespace {
+
+using ::aidl::android::hardware::automotive::vehicle::BnVehicleCallback;
+using ::aidl::android::hardware::automotive::vehicle::GetValueRequest;
+using ::aidl::android::hardware::automotive::vehicle::GetValueResults;
+using ::aidl::android::hardware::automotive::vehicle::IVehicleCallback;
+using ::aidl::android::hardware::automotive::vehicle::PropIdAreaId;
+using ::aidl::android::hardware::automotive::vehicle::SetValueRequest;
+using ::aidl::android::hardware::automotive::vehicle::SetValueResults;
+using ::aidl::android::hardware::automotive::vehicle::StatusCode;
+using ::aidl::android::hardware::automotive::vehicle::SubscribeOptions;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropConfig;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropErrors;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
+using ::aidl::android::hardware::automotive::vehicle::VehiclePropValues;
+using ::ndk::ScopedAStatus;
+using ::ndk::SpAIBinder;
+
+constexpr size_t kClientCount = 50;
+constexpr int32_t kPropCountPerClient = 500;
+// Client i subscribes to [i * kPropStride, i * kPropStride + kPropCountPerClient), so that
+// neighbouring clients share most of their properties.
+constexpr int32_t kPropStride = 10;
+constexpr int32_t kPropCount =
+        kPropStride * static_cast<int32_t>(kClientCount - 1) + kPropCountPerClient;
+
+// An IVehicleHardware that accepts all the subscriptions and does nothing else.
+class NoOpVehicleHardware final : public IVehicleHardware {
+  public:
+    std::vector<VehiclePropConfig> getAllPropertyConfigs() const override { return {}; }
+
+    StatusCode setValues(std::shared_ptr<const SetValuesCallback>,
+                         const std::vector<SetValueRequest>&) override {
+        return StatusCode::OK;
+    }
+
+    StatusCode getValues(std::shared_ptr<const GetValuesCallback>,
+                         const std::vector<GetValueRequest>&) const override {
+        return StatusCode::OK;
+    }
+
+    DumpResult dump(const std::vector<std::string>&) override { return {}; }
+
+    StatusCode checkHealth() override { return StatusCode::OK; }
+
+    void registerOnPropertyChangeEvent(std::unique_ptr<const PropertyChangeCallback>) override {}
+
+    void registerOnPropertySetErrorEvent(
+            std::unique_ptr<const PropertySetErrorCallback>) override {}
+};
+
+class NoOpVehicleCallback final : public BnVehicleCallback {
+  public:
+    ScopedAStatus onGetValues(const GetValueResults&) override { return ScopedAStatus::ok(); }
+
+    ScopedAStatus onSetValues(const SetValueResults&) override { return ScopedAStatus::ok(); }
+
+    ScopedAStatus onPropertyEvent(const VehiclePropValues&, int32_t) override {
+        return ScopedAStatus::ok();
+    }
+
+    ScopedAStatus onPropertySetError(const VehiclePropErrors&) override {
+        return ScopedAStatus::ok();
+    }
+
+    ScopedAStatus onSupportedValueChange(
+            const std::vector<::aidl::android::hardware::automotive::vehicle::PropIdAreaId>&)
+            override {
+        return ScopedAStatus::ok();
+    }
+};
+
+// A copy of the map based lookup that SubscriptionManager::getSubscribedClients used before the
+// fan-out table, as the baseline. The fixture only subscribes to on-change properties, thus the
+// VUR filtering of continuous properties is left out.
+class MapBasedSubscriptions final {
+  public:
+    using ClientIdType = const AIBinder*;
+
+    void subscribe(const std::shared_ptr<IVehicleCallback>& callback,
+                   const std::vector<SubscribeOptions>& options) {
+        std::scoped_lock<std::mutex> lockGuard(mLock);
+        for (const auto& option : options) {
+            for (int32_t areaId : option.areaIds) {
+                PropIdAreaId propIdAreaId{
+                        .propId = option.propId,
+                        .areaId = areaId,
+                };
+                mClientsByPropIdAreaId[propIdAreaId][callback->asBinder().get()] = callback;
+            }
+        }
+    }
+
+    std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropValue>>
+    getSubscribedClients(std::vector<VehiclePropValue>&& updatedValues) {
+        std::scoped_lock<std::mutex> lockGuard(mLock);
+        std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropValue>>
+                clients;
+
+        for (auto& value : updatedValues) {
+            PropIdAreaId propIdAreaId{
+                    .propId = value.prop,
+                    .areaId = value.areaId,
+            };
+            if (mClientsByPropIdAreaId.find(propIdAreaId) == mClientsByPropIdAreaId.end()) {
+                continue;
+            }
+
+            for (const auto& [client, callback] : mClientsByPropIdAreaId[propIdAreaId]) {
+                auto& subConfigs = mContSubConfigsByPropIdArea[propIdAreaId];
+                VehiclePropValue newValue = value;
+                sanitizeByResolution(&(newValue.value), subConfigs.getResolutionForClient(client));
+                clients[callback].push_back(newValue);
+            }
+        }
+        return clients;
+    }
+
+  private:
+    std::mutex mLock;
+    std::unordered_map<PropIdAreaId,
+                       std::unordered_map<ClientIdType, std::shared_ptr<IVehicleCallback>>,
+                       PropIdAreaIdHash>
+            mClientsByPropIdAreaId;
+    std::unordered_map<PropIdAreaId, ContSubConfigs, PropIdAreaIdHash> mContSubConfigsByPropIdArea;
+};
+
+// A SubscriptionManager with kClientCount clients, each subscribing to kPropCountPerClient
+// on-change properties.
+class SubscriptionManagerFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State&) override {
+        mHardware = std::make_unique<NoOpVehicleHardware>();
+        mManager = std::make_unique<SubscriptionManager>(mHardware.get());
+        mMapBasedSubscriptions = std::make_unique<MapBasedSubscriptions>();
+        for (size_t i = 0; i < kClientCount; i++) {
+            mBinders.push_back(ndk::SharedRefBase::make<NoOpVehicleCallback>()->asBinder());
+            mCallbacks.push_back(IVehicleCallback::fromBinder(mBinders.back()));
+            std::vector<SubscribeOptions> options;
+            int32_t firstPropId = static_cast<int32_t>(i) * kPropStride;
+            for (int32_t propId = firstPropId; propId < firstPropId + kPropCountPerClient;
+                 propId++) {
+                options.push_back({
+                        .propId = propId,
+                        .areaIds = {0},
+                });
+            }
+            mManager->subscribe(mCallbacks.back(), options, /*isContinuousProperty=*/false);
+            mMapBasedSubscriptions->subscribe(mCallbacks.back(), options);
+        }
+    }
+
+    void TearDown(const benchmark::State&) override {
+        mManager.reset();
+        mMapBasedSubscriptions.reset();
+        mCallbacks.clear();
+        mBinders.clear();
+        mHardware.reset();
+    }
+
+  protected:
+    std::unique_ptr<NoOpVehicleHardware> mHardware;
+    std::unique_ptr<SubscriptionManager> mManager;
+    std::vector<SpAIBinder> mBinders;
+    std::vector<std::shared_ptr<IVehicleCallback>> mCallbacks;
+    std::unique_ptr<MapBasedSubscriptions> mMapBasedSubscriptions;
+
+    // A batch of events spread evenly over all the subscribed properties.
+    static std::vector<VehiclePropValue> createBatch(int64_t batchSize) {
+        std::vector<VehiclePropValue> values;
+        for (int64_t i = 0; i < batchSize; i++) {
+            values.push_back({
+                    .prop = static_cast<int32_t>((i * 7919) % kPropCount),
+                    .areaId = 0,
+                    .value.floatValues = {1.0f},
+            });
+        }
+        return values;
+    }
+};
+
+BENCHMARK_DEFINE_F(SubscriptionManagerFixture, BM_GetSubscribedClientEvents)
+(benchmark::State& state) {
+    const std::vector<VehiclePropValue> batch = createBatch(state.range(0));
+    size_t deliveredCount = 0;
+    for (auto _ : state) {
+        auto clientEvents = mManager->getSubscribedClientEvents(std::vector(batch));
+        for (const auto& events : clientEvents) {
+            deliveredCount += events.values.size();
+        }
+        benchmark::DoNotOptimize(clientEvents);
+    }
+    state.counters["events_delivered_per_s"] =
+            benchmark::Counter(static_cast<double>(deliveredCount), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(SubscriptionManagerFixture, BM_GetSubscribedClientEvents)
+        ->Arg(1)
+        ->Arg(16)
+        ->Arg(256);
+
+// The map based lookup used before the flat fan-out table, as the baseline.
+BENCHMARK_DEFINE_F(SubscriptionManagerFixture, BM_MapBasedGetSubscribedClients)
+(benchmark::State& state) {
+    const std::vector<VehiclePropValue> batch = createBatch(state.range(0));
+    size_t deliveredCount = 0;
+    for (auto _ : state) {
+        auto clients = mMapBasedSubscriptions->getSubscribedClients(std::vector(batch));
+        for (const auto& clientValues : clients) {
+            deliveredCount += clientValues.second.size();
+        }
+        benchmark::DoNotOptimize(clients);
+    }
+    state.counters["events_delivered_per_s"] =
+            benchmark::Counter(static_cast<double>(deliveredCount), benchmark::Counter::kIsRate);
+}
+BENCHMARK_REGISTER_F(SubscriptionManagerFixture, BM_MapBasedGetSubscribedClients)
+        ->Arg(1)
+        ->Arg(16)
+        ->Arg(256);
+
+// The cost of rebuilding the fan-out table on subscription changes.
+BENCHMARK_DEFINE_F(SubscriptionManagerFixture, BM_SubscribeUnsubscribe)
+(benchmark::State& state) {
+    std::vector<SubscribeOptions> options = {{
+            .propId = kPropCount,
+            .areaIds = {0},
+    }};
+    const std::shared_ptr<IVehicleCallback>& callback = mCallbacks.front();
+    for (auto _ : state) {
+        mManager->subscribe(callback, options, /*isContinuousProperty=*/false);
+        mManager->unsubscribe(callback->asBinder().get(), std::vector<int32_t>{kPropCount});
+    }
+}
+BENCHMARK_REGISTER_F(SubscriptionManagerFixture, BM_SubscribeUnsubscribe);
+
+}  // namespace
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -18,6 +18,7 @@
 #define android_hardware_automotive_vehicle_aidl_impl_vhal_include_ConnectedClient_H_
 
 #include "PendingRequestPool.h"
+#include "SharedMemoryTracker.h"
 
 #include <IVehicleHardware.h>
 #include <VehicleHalTypes.h>
@@ -64,6 +65,9 @@ class ConnectedClient {
     // finished. It must be a set of the requested request IDs.
     std::unordered_set<int64_t> tryFinishRequests(const std::unordered_set<int64_t>& requestIds);
 
+    // Returns whether the request is pending for this client.
+    bool isRequestPending(int64_t requestId);
+
   protected:
     // Gets the callback to be called when the request for this client has timeout.
     virtual std::shared_ptr<const PendingRequestPool::TimeoutCallbackFunc> getTimeoutCallback() = 0;
@@ -104,12 +108,15 @@ class SubscriptionClient {
     using CallbackType =
             std::shared_ptr<aidl::android::hardware::automotive::vehicle::IVehicleCallback>;
 
-    // Marshals the updated values into largeParcelable and sends it through {@code onPropertyEvent}
-    // callback.
+    // Marshals the updated values into largeParcelable once and sends it to all the callbacks
+    // through {@code onPropertyEvent} callback. If a shared memory file is used, it comes from
+    // {@code sharedMemoryTracker}, which tracks it until the clients return it and reuses it
+    // afterwards.
     static void sendUpdatedValues(
-            CallbackType callback,
+            const std::vector<CallbackType>& callbacks,
             std::vector<aidl::android::hardware::automotive::vehicle::VehiclePropValue>&&
-                    updatedValues);
+                    updatedValues,
+            SharedMemoryTracker* sharedMemoryTracker);
     // Marshals the set property error events into largeParcelable and sends it through
     // {@code onPropertySetError} callback.
     static void sendPropertySetErrors(
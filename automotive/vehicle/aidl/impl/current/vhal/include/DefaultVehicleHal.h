@@ -21,6 +21,7 @@
 #include <ParcelableUtils.h>
 #include <PendingRequestPool.h>
 #include <RecurrentTimer.h>
+#include <SharedMemoryTracker.h>
 #include <SubscriptionManager.h>
 
 #include <ConcurrentQueue.h>
@@ -89,6 +90,8 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
   private:
     // friend class for unit testing.
     friend class DefaultVehicleHalTest;
+    // friend class for benchmarking.
+    friend class DefaultVehicleHalBenchmark;
 
     using GetValuesClient = GetSetValuesClient<aidlvhal::GetValueResult, aidlvhal::GetValueResults>;
     using SetValuesClient = GetSetValuesClient<aidlvhal::SetValueResult, aidlvhal::SetValueResults>;
@@ -134,6 +137,13 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
     static constexpr int64_t TIMEOUT_IN_NANO = 30'000'000'000;
     // heart beat event interval: 3s
     static constexpr int64_t HEART_BEAT_INTERVAL_IN_NANO = 3'000'000'000;
+    // The number of property change events queued within one batching window without taking a
+    // lock. Beyond that, only the latest event for each [propId, areaId] is kept.
+    static constexpr size_t BATCHED_EVENT_QUEUE_CAPACITY = 16384;
+    // The max number of requests in one getValues call that could be answered inline through
+    // IVehicleHardware::getValuesInline. Larger calls always use the asynchronous path so that
+    // one call does not hold the binder thread for too long.
+    static constexpr size_t MAX_INLINE_GET_VALUE_REQUEST_COUNT = 128;
     bool mShouldRefreshPropertyConfigs;
     std::unique_ptr<IVehicleHardware> mVehicleHardware;
 
@@ -141,13 +151,18 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
     std::shared_ptr<PendingRequestPool> mPendingRequestPool;
     // SubscriptionManager is thread-safe.
     std::shared_ptr<SubscriptionManager> mSubscriptionManager;
-    // ConcurrentQueue is thread-safe.
-    std::shared_ptr<ConcurrentQueue<aidlvhal::VehiclePropValue>> mBatchedEventQueue;
+    // SharedMemoryTracker is thread-safe.
+    std::shared_ptr<SharedMemoryTracker> mSharedMemoryTracker;
+    // BoundedConcurrentQueue is thread-safe.
+    std::shared_ptr<BoundedConcurrentQueue<aidlvhal::VehiclePropValue>> mBatchedEventQueue;
     // BatchingConsumer is thread-safe.
-    std::shared_ptr<BatchingConsumer<aidlvhal::VehiclePropValue>>
+    std::shared_ptr<BatchingConsumer<aidlvhal::VehiclePropValue,
+                                     BoundedConcurrentQueue<aidlvhal::VehiclePropValue>>>
             mPropertyChangeEventsBatchingConsumer;
     // Only set once during initialization.
     std::chrono::nanoseconds mEventBatchingWindow;
+    // Only set once during initialization.
+    bool mCoalesceContinuousPropertyEvents = false;
     // Only used for testing.
     int32_t mTestInterfaceVersion = 0;
 
@@ -182,6 +197,12 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
 
     android::base::Result<void> checkProperty(const aidlvhal::VehiclePropValue& propValue);
 
+    // Answers small getValues calls through IVehicleHardware::getValuesInline without registering
+    // pending requests or creating a GetValuesClient. Returns false if the requests must go
+    // through the regular asynchronous path, e.g. because a request is invalid.
+    bool tryGetValuesInline(const CallbackType& callback,
+                            const std::vector<aidlvhal::GetValueRequest>& requests);
+
     android::base::Result<std::vector<int64_t>> checkDuplicateRequests(
             const std::vector<aidlvhal::GetValueRequest>& requests);
 
@@ -221,8 +242,14 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
 
     size_t countClients();
 
-    // Handles the property change events in batch.
-    void handleBatchedPropertyEvents(std::vector<aidlvhal::VehiclePropValue>&& batchedEvents);
+    // Handles the property change events in batch. The events of continuous properties are
+    // coalesced if the hardware asks for it. The events are moved out of 'batchedEvents', but the
+    // buffer itself is kept for the next batch.
+    void handleBatchedPropertyEvents(std::vector<aidlvhal::VehiclePropValue>& batchedEvents);
+
+    // Only keeps the latest event for each [propId, areaId] of continuous properties, in place.
+    // The order of the remaining events is kept.
+    void coalesceContinuousPropertyEvents(std::vector<aidlvhal::VehiclePropValue>* events) const;
 
     int32_t getVhalInterfaceVersion() const;
 
@@ -239,7 +266,8 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
             int32_t propId, int32_t areaId) const;
     // Puts the property change events into a queue so that they can handled in batch.
     static void batchPropertyChangeEvent(
-            const std::weak_ptr<ConcurrentQueue<aidlvhal::VehiclePropValue>>& batchedEventQueue,
+            const std::weak_ptr<BoundedConcurrentQueue<aidlvhal::VehiclePropValue>>&
+                    batchedEventQueue,
             std::vector<aidlvhal::VehiclePropValue>&& updatedValues);
 
     // Gets or creates a {@code T} object for the client to or from {@code clients}.
@@ -248,7 +276,10 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
             std::unordered_map<const AIBinder*, std::shared_ptr<T>>* clients,
             const CallbackType& callback, std::shared_ptr<PendingRequestPool> pendingRequestPool);
 
+    // Sends the property change events to the subscribed clients. Clients receiving exactly the
+    // same events share one marshalled parcelable.
     static void onPropertyChangeEvent(const std::weak_ptr<SubscriptionManager>& subscriptionManager,
+                                      const std::weak_ptr<SharedMemoryTracker>& sharedMemoryTracker,
                                       std::vector<aidlvhal::VehiclePropValue>&& updatedValues);
 
     static void onPropertySetErrorEvent(
@@ -260,7 +291,8 @@ class DefaultVehicleHal final : public aidlvhal::BnVehicle {
             const std::vector<PropIdAreaId>& updatedPropIdAreaIds);
 
     static void checkHealth(IVehicleHardware* hardware,
-                            std::weak_ptr<SubscriptionManager> subscriptionManager);
+                            std::weak_ptr<SubscriptionManager> subscriptionManager,
+                            std::weak_ptr<SharedMemoryTracker> sharedMemoryTracker);
 
     static void onBinderDied(void* cookie);
 
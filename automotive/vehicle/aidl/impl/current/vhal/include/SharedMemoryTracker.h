@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef android_hardware_automotive_vehicle_aidl_impl_vhal_include_SharedMemoryTracker_H_
+#define android_hardware_automotive_vehicle_aidl_impl_vhal_include_SharedMemoryTracker_H_
+
+#include <aidl/android/hardware/automotive/vehicle/IVehicle.h>
+#include <android-base/result.h>
+#include <android-base/thread_annotations.h>
+#include <android/binder_auto_utils.h>
+#include <android/binder_ibinder.h>
+#include <android/binder_parcel.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+// SharedMemoryTracker keeps track of the shared memory files delivered to the subscription
+// clients through {@code onPropertyEvent} until the clients return them through
+// {@code returnSharedMemory}.
+//
+// One batch of property events is only marshalled once and the same shared memory file is
+// delivered to all the clients receiving the batch, so one shared memory ID might be held by
+// multiple clients. The ID is released once all the clients holding it have returned it.
+//
+// Each client holds at most {@code maxSharedMemoryFileCount} files (at least one). If a client
+// does not return its files in time, the oldest file held by the client is reclaimed.
+//
+// The files written through {@code writeToSharedMemory} are kept for reuse once every client
+// holding them has returned them. A file is only reused for the same set of clients it was
+// delivered to, since a client might keep its file descriptor and read the file later. A
+// reclaimed file is never reused since its client might still be reading it. The clients can
+// only map the files read-only.
+//
+// This class is thread-safe.
+class SharedMemoryTracker final {
+  public:
+    // The max shared memory file count for a client that has not specified one. This is the
+    // recommended value documented in IVehicle.
+    static constexpr int32_t DEFAULT_MAX_SHARED_MEMORY_FILE_COUNT = 2;
+    // The max number of returned shared memory files kept for reuse.
+    static constexpr size_t MAX_FREE_SHARED_MEMORY_FILE_COUNT = 4;
+
+    // Sets the max number of shared memory files that the client could hold at the same time.
+    void setMaxSharedMemoryFileCount(const AIBinder* clientId, int32_t maxSharedMemoryFileCount);
+
+    // Allocates a new unique shared memory ID. The returned ID is never
+    // {@code IVehicle.INVALID_MEMORY_ID}.
+    int64_t newSharedMemoryId();
+
+    // Writes the marshalled {@code parcel} into a shared memory file to be delivered to
+    // {@code clientIds} and allocates a new shared memory ID for it. A file returned by exactly
+    // the same clients is reused if it is large enough, otherwise a new file is created.
+    // {@code fd} is set to a duplicate of the file descriptor. The caller holds a reference to
+    // the file until it calls {@code finishSending}, so that the file could not be reused before
+    // it is delivered to all the clients.
+    android::base::Result<int64_t> writeToSharedMemory(const AParcel* parcel,
+                                                       std::vector<const AIBinder*> clientIds,
+                                                       ndk::ScopedFileDescriptor* fd);
+
+    // Drops the reference held by the caller of {@code writeToSharedMemory}.
+    void finishSending(int64_t sharedMemoryId);
+
+    // Records that the shared memory file identified by {@code sharedMemoryId} has been delivered
+    // to the client. Returns the number of shared memory files the client is now holding.
+    int32_t acquire(const AIBinder* clientId, int64_t sharedMemoryId);
+
+    // Returns a shared memory file held by the client. Returns false if the client is not
+    // holding the file, for example because the file has already been reclaimed.
+    bool release(const AIBinder* clientId, int64_t sharedMemoryId);
+
+    // Releases all the shared memory files held by the client, drops the returned files the
+    // client has seen and forgets the client.
+    void removeClient(const AIBinder* clientId);
+
+    // Returns the number of shared memory files the client is holding.
+    size_t countSharedMemoryFiles(const AIBinder* clientId) const;
+
+    // Returns the number of shared memory IDs held by at least one client.
+    size_t countSharedMemoryIds() const;
+
+    // Returns the number of returned shared memory files kept for reuse.
+    size_t countFreeSharedMemoryFiles() const;
+
+  private:
+    // A shared memory file mapped read-write, the clients could only map it read-only.
+    struct SharedMemoryFile {
+        ndk::ScopedFileDescriptor fd;
+        size_t size = 0;
+        uint8_t* address = nullptr;
+
+        ~SharedMemoryFile();
+    };
+
+    struct SharedMemoryEntry {
+        // The number of clients holding the file, plus one while the file is being sent.
+        size_t refCount = 0;
+        // False once the file has been reclaimed from a client.
+        bool reusable = true;
+        // nullptr if the ID was allocated by {@code newSharedMemoryId}.
+        std::unique_ptr<SharedMemoryFile> file;
+        // The sorted IDs of the clients the file is delivered to.
+        std::vector<const AIBinder*> clientIds;
+    };
+
+    struct FreeFile {
+        // The sorted IDs of the clients that have seen the file.
+        std::vector<const AIBinder*> clientIds;
+        std::unique_ptr<SharedMemoryFile> file;
+    };
+
+    struct ClientState {
+        int32_t maxSharedMemoryFileCount = DEFAULT_MAX_SHARED_MEMORY_FILE_COUNT;
+        // The held shared memory IDs, from the oldest to the newest.
+        std::deque<int64_t> sharedMemoryIds;
+    };
+
+    mutable std::mutex mLock;
+    int64_t mNextSharedMemoryId GUARDED_BY(mLock) =
+            aidl::android::hardware::automotive::vehicle::IVehicle::INVALID_MEMORY_ID + 1;
+    std::unordered_map<const AIBinder*, ClientState> mClientStates GUARDED_BY(mLock);
+    std::unordered_map<int64_t, SharedMemoryEntry> mEntryBySharedMemoryId GUARDED_BY(mLock);
+    // The returned files, ready to be reused, from the least recently returned.
+    std::vector<FreeFile> mFreeFiles GUARDED_BY(mLock);
+
+    static android::base::Result<std::unique_ptr<SharedMemoryFile>> createFile(size_t size);
+
+    std::unique_ptr<SharedMemoryFile> takeFreeFile(size_t size,
+                                                   const std::vector<const AIBinder*>& clientIds);
+    // Drops a reference to the file, {@code returned} is false if the file is reclaimed rather
+    // than returned by the client.
+    void unrefLocked(int64_t sharedMemoryId, bool returned) REQUIRES(mLock);
+};
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
+
+#endif  // android_hardware_automotive_vehicle_aidl_impl_vhal_include_SharedMemoryTracker_H_
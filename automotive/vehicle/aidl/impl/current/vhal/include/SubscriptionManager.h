@@ -27,6 +27,7 @@
 
 #include <cmath>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
@@ -77,6 +78,29 @@ class SubscriptionManager final {
             std::shared_ptr<aidl::android::hardware::automotive::vehicle::IVehicleCallback>;
     using VehiclePropValue = aidl::android::hardware::automotive::vehicle::VehiclePropValue;
 
+    // Where one value sent to a client comes from.
+    struct EventSource {
+        // The index of the updated value.
+        size_t index;
+        // The resolution the value is sanitized with.
+        float resolution;
+
+        bool operator==(const EventSource& other) const {
+            return index == other.index && resolution == other.resolution;
+        }
+    };
+
+    // The updated values to be sent to one subscribed client.
+    struct ClientEvents {
+        CallbackType callback;
+        std::vector<VehiclePropValue> values;
+        // The source of each value. Clients with equal sources receive equal values, so they could
+        // be grouped without comparing the values.
+        std::vector<EventSource> sources;
+        // A hash of sources.
+        size_t sourcesHash = 0;
+    };
+
     explicit SubscriptionManager(IVehicleHardware* vehicleHardware);
     ~SubscriptionManager();
 
@@ -112,6 +136,12 @@ class SubscriptionManager final {
     std::unordered_map<CallbackType, std::vector<VehiclePropValue>> getSubscribedClients(
             std::vector<VehiclePropValue>&& updatedValues);
 
+    // Same as {@code getSubscribedClients}, but returns a list with one entry for each client
+    // that has at least one updated value. This does not take {@code mLock} and does not allocate
+    // any hash map, so it is the one to use for dispatching events.
+    std::vector<ClientEvents> getSubscribedClientEvents(
+            std::vector<VehiclePropValue>&& updatedValues);
+
     // For a list of set property error events, returns a map that maps clients subscribing to the
     // properties to a list of errors for each client.
     std::unordered_map<CallbackType,
@@ -134,6 +164,9 @@ class SubscriptionManager final {
     // Returns the number of subscribed property change clients.
     size_t countPropertyChangeClients();
 
+    // Returns whether the client subscribes to at least one property.
+    bool hasPropertyChangeSubscriptions(ClientIdType client);
+
     // Returns the number of subscribed supported value change clients.
     size_t countSupportedValueChangeClients();
 
@@ -150,6 +183,34 @@ class SubscriptionManager final {
 
     IVehicleHardware* mVehicleHardware;
 
+    // One client that the events for a subscribed [propId, areaId] must be delivered to.
+    struct FanOutTarget {
+        // The index of the client in {@code FanOutTable.callbacks}.
+        size_t clientIndex;
+        // The resolution requested by the client, 0 for on-change properties.
+        float resolution = 0.0f;
+        // Whether the client enables VUR while IVehicleHardware does not, so that events must be
+        // filtered here.
+        bool filterByVur = false;
+    };
+
+    // A read-only snapshot of the property change subscriptions using flat vectors. A new table is
+    // built each time the subscriptions change and swapped in, so that dispatching events never
+    // waits for {@code mLock}, which is held while calling IVehicleHardware.
+    struct FanOutTable {
+        // The subscribed [propId, areaId]s, sorted by propId then areaId.
+        std::vector<PropIdAreaId> propIdAreaIds;
+        // The targets for propIdAreaIds[i] are targets[targetOffsets[i]] to
+        // targets[targetOffsets[i + 1] - 1]. Has one more element than propIdAreaIds.
+        std::vector<size_t> targetOffsets = {0};
+        std::vector<FanOutTarget> targets;
+        // All the clients subscribing to at least one [propId, areaId].
+        std::vector<CallbackType> callbacks;
+
+        // Returns the index in propIdAreaIds or -1 if the [propId, areaId] is not subscribed.
+        ssize_t find(int32_t propId, int32_t areaId) const;
+    };
+
     struct VehiclePropValueHashPropIdAreaId {
         inline size_t operator()(const VehiclePropValue& vehiclePropValue) const {
             size_t res = 0;
@@ -173,10 +234,17 @@ class SubscriptionManager final {
             mSubscribedPropsByClient GUARDED_BY(mLock);
     std::unordered_map<PropIdAreaId, ContSubConfigs, PropIdAreaIdHash> mContSubConfigsByPropIdArea
             GUARDED_BY(mLock);
+    // Only guards the pointer, the table itself is immutable. Must not acquire {@code mLock}
+    // while holding this lock.
+    mutable std::mutex mFanOutTableLock;
+    std::shared_ptr<const FanOutTable> mFanOutTable GUARDED_BY(mFanOutTableLock);
+    // The latest values used for VUR filtering. This has its own lock since it is updated while
+    // dispatching events.
+    std::mutex mContSubValuesLock;
     std::unordered_map<CallbackType,
                        std::unordered_set<VehiclePropValue, VehiclePropValueHashPropIdAreaId,
                                           VehiclePropValueEqualPropIdAreaId>>
-            mContSubValuesByCallback GUARDED_BY(mLock);
+            mContSubValuesByCallback GUARDED_BY(mContSubValuesLock);
     std::unordered_map<PropIdAreaId, std::unordered_map<ClientIdType, CallbackType>,
                        PropIdAreaIdHash>
             mSupportedValueChangeClientsByPropIdAreaId GUARDED_BY(mLock);
@@ -199,6 +267,19 @@ class SubscriptionManager final {
     VhalResult<void> updateContSubConfigsLocked(const PropIdAreaId& PropIdAreaId,
                                                 const ContSubConfigs& newConfig) REQUIRES(mLock);
 
+    VhalResult<void> subscribeLocked(
+            const CallbackType& callback,
+            const std::vector<aidl::android::hardware::automotive::vehicle::SubscribeOptions>&
+                    options,
+            bool isContinuousProperty) REQUIRES(mLock);
+    VhalResult<void> unsubscribeLocked(ClientIdType client, const std::vector<int32_t>& propIds)
+            REQUIRES(mLock);
+    VhalResult<void> unsubscribeLocked(ClientIdType client) REQUIRES(mLock);
+
+    // Rebuilds {@code mFanOutTable} from the current subscriptions.
+    void rebuildFanOutTableLocked() REQUIRES(mLock);
+    std::shared_ptr<const FanOutTable> getFanOutTable() const;
+
     VhalResult<void> unsubscribePropIdAreaIdLocked(SubscriptionManager::ClientIdType clientId,
                                                    const PropIdAreaId& propIdAreaId)
             REQUIRES(mLock);
@@ -210,7 +291,7 @@ class SubscriptionManager final {
     bool isEmpty();
 
     bool isValueUpdatedLocked(const CallbackType& callback, const VehiclePropValue& value)
-            REQUIRES(mLock);
+            REQUIRES(mContSubValuesLock);
 
     // Get the interval in nanoseconds accroding to sample rate.
     static android::base::Result<int64_t> getIntervalNanos(float sampleRateHz);
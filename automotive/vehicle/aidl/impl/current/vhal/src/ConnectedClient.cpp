@@ -17,8 +17,10 @@
 #include "ConnectedClient.h"
 #include "ParcelableUtils.h"
 
+#include <LargeParcelableBase.h>
 #include <VehicleHalTypes.h>
 
+#include <android/binder_parcel.h>
 #include <utils/Log.h>
 
 #include <inttypes.h>
@@ -42,6 +44,7 @@ using ::aidl::android::hardware::automotive::vehicle::VehiclePropError;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropErrors;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropValue;
 using ::aidl::android::hardware::automotive::vehicle::VehiclePropValues;
+using ::android::automotive::car_binder_lib::LargeParcelableBase;
 using ::android::base::Result;
 using ::ndk::ScopedAStatus;
 
@@ -188,6 +191,34 @@ template void getOrSetValuesCallback<SetValueResult, SetValueResults>(
         std::shared_ptr<::aidl::android::hardware::automotive::vehicle::IVehicleCallback> callback,
         std::vector<SetValueResult>&& results, std::shared_ptr<PendingRequestPool> requestPool);
 
+// The same as payloadsToStableLargeParcelable, except that the shared memory file comes from
+// sharedMemoryTracker, which reuses the files returned by the same clients. If a shared memory
+// file is used, output.sharedMemoryId is set as well.
+ScopedAStatus payloadsToSharedMemory(
+        VehiclePropValues* output, const std::vector<std::shared_ptr<IVehicleCallback>>& callbacks,
+        SharedMemoryTracker* sharedMemoryTracker) {
+    std::unique_ptr<AParcel, decltype(&AParcel_delete)> parcel(AParcel_create(), AParcel_delete);
+    if (binder_status_t status = output->writeToParcel(parcel.get()); status != STATUS_OK) {
+        return ScopedAStatus::fromStatus(status);
+    }
+    if (AParcel_getDataSize(parcel.get()) <= LargeParcelableBase::MAX_DIRECT_PAYLOAD_SIZE) {
+        return ScopedAStatus::ok();
+    }
+    std::vector<const AIBinder*> clientIds;
+    clientIds.reserve(callbacks.size());
+    for (const auto& callback : callbacks) {
+        clientIds.push_back(callback->asBinder().get());
+    }
+    auto result = sharedMemoryTracker->writeToSharedMemory(parcel.get(), std::move(clientIds),
+                                                           &output->sharedMemoryFd);
+    if (!result.ok()) {
+        return toScopedAStatus(result, StatusCode::INTERNAL_ERROR);
+    }
+    output->payloads.clear();
+    output->sharedMemoryId = result.value();
+    return ScopedAStatus::ok();
+}
+
 }  // namespace
 
 ConnectedClient::ConnectedClient(std::shared_ptr<PendingRequestPool> requestPool,
@@ -207,6 +238,10 @@ std::unordered_set<int64_t> ConnectedClient::tryFinishRequests(
     return mRequestPool->tryFinishRequests(id(), requestIds);
 }
 
+bool ConnectedClient::isRequestPending(int64_t requestId) {
+    return mRequestPool->isRequestPending(id(), requestId);
+}
+
 template <class ResultType, class ResultsType>
 GetSetValuesClient<ResultType, ResultsType>::GetSetValuesClient(
         std::shared_ptr<PendingRequestPool> requestPool, std::shared_ptr<IVehicleCallback> callback)
@@ -250,17 +285,17 @@ void GetSetValuesClient<ResultType, ResultsType>::sendResultsSeparately(
 template class GetSetValuesClient<GetValueResult, GetValueResults>;
 template class GetSetValuesClient<SetValueResult, SetValueResults>;
 
-void SubscriptionClient::sendUpdatedValues(std::shared_ptr<IVehicleCallback> callback,
-                                           std::vector<VehiclePropValue>&& updatedValues) {
-    if (updatedValues.empty()) {
+void SubscriptionClient::sendUpdatedValues(
+        const std::vector<std::shared_ptr<IVehicleCallback>>& callbacks,
+        std::vector<VehiclePropValue>&& updatedValues, SharedMemoryTracker* sharedMemoryTracker) {
+    if (updatedValues.empty() || callbacks.empty()) {
         return;
     }
 
-    // TODO(b/205189110): Use memory pool here and fill in sharedMemoryId.
     VehiclePropValues vehiclePropValues;
-    int32_t sharedMemoryFileCount = 0;
+    vehiclePropValues.payloads = std::move(updatedValues);
     ScopedAStatus status =
-            vectorToStableLargeParcelable(std::move(updatedValues), &vehiclePropValues);
+            payloadsToSharedMemory(&vehiclePropValues, callbacks, sharedMemoryTracker);
     if (!status.isOk()) {
         int statusCode = status.getServiceSpecificError();
         ALOGE("subscribe: failed to marshal result into large parcelable, error: "
@@ -269,13 +304,29 @@ void SubscriptionClient::sendUpdatedValues(std::shared_ptr<IVehicleCallback> cal
         return;
     }
 
-    if (ScopedAStatus callbackStatus =
-                callback->onPropertyEvent(vehiclePropValues, sharedMemoryFileCount);
-        !callbackStatus.isOk()) {
-        ALOGE("subscribe: failed to call onPropertyEvent callback, client ID: %p, error: %s, "
-              "exception: %d, service specific error: %d",
-              callback->asBinder().get(), callbackStatus.getMessage(),
-              callbackStatus.getExceptionCode(), callbackStatus.getServiceSpecificError());
+    bool useSharedMemory = vehiclePropValues.sharedMemoryFd.get() != -1;
+
+    for (const auto& callback : callbacks) {
+        int32_t sharedMemoryFileCount = 0;
+        if (useSharedMemory) {
+            sharedMemoryFileCount = sharedMemoryTracker->acquire(
+                    callback->asBinder().get(), vehiclePropValues.sharedMemoryId);
+        }
+        if (ScopedAStatus callbackStatus =
+                    callback->onPropertyEvent(vehiclePropValues, sharedMemoryFileCount);
+            !callbackStatus.isOk()) {
+            ALOGE("subscribe: failed to call onPropertyEvent callback, client ID: %p, error: %s, "
+                  "exception: %d, service specific error: %d",
+                  callback->asBinder().get(), callbackStatus.getMessage(),
+                  callbackStatus.getExceptionCode(), callbackStatus.getServiceSpecificError());
+            if (useSharedMemory) {
+                sharedMemoryTracker->release(callback->asBinder().get(),
+                                             vehiclePropValues.sharedMemoryId);
+            }
+        }
+    }
+    if (useSharedMemory) {
+        sharedMemoryTracker->finishSending(vehiclePropValues.sharedMemoryId);
     }
 }
 
@@ -34,8 +34,10 @@
 #include <utils/Trace.h>
 
 #include <inttypes.h>
+#include <algorithm>
 #include <chrono>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace android {
@@ -50,6 +52,7 @@ using ::aidl::android::hardware::automotive::vehicle::GetValueRequests;
 using ::aidl::android::hardware::automotive::vehicle::GetValueResult;
 using ::aidl::android::hardware::automotive::vehicle::GetValueResults;
 using ::aidl::android::hardware::automotive::vehicle::HasSupportedValueInfo;
+using ::aidl::android::hardware::automotive::vehicle::IVehicle;
 using ::aidl::android::hardware::automotive::vehicle::IVehicleCallback;
 using ::aidl::android::hardware::automotive::vehicle::MinMaxSupportedValueResult;
 using ::aidl::android::hardware::automotive::vehicle::MinMaxSupportedValueResults;
@@ -128,30 +131,41 @@ DefaultVehicleHal::DefaultVehicleHal(std::unique_ptr<IVehicleHardware> vehicleHa
     ALOGD("DefaultVehicleHal init");
     IVehicleHardware* vehicleHardwarePtr = mVehicleHardware.get();
     mSubscriptionManager = std::make_shared<SubscriptionManager>(vehicleHardwarePtr);
+    mSharedMemoryTracker = std::make_shared<SharedMemoryTracker>();
     mEventBatchingWindow = mVehicleHardware->getPropertyOnChangeEventBatchingWindow();
     if (mEventBatchingWindow != std::chrono::nanoseconds(0)) {
-        mBatchedEventQueue = std::make_shared<ConcurrentQueue<VehiclePropValue>>();
-        mPropertyChangeEventsBatchingConsumer =
-                std::make_shared<BatchingConsumer<VehiclePropValue>>();
+        mCoalesceContinuousPropertyEvents =
+                mVehicleHardware->isContinuousPropertyEventCoalescingEnabled();
+        mBatchedEventQueue = std::make_shared<BoundedConcurrentQueue<VehiclePropValue>>(
+                BATCHED_EVENT_QUEUE_CAPACITY, OverflowPolicy::COALESCE_BY_PROP_ID,
+                [](const VehiclePropValue& value) {
+                    return (static_cast<uint64_t>(static_cast<uint32_t>(value.prop)) << 32) |
+                           static_cast<uint32_t>(value.areaId);
+                });
+        mPropertyChangeEventsBatchingConsumer = std::make_shared<
+                BatchingConsumer<VehiclePropValue, BoundedConcurrentQueue<VehiclePropValue>>>();
         mPropertyChangeEventsBatchingConsumer->run(
                 mBatchedEventQueue.get(), mEventBatchingWindow,
-                [this](std::vector<VehiclePropValue> batchedEvents) {
-                    handleBatchedPropertyEvents(std::move(batchedEvents));
+                [this](std::vector<VehiclePropValue>& batchedEvents) {
+                    // Only the events are moved out, the batch buffer is reused by the consumer.
+                    handleBatchedPropertyEvents(batchedEvents);
                 });
     }
 
-    std::weak_ptr<ConcurrentQueue<VehiclePropValue>> batchedEventQueueCopy = mBatchedEventQueue;
+    std::weak_ptr<BoundedConcurrentQueue<VehiclePropValue>> batchedEventQueueCopy =
+            mBatchedEventQueue;
     std::chrono::nanoseconds eventBatchingWindow = mEventBatchingWindow;
     std::weak_ptr<SubscriptionManager> subscriptionManagerCopy = mSubscriptionManager;
+    std::weak_ptr<SharedMemoryTracker> sharedMemoryTrackerCopy = mSharedMemoryTracker;
     mVehicleHardware->registerOnPropertyChangeEvent(
             std::make_unique<IVehicleHardware::PropertyChangeCallback>(
-                    [subscriptionManagerCopy, batchedEventQueueCopy,
+                    [subscriptionManagerCopy, sharedMemoryTrackerCopy, batchedEventQueueCopy,
                      eventBatchingWindow](std::vector<VehiclePropValue> updatedValues) {
                         if (eventBatchingWindow != std::chrono::nanoseconds(0)) {
                             batchPropertyChangeEvent(batchedEventQueueCopy,
                                                      std::move(updatedValues));
                         } else {
-                            onPropertyChangeEvent(subscriptionManagerCopy,
+                            onPropertyChangeEvent(subscriptionManagerCopy, sharedMemoryTrackerCopy,
                                                   std::move(updatedValues));
                         }
                     }));
@@ -168,8 +182,8 @@ DefaultVehicleHal::DefaultVehicleHal(std::unique_ptr<IVehicleHardware> vehicleHa
 
     // Register heartbeat event.
     mRecurrentAction = std::make_shared<std::function<void()>>(
-            [vehicleHardwarePtr, subscriptionManagerCopy]() {
-                checkHealth(vehicleHardwarePtr, subscriptionManagerCopy);
+            [vehicleHardwarePtr, subscriptionManagerCopy, sharedMemoryTrackerCopy]() {
+                checkHealth(vehicleHardwarePtr, subscriptionManagerCopy, sharedMemoryTrackerCopy);
             });
     mRecurrentTimer.registerTimerCallback(HEART_BEAT_INTERVAL_IN_NANO, mRecurrentAction);
 
@@ -204,11 +218,12 @@ DefaultVehicleHal::~DefaultVehicleHal() {
     // mSubscriptionManager uses pointer to mVehicleHardware, so it has to be destroyed before
     // mVehicleHardware.
     mSubscriptionManager.reset();
+    mSharedMemoryTracker.reset();
     mVehicleHardware.reset();
 }
 
 void DefaultVehicleHal::batchPropertyChangeEvent(
-        const std::weak_ptr<ConcurrentQueue<VehiclePropValue>>& batchedEventQueue,
+        const std::weak_ptr<BoundedConcurrentQueue<VehiclePropValue>>& batchedEventQueue,
         std::vector<VehiclePropValue>&& updatedValues) {
     auto batchedEventQueueStrong = batchedEventQueue.lock();
     if (batchedEventQueueStrong == nullptr) {
@@ -219,22 +234,110 @@ void DefaultVehicleHal::batchPropertyChangeEvent(
     batchedEventQueueStrong->push(std::move(updatedValues));
 }
 
-void DefaultVehicleHal::handleBatchedPropertyEvents(std::vector<VehiclePropValue>&& batchedEvents) {
-    onPropertyChangeEvent(mSubscriptionManager, std::move(batchedEvents));
+void DefaultVehicleHal::handleBatchedPropertyEvents(std::vector<VehiclePropValue>& batchedEvents) {
+    // The queue already coalesces the events by [propId, areaId] once it is full.
+    if (mCoalesceContinuousPropertyEvents) {
+        coalesceContinuousPropertyEvents(&batchedEvents);
+    }
+    // Only moves the events, not the buffer.
+    onPropertyChangeEvent(mSubscriptionManager, mSharedMemoryTracker, std::move(batchedEvents));
+}
+
+void DefaultVehicleHal::coalesceContinuousPropertyEvents(
+        std::vector<VehiclePropValue>* events) const {
+    std::unordered_set<int32_t> continuousPropIds;
+    getConfigsByPropId([this, events, &continuousPropIds](const auto& configsByPropId) {
+        SharedScopedLockAssertion lockAssertion(mConfigLock);
+
+        for (const auto& event : *events) {
+            auto it = configsByPropId.find(event.prop);
+            if (it != configsByPropId.end() &&
+                it->second.changeMode == VehiclePropertyChangeMode::CONTINUOUS) {
+                continuousPropIds.insert(event.prop);
+            }
+        }
+    });
+    if (continuousPropIds.empty()) {
+        return;
+    }
+
+    // The index for the latest event for each continuous [propId, areaId].
+    std::unordered_map<PropIdAreaId, size_t, PropIdAreaIdHash> latestIndexByPropIdAreaId;
+    size_t continuousEventCount = 0;
+    for (size_t i = 0; i < events->size(); i++) {
+        const VehiclePropValue& event = (*events)[i];
+        if (continuousPropIds.find(event.prop) != continuousPropIds.end()) {
+            latestIndexByPropIdAreaId[PropIdAreaId{
+                    .propId = event.prop,
+                    .areaId = event.areaId,
+            }] = i;
+            continuousEventCount++;
+        }
+    }
+    if (latestIndexByPropIdAreaId.size() == continuousEventCount) {
+        // Every continuous event is for a different [propId, areaId], nothing to coalesce.
+        return;
+    }
+
+    // Compacts the kept events in place so that the buffer is kept.
+    size_t keptCount = 0;
+    for (size_t i = 0; i < events->size(); i++) {
+        VehiclePropValue& event = (*events)[i];
+        if (continuousPropIds.find(event.prop) != continuousPropIds.end() &&
+            latestIndexByPropIdAreaId[PropIdAreaId{
+                    .propId = event.prop,
+                    .areaId = event.areaId,
+            }] != i) {
+            continue;
+        }
+        if (keptCount != i) {
+            (*events)[keptCount] = std::move(event);
+        }
+        keptCount++;
+    }
+    events->resize(keptCount);
 }
 
 void DefaultVehicleHal::onPropertyChangeEvent(
         const std::weak_ptr<SubscriptionManager>& subscriptionManager,
+        const std::weak_ptr<SharedMemoryTracker>& sharedMemoryTracker,
         std::vector<VehiclePropValue>&& updatedValues) {
     ATRACE_CALL();
     auto manager = subscriptionManager.lock();
-    if (manager == nullptr) {
+    auto tracker = sharedMemoryTracker.lock();
+    if (manager == nullptr || tracker == nullptr) {
         ALOGW("%s: the SubscriptionManager is destroyed, DefaultVehicleHal is ending", __func__);
         return;
     }
-    auto updatedValuesByClients = manager->getSubscribedClients(std::move(updatedValues));
-    for (auto& [callback, values] : updatedValuesByClients) {
-        SubscriptionClient::sendUpdatedValues(callback, std::move(values));
+    auto updatedValuesByClients = manager->getSubscribedClientEvents(std::move(updatedValues));
+
+    // Clients subscribing to the same properties with the same resolutions receive the same events.
+    // Group them by where their events come from so that each distinct list of events is only
+    // marshalled once, without comparing the values themselves.
+    std::unordered_multimap<size_t, size_t> groupIndexesByHash;
+    std::vector<size_t> groupLeaders;
+    std::vector<std::vector<CallbackType>> callbacksByGroup;
+    for (size_t i = 0; i < updatedValuesByClients.size(); i++) {
+        const auto& clientEvents = updatedValuesByClients[i];
+        size_t groupIndex = groupLeaders.size();
+        auto [begin, end] = groupIndexesByHash.equal_range(clientEvents.sourcesHash);
+        for (auto it = begin; it != end; it++) {
+            if (updatedValuesByClients[groupLeaders[it->second]].sources == clientEvents.sources) {
+                groupIndex = it->second;
+                break;
+            }
+        }
+        if (groupIndex == groupLeaders.size()) {
+            groupIndexesByHash.emplace(clientEvents.sourcesHash, groupIndex);
+            groupLeaders.push_back(i);
+            callbacksByGroup.emplace_back();
+        }
+        callbacksByGroup[groupIndex].push_back(clientEvents.callback);
+    }
+    for (size_t groupIndex = 0; groupIndex < groupLeaders.size(); groupIndex++) {
+        SubscriptionClient::sendUpdatedValues(
+                callbacksByGroup[groupIndex],
+                std::move(updatedValuesByClients[groupLeaders[groupIndex]].values), tracker.get());
     }
 }
 
@@ -317,6 +420,7 @@ void DefaultVehicleHal::onBinderDiedWithContext(const AIBinder* clientId) {
     mSetValuesClients.erase(clientId);
     mGetValuesClients.erase(clientId);
     mSubscriptionManager->unsubscribe(clientId);
+    mSharedMemoryTracker->removeClient(clientId);
 }
 
 void DefaultVehicleHal::onBinderUnlinked(void* cookie) {
@@ -532,6 +636,10 @@ ScopedAStatus DefaultVehicleHal::getValues(const CallbackType& callback,
     const std::vector<GetValueRequest>& getValueRequests =
             deserializedResults.value().getObject()->payloads;
 
+    if (tryGetValuesInline(callback, getValueRequests)) {
+        return ScopedAStatus::ok();
+    }
+
     auto maybeRequestIds = checkDuplicateRequests(getValueRequests);
     if (!maybeRequestIds.ok()) {
         ALOGE("getValues: duplicate request ID");
@@ -926,11 +1034,22 @@ void DefaultVehicleHal::parseSubscribeOptions(
 
 ScopedAStatus DefaultVehicleHal::subscribe(const CallbackType& callback,
                                            const std::vector<SubscribeOptions>& options,
-                                           [[maybe_unused]] int32_t maxSharedMemoryFileCount) {
-    // TODO(b/205189110): Use shared memory file count.
+                                           int32_t maxSharedMemoryFileCount) {
     if (callback == nullptr) {
         return ScopedAStatus::fromExceptionCode(EX_NULL_POINTER);
     }
+    if (maxSharedMemoryFileCount < 0) {
+        return ScopedAStatus::fromServiceSpecificErrorWithMessage(
+                toInt(StatusCode::INVALID_ARG),
+                StringPrintf("maxSharedMemoryFileCount must be >= 0, received: %" PRId32,
+                             maxSharedMemoryFileCount)
+                        .c_str());
+    }
+    if (maxSharedMemoryFileCount >= IVehicle::MAX_SHARED_MEMORY_FILES_PER_CLIENT) {
+        ALOGW("subscribe: maxSharedMemoryFileCount: %" PRId32 " is too large, use %" PRId32,
+              maxSharedMemoryFileCount, IVehicle::MAX_SHARED_MEMORY_FILES_PER_CLIENT - 1);
+        maxSharedMemoryFileCount = IVehicle::MAX_SHARED_MEMORY_FILES_PER_CLIENT - 1;
+    }
     std::vector<SubscribeOptions> onChangeSubscriptions;
     std::vector<SubscribeOptions> continuousSubscriptions;
     ScopedAStatus returnStatus = ScopedAStatus::ok();
@@ -975,6 +1094,9 @@ ScopedAStatus DefaultVehicleHal::subscribe(const CallbackType& callback,
                 return toScopedAStatus(result);
             }
         }
+        // Under the lock so that a concurrent unsubscribe does not forget the client after this.
+        mSharedMemoryTracker->setMaxSharedMemoryFileCount(callback->asBinder().get(),
+                                                          maxSharedMemoryFileCount);
     }
     return ScopedAStatus::ok();
 }
@@ -984,11 +1106,27 @@ ScopedAStatus DefaultVehicleHal::unsubscribe(const CallbackType& callback,
     if (callback == nullptr) {
         return ScopedAStatus::fromExceptionCode(EX_NULL_POINTER);
     }
-    return toScopedAStatus(mSubscriptionManager->unsubscribe(callback->asBinder().get(), propIds));
+    const AIBinder* clientId = callback->asBinder().get();
+    // Lock to make sure the client does not subscribe again concurrently.
+    std::scoped_lock lockGuard(mLock);
+    auto result = mSubscriptionManager->unsubscribe(clientId, propIds);
+    if (!mSubscriptionManager->hasPropertyChangeSubscriptions(clientId)) {
+        // The client does not receive property events anymore, release the shared memory files
+        // and the state kept for it.
+        mSharedMemoryTracker->removeClient(clientId);
+    }
+    return toScopedAStatus(result);
 }
 
-ScopedAStatus DefaultVehicleHal::returnSharedMemory(const CallbackType&, int64_t) {
-    // TODO(b/200737967): implement this.
+ScopedAStatus DefaultVehicleHal::returnSharedMemory(const CallbackType& callback,
+                                                    int64_t sharedMemoryId) {
+    if (callback == nullptr) {
+        return ScopedAStatus::fromExceptionCode(EX_NULL_POINTER);
+    }
+    // A file returned after it was reclaimed, or twice, is ignored.
+    if (!mSharedMemoryTracker->release(callback->asBinder().get(), sharedMemoryId)) {
+        ALOGD("%s: ignore unknown shared memory ID: %" PRId64, __func__, sharedMemoryId);
+    }
     return ScopedAStatus::ok();
 }
 
@@ -1256,6 +1394,98 @@ VhalResult<void> DefaultVehicleHal::checkPermissionHelper(
     return {};
 }
 
+bool DefaultVehicleHal::tryGetValuesInline(const CallbackType& callback,
+                                           const std::vector<GetValueRequest>& requests) {
+    if (requests.empty() || requests.size() > MAX_INLINE_GET_VALUE_REQUEST_COUNT || !mConfigInit) {
+        return false;
+    }
+    // Invalid requests are reported by the regular path. The requests are few, so the duplicate
+    // check does not need a set.
+    for (size_t i = 0; i < requests.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (requests[i].requestId == requests[j].requestId) {
+                return false;
+            }
+        }
+    }
+    // Same as checkReadPermission, but without copying the configs.
+    bool allReadable = true;
+    getConfigsByPropId([&requests, &allReadable](const auto& configsByPropId) {
+        for (const auto& request : requests) {
+            int32_t propId = request.prop.prop;
+            auto it = configsByPropId.find(propId);
+            if (it == configsByPropId.end()) {
+                allReadable = false;
+                return;
+            }
+            const VehiclePropConfig& config = it->second;
+            const VehicleAreaConfig* areaConfig = getAreaConfig(request.prop, config);
+            if ((areaConfig == nullptr && !isGlobalProp(propId)) ||
+                (!hasRequiredAccess(config.access, VehiclePropertyAccess::READ) &&
+                 (areaConfig == nullptr ||
+                  !hasRequiredAccess(areaConfig->access, VehiclePropertyAccess::READ)))) {
+                allReadable = false;
+                return;
+            }
+        }
+    });
+    if (!allReadable) {
+        return false;
+    }
+    {
+        std::scoped_lock lockGuard(mLock);
+        // Like the regular path, link to the client's death on its first call so that the state
+        // kept for it is cleaned up. A dead client is reported by the regular path.
+        if (!monitorBinderLifeCycleLocked(callback->asBinder().get())) {
+            return false;
+        }
+        // A request ID that is still pending for this client is a duplicate, which is reported
+        // by the regular path.
+        if (auto it = mGetValuesClients.find(callback->asBinder().get());
+            it != mGetValuesClients.end()) {
+            for (const auto& request : requests) {
+                if (it->second->isRequestPending(request.requestId)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Reuse the results buffer across calls handled by the same binder thread.
+    thread_local GetValueResults parcelableResults;
+    std::vector<GetValueResult>& results = parcelableResults.payloads;
+    results.clear();
+    if (!mVehicleHardware->getValuesInline(requests, &results)) {
+        return false;
+    }
+
+    if (ScopedAStatus status = payloadsToStableLargeParcelable(&parcelableResults);
+        !status.isOk()) {
+        ALOGE("getValues: failed to marshal result into large parcelable, error: %s, code: %d",
+              status.getMessage(), status.getServiceSpecificError());
+        // Fall back to sending the results one by one.
+        GetValueResults singleResult;
+        singleResult.payloads.resize(1);
+        for (auto& result : results) {
+            singleResult.payloads[0] = std::move(result);
+            if (ScopedAStatus callbackStatus = callback->onGetValues(singleResult);
+                !callbackStatus.isOk()) {
+                ALOGE("failed to call GetValueResults callback, client ID: %p, error: %s",
+                      callback->asBinder().get(), callbackStatus.getMessage());
+            }
+        }
+    } else if (ScopedAStatus callbackStatus = callback->onGetValues(parcelableResults);
+               !callbackStatus.isOk()) {
+        ALOGE("failed to call GetValueResults callback, client ID: %p, error: %s, exception: %d, "
+              "service specific error: %d",
+              callback->asBinder().get(), callbackStatus.getMessage(),
+              callbackStatus.getExceptionCode(), callbackStatus.getServiceSpecificError());
+    }
+    results.clear();
+    parcelableResults.sharedMemoryFd = ScopedFileDescriptor();
+    return true;
+}
+
 VhalResult<void> DefaultVehicleHal::checkWritePermission(const VehiclePropValue& value) const {
     return checkPermissionHelper(value, VehiclePropertyAccess::WRITE);
 }
@@ -1265,7 +1495,8 @@ VhalResult<void> DefaultVehicleHal::checkReadPermission(const VehiclePropValue&
 }
 
 void DefaultVehicleHal::checkHealth(IVehicleHardware* vehicleHardware,
-                                    std::weak_ptr<SubscriptionManager> subscriptionManager) {
+                                    std::weak_ptr<SubscriptionManager> subscriptionManager,
+                                    std::weak_ptr<SharedMemoryTracker> sharedMemoryTracker) {
     StatusCode status = vehicleHardware->checkHealth();
     if (status != StatusCode::OK) {
         ALOGE("VHAL check health returns non-okay status");
@@ -1277,7 +1508,7 @@ void DefaultVehicleHal::checkHealth(IVehicleHardware* vehicleHardware,
             .status = VehiclePropertyStatus::AVAILABLE,
             .value.int64Values = {uptimeMillis()},
     }};
-    onPropertyChangeEvent(subscriptionManager, std::move(values));
+    onPropertyChangeEvent(subscriptionManager, sharedMemoryTracker, std::move(values));
     return;
 }
 
@@ -1340,6 +1571,13 @@ binder_status_t DefaultVehicleHal::dump(int fd, const char** args, uint32_t numA
         dprintf(fd, "Currently have %zu supported values change subscribe clients\n",
                 mSubscriptionManager->countSupportedValueChangeClients());
     }
+    if (mBatchedEventQueue) {
+        dprintf(fd,
+                "Coalesced %" PRIu64 " and dropped %" PRIu64
+                " batched property change events beyond the queue capacity\n",
+                mBatchedEventQueue->getCoalescedItemCount(),
+                mBatchedEventQueue->getDroppedItemCount());
+    }
     return STATUS_OK;
 }
 
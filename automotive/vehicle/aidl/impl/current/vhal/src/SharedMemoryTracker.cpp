@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedMemoryTracker"
+
+#include "SharedMemoryTracker.h"
+
+#include <cutils/ashmem.h>
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+using ::android::base::Error;
+using ::android::base::ErrnoError;
+using ::android::base::Result;
+
+SharedMemoryTracker::SharedMemoryFile::~SharedMemoryFile() {
+    if (address != nullptr) {
+        munmap(address, size);
+    }
+}
+
+void SharedMemoryTracker::setMaxSharedMemoryFileCount(const AIBinder* clientId,
+                                                      int32_t maxSharedMemoryFileCount) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    ClientState& state = mClientStates[clientId];
+    state.maxSharedMemoryFileCount = maxSharedMemoryFileCount;
+    // A client always holds the file for the latest event until it returns it.
+    size_t capacity = static_cast<size_t>(std::max(maxSharedMemoryFileCount, 1));
+    while (state.sharedMemoryIds.size() > capacity) {
+        unrefLocked(state.sharedMemoryIds.front(), /*returned=*/false);
+        state.sharedMemoryIds.pop_front();
+    }
+}
+
+int64_t SharedMemoryTracker::newSharedMemoryId() {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mNextSharedMemoryId++;
+}
+
+Result<int64_t> SharedMemoryTracker::writeToSharedMemory(const AParcel* parcel,
+                                                         std::vector<const AIBinder*> clientIds,
+                                                         ndk::ScopedFileDescriptor* fd) {
+    size_t size = static_cast<size_t>(AParcel_getDataSize(parcel));
+    std::sort(clientIds.begin(), clientIds.end());
+    clientIds.erase(std::unique(clientIds.begin(), clientIds.end()), clientIds.end());
+    std::unique_ptr<SharedMemoryFile> file = takeFreeFile(size, clientIds);
+    if (file == nullptr) {
+        auto result = createFile(size);
+        if (!result.ok()) {
+            return Error() << "failed to create shared memory file: " << result.error();
+        }
+        file = std::move(result.value());
+    }
+    // A reused file might be larger than the parcel. The stable parcelable records its own size,
+    // so the stale bytes after it are ignored by the reader.
+    if (binder_status_t status = AParcel_marshal(parcel, file->address, 0, size);
+        status != STATUS_OK) {
+        return Error() << "failed to marshal parcel into shared memory file, status: " << status;
+    }
+    int dupFd = dup(file->fd.get());
+    if (dupFd < 0) {
+        return ErrnoError() << "failed to duplicate shared memory file descriptor";
+    }
+    *fd = ndk::ScopedFileDescriptor(dupFd);
+
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    int64_t sharedMemoryId = mNextSharedMemoryId++;
+    mEntryBySharedMemoryId[sharedMemoryId] = {
+            .refCount = 1,
+            .file = std::move(file),
+            .clientIds = std::move(clientIds),
+    };
+    return sharedMemoryId;
+}
+
+void SharedMemoryTracker::finishSending(int64_t sharedMemoryId) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    unrefLocked(sharedMemoryId, /*returned=*/true);
+}
+
+int32_t SharedMemoryTracker::acquire(const AIBinder* clientId, int64_t sharedMemoryId) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    ClientState& state = mClientStates[clientId];
+    size_t capacity = static_cast<size_t>(std::max(state.maxSharedMemoryFileCount, 1));
+    while (state.sharedMemoryIds.size() >= capacity) {
+        ALOGW("client: %p did not return shared memory file: %" PRId64 " in time, reclaim it",
+              clientId, state.sharedMemoryIds.front());
+        unrefLocked(state.sharedMemoryIds.front(), /*returned=*/false);
+        state.sharedMemoryIds.pop_front();
+    }
+    state.sharedMemoryIds.push_back(sharedMemoryId);
+    SharedMemoryEntry& entry = mEntryBySharedMemoryId[sharedMemoryId];
+    entry.refCount++;
+    if (entry.file != nullptr &&
+        !std::binary_search(entry.clientIds.begin(), entry.clientIds.end(), clientId)) {
+        // The file is seen by a client it was not written for, it can not be reused.
+        entry.reusable = false;
+    }
+    return static_cast<int32_t>(state.sharedMemoryIds.size());
+}
+
+bool SharedMemoryTracker::release(const AIBinder* clientId, int64_t sharedMemoryId) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    auto stateIt = mClientStates.find(clientId);
+    if (stateIt == mClientStates.end()) {
+        return false;
+    }
+    std::deque<int64_t>& sharedMemoryIds = stateIt->second.sharedMemoryIds;
+    auto it = std::find(sharedMemoryIds.begin(), sharedMemoryIds.end(), sharedMemoryId);
+    if (it == sharedMemoryIds.end()) {
+        return false;
+    }
+    sharedMemoryIds.erase(it);
+    unrefLocked(sharedMemoryId, /*returned=*/true);
+    return true;
+}
+
+void SharedMemoryTracker::removeClient(const AIBinder* clientId) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    auto stateIt = mClientStates.find(clientId);
+    if (stateIt != mClientStates.end()) {
+        // The client might still be reading the files, so they are not reused.
+        for (int64_t sharedMemoryId : stateIt->second.sharedMemoryIds) {
+            unrefLocked(sharedMemoryId, /*returned=*/false);
+        }
+        mClientStates.erase(stateIt);
+    }
+    // The client ID might be taken by another client later, so the files the client has seen are
+    // never reused.
+    auto seenByClient = [clientId](const std::vector<const AIBinder*>& clientIds) {
+        return std::binary_search(clientIds.begin(), clientIds.end(), clientId);
+    };
+    for (auto& [_, entry] : mEntryBySharedMemoryId) {
+        if (seenByClient(entry.clientIds)) {
+            entry.reusable = false;
+        }
+    }
+    mFreeFiles.erase(std::remove_if(mFreeFiles.begin(), mFreeFiles.end(),
+                                    [&seenByClient](const FreeFile& freeFile) {
+                                        return seenByClient(freeFile.clientIds);
+                                    }),
+                     mFreeFiles.end());
+}
+
+size_t SharedMemoryTracker::countSharedMemoryFiles(const AIBinder* clientId) const {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    auto stateIt = mClientStates.find(clientId);
+    if (stateIt == mClientStates.end()) {
+        return 0;
+    }
+    return stateIt->second.sharedMemoryIds.size();
+}
+
+size_t SharedMemoryTracker::countSharedMemoryIds() const {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mEntryBySharedMemoryId.size();
+}
+
+size_t SharedMemoryTracker::countFreeSharedMemoryFiles() const {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mFreeFiles.size();
+}
+
+Result<std::unique_ptr<SharedMemoryTracker::SharedMemoryFile>> SharedMemoryTracker::createFile(
+        size_t size) {
+    auto file = std::make_unique<SharedMemoryFile>();
+    file->fd = ndk::ScopedFileDescriptor(ashmem_create_region("vhal_property_events", size));
+    if (file->fd.get() < 0) {
+        return ErrnoError() << "ashmem_create_region failed";
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd.get(), 0);
+    if (address == MAP_FAILED) {
+        return ErrnoError() << "mmap failed";
+    }
+    file->size = size;
+    file->address = static_cast<uint8_t*>(address);
+    // The mapping above stays writable, the clients could only map the file read-only.
+    if (ashmem_set_prot_region(file->fd.get(), PROT_READ) != 0) {
+        return ErrnoError() << "ashmem_set_prot_region failed";
+    }
+    return file;
+}
+
+std::unique_ptr<SharedMemoryTracker::SharedMemoryFile> SharedMemoryTracker::takeFreeFile(
+        size_t size, const std::vector<const AIBinder*>& clientIds) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    // Takes the smallest file that is large enough and only seen by the same clients.
+    auto best = mFreeFiles.end();
+    for (auto it = mFreeFiles.begin(); it != mFreeFiles.end(); it++) {
+        if (it->file->size >= size && it->clientIds == clientIds &&
+            (best == mFreeFiles.end() || it->file->size < best->file->size)) {
+            best = it;
+        }
+    }
+    if (best == mFreeFiles.end()) {
+        return nullptr;
+    }
+    std::unique_ptr<SharedMemoryFile> file = std::move(best->file);
+    mFreeFiles.erase(best);
+    return file;
+}
+
+void SharedMemoryTracker::unrefLocked(int64_t sharedMemoryId, bool returned) {
+    auto it = mEntryBySharedMemoryId.find(sharedMemoryId);
+    if (it == mEntryBySharedMemoryId.end()) {
+        return;
+    }
+    SharedMemoryEntry& entry = it->second;
+    entry.reusable = entry.reusable && returned;
+    if (--entry.refCount > 0) {
+        return;
+    }
+    if (entry.file != nullptr && entry.reusable) {
+        if (mFreeFiles.size() >= MAX_FREE_SHARED_MEMORY_FILE_COUNT) {
+            // Drops the least recently returned file.
+            mFreeFiles.erase(mFreeFiles.begin());
+        }
+        mFreeFiles.push_back({
+                .clientIds = std::move(entry.clientIds),
+                .file = std::move(entry.file),
+        });
+    }
+    mEntryBySharedMemoryId.erase(it);
+}
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
@@ -23,6 +23,8 @@
 #include <utils/SystemClock.h>
 
 #include <inttypes.h>
+#include <algorithm>
+#include <tuple>
 
 namespace android {
 namespace hardware {
@@ -56,10 +58,14 @@ SubscribeOptions newSubscribeOptions(int32_t propId, int32_t areaId, float sampl
     return subscribedOptions;
 }
 
+bool comparePropIdAreaId(const PropIdAreaId& left, const PropIdAreaId& right) {
+    return std::tie(left.propId, left.areaId) < std::tie(right.propId, right.areaId);
+}
+
 }  // namespace
 
 SubscriptionManager::SubscriptionManager(IVehicleHardware* vehicleHardware)
-    : mVehicleHardware(vehicleHardware) {}
+    : mVehicleHardware(vehicleHardware), mFanOutTable(std::make_shared<const FanOutTable>()) {}
 
 SubscriptionManager::~SubscriptionManager() {
     std::scoped_lock<std::mutex> lockGuard(mLock);
@@ -70,6 +76,16 @@ SubscriptionManager::~SubscriptionManager() {
     mSupportedValueChangePropIdAreaIdsByClient.clear();
 }
 
+ssize_t SubscriptionManager::FanOutTable::find(int32_t propId, int32_t areaId) const {
+    auto it = std::lower_bound(propIdAreaIds.begin(), propIdAreaIds.end(),
+                               PropIdAreaId{.propId = propId, .areaId = areaId},
+                               comparePropIdAreaId);
+    if (it == propIdAreaIds.end() || it->propId != propId || it->areaId != areaId) {
+        return -1;
+    }
+    return it - propIdAreaIds.begin();
+}
+
 bool SubscriptionManager::checkSampleRateHz(float sampleRateHz) {
     return getIntervalNanos(sampleRateHz).ok();
 }
@@ -262,6 +278,15 @@ VhalResult<void> SubscriptionManager::subscribe(const std::shared_ptr<IVehicleCa
                                                 bool isContinuousProperty) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
 
+    auto result = subscribeLocked(callback, options, isContinuousProperty);
+    // Part of the options might be subscribed even if the result is an error.
+    rebuildFanOutTableLocked();
+    return result;
+}
+
+VhalResult<void> SubscriptionManager::subscribeLocked(
+        const std::shared_ptr<IVehicleCallback>& callback,
+        const std::vector<SubscribeOptions>& options, bool isContinuousProperty) {
     for (const auto& option : options) {
         float sampleRateHz = option.sampleRate;
 
@@ -346,6 +371,13 @@ VhalResult<void> SubscriptionManager::unsubscribe(SubscriptionManager::ClientIdT
                                                   const std::vector<int32_t>& propIds) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
 
+    auto result = unsubscribeLocked(clientId, propIds);
+    rebuildFanOutTableLocked();
+    return result;
+}
+
+VhalResult<void> SubscriptionManager::unsubscribeLocked(SubscriptionManager::ClientIdType clientId,
+                                                        const std::vector<int32_t>& propIds) {
     if (mSubscribedPropsByClient.find(clientId) == mSubscribedPropsByClient.end()) {
         ALOGW("No property was subscribed for the callback, unsubscribe does nothing");
         return {};
@@ -379,6 +411,13 @@ VhalResult<void> SubscriptionManager::unsubscribe(SubscriptionManager::ClientIdT
 VhalResult<void> SubscriptionManager::unsubscribe(SubscriptionManager::ClientIdType clientId) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
 
+    auto result = unsubscribeLocked(clientId);
+    rebuildFanOutTableLocked();
+    return result;
+}
+
+VhalResult<void> SubscriptionManager::unsubscribeLocked(
+        SubscriptionManager::ClientIdType clientId) {
     if (mSubscribedPropsByClient.find(clientId) == mSubscribedPropsByClient.end()) {
         ALOGW("No property was subscribed for this client, unsubscribe does nothing");
     } else {
@@ -517,61 +556,127 @@ bool SubscriptionManager::isValueUpdatedLocked(const std::shared_ptr<IVehicleCal
     return true;
 }
 
+void SubscriptionManager::rebuildFanOutTableLocked() {
+    auto table = std::make_shared<FanOutTable>();
+    table->propIdAreaIds.reserve(mClientsByPropIdAreaId.size());
+    table->targetOffsets.reserve(mClientsByPropIdAreaId.size() + 1);
+    for (const auto& [propIdAreaId, _] : mClientsByPropIdAreaId) {
+        table->propIdAreaIds.push_back(propIdAreaId);
+    }
+    std::sort(table->propIdAreaIds.begin(), table->propIdAreaIds.end(), comparePropIdAreaId);
+
+    std::unordered_map<ClientIdType, size_t> clientIndexById;
+    for (const auto& propIdAreaId : table->propIdAreaIds) {
+        // On-change properties do not have ContSubConfigs.
+        const auto configIt = mContSubConfigsByPropIdArea.find(propIdAreaId);
+        for (const auto& [clientId, callback] : mClientsByPropIdAreaId[propIdAreaId]) {
+            auto [indexIt, inserted] =
+                    clientIndexById.try_emplace(clientId, table->callbacks.size());
+            if (inserted) {
+                table->callbacks.push_back(callback);
+            }
+            FanOutTarget target = {
+                    .clientIndex = indexIt->second,
+            };
+            if (configIt != mContSubConfigsByPropIdArea.end()) {
+                const ContSubConfigs& subConfigs = configIt->second;
+                target.resolution = subConfigs.getResolutionForClient(clientId);
+                // If client wants VUR (and VUR is supported as checked in DefaultVehicleHal), it
+                // is possible that VUR is not enabled in IVehicleHardware because another client
+                // does not enable VUR. We will implement VUR filtering here for the client that
+                // enables it.
+                target.filterByVur =
+                        subConfigs.isVurEnabledForClient(clientId) && !subConfigs.isVurEnabled();
+            }
+            table->targets.push_back(target);
+        }
+        table->targetOffsets.push_back(table->targets.size());
+    }
+
+    std::scoped_lock<std::mutex> lockGuard(mFanOutTableLock);
+    mFanOutTable = std::move(table);
+}
+
+std::shared_ptr<const SubscriptionManager::FanOutTable> SubscriptionManager::getFanOutTable()
+        const {
+    std::scoped_lock<std::mutex> lockGuard(mFanOutTableLock);
+    return mFanOutTable;
+}
+
 std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropValue>>
 SubscriptionManager::getSubscribedClients(std::vector<VehiclePropValue>&& updatedValues) {
-    std::scoped_lock<std::mutex> lockGuard(mLock);
     std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropValue>> clients;
+    for (auto& clientEvents : getSubscribedClientEvents(std::move(updatedValues))) {
+        clients[clientEvents.callback] = std::move(clientEvents.values);
+    }
+    return clients;
+}
 
-    for (auto& value : updatedValues) {
-        PropIdAreaId propIdAreaId{
-                .propId = value.prop,
-                .areaId = value.areaId,
-        };
-        if (mClientsByPropIdAreaId.find(propIdAreaId) == mClientsByPropIdAreaId.end()) {
+std::vector<SubscriptionManager::ClientEvents> SubscriptionManager::getSubscribedClientEvents(
+        std::vector<VehiclePropValue>&& updatedValues) {
+    std::shared_ptr<const FanOutTable> table = getFanOutTable();
+    // Indexed by the client index in the table.
+    std::vector<ClientEvents> eventsByClient(table->callbacks.size());
+
+    for (size_t valueIndex = 0; valueIndex < updatedValues.size(); valueIndex++) {
+        VehiclePropValue& value = updatedValues[valueIndex];
+        ssize_t index = table->find(value.prop, value.areaId);
+        if (index < 0) {
             continue;
         }
-
-        for (const auto& [client, callback] : mClientsByPropIdAreaId[propIdAreaId]) {
-            // if propId is on-change, propIdAreaId will not exist in mContSubConfigsByPropIdArea,
-            // returning an empty ContSubConfigs value for subConfigs i.e. with resolution = 0 and
-            // enableVur = false.
-            auto& subConfigs = mContSubConfigsByPropIdArea[propIdAreaId];
+        size_t targetBegin = table->targetOffsets[index];
+        size_t targetEnd = table->targetOffsets[index + 1];
+        for (size_t i = targetBegin; i < targetEnd; i++) {
+            const FanOutTarget& target = table->targets[i];
+            const CallbackType& callback = table->callbacks[target.clientIndex];
             // Clients must be sent different VehiclePropValues with different levels of granularity
-            // as requested by the client using resolution.
-            VehiclePropValue newValue = value;
-            sanitizeByResolution(&(newValue.value), subConfigs.getResolutionForClient(client));
-            // If client wants VUR (and VUR is supported as checked in DefaultVehicleHal), it is
-            // possible that VUR is not enabled in IVehicleHardware because another client does not
-            // enable VUR. We will implement VUR filtering here for the client that enables it.
-            if (subConfigs.isVurEnabledForClient(client) && !subConfigs.isVurEnabled()) {
-                if (isValueUpdatedLocked(callback, newValue)) {
-                    clients[callback].push_back(newValue);
-                }
+            // as requested by the client using resolution. The last target takes the value.
+            VehiclePropValue newValue;
+            if (i + 1 == targetEnd) {
+                newValue = std::move(value);
             } else {
-                clients[callback].push_back(newValue);
+                newValue = value;
             }
+            sanitizeByResolution(&(newValue.value), target.resolution);
+            if (target.filterByVur) {
+                std::scoped_lock<std::mutex> lockGuard(mContSubValuesLock);
+                if (!isValueUpdatedLocked(callback, newValue)) {
+                    continue;
+                }
+            }
+            ClientEvents& clientEvents = eventsByClient[target.clientIndex];
+            if (clientEvents.callback == nullptr) {
+                clientEvents.callback = callback;
+            }
+            clientEvents.values.push_back(std::move(newValue));
+            clientEvents.sources.push_back({valueIndex, target.resolution});
+            hashCombine(clientEvents.sourcesHash, valueIndex);
+            hashCombine(clientEvents.sourcesHash, target.resolution);
         }
     }
-    return clients;
+
+    eventsByClient.erase(std::remove_if(eventsByClient.begin(), eventsByClient.end(),
+                                        [](const ClientEvents& clientEvents) {
+                                            return clientEvents.values.empty();
+                                        }),
+                         eventsByClient.end());
+    return eventsByClient;
 }
 
 std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropError>>
 SubscriptionManager::getSubscribedClientsForErrorEvents(
         const std::vector<SetValueErrorEvent>& errorEvents) {
-    std::scoped_lock<std::mutex> lockGuard(mLock);
+    std::shared_ptr<const FanOutTable> table = getFanOutTable();
     std::unordered_map<std::shared_ptr<IVehicleCallback>, std::vector<VehiclePropError>> clients;
 
     for (const auto& errorEvent : errorEvents) {
-        PropIdAreaId propIdAreaId{
-                .propId = errorEvent.propId,
-                .areaId = errorEvent.areaId,
-        };
-        if (mClientsByPropIdAreaId.find(propIdAreaId) == mClientsByPropIdAreaId.end()) {
+        ssize_t index = table->find(errorEvent.propId, errorEvent.areaId);
+        if (index < 0) {
             continue;
         }
 
-        for (const auto& [_, client] : mClientsByPropIdAreaId[propIdAreaId]) {
-            clients[client].push_back({
+        for (size_t i = table->targetOffsets[index]; i < table->targetOffsets[index + 1]; i++) {
+            clients[table->callbacks[table->targets[i].clientIndex]].push_back({
                     .propId = errorEvent.propId,
                     .areaId = errorEvent.areaId,
                     .errorCode = errorEvent.errorCode,
@@ -612,6 +717,11 @@ size_t SubscriptionManager::countPropertyChangeClients() {
     return mSubscribedPropsByClient.size();
 }
 
+bool SubscriptionManager::hasPropertyChangeSubscriptions(ClientIdType client) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mSubscribedPropsByClient.find(client) != mSubscribedPropsByClient.end();
+}
+
 size_t SubscriptionManager::countSupportedValueChangeClients() {
     std::scoped_lock<std::mutex> lockGuard(mLock);
     return mSupportedValueChangePropIdAreaIdsByClient.size();
@@ -465,6 +465,24 @@ class DefaultVehicleHalTest : public testing::Test {
 
     bool hasNoSubscriptions() { return mVhal->mSubscriptionManager->isEmpty(); }
 
+    std::vector<VehiclePropValue> coalesceContinuousPropertyEvents(
+            std::vector<VehiclePropValue> events) {
+        mVhal->coalesceContinuousPropertyEvents(&events);
+        return events;
+    }
+
+    size_t countFreeSharedMemoryFiles() {
+        return mVhal->mSharedMemoryTracker->countFreeSharedMemoryFiles();
+    }
+
+    size_t countSharedMemoryFiles(const std::shared_ptr<IVehicleCallback>& callback) {
+        return mVhal->mSharedMemoryTracker->countSharedMemoryFiles(callback->asBinder().get());
+    }
+
+    static size_t getBatchedEventQueueCapacity() {
+        return DefaultVehicleHal::BATCHED_EVENT_QUEUE_CAPACITY;
+    }
+
     void setBinderAlive(bool isAlive) { mBinderLifecycleHandler->setAlive(isAlive); };
 
     static Result<void> getValuesTestCases(size_t size, GetValueRequests& requests,
@@ -790,6 +808,122 @@ TEST_F(DefaultVehicleHalTest, testGetValuesLarge) {
     EXPECT_EQ(countClients(), static_cast<size_t>(1));
 }
 
+TEST_F(DefaultVehicleHalTest, testGetValuesInline) {
+    GetValueRequests requests;
+    std::vector<GetValueResult> expectedResults;
+    std::vector<GetValueRequest> expectedHardwareRequests;
+
+    // Requests are only answered inline once the configs are cached.
+    VehiclePropConfigs output;
+    getClient()->getAllPropConfigs(&output);
+
+    ASSERT_TRUE(getValuesTestCases(10, requests, expectedResults, expectedHardwareRequests).ok());
+
+    getHardware()->setGetValuesInlineEnabled(true);
+    getHardware()->addGetValueResponses(expectedResults);
+
+    auto status = getClient()->getValues(getCallbackClient(), requests);
+
+    ASSERT_TRUE(status.isOk()) << "getValues failed: " << status.getMessage();
+
+    EXPECT_EQ(getHardware()->nextGetValueRequests(), expectedHardwareRequests)
+            << "requests to hardware mismatch";
+
+    auto maybeGetValueResults = getCallback()->nextGetValueResults();
+    ASSERT_TRUE(maybeGetValueResults.has_value()) << "no results in callback";
+    EXPECT_EQ(maybeGetValueResults.value().payloads, expectedResults) << "results mismatch";
+    EXPECT_EQ(countClients(), static_cast<size_t>(0))
+            << "no client must be created for inline requests";
+    EXPECT_EQ(countPendingRequests(), static_cast<size_t>(0));
+    EXPECT_EQ(countOnBinderDiedContexts(), static_cast<size_t>(1))
+            << "the client binder must be monitored for inline requests";
+}
+
+TEST_F(DefaultVehicleHalTest, testGetValuesInline_clientDied) {
+    GetValueRequests requests;
+    std::vector<GetValueResult> expectedResults;
+    std::vector<GetValueRequest> expectedHardwareRequests;
+
+    VehiclePropConfigs output;
+    getClient()->getAllPropConfigs(&output);
+
+    ASSERT_TRUE(getValuesTestCases(10, requests, expectedResults, expectedHardwareRequests).ok());
+
+    getHardware()->setGetValuesInlineEnabled(true);
+    getHardware()->addGetValueResponses(expectedResults);
+
+    setBinderAlive(false);
+
+    auto status = getClient()->getValues(getCallbackClient(), requests);
+
+    ASSERT_FALSE(status.isOk()) << "getValues must fail if client died";
+    ASSERT_EQ(status.getExceptionCode(), EX_TRANSACTION_FAILED);
+    EXPECT_TRUE(getHardware()->nextGetValueRequests().empty())
+            << "requests from a dead client must not be sent to hardware";
+}
+
+TEST_F(DefaultVehicleHalTest, testGetValuesInline_noReadPermission) {
+    VehiclePropConfigs output;
+    getClient()->getAllPropConfigs(&output);
+    getHardware()->setGetValuesInlineEnabled(true);
+    getHardware()->addGetValueResponses({});
+
+    GetValueRequests requests = {
+            .sharedMemoryFd = {},
+            .payloads =
+                    {
+                            {
+                                    .requestId = 0,
+                                    .prop =
+                                            {
+                                                    .prop = WRITE_ONLY_PROP,
+                                            },
+                            },
+                    },
+    };
+
+    auto status = getClient()->getValues(getCallbackClient(), requests);
+
+    ASSERT_TRUE(status.isOk()) << "getValues failed: " << status.getMessage();
+    EXPECT_TRUE(getHardware()->nextGetValueRequests().empty()) << "expect no request to hardware";
+
+    auto maybeResult = getCallback()->nextGetValueResults();
+    ASSERT_TRUE(maybeResult.has_value()) << "no results in callback";
+    EXPECT_EQ(maybeResult.value().payloads, std::vector<GetValueResult>({
+                                                    {
+                                                            .requestId = 0,
+                                                            .status = StatusCode::ACCESS_DENIED,
+                                                    },
+                                            }))
+            << "invalid requests must not be answered inline";
+}
+
+TEST_F(DefaultVehicleHalTest, testGetValuesInline_notSupportedByHardware) {
+    GetValueRequests requests;
+    std::vector<GetValueResult> expectedResults;
+    std::vector<GetValueRequest> expectedHardwareRequests;
+
+    VehiclePropConfigs output;
+    getClient()->getAllPropConfigs(&output);
+
+    ASSERT_TRUE(getValuesTestCases(10, requests, expectedResults, expectedHardwareRequests).ok());
+
+    // The hardware does not answer inline by default, so the requests go through getValues.
+    getHardware()->addGetValueResponses(expectedResults);
+
+    auto status = getClient()->getValues(getCallbackClient(), requests);
+
+    ASSERT_TRUE(status.isOk()) << "getValues failed: " << status.getMessage();
+
+    EXPECT_EQ(getHardware()->nextGetValueRequests(), expectedHardwareRequests)
+            << "requests to hardware mismatch";
+
+    auto maybeGetValueResults = getCallback()->nextGetValueResults();
+    ASSERT_TRUE(maybeGetValueResults.has_value()) << "no results in callback";
+    EXPECT_EQ(maybeGetValueResults.value().payloads, expectedResults) << "results mismatch";
+    EXPECT_EQ(countClients(), static_cast<size_t>(1));
+}
+
 TEST_F(DefaultVehicleHalTest, testGetValuesErrorFromHardware) {
     GetValueRequests requests;
     std::vector<GetValueResult> expectedResults;
@@ -1821,6 +1955,133 @@ TEST_P(SubscribeInvalidOptionsTest, testSubscribeInvalidOptions) {
     ASSERT_EQ(status.getServiceSpecificError(), toInt(StatusCode::INVALID_ARG));
 }
 
+TEST_F(DefaultVehicleHalTest, testSubscribeInvalidMaxSharedMemoryFileCount) {
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_ON_CHANGE_PROP,
+            },
+    };
+
+    auto status = getClient()->subscribe(getCallbackClient(), options,
+                                         /*maxSharedMemoryFileCount=*/-1);
+
+    ASSERT_FALSE(status.isOk()) << "subscribe with negative maxSharedMemoryFileCount must fail";
+    ASSERT_EQ(status.getServiceSpecificError(), toInt(StatusCode::INVALID_ARG));
+}
+
+TEST_F(DefaultVehicleHalTest, testSubscribeLargeEventsSharedMemory) {
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_ON_CHANGE_PROP,
+            },
+    };
+    std::shared_ptr<MockVehicleCallback> callback2 =
+            ndk::SharedRefBase::make<MockVehicleCallback>();
+    // Keep binder alive to prevent binder reuse.
+    SpAIBinder binder2 = callback2->asBinder();
+    std::shared_ptr<IVehicleCallback> callbackClient2 = IVehicleCallback::fromBinder(binder2);
+
+    ASSERT_TRUE(getClient()->subscribe(getCallbackClient(), options,
+                                       /*maxSharedMemoryFileCount=*/1)
+                        .isOk());
+    ASSERT_TRUE(getClient()->subscribe(callbackClient2, options, /*maxSharedMemoryFileCount=*/1)
+                        .isOk());
+
+    // The event is too large to fit in the payloads, so a shared memory file is used.
+    VehiclePropValue largeValue = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = std::vector<int32_t>(5000, 1),
+    };
+    getHardware()->sendOnPropertyChangeEvent({largeValue});
+
+    auto maybeResults1 = getCallback()->nextOnPropertyEventResults();
+    auto maybeResults2 = callback2->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults1.has_value()) << "no results in callback 1";
+    ASSERT_TRUE(maybeResults2.has_value()) << "no results in callback 2";
+    int64_t sharedMemoryId1 = maybeResults1->sharedMemoryId;
+    ASSERT_TRUE(maybeResults1->payloads.empty()) << "shared memory file should be used";
+    ASSERT_NE(sharedMemoryId1, IVehicle::INVALID_MEMORY_ID);
+    ASSERT_EQ(maybeResults2->sharedMemoryId, sharedMemoryId1)
+            << "the same events must be marshalled once for all the clients";
+    ASSERT_EQ(getCallback()->getSharedMemoryFileCount(), 1);
+    auto result = LargeParcelableBase::stableLargeParcelableToParcelable(maybeResults1.value());
+    ASSERT_TRUE(result.ok()) << "failed to parse shared memory file";
+    ASSERT_THAT(result.value().getObject()->payloads, ElementsAre(largeValue));
+
+    ASSERT_TRUE(getClient()->returnSharedMemory(getCallbackClient(), sharedMemoryId1).isOk());
+    ASSERT_TRUE(getClient()->returnSharedMemory(getCallbackClient(), sharedMemoryId1).isOk())
+            << "returning a shared memory file twice must be ignored";
+
+    // Client 2 never returned the first file, it is reclaimed since client 2 could only hold one
+    // file.
+    getHardware()->sendOnPropertyChangeEvent({largeValue});
+
+    maybeResults2 = callback2->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults2.has_value()) << "no results in callback 2";
+    int64_t sharedMemoryId2 = maybeResults2->sharedMemoryId;
+    ASSERT_NE(sharedMemoryId2, sharedMemoryId1);
+    ASSERT_EQ(callback2->getSharedMemoryFileCount(), 1);
+    EXPECT_TRUE(getClient()->returnSharedMemory(callbackClient2, sharedMemoryId1).isOk())
+            << "returning a reclaimed shared memory file must be ignored";
+    ASSERT_EQ(countFreeSharedMemoryFiles(), 0u) << "a reclaimed file must not be reused";
+
+    // Once both clients return the second file, it is reused for the next events.
+    maybeResults1 = getCallback()->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults1.has_value()) << "no results in callback 1";
+    ASSERT_EQ(maybeResults1->sharedMemoryId, sharedMemoryId2);
+    EXPECT_TRUE(getClient()->returnSharedMemory(getCallbackClient(), sharedMemoryId2).isOk());
+    EXPECT_TRUE(getClient()->returnSharedMemory(callbackClient2, sharedMemoryId2).isOk());
+    ASSERT_EQ(countFreeSharedMemoryFiles(), 1u);
+
+    largeValue.value.int32Values = std::vector<int32_t>(4000, 2);
+    getHardware()->sendOnPropertyChangeEvent({largeValue});
+
+    ASSERT_EQ(countFreeSharedMemoryFiles(), 0u) << "the returned file must be reused";
+    maybeResults1 = getCallback()->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults1.has_value()) << "no results in callback 1";
+    auto reusedResult =
+            LargeParcelableBase::stableLargeParcelableToParcelable(maybeResults1.value());
+    ASSERT_TRUE(reusedResult.ok()) << "failed to parse reused shared memory file";
+    ASSERT_THAT(reusedResult.value().getObject()->payloads, ElementsAre(largeValue));
+}
+
+TEST_F(DefaultVehicleHalTest, testUnsubscribeReleasesSharedMemory) {
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_ON_CHANGE_PROP,
+            },
+    };
+    ASSERT_TRUE(getClient()->subscribe(getCallbackClient(), options,
+                                       /*maxSharedMemoryFileCount=*/1)
+                        .isOk());
+
+    VehiclePropValue largeValue = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = std::vector<int32_t>(5000, 1),
+    };
+    getHardware()->sendOnPropertyChangeEvent({largeValue});
+
+    auto maybeResults = getCallback()->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults.has_value()) << "no results in callback";
+    ASSERT_NE(maybeResults->sharedMemoryId, IVehicle::INVALID_MEMORY_ID);
+    ASSERT_EQ(countSharedMemoryFiles(getCallbackClient()), 1u);
+
+    ASSERT_TRUE(getClient()
+                        ->unsubscribe(getCallbackClient(),
+                                      std::vector<int32_t>({GLOBAL_ON_CHANGE_PROP}))
+                        .isOk());
+
+    ASSERT_EQ(countSharedMemoryFiles(getCallbackClient()), 0u)
+            << "the shared memory files must be released once the client has no subscriptions";
+    ASSERT_EQ(countFreeSharedMemoryFiles(), 0u) << "the client might still read the file";
+}
+
+TEST_F(DefaultVehicleHalTest, testReturnSharedMemoryUnknownId) {
+    auto status = getClient()->returnSharedMemory(getCallbackClient(), /*sharedMemoryId=*/1);
+
+    ASSERT_TRUE(status.isOk()) << "returning an unknown shared memory file must be ignored";
+}
+
 TEST_F(DefaultVehicleHalTest, testSubscribeNoReadPermission) {
     std::vector<SubscribeOptions> options = {{
             .propId = WRITE_ONLY_PROP,
@@ -2059,6 +2320,64 @@ TEST_F(DefaultVehicleHalTest, testOnPropertySetErrorEvent) {
     ASSERT_THAT(vehiclePropErrors.payloads, UnorderedElementsAreArray(expectedResults));
 }
 
+TEST_F(DefaultVehicleHalTest, testCoalesceContinuousPropertyEvents) {
+    VehiclePropValue continuousValue1 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {1},
+    };
+    VehiclePropValue continuousValue2 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {2},
+    };
+    VehiclePropValue areaContinuousLeft1 = {
+            .prop = AREA_CONTINUOUS_PROP,
+            .areaId = toInt(VehicleAreaWindow::ROW_1_LEFT),
+            .value.int32Values = {1},
+    };
+    VehiclePropValue areaContinuousRight = {
+            .prop = AREA_CONTINUOUS_PROP,
+            .areaId = toInt(VehicleAreaWindow::ROW_1_RIGHT),
+            .value.int32Values = {1},
+    };
+    VehiclePropValue areaContinuousLeft2 = {
+            .prop = AREA_CONTINUOUS_PROP,
+            .areaId = toInt(VehicleAreaWindow::ROW_1_LEFT),
+            .value.int32Values = {2},
+    };
+    VehiclePropValue onChangeValue1 = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = {1},
+    };
+    VehiclePropValue onChangeValue2 = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = {2},
+    };
+
+    auto coalescedEvents = coalesceContinuousPropertyEvents(
+            {continuousValue1, onChangeValue1, areaContinuousLeft1, areaContinuousRight,
+             continuousValue2, onChangeValue2, areaContinuousLeft2});
+
+    // Every on-change event must be kept, only the latest continuous event for each
+    // [propId, areaId] is kept.
+    ASSERT_THAT(coalescedEvents, ElementsAre(onChangeValue1, areaContinuousRight, continuousValue2,
+                                             onChangeValue2, areaContinuousLeft2));
+}
+
+TEST_F(DefaultVehicleHalTest, testCoalesceContinuousPropertyEvents_noContinuousEvents) {
+    VehiclePropValue onChangeValue1 = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = {1},
+    };
+    VehiclePropValue onChangeValue2 = {
+            .prop = GLOBAL_ON_CHANGE_PROP,
+            .value.int32Values = {1},
+    };
+
+    auto coalescedEvents = coalesceContinuousPropertyEvents({onChangeValue1, onChangeValue2});
+
+    ASSERT_THAT(coalescedEvents, ElementsAre(onChangeValue1, onChangeValue2));
+}
+
 TEST_F(DefaultVehicleHalTest, testBatchOnPropertyChangeEvents) {
     auto hardware = std::make_unique<MockVehicleHardware>();
     hardware->setPropertyOnChangeEventBatchingWindow(std::chrono::milliseconds(10));
@@ -2145,6 +2464,117 @@ TEST_F(DefaultVehicleHalTest, testBatchOnPropertyChangeEvents) {
     }
 }
 
+TEST_F(DefaultVehicleHalTest, testBatchOnPropertyChangeEvents_fullQueueCoalescesEvents) {
+    auto hardware = std::make_unique<MockVehicleHardware>();
+    hardware->setPropertyOnChangeEventBatchingWindow(std::chrono::milliseconds(10));
+    init(std::move(hardware));
+
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_ON_CHANGE_PROP,
+            },
+    };
+    getClient()->subscribe(getCallbackClient(), options, 0);
+
+    // Send more on-change events within one batching window than the queue could hold.
+    size_t eventCount = getBatchedEventQueueCapacity() + 100;
+    std::vector<VehiclePropValue> values;
+    for (size_t i = 0; i < eventCount; i++) {
+        values.push_back({
+                .prop = GLOBAL_ON_CHANGE_PROP,
+                .value.int32Values = {static_cast<int32_t>(i)},
+        });
+    }
+    getHardware()->sendOnPropertyChangeEvent(values);
+
+    std::vector<VehiclePropValue> receivedValues;
+    while (receivedValues.empty() || receivedValues.back() != values.back()) {
+        ASSERT_TRUE(getCallback()->waitForOnPropertyEventResults(/*size=*/1,
+                                                                 /*timeoutInNano=*/1'000'000'000))
+                << "not received the latest property change event before timeout, received: "
+                << receivedValues.size();
+        auto maybeResults = getCallback()->nextOnPropertyEventResults();
+        ASSERT_TRUE(maybeResults.has_value()) << "no results in callback";
+        for (auto& value : maybeResults.value().payloads) {
+            receivedValues.push_back(std::move(value));
+        }
+    }
+
+    // The queue stays bounded, the events beyond its capacity are coalesced, but the received
+    // events stay in order and the latest one is always delivered.
+    ASSERT_LT(receivedValues.size(), eventCount);
+    for (size_t i = 1; i < receivedValues.size(); i++) {
+        ASSERT_LT(receivedValues[i - 1].value.int32Values[0],
+                  receivedValues[i].value.int32Values[0]);
+    }
+}
+
+TEST_F(DefaultVehicleHalTest, testBatchOnPropertyChangeEvents_continuousCoalescingDisabled) {
+    auto hardware = std::make_unique<MockVehicleHardware>();
+    hardware->setPropertyOnChangeEventBatchingWindow(std::chrono::milliseconds(10));
+    init(std::move(hardware));
+
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_CONTINUOUS_PROP,
+                    // A low sample rate so that the hardware does not generate events during
+                    // the test.
+                    .sampleRate = 0.1,
+            },
+    };
+    getClient()->subscribe(getCallbackClient(), options, 0);
+    VehiclePropValue continuousValue1 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {1},
+    };
+    VehiclePropValue continuousValue2 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {2},
+    };
+    getHardware()->sendOnPropertyChangeEvent({continuousValue1, continuousValue2});
+
+    ASSERT_TRUE(getCallback()->waitForOnPropertyEventResults(/*size=*/1,
+                                                             /*timeoutInNano=*/1'000'000'000))
+            << "not received property change events before timeout";
+    auto maybeResults = getCallback()->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults.has_value()) << "no results in callback";
+    ASSERT_THAT(maybeResults.value().payloads, ElementsAre(continuousValue1, continuousValue2))
+            << "continuous events must not be coalesced unless the hardware asks for it";
+}
+
+TEST_F(DefaultVehicleHalTest, testBatchOnPropertyChangeEvents_continuousCoalescingEnabled) {
+    auto hardware = std::make_unique<MockVehicleHardware>();
+    hardware->setPropertyOnChangeEventBatchingWindow(std::chrono::milliseconds(10));
+    hardware->setContinuousPropertyEventCoalescingEnabled(true);
+    init(std::move(hardware));
+
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = GLOBAL_CONTINUOUS_PROP,
+                    // A low sample rate so that the hardware does not generate events during
+                    // the test.
+                    .sampleRate = 0.1,
+            },
+    };
+    getClient()->subscribe(getCallbackClient(), options, 0);
+    VehiclePropValue continuousValue1 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {1},
+    };
+    VehiclePropValue continuousValue2 = {
+            .prop = GLOBAL_CONTINUOUS_PROP,
+            .value.int32Values = {2},
+    };
+    getHardware()->sendOnPropertyChangeEvent({continuousValue1, continuousValue2});
+
+    ASSERT_TRUE(getCallback()->waitForOnPropertyEventResults(/*size=*/1,
+                                                             /*timeoutInNano=*/1'000'000'000))
+            << "not received property change events before timeout";
+    auto maybeResults = getCallback()->nextOnPropertyEventResults();
+    ASSERT_TRUE(maybeResults.has_value()) << "no results in callback";
+    ASSERT_THAT(maybeResults.value().payloads, ElementsAre(continuousValue2));
+}
+
 TEST_F(DefaultVehicleHalTest, testGetSupportedValuesLists) {
     auto testConfigs = std::vector<VehiclePropConfig>(
             {// This ia valid request, but no supported values are specified.
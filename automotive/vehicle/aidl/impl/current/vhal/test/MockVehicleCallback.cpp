@@ -77,6 +77,7 @@ ScopedAStatus MockVehicleCallback::onPropertyEvent(const VehiclePropValues& resu
         std::scoped_lock<std::mutex> lockGuard(mLock);
         mSharedMemoryFileCount = sharedMemoryFileCount;
         result = storeResults(results, &mOnPropertyEventResults);
+        mOnPropertyEventResults.back().sharedMemoryId = results.sharedMemoryId;
     }
     mCond.notify_all();
     return result;
@@ -122,6 +123,11 @@ size_t MockVehicleCallback::countOnPropertyEventResults() {
     return mOnPropertyEventResults.size();
 }
 
+int32_t MockVehicleCallback::getSharedMemoryFileCount() {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mSharedMemoryFileCount;
+}
+
 std::optional<VehiclePropErrors> MockVehicleCallback::nextOnPropertySetErrorResults() {
     std::scoped_lock<std::mutex> lockGuard(mLock);
     return pop(mOnPropertySetErrorResults);
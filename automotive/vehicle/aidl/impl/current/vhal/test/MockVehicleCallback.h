@@ -70,6 +70,7 @@ class MockVehicleCallback final
     std::optional<aidl::android::hardware::automotive::vehicle::VehiclePropErrors>
     nextOnPropertySetErrorResults();
     size_t countOnPropertyEventResults();
+    int32_t getSharedMemoryFileCount();
     bool waitForSetValueResults(size_t size, size_t timeoutInNano);
     bool waitForGetValueResults(size_t size, size_t timeoutInNano);
     bool waitForOnPropertyEventResults(size_t size, size_t timeoutInNano);
@@ -86,7 +87,7 @@ class MockVehicleCallback final
             GUARDED_BY(mLock);
     std::list<aidl::android::hardware::automotive::vehicle::VehiclePropValues>
             mOnPropertyEventResults GUARDED_BY(mLock);
-    int32_t mSharedMemoryFileCount GUARDED_BY(mLock);
+    int32_t mSharedMemoryFileCount GUARDED_BY(mLock) = 0;
     std::list<aidl::android::hardware::automotive::vehicle::VehiclePropErrors>
             mOnPropertySetErrorResults GUARDED_BY(mLock);
     std::vector<aidl::android::hardware::automotive::vehicle::PropIdAreaId>
@@ -90,6 +90,18 @@ StatusCode MockVehicleHardware::getValues(std::shared_ptr<const GetValuesCallbac
                                 &mGetValueResponses);
 }
 
+bool MockVehicleHardware::getValuesInline(const std::vector<GetValueRequest>& requests,
+                                          std::vector<GetValueResult>* results) const {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    if (!mGetValuesInlineEnabled || mGetValueResponses.empty()) {
+        return false;
+    }
+    mGetValueRequests.push_back(requests);
+    std::optional<std::vector<GetValueResult>> responses = pop(mGetValueResponses);
+    results->insert(results->end(), responses->begin(), responses->end());
+    return true;
+}
+
 void MockVehicleHardware::setDumpResult(DumpResult result) {
     mDumpResult = result;
 }
@@ -256,6 +268,11 @@ void MockVehicleHardware::setGetValueResponder(
     mGetValueResponder = responder;
 }
 
+void MockVehicleHardware::setGetValuesInlineEnabled(bool enabled) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    mGetValuesInlineEnabled = enabled;
+}
+
 std::vector<GetValueRequest> MockVehicleHardware::nextGetValueRequests() {
     std::scoped_lock<std::mutex> lockGuard(mLock);
     std::optional<std::vector<GetValueRequest>> request = pop(mGetValueRequests);
@@ -289,6 +306,11 @@ void MockVehicleHardware::setPropertyOnChangeEventBatchingWindow(std::chrono::na
     mEventBatchingWindow = window;
 }
 
+void MockVehicleHardware::setContinuousPropertyEventCoalescingEnabled(bool enabled) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    mContinuousPropertyEventCoalescingEnabled = enabled;
+}
+
 void MockVehicleHardware::setSupportedValuesListResponse(
         const std::vector<SupportedValuesListResult>& response) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
@@ -316,6 +338,11 @@ std::chrono::nanoseconds MockVehicleHardware::getPropertyOnChangeEventBatchingWi
     return mEventBatchingWindow;
 }
 
+bool MockVehicleHardware::isContinuousPropertyEventCoalescingEnabled() {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    return mContinuousPropertyEventCoalescingEnabled;
+}
+
 StatusCode MockVehicleHardware::subscribeSupportedValueChange(
         const std::vector<PropIdAreaId>& propIdAreaIds) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
@@ -425,6 +452,11 @@ void MockVehicleHardware::sendOnPropertySetErrorEvent(
     (*mPropertySetErrorCallback)(errorEvents);
 }
 
+void MockVehicleHardware::sendOnPropertyChangeEvent(const std::vector<VehiclePropValue>& values) {
+    std::scoped_lock<std::mutex> lockGuard(mLock);
+    (*mPropertyChangeCallback)(values);
+}
+
 void MockVehicleHardware::sendSupportedValueChangeEvent(
         const std::vector<PropIdAreaId>& propIdAreaIds) {
     std::scoped_lock<std::mutex> lockGuard(mLock);
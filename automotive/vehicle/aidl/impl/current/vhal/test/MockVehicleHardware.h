@@ -57,6 +57,11 @@ class MockVehicleHardware final : public IVehicleHardware {
             std::shared_ptr<const GetValuesCallback> callback,
             const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&
                     requests) const override;
+    bool getValuesInline(
+            const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&
+                    requests,
+            std::vector<aidl::android::hardware::automotive::vehicle::GetValueResult>* results)
+            const override;
     DumpResult dump(const std::vector<std::string>&) override;
     aidl::android::hardware::automotive::vehicle::StatusCode checkHealth() override;
     void registerOnPropertyChangeEvent(
@@ -69,6 +74,7 @@ class MockVehicleHardware final : public IVehicleHardware {
     aidl::android::hardware::automotive::vehicle::StatusCode unsubscribe(int32_t propId,
                                                                          int32_t areaId) override;
     std::chrono::nanoseconds getPropertyOnChangeEventBatchingWindow() override;
+    bool isContinuousPropertyEventCoalescingEnabled() override;
     std::vector<aidl::android::hardware::automotive::vehicle::SupportedValuesListResult>
     getSupportedValuesLists(const std::vector<PropIdAreaId>& propIdAreaIds) override;
     std::vector<aidl::android::hardware::automotive::vehicle::MinMaxSupportedValueResult>
@@ -102,6 +108,9 @@ class MockVehicleHardware final : public IVehicleHardware {
                     const std::vector<
                             aidl::android::hardware::automotive::vehicle::GetValueRequest>&)>&&
                     responder);
+    // If enabled, getValuesInline answers the requests with the responses added through
+    // addGetValueResponses.
+    void setGetValuesInlineEnabled(bool enabled);
     std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>
     nextGetValueRequests();
     std::vector<aidl::android::hardware::automotive::vehicle::SetValueRequest>
@@ -113,7 +122,11 @@ class MockVehicleHardware final : public IVehicleHardware {
     void setSleepTime(int64_t timeInNano);
     void setDumpResult(DumpResult result);
     void sendOnPropertySetErrorEvent(const std::vector<SetValueErrorEvent>& errorEvents);
+    void sendOnPropertyChangeEvent(
+            const std::vector<aidl::android::hardware::automotive::vehicle::VehiclePropValue>&
+                    values);
     void setPropertyOnChangeEventBatchingWindow(std::chrono::nanoseconds window);
+    void setContinuousPropertyEventCoalescingEnabled(bool enabled);
     void sendSupportedValueChangeEvent(const std::vector<PropIdAreaId>& propIdAreaIds);
 
     std::set<std::pair<int32_t, int32_t>> getSubscribedOnChangePropIdAreaIds();
@@ -151,6 +164,7 @@ class MockVehicleHardware final : public IVehicleHardware {
     std::unordered_map<const char*, aidl::android::hardware::automotive::vehicle::StatusCode>
             mStatusByFunctions GUARDED_BY(mLock);
     int64_t mSleepTime GUARDED_BY(mLock) = 0;
+    bool mGetValuesInlineEnabled GUARDED_BY(mLock) = false;
     std::unique_ptr<const PropertyChangeCallback> mPropertyChangeCallback GUARDED_BY(mLock);
     std::unique_ptr<const PropertySetErrorCallback> mPropertySetErrorCallback GUARDED_BY(mLock);
     std::unique_ptr<const SupportedValueChangeCallback> mSupportedValueChangeCallback
@@ -160,6 +174,7 @@ class MockVehicleHardware final : public IVehicleHardware {
             const std::vector<aidl::android::hardware::automotive::vehicle::GetValueRequest>&)>
             mGetValueResponder GUARDED_BY(mLock);
     std::chrono::nanoseconds mEventBatchingWindow GUARDED_BY(mLock) = std::chrono::nanoseconds(0);
+    bool mContinuousPropertyEventCoalescingEnabled GUARDED_BY(mLock) = false;
     std::set<std::pair<int32_t, int32_t>> mSubOnChangePropIdAreaIds GUARDED_BY(mLock);
     std::vector<aidl::android::hardware::automotive::vehicle::SubscribeOptions> mSubscribeOptions
             GUARDED_BY(mLock);
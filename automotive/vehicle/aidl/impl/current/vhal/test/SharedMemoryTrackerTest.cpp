@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SharedMemoryTracker.h"
+
+#include <android/binder_parcel.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace automotive {
+namespace vehicle {
+
+using ::aidl::android::hardware::automotive::vehicle::IVehicle;
+
+namespace {
+
+// The tracker only uses the client IDs as keys, they are never dereferenced.
+const AIBinder* const CLIENT_1 = reinterpret_cast<const AIBinder*>(0x1);
+const AIBinder* const CLIENT_2 = reinterpret_cast<const AIBinder*>(0x2);
+
+using ParcelPtr = std::unique_ptr<AParcel, decltype(&AParcel_delete)>;
+
+ParcelPtr createParcel(size_t int32Count, int32_t value) {
+    ParcelPtr parcel(AParcel_create(), AParcel_delete);
+    for (size_t i = 0; i < int32Count; i++) {
+        AParcel_writeInt32(parcel.get(), value);
+    }
+    return parcel;
+}
+
+std::vector<uint8_t> marshal(const AParcel* parcel) {
+    std::vector<uint8_t> data(AParcel_getDataSize(parcel));
+    AParcel_marshal(parcel, data.data(), 0, data.size());
+    return data;
+}
+
+std::vector<uint8_t> readFile(const ndk::ScopedFileDescriptor& fd, size_t size) {
+    std::vector<uint8_t> data(size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (address == MAP_FAILED) {
+        return {};
+    }
+    memcpy(data.data(), address, size);
+    munmap(address, size);
+    return data;
+}
+
+}  // namespace
+
+TEST(SharedMemoryTrackerTest, testNewSharedMemoryId) {
+    SharedMemoryTracker tracker;
+
+    int64_t id1 = tracker.newSharedMemoryId();
+    int64_t id2 = tracker.newSharedMemoryId();
+
+    ASSERT_NE(id1, IVehicle::INVALID_MEMORY_ID);
+    ASSERT_NE(id2, IVehicle::INVALID_MEMORY_ID);
+    ASSERT_NE(id1, id2);
+}
+
+TEST(SharedMemoryTrackerTest, testAcquireRelease) {
+    SharedMemoryTracker tracker;
+    int64_t id = tracker.newSharedMemoryId();
+
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id), 1);
+    ASSERT_EQ(tracker.acquire(CLIENT_2, id), 1);
+    ASSERT_EQ(tracker.countSharedMemoryIds(), 1u);
+
+    ASSERT_TRUE(tracker.release(CLIENT_1, id));
+    ASSERT_FALSE(tracker.release(CLIENT_1, id)) << "must not release the same file twice";
+    ASSERT_EQ(tracker.countSharedMemoryIds(), 1u) << "file is still held by client 2";
+
+    ASSERT_TRUE(tracker.release(CLIENT_2, id));
+    ASSERT_EQ(tracker.countSharedMemoryIds(), 0u);
+}
+
+TEST(SharedMemoryTrackerTest, testReleaseUnknownId) {
+    SharedMemoryTracker tracker;
+    int64_t id = tracker.newSharedMemoryId();
+    tracker.acquire(CLIENT_1, id);
+
+    ASSERT_FALSE(tracker.release(CLIENT_2, id)) << "client 2 does not hold the file";
+    ASSERT_FALSE(tracker.release(CLIENT_1, id + 1));
+}
+
+TEST(SharedMemoryTrackerTest, testReclaimOldestFile) {
+    SharedMemoryTracker tracker;
+    tracker.setMaxSharedMemoryFileCount(CLIENT_1, 2);
+    int64_t id1 = tracker.newSharedMemoryId();
+    int64_t id2 = tracker.newSharedMemoryId();
+    int64_t id3 = tracker.newSharedMemoryId();
+
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id1), 1);
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id2), 2);
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id3), 2);
+
+    ASSERT_FALSE(tracker.release(CLIENT_1, id1)) << "the oldest file must be reclaimed";
+    ASSERT_TRUE(tracker.release(CLIENT_1, id2));
+    ASSERT_TRUE(tracker.release(CLIENT_1, id3));
+}
+
+TEST(SharedMemoryTrackerTest, testZeroMaxSharedMemoryFileCount) {
+    SharedMemoryTracker tracker;
+    tracker.setMaxSharedMemoryFileCount(CLIENT_1, 0);
+    int64_t id1 = tracker.newSharedMemoryId();
+    int64_t id2 = tracker.newSharedMemoryId();
+
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id1), 1);
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id2), 1);
+
+    ASSERT_TRUE(tracker.release(CLIENT_1, id2)) << "the latest file could always be returned";
+}
+
+TEST(SharedMemoryTrackerTest, testRemoveClient) {
+    SharedMemoryTracker tracker;
+    int64_t id = tracker.newSharedMemoryId();
+    tracker.acquire(CLIENT_1, id);
+    tracker.acquire(CLIENT_2, id);
+
+    tracker.removeClient(CLIENT_1);
+
+    ASSERT_EQ(tracker.countSharedMemoryFiles(CLIENT_1), 0u);
+    ASSERT_EQ(tracker.countSharedMemoryFiles(CLIENT_2), 1u);
+    ASSERT_EQ(tracker.countSharedMemoryIds(), 1u);
+
+    tracker.removeClient(CLIENT_2);
+
+    ASSERT_EQ(tracker.countSharedMemoryIds(), 0u);
+}
+
+TEST(SharedMemoryTrackerTest, testReuseReturnedFile) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel1 = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd1;
+
+    auto result = tracker.writeToSharedMemory(parcel1.get(), {CLIENT_1, CLIENT_2}, &fd1);
+    ASSERT_TRUE(result.ok()) << result.error();
+    int64_t id1 = result.value();
+    ASSERT_EQ(readFile(fd1, AParcel_getDataSize(parcel1.get())), marshal(parcel1.get()));
+    ASSERT_EQ(tracker.acquire(CLIENT_1, id1), 1);
+    ASSERT_EQ(tracker.acquire(CLIENT_2, id1), 1);
+    tracker.finishSending(id1);
+
+    ASSERT_TRUE(tracker.release(CLIENT_1, id1));
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u) << "file is still held by client 2";
+    ASSERT_TRUE(tracker.release(CLIENT_2, id1));
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u);
+
+    // A smaller parcel fits in the returned file.
+    ParcelPtr parcel2 = createParcel(/*int32Count=*/500, /*value=*/2);
+    ndk::ScopedFileDescriptor fd2;
+    result = tracker.writeToSharedMemory(parcel2.get(), {CLIENT_2, CLIENT_1}, &fd2);
+    ASSERT_TRUE(result.ok()) << result.error();
+    ASSERT_NE(result.value(), id1);
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u) << "the returned file must be reused";
+    ASSERT_EQ(readFile(fd2, AParcel_getDataSize(parcel2.get())), marshal(parcel2.get()));
+}
+
+TEST(SharedMemoryTrackerTest, testDoNotReuseReclaimedFile) {
+    SharedMemoryTracker tracker;
+    tracker.setMaxSharedMemoryFileCount(CLIENT_1, 1);
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result1 = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result1.ok()) << result1.error();
+    tracker.acquire(CLIENT_1, result1.value());
+    tracker.finishSending(result1.value());
+    auto result2 = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result2.ok()) << result2.error();
+    tracker.acquire(CLIENT_1, result2.value());
+    tracker.finishSending(result2.value());
+
+    ASSERT_FALSE(tracker.release(CLIENT_1, result1.value())) << "the first file is reclaimed";
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u)
+            << "the client might still read the reclaimed file";
+    ASSERT_TRUE(tracker.release(CLIENT_1, result2.value()));
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u);
+}
+
+TEST(SharedMemoryTrackerTest, testKeepFileUntilSent) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+    tracker.acquire(CLIENT_1, result.value());
+    ASSERT_TRUE(tracker.release(CLIENT_1, result.value()));
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u)
+            << "the file must not be reused before it is sent to all the clients";
+
+    tracker.finishSending(result.value());
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u);
+}
+
+TEST(SharedMemoryTrackerTest, testFileIsReadOnly) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+
+    size_t size = AParcel_getDataSize(parcel.get());
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    ASSERT_EQ(address, MAP_FAILED) << "the clients must not be able to write to the file";
+    ASSERT_EQ(readFile(fd, size), marshal(parcel.get()));
+}
+
+TEST(SharedMemoryTrackerTest, testDoNotReuseFileForOtherClients) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+    tracker.acquire(CLIENT_1, result.value());
+    tracker.finishSending(result.value());
+    ASSERT_TRUE(tracker.release(CLIENT_1, result.value()));
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u);
+
+    result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_2}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u)
+            << "client 1 might still read the returned file";
+
+    result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u);
+}
+
+TEST(SharedMemoryTrackerTest, testDoNotReuseFileSeenByOtherClient) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result.ok()) << result.error();
+    tracker.acquire(CLIENT_1, result.value());
+    tracker.acquire(CLIENT_2, result.value());
+    tracker.finishSending(result.value());
+    ASSERT_TRUE(tracker.release(CLIENT_1, result.value()));
+    ASSERT_TRUE(tracker.release(CLIENT_2, result.value()));
+
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 0u)
+            << "the file is seen by a client it was not written for";
+}
+
+TEST(SharedMemoryTrackerTest, testRemoveClientDropsFreeFiles) {
+    SharedMemoryTracker tracker;
+    ParcelPtr parcel = createParcel(/*int32Count=*/1000, /*value=*/1);
+    ndk::ScopedFileDescriptor fd;
+
+    auto result1 = tracker.writeToSharedMemory(parcel.get(), {CLIENT_1}, &fd);
+    ASSERT_TRUE(result1.ok()) << result1.error();
+    auto result2 = tracker.writeToSharedMemory(parcel.get(), {CLIENT_2}, &fd);
+    ASSERT_TRUE(result2.ok()) << result2.error();
+    tracker.finishSending(result1.value());
+    tracker.finishSending(result2.value());
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 2u);
+
+    tracker.removeClient(CLIENT_1);
+
+    ASSERT_EQ(tracker.countFreeSharedMemoryFiles(), 1u)
+            << "the files seen by the removed client must be dropped";
+}
+
+}  // namespace vehicle
+}  // namespace automotive
+}  // namespace hardware
+}  // namespace android
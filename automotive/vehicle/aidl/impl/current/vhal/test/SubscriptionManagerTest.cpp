@@ -429,6 +429,120 @@ TEST_F(SubscriptionManagerTest, testSubscribeOnchange) {
     ASSERT_THAT(clients[client2], ElementsAre(updatedValues[0]));
 }
 
+TEST_F(SubscriptionManagerTest, testGetSubscribedClientEvents) {
+    std::vector<SubscribeOptions> options1 = {
+            {
+                    .propId = 0,
+                    .areaIds = {0},
+            },
+            {
+                    .propId = 1,
+                    .areaIds = {0},
+            },
+    };
+    std::vector<SubscribeOptions> options2 = {
+            {
+                    .propId = 1,
+                    .areaIds = {0},
+            },
+    };
+
+    SpAIBinder binder1 = ndk::SharedRefBase::make<PropertyCallback>()->asBinder();
+    std::shared_ptr<IVehicleCallback> client1 = IVehicleCallback::fromBinder(binder1);
+    SpAIBinder binder2 = ndk::SharedRefBase::make<PropertyCallback>()->asBinder();
+    std::shared_ptr<IVehicleCallback> client2 = IVehicleCallback::fromBinder(binder2);
+    ASSERT_TRUE(getManager()->subscribe(client1, options1, false).ok());
+    ASSERT_TRUE(getManager()->subscribe(client2, options2, false).ok());
+
+    std::vector<VehiclePropValue> updatedValues = {
+            {
+                    .prop = 1,
+                    .areaId = 0,
+                    .timestamp = 1,
+            },
+            {
+                    .prop = 2,
+                    .areaId = 0,
+            },
+            {
+                    .prop = 0,
+                    .areaId = 0,
+            },
+            {
+                    .prop = 1,
+                    .areaId = 0,
+                    .timestamp = 2,
+            },
+    };
+    auto clientEvents =
+            getManager()->getSubscribedClientEvents(std::vector<VehiclePropValue>(updatedValues));
+
+    ASSERT_EQ(clientEvents.size(), 2u);
+    for (const auto& events : clientEvents) {
+        if (events.callback == client1) {
+            // The order of the events must be kept.
+            EXPECT_THAT(events.values,
+                        ElementsAre(updatedValues[0], updatedValues[2], updatedValues[3]));
+        } else {
+            EXPECT_EQ(events.callback, client2);
+            EXPECT_THAT(events.values, ElementsAre(updatedValues[0], updatedValues[3]));
+        }
+    }
+    EXPECT_FALSE(clientEvents[0].sources == clientEvents[1].sources);
+
+    ASSERT_TRUE(getManager()->unsubscribe(client1->asBinder().get()).ok());
+
+    clientEvents =
+            getManager()->getSubscribedClientEvents(std::vector<VehiclePropValue>(updatedValues));
+
+    ASSERT_EQ(clientEvents.size(), 1u);
+    EXPECT_EQ(clientEvents[0].callback, client2);
+    EXPECT_THAT(clientEvents[0].values, ElementsAre(updatedValues[0], updatedValues[3]));
+}
+
+TEST_F(SubscriptionManagerTest, testGetSubscribedClientEventsSameSources) {
+    std::vector<SubscribeOptions> options = {
+            {
+                    .propId = 0,
+                    .areaIds = {0},
+            },
+            {
+                    .propId = 1,
+                    .areaIds = {0},
+            },
+    };
+
+    SpAIBinder binder1 = ndk::SharedRefBase::make<PropertyCallback>()->asBinder();
+    std::shared_ptr<IVehicleCallback> client1 = IVehicleCallback::fromBinder(binder1);
+    SpAIBinder binder2 = ndk::SharedRefBase::make<PropertyCallback>()->asBinder();
+    std::shared_ptr<IVehicleCallback> client2 = IVehicleCallback::fromBinder(binder2);
+    ASSERT_TRUE(getManager()->subscribe(client1, options, false).ok());
+    ASSERT_TRUE(getManager()->subscribe(client2, options, false).ok());
+
+    std::vector<VehiclePropValue> updatedValues = {
+            {
+                    .prop = 1,
+                    .areaId = 0,
+            },
+            {
+                    .prop = 2,
+                    .areaId = 0,
+            },
+            {
+                    .prop = 0,
+                    .areaId = 0,
+            },
+    };
+    auto clientEvents =
+            getManager()->getSubscribedClientEvents(std::vector<VehiclePropValue>(updatedValues));
+
+    // Clients with the same subscriptions must be grouped together when dispatching the events.
+    ASSERT_EQ(clientEvents.size(), 2u);
+    EXPECT_EQ(clientEvents[0].values, clientEvents[1].values);
+    EXPECT_EQ(clientEvents[0].sources, clientEvents[1].sources);
+    EXPECT_EQ(clientEvents[0].sourcesHash, clientEvents[1].sourcesHash);
+}
+
 TEST_F(SubscriptionManagerTest, testSubscribeInvalidOption) {
     std::vector<SubscribeOptions> options = {
             {
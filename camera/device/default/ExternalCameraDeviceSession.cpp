@@ -1141,38 +1141,41 @@ int ExternalCameraDeviceSession::configureV4l2StreamLocked(const SupportedV4L2Fo
     ALOGI("%s: set mMaxLagNs to %" PRIu64 " ns, v4lBufferCount %u", __FUNCTION__, mMaxLagNs,
           v4lBufferCount);
 
-    // VIDIOC_REQBUFS: create buffers
-    v4l2_requestbuffers req_buffers{};
-    req_buffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req_buffers.memory = V4L2_MEMORY_MMAP;
-    req_buffers.count = v4lBufferCount;
-    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_REQBUFS, &req_buffers)) < 0) {
-        ALOGE("%s: VIDIOC_REQBUFS failed: %s", __FUNCTION__, strerror(errno));
-        return -errno;
+    // VIDIOC_REQBUFS: create buffers and map them once for all frames
+    if (mV4l2BufferPool != nullptr) {
+        // Left over by a configuration that failed after allocating buffers
+        mV4l2BufferPool->release();
+    }
+    mV4l2BufferPool =
+            std::make_shared<V4L2BufferPool>(mV4l2Fd.get(), mCfg.v4l2MemoryType, mCfg.dmaBufHeap);
+    ret = mV4l2BufferPool->allocate(v4lBufferCount, bufferSize);
+    if (ret != 0 && mCfg.v4l2MemoryType != V4L2MemoryType::MMAP) {
+        ALOGW("%s: v4l2 memory type %d not usable, falling back to mmap", __FUNCTION__,
+              static_cast<int>(mCfg.v4l2MemoryType));
+        mV4l2BufferPool = std::make_shared<V4L2BufferPool>(mV4l2Fd.get(), V4L2MemoryType::MMAP,
+                                                           mCfg.dmaBufHeap);
+        ret = mV4l2BufferPool->allocate(v4lBufferCount, bufferSize);
+    }
+    if (ret != 0) {
+        mV4l2BufferPool.reset();
+        return ret;
     }
 
     // Driver can indeed return more buffer if it needs more to operate
-    if (req_buffers.count < v4lBufferCount) {
+    if (mV4l2BufferPool->getBufferCount() < v4lBufferCount) {
         ALOGE("%s: VIDIOC_REQBUFS expected %d buffers, got %d instead", __FUNCTION__,
-              v4lBufferCount, req_buffers.count);
+              v4lBufferCount, mV4l2BufferPool->getBufferCount());
+        mV4l2BufferPool->release();
+        mV4l2BufferPool.reset();
         return NO_MEMORY;
     }
 
-    // VIDIOC_QUERYBUF:  get buffer offset in the V4L2 fd
     // VIDIOC_QBUF: send buffer to driver
-    mV4L2BufferCount = req_buffers.count;
-    for (uint32_t i = 0; i < req_buffers.count; i++) {
-        v4l2_buffer buffer = {
-                .index = i, .type = V4L2_BUF_TYPE_VIDEO_CAPTURE, .memory = V4L2_MEMORY_MMAP};
-
-        if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_QUERYBUF, &buffer)) < 0) {
-            ALOGE("%s: QUERYBUF %d failed: %s", __FUNCTION__, i, strerror(errno));
-            return -errno;
-        }
-
-        if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_QBUF, &buffer)) < 0) {
-            ALOGE("%s: QBUF %d failed: %s", __FUNCTION__, i, strerror(errno));
-            return -errno;
+    mV4L2BufferCount = mV4l2BufferPool->getBufferCount();
+    for (uint32_t i = 0; i < mV4L2BufferCount; i++) {
+        ret = mV4l2BufferPool->queueBuffer(i);
+        if (ret != 0) {
+            return ret;
         }
     }
 
@@ -1201,16 +1204,14 @@ int ExternalCameraDeviceSession::configureV4l2StreamLocked(const SupportedV4L2Fo
     // Swallow first few frames after streamOn to account for bad frames from some devices
     for (int i = 0; i < kBadFramesAfterStreamOn; i++) {
         v4l2_buffer buffer{};
-        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buffer.memory = V4L2_MEMORY_MMAP;
-        if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_DQBUF, &buffer)) < 0) {
-            ALOGE("%s: DQBUF fails: %s", __FUNCTION__, strerror(errno));
-            return -errno;
+        ret = mV4l2BufferPool->dequeueBuffer(&buffer);
+        if (ret != 0) {
+            return ret;
         }
 
-        if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_QBUF, &buffer)) < 0) {
-            ALOGE("%s: QBUF index %d fails: %s", __FUNCTION__, buffer.index, strerror(errno));
-            return -errno;
+        ret = mV4l2BufferPool->queueBuffer(buffer.index);
+        if (ret != 0) {
+            return ret;
         }
     }
 
@@ -1242,19 +1243,11 @@ std::unique_ptr<V4L2Frame> ExternalCameraDeviceSession::dequeueV4l2FrameLocked(n
     v4l2_buffer buffer{};
     do {
         ATRACE_BEGIN("VIDIOC_DQBUF");
-        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buffer.memory = V4L2_MEMORY_MMAP;
-        if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_DQBUF, &buffer)) < 0) {
-            ALOGE("%s: DQBUF fails: %s", __FUNCTION__, strerror(errno));
+        if (mV4l2BufferPool->dequeueBuffer(&buffer) != 0) {
             return ret;
         }
         ATRACE_END();
 
-        if (buffer.index >= mV4L2BufferCount) {
-            ALOGE("%s: Invalid buffer id: %d", __FUNCTION__, buffer.index);
-            return ret;
-        }
-
         if (buffer.flags & V4L2_BUF_FLAG_ERROR) {
             ALOGE("%s: v4l2 buf error! buf flag 0x%x", __FUNCTION__, buffer.flags);
             // TODO: try to dequeue again
@@ -1292,7 +1285,7 @@ std::unique_ptr<V4L2Frame> ExternalCameraDeviceSession::dequeueV4l2FrameLocked(n
         if (lagNs > mMaxLagNs) {
             ALOGI("%s: drop too old buffer, index %d, lag %" PRIu64 " ns > max %" PRIu64 " ns", __FUNCTION__,
                   buffer.index, lagNs, mMaxLagNs);
-            int retVal = ioctl(mV4l2Fd.get(), VIDIOC_QBUF, &buffer);
+            int retVal = mV4l2BufferPool->queueBuffer(buffer.index);
             if (retVal) {
                 ALOGE("%s: unexpected VIDIOC_QBUF failed, retVal %d", __FUNCTION__, retVal);
                 return ret;
@@ -1306,20 +1299,15 @@ std::unique_ptr<V4L2Frame> ExternalCameraDeviceSession::dequeueV4l2FrameLocked(n
     }
 
     return std::make_unique<V4L2Frame>(mV4l2StreamingFmt.width, mV4l2StreamingFmt.height,
-                                       mV4l2StreamingFmt.fourcc, buffer.index, mV4l2Fd.get(),
-                                       buffer.bytesused, buffer.m.offset);
+                                       mV4l2StreamingFmt.fourcc, buffer.index, mV4l2BufferPool,
+                                       buffer.bytesused);
 }
 
 void ExternalCameraDeviceSession::enqueueV4l2Frame(const std::shared_ptr<V4L2Frame>& frame) {
     ATRACE_CALL();
     frame->unmap();
     ATRACE_BEGIN("VIDIOC_QBUF");
-    v4l2_buffer buffer{};
-    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buffer.memory = V4L2_MEMORY_MMAP;
-    buffer.index = frame->mBufferIndex;
-    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_QBUF, &buffer)) < 0) {
-        ALOGE("%s: QBUF index %d fails: %s", __FUNCTION__, frame->mBufferIndex, strerror(errno));
+    if (mV4l2BufferPool->queueBuffer(frame->mBufferIndex) != 0) {
         return;
     }
     ATRACE_END();
@@ -1463,13 +1451,10 @@ int ExternalCameraDeviceSession::v4l2StreamOffLocked() {
     }
 
     // VIDIOC_REQBUFS: clear buffers
-    v4l2_requestbuffers req_buffers{};
-    req_buffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req_buffers.memory = V4L2_MEMORY_MMAP;
-    req_buffers.count = 0;
-    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd.get(), VIDIOC_REQBUFS, &req_buffers)) < 0) {
-        ALOGE("%s: REQBUFS failed: %s", __FUNCTION__, strerror(errno));
-        return -errno;
+    int ret = mV4l2BufferPool->release();
+    mV4l2BufferPool.reset();
+    if (ret != 0) {
+        return ret;
     }
 
     mV4l2Streaming = false;
@@ -2164,7 +2149,16 @@ ExternalCameraDeviceSession::OutputThread::OutputThread(
       mCameraCharacteristics(chars),
       mBufferRequestThread(bufReqThread) {}
 
-ExternalCameraDeviceSession::OutputThread::~OutputThread() {}
+ExternalCameraDeviceSession::OutputThread::~OutputThread() {
+    if (mConvertThread != nullptr) {
+        mConvertThread->requestExitAndWait();
+        // Return the requests the ConvertThread did not get to
+        drainDecodedRequests();
+    }
+    for (auto& worker : mConvertWorkers) {
+        worker->requestExitAndWait();
+    }
+}
 
 Status ExternalCameraDeviceSession::OutputThread::allocateIntermediateBuffers(
         const Size& v4lSize, const Size& thumbSize, const std::vector<Stream>& streams,
@@ -2176,17 +2170,26 @@ Status ExternalCameraDeviceSession::OutputThread::allocateIntermediateBuffers(
         return Status::INTERNAL_ERROR;
     }
 
-    // Allocating intermediate YU12 frame
-    if (mYu12Frame == nullptr || mYu12Frame->mWidth != v4lSize.width ||
-        mYu12Frame->mHeight != v4lSize.height) {
-        mYu12Frame.reset();
-        mYu12Frame = std::make_shared<AllocatedFrame>(v4lSize.width, v4lSize.height);
-        int ret = mYu12Frame->allocate(&mYu12FrameLayout);
-        if (ret != 0) {
-            ALOGE("%s: allocating YU12 frame failed!", __FUNCTION__);
-            return Status::INTERNAL_ERROR;
+    // Allocating intermediate YU12 frames
+    if (mYu12Frames.empty() || mYu12Frames[0]->mWidth != v4lSize.width ||
+        mYu12Frames[0]->mHeight != v4lSize.height) {
+        mYu12Frames.clear();
+        for (int i = 0; i < kNumYu12Frames; i++) {
+            std::shared_ptr<AllocatedFrame> frame =
+                    std::make_shared<AllocatedFrame>(v4lSize.width, v4lSize.height);
+            int ret = frame->allocate();
+            if (ret != 0) {
+                ALOGE("%s: allocating YU12 frame failed!", __FUNCTION__);
+                mYu12Frames.clear();
+                return Status::INTERNAL_ERROR;
+            }
+            mYu12Frames.push_back(frame);
         }
     }
+    {
+        std::lock_guard<std::mutex> framesLk(mYu12FramesLock);
+        mFreeYu12Frames.assign(mYu12Frames.begin(), mYu12Frames.end());
+    }
 
     // Allocating intermediate YU12 thumbnail frame
     if (mYu12ThumbFrame == nullptr || mYu12ThumbFrame->mWidth != thumbSize.width ||
@@ -2239,7 +2242,7 @@ Status ExternalCameraDeviceSession::OutputThread::allocateIntermediateBuffers(
     }
 
     // Allocate mute test pattern frame
-    mMuteTestPatternFrame.resize(mYu12Frame->mWidth * mYu12Frame->mHeight * 3);
+    mMuteTestPatternFrame.resize(v4lSize.width * v4lSize.height * 3);
 
     mBlobBufferSize = blobBufferSize;
     return Status::OK;
@@ -2265,12 +2268,10 @@ void ExternalCameraDeviceSession::OutputThread::flush() {
     std::unique_lock<std::mutex> lk(mRequestListLock);
     std::list<std::shared_ptr<HalRequest>> reqs = std::move(mRequestList);
     mRequestList.clear();
-    if (mProcessingRequest) {
-        auto timeout = std::chrono::seconds(kFlushWaitTimeoutSec);
-        auto st = mRequestDoneCond.wait_for(lk, timeout);
-        if (st == std::cv_status::timeout) {
-            ALOGE("%s: wait for inflight request finish timeout!", __FUNCTION__);
-        }
+    auto timeout = std::chrono::seconds(kFlushWaitTimeoutSec);
+    auto processingDone = [this] { return mProcessingFrameNumbers.empty(); };
+    if (!mRequestDoneCond.wait_for(lk, timeout, processingDone)) {
+        ALOGE("%s: wait for inflight request finish timeout!", __FUNCTION__);
     }
 
     ALOGV("%s: flushing inflight requests", __FUNCTION__);
@@ -2282,8 +2283,14 @@ void ExternalCameraDeviceSession::OutputThread::flush() {
 
 void ExternalCameraDeviceSession::OutputThread::dump(int fd) {
     std::lock_guard<std::mutex> lk(mRequestListLock);
-    if (mProcessingRequest) {
-        dprintf(fd, "OutputThread processing frame %d\n", mProcessingFrameNumber);
+    if (!mProcessingFrameNumbers.empty()) {
+        dprintf(fd, "OutputThread processing frame: ");
+        const char* separator = "";
+        for (int32_t frameNumber : mProcessingFrameNumbers) {
+            dprintf(fd, "%s%d", separator, frameNumber);
+            separator = ", ";
+        }
+        dprintf(fd, "\n");
     } else {
         dprintf(fd, "OutputThread not processing any frames\n");
     }
@@ -2312,12 +2319,10 @@ ExternalCameraDeviceSession::OutputThread::switchToOffline() {
     std::unique_lock<std::mutex> lk(mRequestListLock);
     std::list<std::shared_ptr<HalRequest>> reqs = std::move(mRequestList);
     mRequestList.clear();
-    if (mProcessingRequest) {
-        auto timeout = std::chrono::seconds(kFlushWaitTimeoutSec);
-        auto st = mRequestDoneCond.wait_for(lk, timeout);
-        if (st == std::cv_status::timeout) {
-            ALOGE("%s: wait for inflight request finish timeout!", __FUNCTION__);
-        }
+    auto timeout = std::chrono::seconds(kFlushWaitTimeoutSec);
+    auto processingDone = [this] { return mProcessingFrameNumbers.empty(); };
+    if (!mRequestDoneCond.wait_for(lk, timeout, processingDone)) {
+        ALOGE("%s: wait for inflight request finish timeout!", __FUNCTION__);
     }
     lk.unlock();
     clearIntermediateBuffers();
@@ -2367,18 +2372,106 @@ void ExternalCameraDeviceSession::OutputThread::waitForNextRequest(
     }
     *out = mRequestList.front();
     mRequestList.pop_front();
-    mProcessingRequest = true;
-    mProcessingFrameNumber = (*out)->frameNumber;
+    mProcessingFrameNumbers.push_back((*out)->frameNumber);
 }
 
-void ExternalCameraDeviceSession::OutputThread::signalRequestDone() {
+void ExternalCameraDeviceSession::OutputThread::signalRequestDone(int32_t frameNumber) {
     std::unique_lock<std::mutex> lk(mRequestListLock);
-    mProcessingRequest = false;
-    mProcessingFrameNumber = 0;
+    mProcessingFrameNumbers.remove(frameNumber);
     lk.unlock();
     mRequestDoneCond.notify_one();
 }
 
+std::shared_ptr<AllocatedFrame> ExternalCameraDeviceSession::OutputThread::acquireYu12Frame() {
+    ATRACE_CALL();
+    std::unique_lock<std::mutex> lk(mYu12FramesLock);
+    while (mFreeYu12Frames.empty()) {
+        if (exitPending() || mConvertThreadExited) {
+            return nullptr;
+        }
+        mYu12FrameCond.wait_for(lk, std::chrono::milliseconds(kReqWaitTimeoutMs));
+    }
+    std::shared_ptr<AllocatedFrame> frame = mFreeYu12Frames.front();
+    mFreeYu12Frames.pop_front();
+    return frame;
+}
+
+void ExternalCameraDeviceSession::OutputThread::releaseYu12Frame(
+        const std::shared_ptr<AllocatedFrame>& frame) {
+    if (frame == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lk(mYu12FramesLock);
+    mFreeYu12Frames.push_back(frame);
+    lk.unlock();
+    mYu12FrameCond.notify_one();
+}
+
+bool ExternalCameraDeviceSession::OutputThread::queueDecodedRequest(DecodedRequest&& decoded) {
+    std::unique_lock<std::mutex> lk(mRequestListLock);
+    if (mConvertThreadExited) {
+        return false;
+    }
+    mDecodedRequests.push_back(std::move(decoded));
+    lk.unlock();
+    mDecodedRequestCond.notify_one();
+    return true;
+}
+
+bool ExternalCameraDeviceSession::OutputThread::waitForDecodedRequest(DecodedRequest* decoded) {
+    std::unique_lock<std::mutex> lk(mRequestListLock);
+    if (mDecodedRequests.empty()) {
+        auto timeout = std::chrono::milliseconds(kReqWaitTimeoutMs);
+        mDecodedRequestCond.wait_for(lk, timeout);
+        if (mDecodedRequests.empty()) {
+            return false;
+        }
+    }
+    *decoded = std::move(mDecodedRequests.front());
+    mDecodedRequests.pop_front();
+    return true;
+}
+
+void ExternalCameraDeviceSession::OutputThread::failDecodedRequest(
+        DecodedRequest& decoded, const std::shared_ptr<OutputThreadInterface>& parent) {
+    const std::shared_ptr<HalRequest>& req = decoded.req;
+    releaseYu12Frame(decoded.yu12Frame);
+    decoded.yu12Frame.reset();
+    if (parent == nullptr) {
+        ALOGE("%s: session has been disconnected, dropping frame %d", __FUNCTION__,
+              req->frameNumber);
+    } else if (decoded.deviceError) {
+        parent->notifyError(req->frameNumber, /*stream*/ -1, ErrorCode::ERROR_DEVICE);
+    } else if (parent->processCaptureRequestError(req) != Status::OK) {
+        ALOGE("%s: failed to process capture request error!", __FUNCTION__);
+        parent->notifyError(req->frameNumber, /*stream*/ -1, ErrorCode::ERROR_DEVICE);
+    }
+    signalRequestDone(req->frameNumber);
+}
+
+void ExternalCameraDeviceSession::OutputThread::drainDecodedRequests() {
+    std::unique_lock<std::mutex> lk(mRequestListLock);
+    std::deque<DecodedRequest> decodedRequests = std::move(mDecodedRequests);
+    mDecodedRequests.clear();
+    lk.unlock();
+
+    auto parent = mParent.lock();
+    for (auto& decoded : decodedRequests) {
+        ALOGV("%s: returning frame %d as error", __FUNCTION__, decoded.req->frameNumber);
+        failDecodedRequest(decoded, parent);
+    }
+}
+
+void ExternalCameraDeviceSession::OutputThread::onConvertThreadExit() {
+    {
+        std::lock_guard<std::mutex> lk(mRequestListLock);
+        mConvertThreadExited = true;
+    }
+    // Wake up the OutputThread if it is waiting for a YU12 frame
+    mYu12FrameCond.notify_all();
+    drainDecodedRequests();
+}
+
 int ExternalCameraDeviceSession::OutputThread::cropAndScaleLocked(
         std::shared_ptr<AllocatedFrame>& in, const Size& outSz, YCbCrLayout* out) {
     Size inSz = {in->mWidth, in->mHeight};
@@ -2417,12 +2510,16 @@ int ExternalCameraDeviceSession::OutputThread::cropAndScaleLocked(
         return 0;
     }
 
-    auto it = mScaledYu12Frames.find(outSz);
     std::shared_ptr<AllocatedFrame> scaledYu12Buf;
-    if (it != mScaledYu12Frames.end()) {
-        scaledYu12Buf = it->second;
-    } else {
-        it = mIntermediateBuffers.find(outSz);
+    {
+        std::lock_guard<std::mutex> scaledLk(mScaledYu12FramesLock);
+        auto it = mScaledYu12Frames.find(outSz);
+        if (it != mScaledYu12Frames.end()) {
+            scaledYu12Buf = it->second;
+        }
+    }
+    if (scaledYu12Buf == nullptr) {
+        auto it = mIntermediateBuffers.find(outSz);
         if (it == mIntermediateBuffers.end()) {
             ALOGE("%s: failed to find intermediate buffer size %dx%d", __FUNCTION__, outSz.width,
                   outSz.height);
@@ -2455,6 +2552,7 @@ int ExternalCameraDeviceSession::OutputThread::cropAndScaleLocked(
     }
 
     *out = outLayout;
+    std::lock_guard<std::mutex> scaledLk(mScaledYu12FramesLock);
     mScaledYu12Frames.insert({outSz, scaledYu12Buf});
     return 0;
 }
@@ -2582,9 +2680,69 @@ int ExternalCameraDeviceSession::OutputThread::cropAndScaleThumbLocked(
     return 0;
 }
 
-int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
-        HalStreamBuffer& halBuf, const common::V1_0::helper::CameraMetadata& setting) {
+bool ExternalCameraDeviceSession::OutputThread::canPassthroughMjpeg(const HalRequest& req,
+                                                                    const HalStreamBuffer& halBuf,
+                                                                    bool muted) {
+    if (muted || req.frameIn->mFourcc != V4L2_PIX_FMT_MJPEG ||
+        halBuf.width != req.frameIn->mWidth || halBuf.height != req.frameIn->mHeight) {
+        return false;
+    }
+
+    uint8_t* inData;
+    size_t inDataSize;
+    MjpegBody body;
+    if (req.frameIn->getData(&inData, &inDataSize) != 0 ||
+        getMjpegBody(inData, inDataSize, &body) != 0) {
+        return false;
+    }
+
+    // Parsing the JPEG headers is cheap next to a decode. Frames libjpeg can not read, or of
+    // another size than the V4L2 format, are decoded and re-encoded instead.
+    int width, height;
+    if (libyuv::MJPGSize(inData, inDataSize, &width, &height) != 0 || width != halBuf.width ||
+        height != halBuf.height) {
+        ALOGV("%s: MJPEG frame header check failed, decoding the frame", __FUNCTION__);
+        return false;
+    }
+    return true;
+}
+
+bool ExternalCameraDeviceSession::OutputThread::needsYu12Frame(const HalRequest& req, bool muted) {
+    if (muted || req.frameIn->mFourcc != V4L2_PIX_FMT_MJPEG) {
+        return true;
+    }
+
+    // Decoding into more than one output costs more than decoding once and copying
+    int numDirectYuvOutputs = 0;
+    for (const auto& halBuf : req.buffers) {
+        switch (halBuf.format) {
+            case PixelFormat::BLOB: {
+                camera_metadata_ro_entry entry = req.setting.find(ANDROID_JPEG_THUMBNAIL_SIZE);
+                bool outputThumbnail =
+                        entry.count == 2 && (entry.data.i32[0] != 0 || entry.data.i32[1] != 0);
+                if (outputThumbnail || !canPassthroughMjpeg(req, halBuf, muted)) {
+                    return true;
+                }
+            } break;
+            case PixelFormat::YCBCR_420_888:
+            case PixelFormat::YV12:
+                if (halBuf.width != req.frameIn->mWidth || halBuf.height != req.frameIn->mHeight ||
+                    ++numDirectYuvOutputs > 1) {
+                    return true;
+                }
+                break;
+            default:
+                return true;
+        }
+    }
+    return false;
+}
+
+int ExternalCameraDeviceSession::OutputThread::createJpegLocked(const DecodedRequest& decoded,
+                                                                HalStreamBuffer& halBuf) {
     ATRACE_CALL();
+    const common::V1_0::helper::CameraMetadata& setting = decoded.req->setting;
+    std::shared_ptr<AllocatedFrame> yu12Frame = decoded.yu12Frame;
     int ret;
     auto lfail = [&](auto... args) {
         ALOGE(args...);
@@ -2601,7 +2759,6 @@ int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
           static_cast<uint64_t>(halBuf.bufferId), halBuf.width, halBuf.height);
     ALOGV("%s: HAL buffer fmt: %x usage: %" PRIx64 " ptr: %p", __FUNCTION__, halBuf.format,
           static_cast<uint64_t>(halBuf.usage), halBuf.bufPtr);
-    ALOGV("%s: YV12 buffer %d x %d", __FUNCTION__, mYu12Frame->mWidth, mYu12Frame->mHeight);
 
     int jpegQuality, thumbQuality;
     Size thumbSize;
@@ -2654,9 +2811,19 @@ int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
     /* Temporary thumbnail code buffer */
     std::vector<uint8_t> thumbCode(outputThumbnail ? maxThumbCodeSize : 0);
 
+    /* At the V4L2 frame size the MJPEG frame is used as the main image as is. Note that
+     * ANDROID_JPEG_QUALITY is not applied in this case. */
+    bool passthrough = canPassthroughMjpeg(*decoded.req, halBuf, decoded.muted);
+    if (yu12Frame == nullptr && (outputThumbnail || !passthrough)) {
+        return lfail("%s: no decoded YU12 frame for the JPEG output", __FUNCTION__);
+    }
+    if (yu12Frame != nullptr) {
+        ALOGV("%s: YV12 buffer %d x %d", __FUNCTION__, yu12Frame->mWidth, yu12Frame->mHeight);
+    }
+
     YCbCrLayout yu12Thumb;
     if (outputThumbnail) {
-        ret = cropAndScaleThumbLocked(mYu12Frame, thumbSize, &yu12Thumb);
+        ret = cropAndScaleThumbLocked(yu12Frame, thumbSize, &yu12Thumb);
 
         if (ret != 0) {
             return lfail("%s: crop and scale thumbnail failed!", __FUNCTION__);
@@ -2664,10 +2831,12 @@ int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
     }
 
     /* Scale and crop main jpeg */
-    ret = cropAndScaleLocked(mYu12Frame, jpegSize, &yu12Main);
+    if (!passthrough) {
+        ret = cropAndScaleLocked(yu12Frame, jpegSize, &yu12Main);
 
-    if (ret != 0) {
-        return lfail("%s: crop and scale main failed!", __FUNCTION__);
+        if (ret != 0) {
+            return lfail("%s: crop and scale main failed!", __FUNCTION__);
+        }
     }
 
     /* Encode the thumbnail image */
@@ -2712,9 +2881,25 @@ int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
         return lfail("%s: could not lock %zu bytes", __FUNCTION__, maxJpegCodeSize);
     }
 
-    /* Encode the main jpeg image */
-    ret = encodeJpegYU12(jpegSize, yu12Main, jpegQuality, exifData, exifDataSize, bufPtr,
-                         maxJpegCodeSize, jpegCodeSize);
+    /* Encode the main jpeg image, or copy the MJPEG frame with the EXIF data inserted */
+    if (passthrough) {
+        ATRACE_BEGIN("MJPGPassthrough");
+        uint8_t* inData;
+        size_t inDataSize;
+        MjpegBody body;
+        ret = decoded.req->frameIn->getData(&inData, &inDataSize);
+        if (ret == 0) {
+            ret = getMjpegBody(inData, inDataSize, &body);
+        }
+        if (ret == 0) {
+            ret = writeJpegWithApp1(inData, body, exifData, exifDataSize, bufPtr,
+                                    maxJpegCodeSize - sizeof(CameraBlob), jpegCodeSize);
+        }
+        ATRACE_END();
+    } else {
+        ret = encodeJpegYU12(jpegSize, yu12Main, jpegQuality, exifData, exifDataSize, bufPtr,
+                             maxJpegCodeSize, jpegCodeSize);
+    }
 
     /* TODO: Not sure this belongs here, maybe better to pass jpegCodeSize out
      * and do this when returning buffer to parent */
@@ -2742,13 +2927,205 @@ int ExternalCameraDeviceSession::OutputThread::createJpegLocked(
 
 void ExternalCameraDeviceSession::OutputThread::clearIntermediateBuffers() {
     std::lock_guard<std::mutex> lk(mBufferLock);
-    mYu12Frame.reset();
+    mYu12Frames.clear();
+    {
+        std::lock_guard<std::mutex> framesLk(mYu12FramesLock);
+        mFreeYu12Frames.clear();
+    }
     mYu12ThumbFrame.reset();
     mIntermediateBuffers.clear();
     mMuteTestPatternFrame.clear();
     mBlobBufferSize = 0;
 }
 
+int ExternalCameraDeviceSession::OutputThread::processOutputBufferLocked(
+        const DecodedRequest& decoded, HalStreamBuffer& halBuf) {
+    const std::shared_ptr<HalRequest>& req = decoded.req;
+    std::shared_ptr<AllocatedFrame> yu12Frame = decoded.yu12Frame;
+    const int kSyncWaitTimeoutMs = 500;
+    if (*(halBuf.bufPtr) == nullptr) {
+        ALOGW("%s: buffer for stream %d missing", __FUNCTION__, halBuf.streamId);
+        halBuf.fenceTimeout = true;
+    } else if (halBuf.acquireFence >= 0) {
+        int ret = sync_wait(halBuf.acquireFence, kSyncWaitTimeoutMs);
+        if (ret) {
+            halBuf.fenceTimeout = true;
+        } else {
+            ::close(halBuf.acquireFence);
+            halBuf.acquireFence = -1;
+        }
+    }
+
+    if (halBuf.fenceTimeout) {
+        return 0;
+    }
+
+    // Gralloc lockYCbCr the buffer
+    switch (halBuf.format) {
+        case PixelFormat::BLOB: {
+            int ret = createJpegLocked(decoded, halBuf);
+
+            if (ret != 0) {
+                ALOGE("%s: createJpegLocked failed with %d", __FUNCTION__, ret);
+                return ret;
+            }
+        } break;
+        case PixelFormat::Y16: {
+            uint8_t* inData;
+            size_t inDataSize;
+            if (req->frameIn->getData(&inData, &inDataSize) != 0) {
+                ALOGE("%s: V4L2 buffer map failed", __FUNCTION__);
+                return -1;
+            }
+
+            void* outLayout = sHandleImporter.lock(
+                    *(halBuf.bufPtr), static_cast<uint64_t>(halBuf.usage), inDataSize);
+
+            std::memcpy(outLayout, inData, inDataSize);
+
+            int relFence = sHandleImporter.unlock(*(halBuf.bufPtr));
+            if (relFence >= 0) {
+                halBuf.acquireFence = relFence;
+            }
+        } break;
+        case PixelFormat::YCBCR_420_888:
+        case PixelFormat::YV12: {
+            android::Rect outRect{0, 0, static_cast<int32_t>(halBuf.width),
+                                  static_cast<int32_t>(halBuf.height)};
+            android_ycbcr result = sHandleImporter.lockYCbCr(
+                    *(halBuf.bufPtr), static_cast<uint64_t>(halBuf.usage), outRect);
+            ALOGV("%s: outLayout y %p cb %p cr %p y_str %zu c_str %zu c_step %zu", __FUNCTION__,
+                  result.y, result.cb, result.cr, result.ystride, result.cstride,
+                  result.chroma_step);
+            if (result.ystride > UINT32_MAX || result.cstride > UINT32_MAX ||
+                result.chroma_step > UINT32_MAX) {
+                ALOGE("%s: lockYCbCr failed. Unexpected values!", __FUNCTION__);
+                return -1;
+            }
+            YCbCrLayout outLayout = {.y = result.y,
+                                     .cb = result.cb,
+                                     .cr = result.cr,
+                                     .yStride = static_cast<uint32_t>(result.ystride),
+                                     .cStride = static_cast<uint32_t>(result.cstride),
+                                     .chromaStep = static_cast<uint32_t>(result.chroma_step)};
+
+            // Convert to output buffer size/format
+            uint32_t outputFourcc = getFourCcFromLayout(outLayout);
+            ALOGV("%s: converting to format %c%c%c%c", __FUNCTION__, outputFourcc & 0xFF,
+                  (outputFourcc >> 8) & 0xFF, (outputFourcc >> 16) & 0xFF,
+                  (outputFourcc >> 24) & 0xFF);
+
+            Size sz{halBuf.width, halBuf.height};
+            if (yu12Frame == nullptr) {
+                // Output is of the V4L2 frame size, decode the MJPEG frame into it directly
+                uint8_t* inData;
+                size_t inDataSize;
+                if (req->frameIn->getData(&inData, &inDataSize) != 0) {
+                    ALOGE("%s: V4L2 buffer map failed", __FUNCTION__);
+                    return -1;
+                }
+                ATRACE_BEGIN("MJPGtoOutput");
+                int ret = decodeMjpeg(inData, inDataSize, outLayout, sz, outputFourcc);
+                ATRACE_END();
+                if (ret != 0) {
+                    // For some webcam, the first few V4L2 frames might be malformed...
+                    // Return this buffer as error instead of failing the device.
+                    ALOGE("%s: decode to output buffer failed! ret %d", __FUNCTION__, ret);
+                    int relFence = sHandleImporter.unlock(*(halBuf.bufPtr));
+                    if (relFence >= 0) {
+                        halBuf.acquireFence = relFence;
+                    }
+                    halBuf.fenceTimeout = true;
+                    return 0;
+                }
+            } else {
+                YCbCrLayout cropAndScaled;
+                ATRACE_BEGIN("cropAndScaleLocked");
+                int ret = cropAndScaleLocked(yu12Frame, sz, &cropAndScaled);
+                ATRACE_END();
+                if (ret != 0) {
+                    ALOGE("%s: crop and scale failed!", __FUNCTION__);
+                    return ret;
+                }
+
+                ATRACE_BEGIN("formatConvert");
+                ret = formatConvert(cropAndScaled, outLayout, sz, outputFourcc);
+                ATRACE_END();
+                if (ret != 0) {
+                    ALOGE("%s: format conversion failed!", __FUNCTION__);
+                    return ret;
+                }
+            }
+            int relFence = sHandleImporter.unlock(*(halBuf.bufPtr));
+            if (relFence >= 0) {
+                halBuf.acquireFence = relFence;
+            }
+        } break;
+        default:
+            ALOGE("%s: unknown output format %x", __FUNCTION__, halBuf.format);
+            return -1;
+    }
+    return 0;
+}
+
+int ExternalCameraDeviceSession::OutputThread::processOutputBuffersLocked(
+        const DecodedRequest& decoded) {
+    ATRACE_CALL();
+    const std::shared_ptr<HalRequest>& req = decoded.req;
+    // Output buffers of the same size are scaled into the same intermediate buffer and JPEG
+    // buffers share the thumbnail buffer, so such buffers are filled one after another by the
+    // same task. Task 0 fills the JPEG buffers, all tasks run in parallel.
+    std::vector<std::vector<HalStreamBuffer*>> tasks(1);
+    std::unordered_map<Size, size_t, SizeHasher> taskBySize;
+    for (const auto& halBuf : req->buffers) {
+        if (halBuf.format == PixelFormat::BLOB) {
+            taskBySize[Size{halBuf.width, halBuf.height}] = 0;
+        }
+    }
+    for (auto& halBuf : req->buffers) {
+        auto [it, inserted] =
+                taskBySize.emplace(Size{halBuf.width, halBuf.height}, tasks.size());
+        if (inserted) {
+            tasks.emplace_back();
+        }
+        tasks[it->second].push_back(&halBuf);
+    }
+    if (tasks[0].empty()) {
+        tasks.erase(tasks.begin());
+    }
+    if (tasks.empty()) {
+        return 0;
+    }
+
+    auto runTask = [&](const std::vector<HalStreamBuffer*>& bufs) {
+        for (HalStreamBuffer* halBuf : bufs) {
+            int ret = processOutputBufferLocked(decoded, *halBuf);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        return 0;
+    };
+
+    // The first task runs on this thread, the others on the ConvertWorkers. Should there be
+    // more tasks than workers, the remaining ones run on this thread too.
+    size_t numWorkerTasks = std::min(tasks.size() - 1, mConvertWorkers.size());
+    for (size_t i = 0; i < numWorkerTasks; i++) {
+        mConvertWorkers[i]->submitTask([&runTask, &bufs = tasks[i + 1]] { return runTask(bufs); });
+    }
+    int ret = runTask(tasks[0]);
+    for (size_t i = numWorkerTasks + 1; i < tasks.size() && ret == 0; i++) {
+        ret = runTask(tasks[i]);
+    }
+    for (size_t i = 0; i < numWorkerTasks; i++) {
+        int taskRet = mConvertWorkers[i]->waitForTaskDone();
+        if (ret == 0) {
+            ret = taskRet;
+        }
+    }
+    return ret;
+}
+
 bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
     std::shared_ptr<HalRequest> req;
     auto parent = mParent.lock();
@@ -2757,6 +3134,15 @@ bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
         return false;
     }
 
+    if (mConvertThread == nullptr) {
+        for (int i = 0; i < kNumConvertWorkers; i++) {
+            mConvertWorkers.push_back(std::make_unique<ConvertWorker>());
+            mConvertWorkers.back()->run();
+        }
+        mConvertThread = std::make_shared<ConvertThread>(this);
+        mConvertThread->run();
+    }
+
     // TODO: maybe we need to setup a sensor thread to dq/enq v4l frames
     //       regularly to prevent v4l buffer queue filled with stale buffers
     //       when app doesn't program a preview request
@@ -2766,10 +3152,24 @@ bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
         return true;
     }
 
+    // Queues the decoded request for the ConvertThread, so the results of the requests decoded
+    // before are returned first. Returns the request right away if the ConvertThread has exited.
+    auto queueDecoded = [&](DecodedRequest&& decoded) {
+        if (queueDecodedRequest(std::move(decoded))) {
+            return true;
+        }
+        ALOGE("%s: ConvertThread has exited, returning frame %d as error", __FUNCTION__,
+              req->frameNumber);
+        failDecodedRequest(decoded, parent);
+        return false;
+    };
+
     auto onDeviceError = [&](auto... args) {
         ALOGE(args...);
-        parent->notifyError(req->frameNumber, /*stream*/ -1, ErrorCode::ERROR_DEVICE);
-        signalRequestDone();
+        DecodedRequest decoded;
+        decoded.req = req;
+        decoded.deviceError = true;
+        queueDecoded(std::move(decoded));
         return false;
     };
 
@@ -2786,13 +3186,11 @@ bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
         return onDeviceError("%s: failed to send buffer request!", __FUNCTION__);
     }
 
-    std::unique_lock<std::mutex> lk(mBufferLock);
     // Convert input V4L2 frame to YU12 of the same size
     // TODO: see if we can save some computation by converting to YV12 here
     uint8_t* inData;
     size_t inDataSize;
     if (req->frameIn->getData(&inData, &inDataSize) != 0) {
-        lk.unlock();
         return onDeviceError("%s: V4L2 buffer map failed", __FUNCTION__);
     }
 
@@ -2820,43 +3218,52 @@ bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
         }
     }
 
-    // TODO: in some special case maybe we can decode jpg directly to gralloc output?
-    if (req->frameIn->mFourcc == V4L2_PIX_FMT_MJPEG) {
+    DecodedRequest decoded;
+    decoded.req = req;
+    decoded.muted = mCameraMuted;
+    // Outputs of the V4L2 frame size are filled from the MJPEG frame directly when possible,
+    // skipping the intermediate YU12 frame
+    if (req->frameIn->mFourcc == V4L2_PIX_FMT_MJPEG && needsYu12Frame(*req, mCameraMuted)) {
+        // Waits while the ConvertThread is still reading all the YU12 frames
+        decoded.yu12Frame = acquireYu12Frame();
+        if (decoded.yu12Frame == nullptr) {
+            ALOGV("%s: exiting, returning frame %d as error", __FUNCTION__, req->frameNumber);
+            waitForBufferRequestDone(&req->buffers);
+            failDecodedRequest(decoded, parent);
+            return false;
+        }
+
+        YCbCrLayout yu12Layout;
+        if (decoded.yu12Frame->getLayout(&yu12Layout) != 0) {
+            releaseYu12Frame(decoded.yu12Frame);
+            return onDeviceError("%s: failed to get YU12 frame layout", __FUNCTION__);
+        }
+        int width = decoded.yu12Frame->mWidth;
+        int height = decoded.yu12Frame->mHeight;
+
         ATRACE_BEGIN("MJPGtoI420");
         res = 0;
         if (mCameraMuted) {
             res = libyuv::ConvertToI420(
                     mMuteTestPatternFrame.data(), mMuteTestPatternFrame.size(),
-                    static_cast<uint8_t*>(mYu12FrameLayout.y), mYu12FrameLayout.yStride,
-                    static_cast<uint8_t*>(mYu12FrameLayout.cb), mYu12FrameLayout.cStride,
-                    static_cast<uint8_t*>(mYu12FrameLayout.cr), mYu12FrameLayout.cStride, 0, 0,
-                    mYu12Frame->mWidth, mYu12Frame->mHeight, mYu12Frame->mWidth,
-                    mYu12Frame->mHeight, libyuv::kRotate0, libyuv::FOURCC_RAW);
+                    static_cast<uint8_t*>(yu12Layout.y), yu12Layout.yStride,
+                    static_cast<uint8_t*>(yu12Layout.cb), yu12Layout.cStride,
+                    static_cast<uint8_t*>(yu12Layout.cr), yu12Layout.cStride, 0, 0, width, height,
+                    width, height, libyuv::kRotate0, libyuv::FOURCC_RAW);
         } else {
-            res = libyuv::MJPGToI420(
-                    inData, inDataSize, static_cast<uint8_t*>(mYu12FrameLayout.y),
-                    mYu12FrameLayout.yStride, static_cast<uint8_t*>(mYu12FrameLayout.cb),
-                    mYu12FrameLayout.cStride, static_cast<uint8_t*>(mYu12FrameLayout.cr),
-                    mYu12FrameLayout.cStride, mYu12Frame->mWidth, mYu12Frame->mHeight,
-                    mYu12Frame->mWidth, mYu12Frame->mHeight);
+            res = libyuv::MJPGToI420(inData, inDataSize, static_cast<uint8_t*>(yu12Layout.y),
+                                     yu12Layout.yStride, static_cast<uint8_t*>(yu12Layout.cb),
+                                     yu12Layout.cStride, static_cast<uint8_t*>(yu12Layout.cr),
+                                     yu12Layout.cStride, width, height, width, height);
         }
         ATRACE_END();
 
         if (res != 0) {
             // For some webcam, the first few V4L2 frames might be malformed...
             ALOGE("%s: Convert V4L2 frame to YU12 failed! res %d", __FUNCTION__, res);
-
-            ATRACE_BEGIN("Wait for BufferRequest done");
-            res = waitForBufferRequestDone(&req->buffers);
-            ATRACE_END();
-
-            lk.unlock();
-            Status st = parent->processCaptureRequestError(req);
-            if (st != Status::OK) {
-                return onDeviceError("%s: failed to process capture request error!", __FUNCTION__);
-            }
-            signalRequestDone();
-            return true;
+            releaseYu12Frame(decoded.yu12Frame);
+            decoded.yu12Frame.reset();
+            decoded.failed = true;
         }
     }
 
@@ -2864,122 +3271,115 @@ bool ExternalCameraDeviceSession::OutputThread::threadLoop() {
     res = waitForBufferRequestDone(&req->buffers);
     ATRACE_END();
 
-    if (res != 0) {
+    if (res != 0 && !decoded.failed) {
         // HAL buffer management buffer request can fail
         ALOGE("%s: wait for BufferRequest done failed! res %d", __FUNCTION__, res);
-        lk.unlock();
-        Status st = parent->processCaptureRequestError(req);
-        if (st != Status::OK) {
-            return onDeviceError("%s: failed to process capture request error!", __FUNCTION__);
-        }
-        signalRequestDone();
-        return true;
+        releaseYu12Frame(decoded.yu12Frame);
+        decoded.yu12Frame.reset();
+        decoded.failed = true;
     }
 
-    ALOGV("%s processing new request", __FUNCTION__);
-    const int kSyncWaitTimeoutMs = 500;
-    for (auto& halBuf : req->buffers) {
-        if (*(halBuf.bufPtr) == nullptr) {
-            ALOGW("%s: buffer for stream %d missing", __FUNCTION__, halBuf.streamId);
-            halBuf.fenceTimeout = true;
-        } else if (halBuf.acquireFence >= 0) {
-            int ret = sync_wait(halBuf.acquireFence, kSyncWaitTimeoutMs);
-            if (ret) {
-                halBuf.fenceTimeout = true;
-            } else {
-                ::close(halBuf.acquireFence);
-                halBuf.acquireFence = -1;
-            }
-        }
-
-        if (halBuf.fenceTimeout) {
-            continue;
-        }
-
-        // Gralloc lockYCbCr the buffer
-        switch (halBuf.format) {
-            case PixelFormat::BLOB: {
-                int ret = createJpegLocked(halBuf, req->setting);
-
-                if (ret != 0) {
-                    lk.unlock();
-                    return onDeviceError("%s: createJpegLocked failed with %d", __FUNCTION__, ret);
-                }
-            } break;
-            case PixelFormat::Y16: {
-                void* outLayout = sHandleImporter.lock(
-                        *(halBuf.bufPtr), static_cast<uint64_t>(halBuf.usage), inDataSize);
+    // The ConvertThread fills the output buffers and returns the results in request order,
+    // while this thread goes on decoding the next request.
+    return queueDecoded(std::move(decoded));
+}
 
-                std::memcpy(outLayout, inData, inDataSize);
+bool ExternalCameraDeviceSession::OutputThread::processDecodedRequest(DecodedRequest& decoded) {
+    std::shared_ptr<HalRequest>& req = decoded.req;
+    auto parent = mParent.lock();
+    if (parent == nullptr) {
+        ALOGE("%s: session has been disconnected!", __FUNCTION__);
+        releaseYu12Frame(decoded.yu12Frame);
+        signalRequestDone(req->frameNumber);
+        return false;
+    }
 
-                int relFence = sHandleImporter.unlock(*(halBuf.bufPtr));
-                if (relFence >= 0) {
-                    halBuf.acquireFence = relFence;
-                }
-            } break;
-            case PixelFormat::YCBCR_420_888:
-            case PixelFormat::YV12: {
-                android::Rect outRect{0, 0, static_cast<int32_t>(halBuf.width),
-                                      static_cast<int32_t>(halBuf.height)};
-                android_ycbcr result = sHandleImporter.lockYCbCr(
-                        *(halBuf.bufPtr), static_cast<uint64_t>(halBuf.usage), outRect);
-                ALOGV("%s: outLayout y %p cb %p cr %p y_str %zu c_str %zu c_step %zu", __FUNCTION__,
-                      result.y, result.cb, result.cr, result.ystride, result.cstride,
-                      result.chroma_step);
-                if (result.ystride > UINT32_MAX || result.cstride > UINT32_MAX ||
-                    result.chroma_step > UINT32_MAX) {
-                    return onDeviceError("%s: lockYCbCr failed. Unexpected values!", __FUNCTION__);
-                }
-                YCbCrLayout outLayout = {.y = result.y,
-                                         .cb = result.cb,
-                                         .cr = result.cr,
-                                         .yStride = static_cast<uint32_t>(result.ystride),
-                                         .cStride = static_cast<uint32_t>(result.cstride),
-                                         .chromaStep = static_cast<uint32_t>(result.chroma_step)};
-
-                // Convert to output buffer size/format
-                uint32_t outputFourcc = getFourCcFromLayout(outLayout);
-                ALOGV("%s: converting to format %c%c%c%c", __FUNCTION__, outputFourcc & 0xFF,
-                      (outputFourcc >> 8) & 0xFF, (outputFourcc >> 16) & 0xFF,
-                      (outputFourcc >> 24) & 0xFF);
+    auto onDeviceError = [&](auto... args) {
+        ALOGE(args...);
+        parent->notifyError(req->frameNumber, /*stream*/ -1, ErrorCode::ERROR_DEVICE);
+        signalRequestDone(req->frameNumber);
+        return false;
+    };
 
-                YCbCrLayout cropAndScaled;
-                ATRACE_BEGIN("cropAndScaleLocked");
-                int ret = cropAndScaleLocked(mYu12Frame, Size{halBuf.width, halBuf.height},
-                                             &cropAndScaled);
-                ATRACE_END();
-                if (ret != 0) {
-                    lk.unlock();
-                    return onDeviceError("%s: crop and scale failed!", __FUNCTION__);
-                }
+    if (decoded.failed || decoded.deviceError) {
+        failDecodedRequest(decoded, parent);
+        return true;
+    }
 
-                Size sz{halBuf.width, halBuf.height};
-                ATRACE_BEGIN("formatConvert");
-                ret = formatConvert(cropAndScaled, outLayout, sz, outputFourcc);
-                ATRACE_END();
-                if (ret != 0) {
-                    lk.unlock();
-                    return onDeviceError("%s: format conversion failed!", __FUNCTION__);
-                }
-                int relFence = sHandleImporter.unlock(*(halBuf.bufPtr));
-                if (relFence >= 0) {
-                    halBuf.acquireFence = relFence;
-                }
-            } break;
-            default:
-                lk.unlock();
-                return onDeviceError("%s: unknown output format %x", __FUNCTION__, halBuf.format);
-        }
-    }  // for each buffer
+    ALOGV("%s processing new request", __FUNCTION__);
+    std::unique_lock<std::mutex> lk(mBufferLock);
+    int ret = processOutputBuffersLocked(decoded);
     mScaledYu12Frames.clear();
+    lk.unlock();
+
+    // The OutputThread can decode the next request into this frame now
+    releaseYu12Frame(decoded.yu12Frame);
+    decoded.yu12Frame.reset();
+    if (ret != 0) {
+        ALOGE("%s: failed to fill output buffers of frame %d! ret %d", __FUNCTION__,
+              req->frameNumber, ret);
+        failDecodedRequest(decoded, parent);
+        return true;
+    }
 
     // Don't hold the lock while calling back to parent
-    lk.unlock();
     Status st = parent->processCaptureResult(req);
     if (st != Status::OK) {
         return onDeviceError("%s: failed to process capture result!", __FUNCTION__);
     }
-    signalRequestDone();
+    signalRequestDone(req->frameNumber);
+    return true;
+}
+
+bool ExternalCameraDeviceSession::OutputThread::ConvertThread::threadLoop() {
+    DecodedRequest decoded;
+    if (!mOutputThread->waitForDecodedRequest(&decoded)) {
+        // No decoded request, wait again
+        return true;
+    }
+    if (!mOutputThread->processDecodedRequest(decoded)) {
+        mOutputThread->onConvertThreadExit();
+        return false;
+    }
+    return true;
+}
+
+void ExternalCameraDeviceSession::OutputThread::ConvertWorker::submitTask(
+        std::function<int()> task) {
+    std::unique_lock<std::mutex> lk(mLock);
+    mTask = std::move(task);
+    mTaskDone = false;
+    lk.unlock();
+    mTaskCond.notify_one();
+}
+
+int ExternalCameraDeviceSession::OutputThread::ConvertWorker::waitForTaskDone() {
+    std::unique_lock<std::mutex> lk(mLock);
+    mTaskDoneCond.wait(lk, [this] { return mTaskDone; });
+    return mTaskRet;
+}
+
+bool ExternalCameraDeviceSession::OutputThread::ConvertWorker::threadLoop() {
+    std::unique_lock<std::mutex> lk(mLock);
+    if (mTask == nullptr) {
+        auto timeout = std::chrono::milliseconds(kReqWaitTimeoutMs);
+        mTaskCond.wait_for(lk, timeout);
+        if (mTask == nullptr) {
+            // No task, wait again
+            return true;
+        }
+    }
+    std::function<int()> task = std::move(mTask);
+    mTask = nullptr;
+    lk.unlock();
+
+    int ret = task();
+
+    lk.lock();
+    mTaskRet = ret;
+    mTaskDone = true;
+    lk.unlock();
+    mTaskDoneCond.notify_one();
     return true;
 }
 
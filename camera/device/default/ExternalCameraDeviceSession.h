@@ -29,7 +29,9 @@
 #include <android/hardware/graphics/mapper/4.0/IMapper.h>
 #include <fmq/AidlMessageQueue.h>
 #include <utils/Thread.h>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <list>
 
 namespace android {
@@ -185,6 +187,52 @@ class ExternalCameraDeviceSession : public BnCameraDeviceSession, public OutputT
         static const int kFlushWaitTimeoutSec = 3;  // 3 sec
         static const int kReqWaitTimeoutMs = 33;    // 33ms
         static const int kReqWaitTimesMax = 90;     // 33ms * 90 ~= 3 sec
+        // Number of YU12 frames the V4L2 frames are decoded into. With two frames the next
+        // V4L2 frame can be decoded while the previous one is being converted.
+        static const int kNumYu12Frames = 2;
+        // Number of ConvertWorkers filling output buffers alongside the ConvertThread, one per
+        // output size a request can have besides the one the ConvertThread fills
+        static const int kNumConvertWorkers = kMaxProcessedStream + kMaxStallStream - 1;
+
+        // A request whose V4L2 frame has been decoded and whose output buffers are ready
+        struct DecodedRequest {
+            std::shared_ptr<HalRequest> req;
+            // null for non MJPEG input, or if all outputs are filled from the MJPEG frame directly
+            std::shared_ptr<AllocatedFrame> yu12Frame;
+            bool muted = false;   // yu12Frame holds the test pattern instead of the V4L2 frame
+            bool failed = false;  // decode or buffer request failed, return the request as error
+            bool deviceError = false;  // the OutputThread failed, notify ERROR_DEVICE
+        };
+
+        // Fills the output buffers of the requests decoded by the OutputThread and returns the
+        // capture results in the order the requests were submitted.
+        class ConvertThread : public SimpleThread {
+          public:
+            explicit ConvertThread(OutputThread* outputThread) : mOutputThread(outputThread) {}
+
+            bool threadLoop() override;
+
+          private:
+            OutputThread* const mOutputThread;
+        };
+
+        // Runs one output buffer fill task of the ConvertThread at a time
+        class ConvertWorker : public SimpleThread {
+          public:
+            void submitTask(std::function<int()> task);
+            // Returns the result of the submitted task
+            int waitForTaskDone();
+
+            bool threadLoop() override;
+
+          private:
+            std::mutex mLock;
+            std::condition_variable mTaskCond;      // signaled when a task is submitted
+            std::condition_variable mTaskDoneCond;  // signaled when the task is done
+            std::function<int()> mTask;
+            bool mTaskDone = false;
+            int mTaskRet = 0;
+        };
 
         // Methods to request output buffer in parallel
         int requestBufferStart(const std::vector<HalStreamBuffer>&);
@@ -192,7 +240,41 @@ class ExternalCameraDeviceSession : public BnCameraDeviceSession, public OutputT
                 /*out*/ std::vector<HalStreamBuffer>*);
 
         void waitForNextRequest(std::shared_ptr<HalRequest>* out);
-        void signalRequestDone();
+        void signalRequestDone(int32_t frameNumber);
+
+        // Returns null if the thread is requested to exit, or the ConvertThread has exited,
+        // before a YU12 frame is released
+        std::shared_ptr<AllocatedFrame> acquireYu12Frame();
+        void releaseYu12Frame(const std::shared_ptr<AllocatedFrame>& frame);
+
+        // Returns false, leaving decoded untouched, if the ConvertThread has exited and will not
+        // process the request
+        bool queueDecodedRequest(DecodedRequest&& decoded);
+        bool waitForDecodedRequest(/*out*/ DecodedRequest* decoded);
+        // Returns false if the ConvertThread must exit
+        bool processDecodedRequest(DecodedRequest& decoded);
+        // Returns the request as error without filling its output buffers
+        void failDecodedRequest(DecodedRequest& decoded,
+                                const std::shared_ptr<OutputThreadInterface>& parent);
+        // Fails the decoded requests no ConvertThread will process
+        void drainDecodedRequests();
+        void onConvertThreadExit();
+
+        // Whether the MJPEG V4L2 frame can be copied into the JPEG output buffer as is, skipping
+        // the decode and re-encode of the main image
+        static bool canPassthroughMjpeg(const HalRequest& req, const HalStreamBuffer& halBuf,
+                                        bool muted);
+        // Whether some output buffer of the request must be filled from a decoded YU12 frame.
+        // If not, YUV outputs of the V4L2 frame size are decoded into directly.
+        static bool needsYu12Frame(const HalRequest& req, bool muted);
+
+        // Fill all output buffers of the request, running independent streams in parallel on
+        // the ConvertWorkers
+        int processOutputBuffersLocked(const DecodedRequest& decoded);
+
+        // Wait for the acquire fence of one output buffer and fill it from the YU12 frame, or
+        // from the V4L2 frame directly for Y16 output and the MJPEG fast paths
+        int processOutputBufferLocked(const DecodedRequest& decoded, HalStreamBuffer& halBuf);
 
         int cropAndScaleLocked(std::shared_ptr<AllocatedFrame>& in, const Size& outSize,
                                YCbCrLayout* out);
@@ -200,8 +282,7 @@ class ExternalCameraDeviceSession : public BnCameraDeviceSession, public OutputT
         int cropAndScaleThumbLocked(std::shared_ptr<AllocatedFrame>& in, const Size& outSize,
                                     YCbCrLayout* out);
 
-        int createJpegLocked(HalStreamBuffer& halBuf,
-                             const common::V1_0::helper::CameraMetadata& settings);
+        int createJpegLocked(const DecodedRequest& decoded, HalStreamBuffer& halBuf);
 
         void clearIntermediateBuffers();
 
@@ -210,29 +291,44 @@ class ExternalCameraDeviceSession : public BnCameraDeviceSession, public OutputT
         const common::V1_0::helper::CameraMetadata mCameraCharacteristics;
 
         mutable std::mutex mRequestListLock;       // Protect access to mRequestList,
-                                                   // mProcessingRequest and mProcessingFrameNumber
+                                                   // mProcessingFrameNumbers and mDecodedRequests
         std::condition_variable mRequestCond;      // signaled when a new request is submitted
         std::condition_variable mRequestDoneCond;  // signaled when a request is done processing
+        std::condition_variable mDecodedRequestCond;  // signaled when a request is decoded
         std::list<std::shared_ptr<HalRequest>> mRequestList;
-        bool mProcessingRequest = false;
-        uint32_t mProcessingFrameNumber = 0;
+        // Requests taken from mRequestList whose results have not been returned yet
+        std::list<int32_t> mProcessingFrameNumbers;
+        std::deque<DecodedRequest> mDecodedRequests;
+
+        // Started by the first threadLoop of the session OutputThread; the offline session
+        // processes its requests serially and does not use it.
+        std::shared_ptr<ConvertThread> mConvertThread;
+        // Set under mRequestListLock once the ConvertThread stops taking decoded requests
+        std::atomic_bool mConvertThreadExited{false};
+        // Started along with mConvertThread
+        std::vector<std::unique_ptr<ConvertWorker>> mConvertWorkers;
 
         // V4L2 frameIn
-        // (MJPG decode)-> mYu12Frame
-        // (Scale)-> mScaledYu12Frames
-        // (Format convert) -> output gralloc frames
+        // (MJPG decode, OutputThread)-> one of mYu12Frames
+        // (Scale, ConvertThread)-> mScaledYu12Frames
+        // (Format convert, ConvertThread) -> output gralloc frames
         mutable std::mutex mBufferLock;  // Protect access to intermediate buffers
-        std::shared_ptr<AllocatedFrame> mYu12Frame;
+        std::vector<std::shared_ptr<AllocatedFrame>> mYu12Frames;
         std::shared_ptr<AllocatedFrame> mYu12ThumbFrame;
         std::unordered_map<Size, std::shared_ptr<AllocatedFrame>, SizeHasher> mIntermediateBuffers;
+        std::mutex mScaledYu12FramesLock;  // Protect mScaledYu12Frames from parallel conversions
         std::unordered_map<Size, std::shared_ptr<AllocatedFrame>, SizeHasher> mScaledYu12Frames;
-        YCbCrLayout mYu12FrameLayout;
         YCbCrLayout mYu12ThumbFrameLayout;
+        // Mute state is only accessed by the decoding thread once streams are configured
         std::vector<uint8_t> mMuteTestPatternFrame;
         uint32_t mTestPatternData[4] = {0, 0, 0, 0};
         bool mCameraMuted = false;
         uint32_t mBlobBufferSize = 0;  // 0 -> HAL derive buffer size, else: use given size
 
+        std::mutex mYu12FramesLock;                // Protect access to mFreeYu12Frames
+        std::condition_variable mYu12FrameCond;    // signaled when a YU12 frame is released
+        std::list<std::shared_ptr<AllocatedFrame>> mFreeYu12Frames;
+
         std::string mExifMake;
         std::string mExifModel;
 
@@ -332,6 +428,8 @@ class ExternalCameraDeviceSession : public BnCameraDeviceSession, public OutputT
     SupportedV4L2Format mV4l2StreamingFmt;
     double mV4l2StreamingFps = 0.0;
     size_t mV4L2BufferCount = 0;
+    // The buffers of the current v4l2 stream, shared with the V4L2Frames dequeued from it
+    std::shared_ptr<V4L2BufferPool> mV4l2BufferPool;
 
     static const int kBufferWaitTimeoutSec = 3;  // TODO: handle long exposure (or not allowing)
     std::mutex mV4l2BufferLock;                  // protect the buffer count and condition below
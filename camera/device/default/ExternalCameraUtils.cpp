@@ -20,12 +20,20 @@
 #include "ExternalCameraUtils.h"
 
 #include <aidlcommonsupport/NativeHandle.h>
+#include <fcntl.h>
 #include <jpeglib.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
 #include <linux/videodev2.h>
 #include <log/log.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <future>
+#include <thread>
 
 #define HAVE_JPEG  // required for libyuv.h to export MJPEG decode APIs
 #include <libyuv.h>
@@ -44,6 +52,23 @@ const int kDefaultNumVideoBuffer = 4;
 const int kDefaultNumStillBuffer = 2;
 const int kDefaultOrientation = 0;  // suitable for natural landscape displays like tablet/TV
                                     // For phone devices 270 is better
+const char* kDefaultDmaBufHeap = "system";
+
+bool parseV4L2MemoryType(const char* name, V4L2MemoryType* type) {
+    const std::pair<const char*, V4L2MemoryType> kTypes[] = {
+            {"mmap", V4L2MemoryType::MMAP},
+            {"dmabuf-export", V4L2MemoryType::DMABUF_EXPORT},
+            {"dmabuf-import", V4L2MemoryType::DMABUF_IMPORT},
+            {"userptr", V4L2MemoryType::USERPTR},
+    };
+    for (const auto& [typeName, typeValue] : kTypes) {
+        if (name != nullptr && strcmp(name, typeName) == 0) {
+            *type = typeValue;
+            return true;
+        }
+    }
+    return false;
+}
 }  // anonymous namespace
 
 const char* ExternalCameraConfig::kDefaultCfgPath = "/vendor/etc/external_camera_config.xml";
@@ -124,6 +149,21 @@ ExternalCameraConfig ExternalCameraConfig::loadFromCfg(const char* cfgPath) {
                 numStillBuf->UnsignedAttribute("count", /*Default*/ kDefaultNumStillBuffer);
     }
 
+    XMLElement* v4l2Memory = deviceCfg->FirstChildElement("V4L2Memory");
+    if (v4l2Memory == nullptr) {
+        ALOGI("%s: no v4l2 memory type specified", __FUNCTION__);
+    } else {
+        const char* type = v4l2Memory->Attribute("type");
+        if (!parseV4L2MemoryType(type, &ret.v4l2MemoryType)) {
+            ALOGW("%s: unknown v4l2 memory type %s, using mmap", __FUNCTION__,
+                  type != nullptr ? type : "(null)");
+        }
+        const char* heap = v4l2Memory->Attribute("heap");
+        if (heap != nullptr) {
+            ret.dmaBufHeap = heap;
+        }
+    }
+
     XMLElement* fpsList = deviceCfg->FirstChildElement("FpsList");
     if (fpsList == nullptr) {
         ALOGI("%s: no fps list specified", __FUNCTION__);
@@ -169,9 +209,9 @@ ExternalCameraConfig ExternalCameraConfig::loadFromCfg(const char* cfgPath) {
     }
 
     ALOGI("%s: external camera cfg loaded: maxJpgBufSize %d,"
-          " num video buffers %d, num still buffers %d, orientation %d",
+          " num video buffers %d, num still buffers %d, v4l2 memory type %d, orientation %d",
           __FUNCTION__, ret.maxJpegBufSize, ret.numVideoBuffers, ret.numStillBuffers,
-          ret.orientation);
+          static_cast<int>(ret.v4l2MemoryType), ret.orientation);
     for (const auto& limit : ret.fpsLimits) {
         ALOGI("%s: fpsLimitList: %dx%d@%f", __FUNCTION__, limit.size.width, limit.size.height,
               limit.fpsUpperBound);
@@ -219,6 +259,8 @@ ExternalCameraConfig::ExternalCameraConfig()
       maxJpegBufSize(kDefaultJpegBufSize),
       numVideoBuffers(kDefaultNumVideoBuffer),
       numStillBuffers(kDefaultNumStillBuffer),
+      v4l2MemoryType(V4L2MemoryType::MMAP),
+      dmaBufHeap(kDefaultDmaBufHeap),
       depthEnabled(false),
       orientation(kDefaultOrientation) {
     fpsLimits.push_back({/* size */ {/* width */ 640, /* height */ 480}, /* fpsUpperBound */ 30.0});
@@ -242,9 +284,222 @@ Frame::Frame(uint32_t width, uint32_t height, uint32_t fourcc)
     : mWidth(width), mHeight(height), mFourcc(fourcc) {}
 Frame::~Frame() {}
 
-V4L2Frame::V4L2Frame(uint32_t w, uint32_t h, uint32_t fourcc, int bufIdx, int fd, uint32_t dataSize,
-                     uint64_t offset)
-    : Frame(w, h, fourcc), mBufferIndex(bufIdx), mFd(fd), mDataSize(dataSize), mOffset(offset) {}
+V4L2BufferPool::V4L2BufferPool(int v4l2Fd, V4L2MemoryType memoryType,
+                               const std::string& dmaBufHeap)
+    : mV4l2Fd(v4l2Fd),
+      mMemoryType(memoryType),
+      mDmaBufHeap(dmaBufHeap),
+      mV4l2Memory(memoryType == V4L2MemoryType::USERPTR         ? V4L2_MEMORY_USERPTR
+                  : memoryType == V4L2MemoryType::DMABUF_IMPORT ? V4L2_MEMORY_DMABUF
+                                                                : V4L2_MEMORY_MMAP) {}
+
+V4L2BufferPool::~V4L2BufferPool() {
+    // The v4l2 fd might be closed already, so only the mappings are released here
+    freeBuffers();
+}
+
+int V4L2BufferPool::allocate(uint32_t count, uint32_t bufferSize) {
+    v4l2_requestbuffers reqBuffers{};
+    reqBuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    reqBuffers.memory = mV4l2Memory;
+    reqBuffers.count = count;
+    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_REQBUFS, &reqBuffers)) < 0) {
+        ALOGE("%s: VIDIOC_REQBUFS failed: %s", __FUNCTION__, strerror(errno));
+        return -errno;
+    }
+
+    android::base::unique_fd dmaHeapFd;
+    if (mMemoryType == V4L2MemoryType::DMABUF_IMPORT) {
+        std::string heapPath = "/dev/dma_heap/" + mDmaBufHeap;
+        dmaHeapFd.reset(TEMP_FAILURE_RETRY(open(heapPath.c_str(), O_RDONLY | O_CLOEXEC)));
+        if (dmaHeapFd.get() < 0) {
+            int ret = -errno;
+            ALOGE("%s: open %s failed: %s", __FUNCTION__, heapPath.c_str(), strerror(errno));
+            release();
+            return ret;
+        }
+    }
+
+    mBuffers.resize(reqBuffers.count);
+    for (uint32_t i = 0; i < reqBuffers.count; i++) {
+        int ret = allocateBuffer(i, bufferSize, dmaHeapFd.get(), &mBuffers[i]);
+        if (ret != 0) {
+            release();
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int V4L2BufferPool::allocateBuffer(uint32_t index, uint32_t bufferSize, int dmaHeapFd,
+                                   Buffer* buffer) {
+    void* addr = MAP_FAILED;
+    switch (mMemoryType) {
+        case V4L2MemoryType::MMAP:
+        case V4L2MemoryType::DMABUF_EXPORT: {
+            v4l2_buffer v4l2Buffer{};
+            v4l2Buffer.index = index;
+            v4l2Buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            v4l2Buffer.memory = V4L2_MEMORY_MMAP;
+            if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_QUERYBUF, &v4l2Buffer)) < 0) {
+                ALOGE("%s: QUERYBUF %d failed: %s", __FUNCTION__, index, strerror(errno));
+                return -errno;
+            }
+            buffer->size = v4l2Buffer.length;
+            if (mMemoryType == V4L2MemoryType::MMAP) {
+                addr = mmap(nullptr, buffer->size, PROT_READ, MAP_SHARED, mV4l2Fd,
+                            v4l2Buffer.m.offset);
+                break;
+            }
+
+            v4l2_exportbuffer exportBuffer{};
+            exportBuffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            exportBuffer.index = index;
+            exportBuffer.flags = O_RDONLY | O_CLOEXEC;
+            if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_EXPBUF, &exportBuffer)) < 0) {
+                ALOGE("%s: EXPBUF %d failed: %s", __FUNCTION__, index, strerror(errno));
+                return -errno;
+            }
+            buffer->dmaBufFd.reset(exportBuffer.fd);
+            addr = mmap(nullptr, buffer->size, PROT_READ, MAP_SHARED, buffer->dmaBufFd.get(), 0);
+            break;
+        }
+        case V4L2MemoryType::DMABUF_IMPORT: {
+            buffer->size = (bufferSize + getpagesize() - 1) & ~(getpagesize() - 1);
+            dma_heap_allocation_data allocation{};
+            allocation.len = buffer->size;
+            allocation.fd_flags = O_RDWR | O_CLOEXEC;
+            if (TEMP_FAILURE_RETRY(ioctl(dmaHeapFd, DMA_HEAP_IOCTL_ALLOC, &allocation)) < 0) {
+                ALOGE("%s: DMA-BUF heap allocation of %zu bytes failed: %s", __FUNCTION__,
+                      buffer->size, strerror(errno));
+                return -errno;
+            }
+            buffer->dmaBufFd.reset(allocation.fd);
+            addr = mmap(nullptr, buffer->size, PROT_READ, MAP_SHARED, buffer->dmaBufFd.get(), 0);
+            break;
+        }
+        case V4L2MemoryType::USERPTR:
+            buffer->size = (bufferSize + getpagesize() - 1) & ~(getpagesize() - 1);
+            addr = mmap(nullptr, buffer->size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            break;
+    }
+
+    if (addr == MAP_FAILED) {
+        ALOGE("%s: V4L2 buffer %d map failed: %s", __FUNCTION__, index, strerror(errno));
+        return -errno;
+    }
+    buffer->data = static_cast<uint8_t*>(addr);
+    return 0;
+}
+
+void V4L2BufferPool::freeBuffers() {
+    for (auto& buffer : mBuffers) {
+        if (buffer.data != nullptr && munmap(buffer.data, buffer.size) != 0) {
+            ALOGE("%s: V4L2 buffer unmap failed: %s", __FUNCTION__, strerror(errno));
+        }
+    }
+    mBuffers.clear();
+}
+
+int V4L2BufferPool::release() {
+    // Buffers exported or mapped by the driver must be unmapped before they can be freed
+    freeBuffers();
+
+    v4l2_requestbuffers reqBuffers{};
+    reqBuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    reqBuffers.memory = mV4l2Memory;
+    reqBuffers.count = 0;
+    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_REQBUFS, &reqBuffers)) < 0) {
+        ALOGE("%s: REQBUFS failed: %s", __FUNCTION__, strerror(errno));
+        return -errno;
+    }
+    return 0;
+}
+
+int V4L2BufferPool::queueBuffer(uint32_t index) {
+    if (index >= mBuffers.size()) {
+        ALOGE("%s: Invalid buffer id: %d", __FUNCTION__, index);
+        return -EINVAL;
+    }
+
+    v4l2_buffer buffer{};
+    buffer.index = index;
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = mV4l2Memory;
+    if (mMemoryType == V4L2MemoryType::USERPTR) {
+        buffer.m.userptr = reinterpret_cast<unsigned long>(mBuffers[index].data);
+        buffer.length = mBuffers[index].size;
+    } else if (mMemoryType == V4L2MemoryType::DMABUF_IMPORT) {
+        buffer.m.fd = mBuffers[index].dmaBufFd.get();
+        buffer.length = mBuffers[index].size;
+    }
+    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_QBUF, &buffer)) < 0) {
+        ALOGE("%s: QBUF index %d fails: %s", __FUNCTION__, index, strerror(errno));
+        return -errno;
+    }
+    return 0;
+}
+
+int V4L2BufferPool::dequeueBuffer(v4l2_buffer* buffer) {
+    *buffer = {};
+    buffer->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer->memory = mV4l2Memory;
+    if (TEMP_FAILURE_RETRY(ioctl(mV4l2Fd, VIDIOC_DQBUF, buffer)) < 0) {
+        ALOGE("%s: DQBUF fails: %s", __FUNCTION__, strerror(errno));
+        return -errno;
+    }
+
+    if (buffer->index >= mBuffers.size()) {
+        ALOGE("%s: Invalid buffer id: %d", __FUNCTION__, buffer->index);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int V4L2BufferPool::beginCpuAccess(uint32_t index, uint8_t** data) {
+    if (index >= mBuffers.size()) {
+        ALOGE("%s: Invalid buffer id: %d", __FUNCTION__, index);
+        return -EINVAL;
+    }
+
+    if (mBuffers[index].dmaBufFd.get() >= 0) {
+        dma_buf_sync sync{};
+        sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ;
+        if (TEMP_FAILURE_RETRY(ioctl(mBuffers[index].dmaBufFd.get(), DMA_BUF_IOCTL_SYNC,
+                                     &sync)) < 0) {
+            ALOGE("%s: DMA-BUF sync start failed: %s", __FUNCTION__, strerror(errno));
+            return -errno;
+        }
+    }
+    *data = mBuffers[index].data;
+    return 0;
+}
+
+int V4L2BufferPool::endCpuAccess(uint32_t index) {
+    if (index >= mBuffers.size()) {
+        ALOGE("%s: Invalid buffer id: %d", __FUNCTION__, index);
+        return -EINVAL;
+    }
+
+    if (mBuffers[index].dmaBufFd.get() >= 0) {
+        dma_buf_sync sync{};
+        sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+        if (TEMP_FAILURE_RETRY(ioctl(mBuffers[index].dmaBufFd.get(), DMA_BUF_IOCTL_SYNC,
+                                     &sync)) < 0) {
+            ALOGE("%s: DMA-BUF sync end failed: %s", __FUNCTION__, strerror(errno));
+            return -errno;
+        }
+    }
+    return 0;
+}
+
+V4L2Frame::V4L2Frame(uint32_t w, uint32_t h, uint32_t fourcc, int bufIdx,
+                     std::shared_ptr<V4L2BufferPool> bufferPool, uint32_t dataSize)
+    : Frame(w, h, fourcc),
+      mBufferIndex(bufIdx),
+      mBufferPool(std::move(bufferPool)),
+      mDataSize(dataSize) {}
 
 V4L2Frame::~V4L2Frame() {
     unmap();
@@ -263,17 +518,16 @@ int V4L2Frame::map(uint8_t** data, size_t* dataSize) {
 
     std::lock_guard<std::mutex> lk(mLock);
     if (!mMapped) {
-        void* addr = mmap(nullptr, mDataSize, PROT_READ, MAP_SHARED, mFd, mOffset);
-        if (addr == MAP_FAILED) {
-            ALOGE("%s: V4L2 buffer map failed: %s", __FUNCTION__, strerror(errno));
+        if (mBufferPool->beginCpuAccess(mBufferIndex, &mData) != 0) {
+            ALOGE("%s: V4L2 buffer map failed", __FUNCTION__);
             return -EINVAL;
         }
-        mData = static_cast<uint8_t*>(addr);
         mMapped = true;
     }
     *data = mData;
     *dataSize = mDataSize;
-    ALOGV("%s: V4L map FD %d, data %p size %zu", __FUNCTION__, mFd, mData, mDataSize);
+    ALOGV("%s: V4L map buffer %d, data %p size %zu", __FUNCTION__, mBufferIndex, mData,
+          mDataSize);
     return 0;
 }
 
@@ -281,8 +535,8 @@ int V4L2Frame::unmap() {
     std::lock_guard<std::mutex> lk(mLock);
     if (mMapped) {
         ALOGV("%s: V4L unmap data %p size %zu", __FUNCTION__, mData, mDataSize);
-        if (munmap(mData, mDataSize) != 0) {
-            ALOGE("%s: V4L2 buffer unmap failed: %s", __FUNCTION__, strerror(errno));
+        if (mBufferPool->endCpuAccess(mBufferIndex) != 0) {
+            ALOGE("%s: V4L2 buffer unmap failed", __FUNCTION__);
             return -EINVAL;
         }
         mMapped = false;
@@ -567,9 +821,18 @@ int formatConvert(const YCbCrLayout& in, const YCbCrLayout& out, Size sz, uint32
     return 0;
 }
 
-int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
-                   const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
-                   size_t& actualCodeSize) {
+namespace {
+
+/* Images are split so that every strip has at least this many pixels, thinner strips
+ * cost more in thread startup and restart markers than they save */
+const int32_t kMinJpegStripPixels = 1 << 20;
+
+/* Encode into out, or into growableOut if it is not null. With restartInRows set, a restart
+ * marker is written after every restartInRows MCU rows. */
+int encodeJpegYU12Impl(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
+                       const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
+                       std::vector<uint8_t>* growableOut, int restartInRows,
+                       size_t& actualCodeSize) {
     /* libjpeg is a C library so we use C-style "inheritance" by
      * putting libjpeg's jpeg_destination_mgr first in our custom
      * struct. This allows us to cast jpeg_destination_mgr* to
@@ -580,6 +843,7 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
         size_t mBufferSize;
         size_t mEncodedSize;
         bool mSuccess;
+        std::vector<uint8_t>* mGrowableBuffer;
     } dmgr;
 
     jpeg_compress_struct cinfo = {};
@@ -610,10 +874,16 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
     jpeg_create_compress(&cinfo);
 
     /* Initialize our destination manager */
-    dmgr.mBuffer = static_cast<JOCTET*>(out);
-    dmgr.mBufferSize = maxOutSize;
+    if (growableOut != nullptr) {
+        dmgr.mBuffer = growableOut->data();
+        dmgr.mBufferSize = growableOut->size();
+    } else {
+        dmgr.mBuffer = static_cast<JOCTET*>(out);
+        dmgr.mBufferSize = maxOutSize;
+    }
     dmgr.mEncodedSize = 0;
     dmgr.mSuccess = true;
+    dmgr.mGrowableBuffer = growableOut;
     cinfo.client_data = static_cast<void*>(&dmgr);
 
     /* These lambdas become C-style function pointers and as per C++11 spec
@@ -625,9 +895,20 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
         ALOGV("%s:%d jpeg start: %p [%zu]", __FUNCTION__, __LINE__, dmgr.mBuffer, dmgr.mBufferSize);
     };
 
-    dmgr.mgr.empty_output_buffer = [](j_compress_ptr cinfo __unused) {
-        ALOGV("%s:%d Out of buffer", __FUNCTION__, __LINE__);
-        return 0;
+    dmgr.mgr.empty_output_buffer = [](j_compress_ptr cinfo) {
+        auto& dmgr = reinterpret_cast<CustomJpegDestMgr&>(*cinfo->dest);
+        if (dmgr.mGrowableBuffer == nullptr) {
+            ALOGV("%s:%d Out of buffer", __FUNCTION__, __LINE__);
+            return 0;
+        }
+        /* Called when the whole buffer is used up */
+        size_t used = dmgr.mBufferSize;
+        dmgr.mGrowableBuffer->resize(std::max<size_t>(used * 2, 4096));
+        dmgr.mBuffer = dmgr.mGrowableBuffer->data();
+        dmgr.mBufferSize = dmgr.mGrowableBuffer->size();
+        dmgr.mgr.next_output_byte = dmgr.mBuffer + used;
+        dmgr.mgr.free_in_buffer = dmgr.mBufferSize - used;
+        return 1;
     };
 
     dmgr.mgr.term_destination = [](j_compress_ptr cinfo) {
@@ -652,6 +933,11 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
     jpeg_set_colorspace(&cinfo, JCS_YCbCr);
     cinfo.raw_data_in = 1;
     cinfo.dct_method = JDCT_IFAST;
+    if (restartInRows > 0) {
+        /* Strips are stitched together, so they must all use the standard Huffman tables */
+        cinfo.optimize_coding = FALSE;
+        cinfo.restart_in_rows = restartInRows;
+    }
 
     /* Configure sampling factors. The sampling factor is JPEG subsampling 420
      * because the source format is YUV420. Note that libjpeg sampling factors
@@ -718,12 +1004,14 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
         if (done != batchSize) {
             ALOGE("%s: compressed %u lines, expected %u (total %u/%u)", __FUNCTION__, done,
                   batchSize, cinfo.next_scanline, cinfo.image_height);
+            jpeg_destroy_compress(&cinfo);
             return -1;
         }
     }
 
     /* This will flush everything */
     jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
 
     /* Grab the actual code size and set it */
     actualCodeSize = dmgr.mEncodedSize;
@@ -731,6 +1019,317 @@ int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQualit
     return 0;
 }
 
+/* One horizontal strip of an image, encoded as a JPEG image of its own */
+struct JpegStrip {
+    std::vector<uint8_t> code;
+    size_t sofOffset = 0;   // Offset of the SOF0 marker
+    size_t scanOffset = 0;  // Offset of the entropy coded data, right after the SOS segment
+    size_t scanSize = 0;    // Size of the entropy coded data, up to EOI
+};
+
+/* Locate the frame header and the scan of a strip written by libjpeg, and renumber its
+ * restart markers to count on from the firstRestart-th restart marker of the whole image */
+int prepareJpegStrip(JpegStrip* strip, int firstRestart) {
+    const uint8_t kMarker = 0xFF;
+    const uint8_t kSOF0 = 0xC0;
+    const uint8_t kSOS = 0xDA;
+    const uint8_t kRST0 = 0xD0;
+    const uint8_t kRST7 = 0xD7;
+
+    const std::vector<uint8_t>& code = strip->code;
+    size_t pos = 2;  // SOI
+    bool foundSof = false;
+    while (true) {
+        if (pos + 4 > code.size() || code[pos] != kMarker) {
+            ALOGE("%s: malformed segment at offset %zu", __FUNCTION__, pos);
+            return -1;
+        }
+        uint8_t marker = code[pos + 1];
+        size_t segmentSize = (static_cast<size_t>(code[pos + 2]) << 8) | code[pos + 3];
+        if (marker == kSOF0) {
+            strip->sofOffset = pos;
+            foundSof = true;
+        }
+        pos += 2 + segmentSize;
+        if (marker == kSOS) {
+            break;
+        }
+    }
+    /* libjpeg writes EOI right after the entropy coded data */
+    if (!foundSof || pos + 2 > code.size()) {
+        ALOGE("%s: incomplete JPEG strip", __FUNCTION__);
+        return -1;
+    }
+    strip->scanOffset = pos;
+    strip->scanSize = code.size() - 2 - pos;
+
+    /* 0xFF in entropy coded data is always followed by a stuffed 0x00, so any 0xFF followed
+     * by RSTn is a restart marker */
+    uint8_t* scan = strip->code.data() + strip->scanOffset;
+    for (size_t i = 0; i + 1 < strip->scanSize; i++) {
+        if (scan[i] == kMarker && scan[i + 1] >= kRST0 && scan[i + 1] <= kRST7) {
+            scan[i + 1] = kRST0 + ((scan[i + 1] - kRST0 + firstRestart) & 7);
+            i++;
+        }
+    }
+    return 0;
+}
+
+}  // anonymous namespace
+
+int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
+                   const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
+                   size_t& actualCodeSize) {
+    int numStrips = std::min(static_cast<int64_t>(std::thread::hardware_concurrency()),
+                             static_cast<int64_t>(inSz.width) * inSz.height / kMinJpegStripPixels);
+    return encodeJpegYU12(inSz, inLayout, jpegQuality, app1Buffer, app1Size, out, maxOutSize,
+                          actualCodeSize, std::max(numStrips, 1));
+}
+
+int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
+                   const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
+                   size_t& actualCodeSize, int numStrips) {
+    /* YUV420 MCUs are 2 blocks high */
+    const int32_t kMcuHeight = DCTSIZE * 2;
+    int32_t mcuRows = (inSz.height + kMcuHeight - 1) / kMcuHeight;
+    int32_t stripMcuRows = (mcuRows + std::max(numStrips, 1) - 1) / std::max(numStrips, 1);
+    numStrips = (mcuRows + stripMcuRows - 1) / stripMcuRows;
+    if (numStrips <= 1) {
+        return encodeJpegYU12Impl(inSz, inLayout, jpegQuality, app1Buffer, app1Size, out,
+                                  maxOutSize, /*growableOut*/ nullptr, /*restartInRows*/ 0,
+                                  actualCodeSize);
+    }
+
+    /* Every strip is encoded as an image of its own with a restart marker after every MCU
+     * row. As a restart resets the DC predictors, the scans of the strips can be joined into
+     * one scan with a restart marker in between them. */
+    std::vector<JpegStrip> strips(numStrips);
+    auto encodeStrip = [&](int i) {
+        int32_t top = i * stripMcuRows * kMcuHeight;
+        Size stripSz{inSz.width, std::min(stripMcuRows * kMcuHeight, inSz.height - top)};
+        YCbCrLayout stripLayout = inLayout;
+        stripLayout.y = static_cast<uint8_t*>(inLayout.y) + top * inLayout.yStride;
+        stripLayout.cb = static_cast<uint8_t*>(inLayout.cb) + top / 2 * inLayout.cStride;
+        stripLayout.cr = static_cast<uint8_t*>(inLayout.cr) + top / 2 * inLayout.cStride;
+
+        /* Roughly 1 byte per pixel, the buffer grows if needed */
+        JpegStrip& strip = strips[i];
+        strip.code.resize(static_cast<size_t>(stripSz.width) * stripSz.height +
+                          (i == 0 ? app1Size : 0));
+        size_t codeSize = 0;
+        int ret = encodeJpegYU12Impl(stripSz, stripLayout, jpegQuality,
+                                     i == 0 ? app1Buffer : nullptr, i == 0 ? app1Size : 0,
+                                     nullptr, 0, &strip.code, /*restartInRows*/ 1, codeSize);
+        if (ret != 0) {
+            return ret;
+        }
+        strip.code.resize(codeSize);
+        return prepareJpegStrip(&strip, i * stripMcuRows);
+    };
+
+    /* The first strip is encoded on this thread */
+    std::vector<std::future<int>> pending;
+    for (int i = 1; i < numStrips; i++) {
+        pending.push_back(std::async(std::launch::async, encodeStrip, i));
+    }
+    int ret = encodeStrip(0);
+    for (auto& strip : pending) {
+        int stripRet = strip.get();
+        if (ret == 0) {
+            ret = stripRet;
+        }
+    }
+    if (ret != 0) {
+        ALOGE("%s: encoding strips failed", __FUNCTION__);
+        return ret;
+    }
+
+    /* Headers of the first strip, one scan made of all strips, EOI */
+    size_t codeSize = strips[0].scanOffset + 2 * (numStrips - 1) + 2;
+    for (const auto& strip : strips) {
+        codeSize += strip.scanSize;
+    }
+    if (codeSize > maxOutSize) {
+        ALOGE("%s: JPEG image size %zu exceeds buffer size %zu", __FUNCTION__, codeSize,
+              maxOutSize);
+        return -1;
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    std::memcpy(dst, strips[0].code.data(), strips[0].scanOffset);
+    /* SOF0: marker, length, precision, height. The first strip has the height of a strip. */
+    dst[strips[0].sofOffset + 5] = static_cast<uint8_t>(inSz.height >> 8);
+    dst[strips[0].sofOffset + 6] = static_cast<uint8_t>(inSz.height & 0xFF);
+    dst += strips[0].scanOffset;
+    for (int i = 0; i < numStrips; i++) {
+        if (i > 0) {
+            /* Restart marker after the last MCU row of the previous strip */
+            *dst++ = 0xFF;
+            *dst++ = 0xD0 + ((i * stripMcuRows - 1) & 7);
+        }
+        std::memcpy(dst, strips[i].code.data() + strips[i].scanOffset, strips[i].scanSize);
+        dst += strips[i].scanSize;
+    }
+    *dst++ = 0xFF;
+    *dst++ = 0xD9;  // EOI
+
+    actualCodeSize = codeSize;
+    return 0;
+}
+
+int decodeMjpeg(const uint8_t* in, size_t inSize, const YCbCrLayout& out, Size sz,
+                uint32_t format) {
+    int ret = 0;
+    switch (format) {
+        case V4L2_PIX_FMT_NV21:
+            ret = libyuv::MJPGToNV21(
+                    in, inSize, static_cast<uint8_t*>(out.y), static_cast<int32_t>(out.yStride),
+                    static_cast<uint8_t*>(out.cr), static_cast<int32_t>(out.cStride),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height));
+            break;
+        case V4L2_PIX_FMT_NV12:
+            ret = libyuv::MJPGToNV12(
+                    in, inSize, static_cast<uint8_t*>(out.y), static_cast<int32_t>(out.yStride),
+                    static_cast<uint8_t*>(out.cb), static_cast<int32_t>(out.cStride),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height));
+            break;
+        case V4L2_PIX_FMT_YVU420:  // YV12
+        case V4L2_PIX_FMT_YUV420:  // YU12
+            ret = libyuv::MJPGToI420(
+                    in, inSize, static_cast<uint8_t*>(out.y), static_cast<int32_t>(out.yStride),
+                    static_cast<uint8_t*>(out.cb), static_cast<int32_t>(out.cStride),
+                    static_cast<uint8_t*>(out.cr), static_cast<int32_t>(out.cStride),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height),
+                    static_cast<int32_t>(sz.width), static_cast<int32_t>(sz.height));
+            break;
+        case FLEX_YUV_GENERIC:
+            ALOGE("%s: unsupported flexible yuv layout"
+                  " y %p cb %p cr %p y_str %d c_str %d c_step %d",
+                  __FUNCTION__, out.y, out.cb, out.cr, out.yStride, out.cStride, out.chromaStep);
+            return -1;
+        default:
+            ALOGE("%s: unknown YUV format 0x%x!", __FUNCTION__, format);
+            return -1;
+    }
+    if (ret != 0) {
+        ALOGE("%s: decode MJPEG to format 0x%x failed! ret %d", __FUNCTION__, format, ret);
+    }
+    return ret;
+}
+
+int getMjpegBody(const uint8_t* in, size_t inSize, MjpegBody* out) {
+    const uint8_t kMarker = 0xFF;
+    const uint8_t kSOI = 0xD8;
+    const uint8_t kEOI = 0xD9;
+    const uint8_t kSOS = 0xDA;
+    const uint8_t kDHT = 0xC4;
+    const uint8_t kAPP0 = 0xE0;
+    const uint8_t kAPP14 = 0xEE;
+    const uint8_t kAPP15 = 0xEF;
+    const char kAdobe[] = "Adobe";
+
+    if (in == nullptr || out == nullptr || inSize < 4 || in[0] != kMarker || in[1] != kSOI) {
+        ALOGV("%s: not a JPEG image", __FUNCTION__);
+        return -EINVAL;
+    }
+
+    // Walk the segments up to the start of scan. The APPn segments right after SOI are
+    // replaced by the caller, except for the Adobe APP14 segment. The body starts at the first
+    // other segment.
+    MjpegBody body;
+    size_t pos = 2;
+    bool hasHuffmanTables = false;
+    while (true) {
+        if (pos + 4 > inSize || in[pos] != kMarker) {
+            ALOGV("%s: malformed segment at offset %zu", __FUNCTION__, pos);
+            return -EINVAL;
+        }
+        uint8_t marker = in[pos + 1];
+        if (marker == kMarker) {
+            pos++;  // Fill byte
+            continue;
+        }
+        if (body.offset == 0 && (marker < kAPP0 || marker > kAPP15)) {
+            body.offset = pos;
+        }
+        if (marker == kSOS) {
+            break;
+        }
+        hasHuffmanTables |= (marker == kDHT);
+        size_t segmentSize = (static_cast<size_t>(in[pos + 2]) << 8) | in[pos + 3];
+        if (segmentSize < 2 || pos + 2 + segmentSize > inSize) {
+            ALOGV("%s: malformed segment at offset %zu", __FUNCTION__, pos);
+            return -EINVAL;
+        }
+        if (body.offset == 0 && marker == kAPP14 && body.app14Size == 0 &&
+            segmentSize >= 2 + sizeof(kAdobe) - 1 &&
+            std::memcmp(in + pos + 4, kAdobe, sizeof(kAdobe) - 1) == 0) {
+            body.app14Offset = pos;
+            body.app14Size = 2 + segmentSize;
+        }
+        pos += 2 + segmentSize;
+    }
+
+    // Many UVC cameras omit the Huffman tables and rely on the default ones, such frames are
+    // not complete JPEG images.
+    if (!hasHuffmanTables) {
+        ALOGV("%s: MJPEG frame has no Huffman tables", __FUNCTION__);
+        return -EINVAL;
+    }
+
+    // Drop any padding the camera added after EOI
+    size_t end = inSize;
+    while (end >= pos + 2 && !(in[end - 2] == kMarker && in[end - 1] == kEOI)) {
+        end--;
+    }
+    if (end < pos + 2) {
+        ALOGV("%s: MJPEG frame has no EOI", __FUNCTION__);
+        return -EINVAL;
+    }
+
+    body.size = end - body.offset;
+    *out = body;
+    return 0;
+}
+
+int writeJpegWithApp1(const uint8_t* mjpeg, const MjpegBody& body, const void* app1Buffer,
+                      size_t app1Size, void* out, size_t maxOutSize, size_t& actualCodeSize) {
+    // The segment length includes the 2 bytes of the length field itself
+    size_t app1SegmentSize = (app1Buffer && app1Size) ? app1Size + 2 : 0;
+    if (app1SegmentSize > 0xFFFF) {
+        ALOGE("%s: APP1 segment too large (%zu)", __FUNCTION__, app1SegmentSize);
+        return -EINVAL;
+    }
+
+    size_t codeSize =
+            2 + (app1SegmentSize > 0 ? 2 + app1SegmentSize : 0) + body.app14Size + body.size;
+    if (codeSize > maxOutSize) {
+        ALOGE("%s: JPEG image size %zu exceeds buffer size %zu", __FUNCTION__, codeSize,
+              maxOutSize);
+        return -ENOSPC;
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    *dst++ = 0xFF;
+    *dst++ = 0xD8;  // SOI
+    if (app1SegmentSize > 0) {
+        *dst++ = 0xFF;
+        *dst++ = 0xE1;  // APP1
+        *dst++ = static_cast<uint8_t>(app1SegmentSize >> 8);
+        *dst++ = static_cast<uint8_t>(app1SegmentSize & 0xFF);
+        std::memcpy(dst, app1Buffer, app1Size);
+        dst += app1Size;
+    }
+    std::memcpy(dst, mjpeg + body.app14Offset, body.app14Size);
+    dst += body.app14Size;
+    std::memcpy(dst, mjpeg + body.offset, body.size);
+
+    actualCodeSize = codeSize;
+    return 0;
+}
+
 Size getMaxThumbnailResolution(const common::V1_0::helper::CameraMetadata& chars) {
     Size thumbSize{0, 0};
     camera_metadata_ro_entry entry = chars.find(ANDROID_JPEG_AVAILABLE_THUMBNAIL_SIZES);
@@ -25,11 +25,14 @@
 #include <aidl/android/hardware/camera/device/NotifyMsg.h>
 #include <aidl/android/hardware/graphics/common/BufferUsage.h>
 #include <aidl/android/hardware/graphics/common/PixelFormat.h>
+#include <android-base/unique_fd.h>
 #include <android/hardware/graphics/mapper/2.0/IMapper.h>
 #include <android/hardware/graphics/mapper/3.0/IMapper.h>
 #include <android/hardware/graphics/mapper/4.0/IMapper.h>
+#include <linux/videodev2.h>
 #include <tinyxml2.h>
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -69,6 +72,14 @@ struct SizeHasher {
     }
 };
 
+// How the V4L2 capture buffers are allocated and accessed by the CPU
+enum class V4L2MemoryType {
+    MMAP,           // Allocated by the driver, mapped through the V4L2 device
+    DMABUF_EXPORT,  // Allocated by the driver, exported as DMA-BUFs with VIDIOC_EXPBUF
+    DMABUF_IMPORT,  // Allocated from a DMA-BUF heap, imported with V4L2_MEMORY_DMABUF
+    USERPTR,        // Page aligned CPU memory, imported with V4L2_MEMORY_USERPTR
+};
+
 struct ExternalCameraConfig {
     static const char* kDefaultCfgPath;
     static ExternalCameraConfig loadFromCfg(const char* cfgPath = kDefaultCfgPath);
@@ -91,6 +102,12 @@ struct ExternalCameraConfig {
     // Size of v4l2 buffer queue when streaming > kMaxVideoSize
     uint32_t numStillBuffers;
 
+    // How the v4l2 buffers are allocated. Falls back to MMAP if the device does not support it.
+    V4L2MemoryType v4l2MemoryType;
+
+    // Name of the DMA-BUF heap the v4l2 buffers are allocated from with DMABUF_IMPORT
+    std::string dmaBufHeap;
+
     // Indication that the device connected supports depth output
     bool depthEnabled;
 
@@ -147,25 +164,70 @@ struct Frame : public std::enable_shared_from_this<Frame> {
     virtual int getData(uint8_t** outData, size_t* dataSize) = 0;
 };
 
+using ::android::hardware::camera::external::common::V4L2MemoryType;
+
+// The V4L2 capture buffers of a stream. The buffers are allocated and mapped for the CPU once
+// when streaming is configured and recycled for every frame, instead of being mapped and
+// unmapped for every dequeued frame.
+class V4L2BufferPool {
+  public:
+    // Doesn't claim ownership of v4l2Fd. dmaBufHeap is only used with DMABUF_IMPORT.
+    V4L2BufferPool(int v4l2Fd, V4L2MemoryType memoryType, const std::string& dmaBufHeap);
+    ~V4L2BufferPool();
+
+    // Requests count buffers of at least bufferSize bytes and maps them. The driver might
+    // allocate more buffers than requested. Returns 0 on success or a negative errno.
+    int allocate(uint32_t count, uint32_t bufferSize);
+    // Unmaps and frees all the buffers. Must be called after streaming is stopped.
+    int release();
+
+    int queueBuffer(uint32_t index);
+    int dequeueBuffer(v4l2_buffer* buffer);
+
+    // CPU reads of a dequeued buffer must be bracketed by beginCpuAccess and endCpuAccess to
+    // keep caches coherent with DMA-BUF backed buffers.
+    int beginCpuAccess(uint32_t index, uint8_t** data);
+    int endCpuAccess(uint32_t index);
+
+    uint32_t getBufferCount() const { return mBuffers.size(); }
+    V4L2MemoryType getMemoryType() const { return mMemoryType; }
+
+  private:
+    struct Buffer {
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        ::android::base::unique_fd dmaBufFd;  // DMABUF_EXPORT and DMABUF_IMPORT only
+    };
+
+    int allocateBuffer(uint32_t index, uint32_t bufferSize, int dmaHeapFd, Buffer* buffer);
+    void freeBuffers();
+
+    const int mV4l2Fd;
+    const V4L2MemoryType mMemoryType;
+    const std::string mDmaBufHeap;
+    const uint32_t mV4l2Memory;  // V4L2_MEMORY_* used for VIDIOC_REQBUFS/QBUF/DQBUF
+    std::vector<Buffer> mBuffers;
+};
+
 // A class provide access to a dequeued V4L2 frame buffer (mostly in MJPG format)
 // Also contains necessary information to enqueue the buffer back to V4L2 buffer queue
 class V4L2Frame : public Frame {
   public:
-    V4L2Frame(uint32_t w, uint32_t h, uint32_t fourcc, int bufIdx, int fd, uint32_t dataSize,
-              uint64_t offset);
+    V4L2Frame(uint32_t w, uint32_t h, uint32_t fourcc, int bufIdx,
+              std::shared_ptr<V4L2BufferPool> bufferPool, uint32_t dataSize);
     virtual ~V4L2Frame();
 
     virtual int getData(uint8_t** outData, size_t* dataSize) override;
 
     const int mBufferIndex;  // for later enqueue
+    // The buffer stays mapped in the buffer pool, map/unmap begin and end CPU access to it
     int map(uint8_t** data, size_t* dataSize);
     int unmap();
 
   private:
     std::mutex mLock;
-    const int mFd;  // used for mmap but doesn't claim ownership
+    const std::shared_ptr<V4L2BufferPool> mBufferPool;
     const size_t mDataSize;
-    const uint64_t mOffset;  // used for mmap
     uint8_t* mData = nullptr;
     bool mMapped = false;
 };
@@ -247,10 +309,45 @@ int getCropRect(CroppingType ct, const Size& inSize, const Size& outSize, IMappe
 
 int formatConvert(const YCbCrLayout& in, const YCbCrLayout& out, Size sz, uint32_t format);
 
+// Encode a YU12 image into a baseline JPEG. Images of several megapixels are split into
+// horizontal strips compressed in parallel, one per CPU at most.
 int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
                    const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
                    size_t& actualCodeSize);
 
+// Same as above with numStrips strips of whole MCU rows compressed in parallel and stitched
+// into one image, with a restart marker after every MCU row. With a single strip the image is
+// encoded on the calling thread without restart markers.
+int encodeJpegYU12(const Size& inSz, const YCbCrLayout& inLayout, int jpegQuality,
+                   const void* app1Buffer, size_t app1Size, void* out, size_t maxOutSize,
+                   size_t& actualCodeSize, int numStrips);
+
+// Decode a MJPEG frame of size sz directly into a YV12/YU12/NV12/NV21 output layout
+int decodeMjpeg(const uint8_t* in, size_t inSize, const YCbCrLayout& out, Size sz,
+                uint32_t format);
+
+// The parts of a MJPEG frame kept when it is passed through to a JPEG output buffer, as
+// offsets into the frame
+struct MjpegBody {
+    // Adobe APP14 segment among the leading APPn segments, if any. Decoders need it to tell
+    // RGB from YCbCr components.
+    size_t app14Offset = 0;
+    size_t app14Size = 0;
+    // From the first segment following SOI and the leading APPn segments, up to and including EOI
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+// Locate the parts of a MJPEG frame to keep when replacing its leading APPn segments. Fails if
+// the frame is not a complete JPEG image, so it cannot be passed through to a JPEG output
+// buffer.
+int getMjpegBody(const uint8_t* in, size_t inSize, /*out*/ MjpegBody* out);
+
+// Write SOI, an APP1 segment with the given payload, then the APP14 segment and the body found
+// by getMjpegBody in the MJPEG frame
+int writeJpegWithApp1(const uint8_t* mjpeg, const MjpegBody& body, const void* app1Buffer,
+                      size_t app1Size, void* out, size_t maxOutSize, size_t& actualCodeSize);
+
 Size getMaxThumbnailResolution(const common::V1_0::helper::CameraMetadata&);
 
 void freeReleaseFences(std::vector<CaptureResult>&);
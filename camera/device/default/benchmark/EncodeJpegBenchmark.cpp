@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ExternalCameraUtils.h"
+
+#include <benchmark/benchmark.h>
+#include <jpeglib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace android::hardware::camera::device::implementation {
+namespace {
+
+const int kJpegQuality = 90;
+
+// A YU12 image with smooth gradients and some high frequency detail, so that the encoder does
+// not work on flat blocks only.
+std::vector<uint8_t> createYu12Image(int32_t width, int32_t height) {
+    std::vector<uint8_t> image(width * height * 3 / 2);
+    uint8_t* y = image.data();
+    for (int32_t row = 0; row < height; row++) {
+        for (int32_t col = 0; col < width; col++) {
+            y[row * width + col] = (col * 255 / width + ((row * col) >> 6)) & 0xFF;
+        }
+    }
+    uint8_t* cb = y + width * height;
+    uint8_t* cr = cb + width * height / 4;
+    for (int32_t row = 0; row < height / 2; row++) {
+        for (int32_t col = 0; col < width / 2; col++) {
+            cb[row * width / 2 + col] = 64 + (row * 128 / height);
+            cr[row * width / 2 + col] = 192 - (col * 128 / width);
+        }
+    }
+    return image;
+}
+
+YCbCrLayout getYu12Layout(std::vector<uint8_t>& image, int32_t width, int32_t height) {
+    YCbCrLayout layout;
+    layout.y = image.data();
+    layout.cb = image.data() + width * height;
+    layout.cr = image.data() + width * height * 5 / 4;
+    layout.yStride = width;
+    layout.cStride = width / 2;
+    layout.chromaStep = 1;
+    return layout;
+}
+
+// Decodes the JPEG image and returns the PSNR of its luma against the source image, or 0 if
+// the image cannot be decoded.
+double getLumaPsnr(const uint8_t* jpeg, size_t jpegSize, const uint8_t* y, int32_t width,
+                   int32_t height) {
+    jpeg_decompress_struct cinfo = {};
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, jpeg, jpegSize);
+    if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK ||
+        cinfo.image_width != static_cast<JDIMENSION>(width) ||
+        cinfo.image_height != static_cast<JDIMENSION>(height)) {
+        jpeg_destroy_decompress(&cinfo);
+        return 0;
+    }
+    cinfo.out_color_space = JCS_YCbCr;
+    jpeg_start_decompress(&cinfo);
+
+    std::vector<uint8_t> row(width * cinfo.output_components);
+    double squaredError = 0;
+    while (cinfo.output_scanline < cinfo.output_height) {
+        const uint8_t* src = y + cinfo.output_scanline * width;
+        JSAMPROW rowPtr = row.data();
+        jpeg_read_scanlines(&cinfo, &rowPtr, 1);
+        for (int32_t col = 0; col < width; col++) {
+            double diff = row[col * cinfo.output_components] - src[col];
+            squaredError += diff * diff;
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    double mse = squaredError / (static_cast<double>(width) * height);
+    return mse == 0 ? 100 : 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+// Arguments: number of strips, width, height. One strip is the single threaded encoder without
+// restart markers.
+void BM_EncodeJpegYU12(benchmark::State& state) {
+    const int numStrips = state.range(0);
+    const int32_t width = state.range(1);
+    const int32_t height = state.range(2);
+
+    std::vector<uint8_t> image = createYu12Image(width, height);
+    YCbCrLayout layout = getYu12Layout(image, width, height);
+    std::vector<uint8_t> out(width * height * 3 / 2);
+    size_t codeSize = 0;
+
+    for (auto _ : state) {
+        if (encodeJpegYU12(Size{width, height}, layout, kJpegQuality, /*app1Buffer*/ nullptr,
+                           /*app1Size*/ 0, out.data(), out.size(), codeSize, numStrips) != 0) {
+            state.SkipWithError("encodeJpegYU12 failed");
+            return;
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["bytes"] = codeSize;
+    state.counters["psnr"] = getLumaPsnr(out.data(), codeSize, image.data(), width, height);
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void getArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"strips", "width", "height"});
+    const int maxStrips = std::max(std::thread::hardware_concurrency(), 4u);
+    for (auto [width, height] : {std::pair(1920, 1080), std::pair(3264, 2448),
+                                 std::pair(4000, 3000), std::pair(4208, 3120)}) {
+        for (int numStrips = 1; numStrips <= maxStrips; numStrips *= 2) {
+            b->Args({numStrips, width, height});
+        }
+    }
+    b->UseRealTime();
+    b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_EncodeJpegYU12)->Apply(getArguments);
+
+}  // namespace
+}  // namespace android::hardware::camera::device::implementation
+
+BENCHMARK_MAIN();
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Captures frames from a V4L2 device with every V4L2MemoryType and reads each frame like the
+// decode stage of the external camera HAL does. Without a USB camera, the vivid virtual driver
+// can be used:
+//     modprobe vivid
+//     V4L2_CAPTURE_DEVICE=/dev/video0 camera.device-external-impl_benchmark
+
+#include "ExternalCameraUtils.h"
+
+#include <android-base/unique_fd.h>
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace android::hardware::camera::device::implementation {
+namespace {
+
+using ::android::base::unique_fd;
+
+const uint32_t kNumBuffers = 4;
+
+const char* getDevicePath() {
+    const char* path = getenv("V4L2_CAPTURE_DEVICE");
+    return path != nullptr ? path : "/dev/video0";
+}
+
+// Arguments: width, height. Returns the size of a frame, or 0 on failure.
+uint32_t setFormat(int fd, uint32_t width, uint32_t height) {
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (ioctl(fd, VIDIOC_G_FMT, &fmt) < 0) {
+        return 0;
+    }
+    fmt.fmt.pix.width = width;
+    fmt.fmt.pix.height = height;
+    if (ioctl(fd, VIDIOC_S_FMT, &fmt) < 0) {
+        return 0;
+    }
+    return fmt.fmt.pix.sizeimage;
+}
+
+int setStreaming(int fd, bool on) {
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    return ioctl(fd, on ? VIDIOC_STREAMON : VIDIOC_STREAMOFF, &type);
+}
+
+// Arguments: memory type, map every frame, width, height. Mapping every frame reproduces how
+// V4L2Frame mapped MMAP buffers before they were pooled.
+void BM_V4L2Capture(benchmark::State& state) {
+    const auto memoryType = static_cast<V4L2MemoryType>(state.range(0));
+    const bool mapEveryFrame = state.range(1) != 0;
+    const uint32_t width = state.range(2);
+    const uint32_t height = state.range(3);
+
+    unique_fd fd(open(getDevicePath(), O_RDWR | O_CLOEXEC));
+    if (fd.get() < 0) {
+        state.SkipWithError("Cannot open the V4L2 device, set V4L2_CAPTURE_DEVICE");
+        return;
+    }
+    uint32_t bufferSize = setFormat(fd.get(), width, height);
+    if (bufferSize == 0) {
+        state.SkipWithError("Cannot set the capture format");
+        return;
+    }
+
+    auto pool = std::make_shared<V4L2BufferPool>(fd.get(), memoryType, "system");
+    if (pool->allocate(kNumBuffers, bufferSize) != 0) {
+        state.SkipWithError("Memory type not supported by the device");
+        return;
+    }
+    for (uint32_t i = 0; i < pool->getBufferCount(); i++) {
+        pool->queueBuffer(i);
+    }
+    if (setStreaming(fd.get(), true) < 0) {
+        pool->release();
+        state.SkipWithError("VIDIOC_STREAMON failed");
+        return;
+    }
+
+    std::vector<uint8_t> decoded(bufferSize);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        v4l2_buffer buffer;
+        if (pool->dequeueBuffer(&buffer) != 0) {
+            state.SkipWithError("VIDIOC_DQBUF failed");
+            break;
+        }
+
+        if (mapEveryFrame) {
+            v4l2_buffer query{};
+            query.index = buffer.index;
+            query.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            query.memory = V4L2_MEMORY_MMAP;
+            ioctl(fd.get(), VIDIOC_QUERYBUF, &query);
+            void* data = mmap(nullptr, buffer.bytesused, PROT_READ, MAP_SHARED, fd.get(),
+                              query.m.offset);
+            if (data == MAP_FAILED) {
+                state.SkipWithError("mmap failed");
+                break;
+            }
+            memcpy(decoded.data(), data, buffer.bytesused);
+            munmap(data, buffer.bytesused);
+        } else {
+            V4L2Frame frame(width, height, 0, buffer.index, pool, buffer.bytesused);
+            uint8_t* data;
+            size_t dataSize;
+            if (frame.getData(&data, &dataSize) != 0) {
+                state.SkipWithError("V4L2Frame::getData failed");
+                break;
+            }
+            memcpy(decoded.data(), data, dataSize);
+            frame.unmap();
+        }
+        benchmark::DoNotOptimize(decoded.data());
+        bytes += buffer.bytesused;
+
+        pool->queueBuffer(buffer.index);
+    }
+
+    setStreaming(fd.get(), false);
+    pool->release();
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+
+void getArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"memory", "mapEveryFrame", "width", "height"});
+    for (auto [width, height] : {std::pair(640, 480), std::pair(1920, 1080)}) {
+        b->Args({static_cast<int>(V4L2MemoryType::MMAP), 1, width, height});
+        for (V4L2MemoryType memoryType :
+             {V4L2MemoryType::MMAP, V4L2MemoryType::DMABUF_EXPORT, V4L2MemoryType::DMABUF_IMPORT,
+              V4L2MemoryType::USERPTR}) {
+            b->Args({static_cast<int>(memoryType), 0, width, height});
+        }
+    }
+}
+
+BENCHMARK(BM_V4L2Capture)->Apply(getArguments);
+
+}  // namespace
+}  // namespace android::hardware::camera::device::implementation
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ExternalCameraUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+
+namespace android::hardware::camera::device::implementation {
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+const Bytes kSoi = {0xFF, 0xD8};
+const Bytes kEoi = {0xFF, 0xD9};
+
+// A segment with the given marker and payload, the length field is filled in
+Bytes segment(uint8_t marker, const Bytes& payload) {
+    size_t length = payload.size() + 2;
+    Bytes bytes = {0xFF, marker, static_cast<uint8_t>(length >> 8),
+                   static_cast<uint8_t>(length & 0xFF)};
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    return bytes;
+}
+
+Bytes concat(const std::vector<Bytes>& parts) {
+    Bytes bytes;
+    for (const auto& part : parts) {
+        bytes.insert(bytes.end(), part.begin(), part.end());
+    }
+    return bytes;
+}
+
+Bytes slice(const Bytes& bytes, size_t offset, size_t size) {
+    return Bytes(bytes.begin() + offset, bytes.begin() + offset + size);
+}
+
+const Bytes kApp0 = segment(0xE0, {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0});
+const Bytes kApp14 = segment(0xEE, {'A', 'd', 'o', 'b', 'e', 0, 100, 0, 0, 0, 0, 1});
+const Bytes kDqt = segment(0xDB, Bytes(65, 1));
+const Bytes kSof = segment(0xC0, {8, 0, 16, 0, 16, 1, 1, 0x11, 0});
+const Bytes kDht = segment(0xC4, Bytes(29, 0));
+const Bytes kSos = segment(0xDA, {1, 1, 0, 0, 63, 0});
+const Bytes kScan = {0x12, 0x34, 0xFF, 0x00, 0x56};
+
+// The tables, frame header and scan of a frame, up to and including EOI
+const Bytes kBody = concat({kDqt, kSof, kDht, kSos, kScan, kEoi});
+
+// A YU12 image with distinct content in every MCU
+struct Yu12Image {
+    Yu12Image(int32_t width, int32_t height)
+        : size{width, height},
+          y(width * height),
+          cb((width / 2) * ((height + 1) / 2)),
+          cr(cb.size()) {
+        for (int32_t row = 0; row < height; row++) {
+            for (int32_t col = 0; col < width; col++) {
+                y[row * width + col] = static_cast<uint8_t>(col * 3 + row * 7 + (col * row >> 5));
+            }
+        }
+        for (size_t i = 0; i < cb.size(); i++) {
+            cb[i] = static_cast<uint8_t>(i * 13);
+            cr[i] = static_cast<uint8_t>(i >> 3);
+        }
+    }
+
+    YCbCrLayout layout() {
+        YCbCrLayout layout = {};
+        layout.y = y.data();
+        layout.cb = cb.data();
+        layout.cr = cr.data();
+        layout.yStride = size.width;
+        layout.cStride = size.width / 2;
+        layout.chromaStep = 1;
+        return layout;
+    }
+
+    bool operator==(const Yu12Image& other) const {
+        return size == other.size && y == other.y && cb == other.cb && cr == other.cr;
+    }
+
+    Size size;
+    Bytes y;
+    Bytes cb;
+    Bytes cr;
+};
+
+}  // namespace
+
+TEST(ExternalCameraUtilsTest, GetMjpegBodySkipsLeadingAppSegments) {
+    Bytes frame = concat({kSoi, kApp0, segment(0xE1, {'E', 'x', 'i', 'f', 0, 0}), kBody});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+    EXPECT_EQ(kBody, slice(frame, body.offset, body.size));
+    EXPECT_EQ(0u, body.app14Size);
+}
+
+TEST(ExternalCameraUtilsTest, GetMjpegBodyKeepsAdobeApp14) {
+    Bytes frame = concat({kSoi, kApp0, kApp14, segment(0xEE, {'O', 't', 'h', 'e', 'r'}), kBody});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+    EXPECT_EQ(kApp14, slice(frame, body.app14Offset, body.app14Size));
+    EXPECT_EQ(kBody, slice(frame, body.offset, body.size));
+}
+
+TEST(ExternalCameraUtilsTest, GetMjpegBodyDropsPaddingAfterEoi) {
+    Bytes frame = concat({kSoi, kApp0, kBody, Bytes(16, 0)});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+    EXPECT_EQ(kBody, slice(frame, body.offset, body.size));
+}
+
+TEST(ExternalCameraUtilsTest, GetMjpegBodySkipsFillBytes) {
+    Bytes frame = concat({kSoi, kApp0, {0xFF, 0xFF}, kBody});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+    EXPECT_EQ(kBody, slice(frame, body.offset, body.size));
+}
+
+TEST(ExternalCameraUtilsTest, GetMjpegBodyRejectsIncompleteFrames) {
+    MjpegBody body;
+    Bytes notJpeg = concat({{0x00, 0x00}, kApp0, kBody});
+    EXPECT_EQ(-EINVAL, getMjpegBody(notJpeg.data(), notJpeg.size(), &body));
+    // UVC cameras may rely on the default Huffman tables
+    Bytes noHuffmanTables = concat({kSoi, kApp0, kDqt, kSof, kSos, kScan, kEoi});
+    EXPECT_EQ(-EINVAL, getMjpegBody(noHuffmanTables.data(), noHuffmanTables.size(), &body));
+    Bytes noEoi = concat({kSoi, kApp0, kDqt, kSof, kDht, kSos, kScan});
+    EXPECT_EQ(-EINVAL, getMjpegBody(noEoi.data(), noEoi.size(), &body));
+    Bytes noSos = concat({kSoi, kApp0, kDqt, kSof, kDht});
+    EXPECT_EQ(-EINVAL, getMjpegBody(noSos.data(), noSos.size(), &body));
+    Bytes truncated = slice(concat({kSoi, kApp0, kBody}), 0, kSoi.size() + kApp0.size() + 10);
+    EXPECT_EQ(-EINVAL, getMjpegBody(truncated.data(), truncated.size(), &body));
+}
+
+TEST(ExternalCameraUtilsTest, WriteJpegWithApp1) {
+    Bytes frame = concat({kSoi, kApp0, kApp14, kBody, Bytes(4, 0)});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+
+    Bytes app1 = {'E', 'x', 'i', 'f', 0, 0, 1, 2, 3};
+    Bytes expected = concat({kSoi, segment(0xE1, app1), kApp14, kBody});
+    Bytes out(expected.size());
+    size_t codeSize = 0;
+    ASSERT_EQ(0, writeJpegWithApp1(frame.data(), body, app1.data(), app1.size(), out.data(),
+                                   out.size(), codeSize));
+    EXPECT_EQ(expected.size(), codeSize);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(ExternalCameraUtilsTest, WriteJpegWithoutApp1) {
+    Bytes frame = concat({kSoi, kApp0, kBody});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+
+    Bytes expected = concat({kSoi, kBody});
+    Bytes out(expected.size());
+    size_t codeSize = 0;
+    ASSERT_EQ(0, writeJpegWithApp1(frame.data(), body, nullptr, 0, out.data(), out.size(),
+                                   codeSize));
+    EXPECT_EQ(expected.size(), codeSize);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(ExternalCameraUtilsTest, WriteJpegWithApp1Fails) {
+    Bytes frame = concat({kSoi, kApp0, kBody});
+    MjpegBody body;
+    ASSERT_EQ(0, getMjpegBody(frame.data(), frame.size(), &body));
+
+    Bytes app1 = {'E', 'x', 'i', 'f', 0, 0};
+    Bytes out(kSoi.size() + 4 + app1.size() + kBody.size() - 1);
+    size_t codeSize = 0;
+    EXPECT_EQ(-ENOSPC, writeJpegWithApp1(frame.data(), body, app1.data(), app1.size(),
+                                         out.data(), out.size(), codeSize));
+
+    // The segment length field is 16 bits and includes itself
+    Bytes largeApp1(0xFFFE);
+    out.resize(largeApp1.size() + frame.size() + 4);
+    EXPECT_EQ(-EINVAL, writeJpegWithApp1(frame.data(), body, largeApp1.data(), largeApp1.size(),
+                                         out.data(), out.size(), codeSize));
+    EXPECT_EQ(0u, codeSize);
+}
+
+TEST(ExternalCameraUtilsTest, EncodeJpegYU12InStrips) {
+    // The height is not a multiple of the MCU height, so the last strip is padded
+    Yu12Image image(320, 250);
+    Bytes app1 = {'E', 'x', 'i', 'f', 0, 0, 1, 2, 3};
+
+    Bytes single(image.y.size() * 2);
+    size_t singleSize = 0;
+    ASSERT_EQ(0, encodeJpegYU12(image.size, image.layout(), 90, app1.data(), app1.size(),
+                                single.data(), single.size(), singleSize, /*numStrips*/ 1));
+    single.resize(singleSize);
+    Yu12Image singleDecoded(image.size.width, image.size.height);
+    ASSERT_EQ(0, decodeMjpeg(single.data(), single.size(), singleDecoded.layout(), image.size,
+                             V4L2_PIX_FMT_YUV420));
+
+    // Restart markers reset the DC predictors only, so every strip count decodes to the same
+    // image as the single strip, down to the last strip of a single MCU row.
+    for (int numStrips : {2, 3, 16}) {
+        SCOPED_TRACE(numStrips);
+        Bytes strips(image.y.size() * 2);
+        size_t stripsSize = 0;
+        ASSERT_EQ(0, encodeJpegYU12(image.size, image.layout(), 90, app1.data(), app1.size(),
+                                    strips.data(), strips.size(), stripsSize, numStrips));
+        strips.resize(stripsSize);
+        EXPECT_NE(single, strips);
+
+        // The headers, APP1 included, are written once, as for the single strip
+        size_t headersSize = std::search(single.begin(), single.end(), kSos.begin(),
+                                         kSos.begin() + 2) - single.begin();
+        EXPECT_EQ(slice(single, 0, headersSize), slice(strips, 0, headersSize));
+        Bytes app1Segment = segment(0xE1, app1);
+        EXPECT_EQ(strips.end(), std::search(strips.begin() + headersSize, strips.end(),
+                                            app1Segment.begin(), app1Segment.end()));
+
+        Yu12Image stripsDecoded(image.size.width, image.size.height);
+        ASSERT_EQ(0, decodeMjpeg(strips.data(), strips.size(), stripsDecoded.layout(),
+                                 image.size, V4L2_PIX_FMT_YUV420));
+        EXPECT_TRUE(singleDecoded == stripsDecoded);
+    }
+}
+
+}  // namespace android::hardware::camera::device::implementation